@@ -256,6 +256,51 @@ else()
     set(SL_HAVE_IPC 0)
 endif()
 
+# Detect io_uring (Linux). The ring is driven with raw syscalls, so only
+# the kernel UAPI header is needed, not liburing. Whether the running
+# kernel supports it is checked when an I/O thread sets up its ring.
+if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    check_c_source_compiles("
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+int main(void) {
+    struct io_uring_sqe sqe;
+    sqe.opcode = IORING_OP_RECV;
+    sqe.opcode = IORING_OP_SENDMSG;
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    return IORING_FEAT_FAST_POLL + IORING_REGISTER_EVENTFD
+           + __NR_io_uring_setup + __NR_io_uring_enter + sqe.opcode;
+}
+" HAVE_IO_URING)
+endif()
+if(HAVE_IO_URING)
+    set(SL_HAVE_IO_URING 1)
+    message(STATUS "io_uring support detected")
+else()
+    set(SL_HAVE_IO_URING 0)
+endif()
+
+# Detect the shared-memory transport (Linux). The rendezvous runs over a
+# UNIX domain socket that passes a memfd and two eventfds to the peer.
+if(SL_HAVE_IPC AND CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    check_c_source_compiles("
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+int main(void) {
+    int fd = memfd_create(\"x\", MFD_CLOEXEC);
+    return fd + eventfd(0, EFD_NONBLOCK) + SCM_RIGHTS + MSG_CMSG_CLOEXEC;
+}
+" HAVE_SHM_TRANSPORT)
+endif()
+if(HAVE_SHM_TRANSPORT)
+    set(SL_HAVE_SHM 1)
+    message(STATUS "Shared-memory transport support detected")
+else()
+    set(SL_HAVE_SHM 0)
+endif()
+
 # Platform-specific compiler flags
 if(MSVC)
     # MSVC-specific flags
@@ -297,6 +342,8 @@ message(STATUS "  kqueue:          ${SL_HAVE_KQUEUE}")
 message(STATUS "  select:          ${SL_HAVE_SELECT}")
 message(STATUS "  eventfd:         ${SL_HAVE_EVENTFD}")
 message(STATUS "  IPC:             ${SL_HAVE_IPC}")
+message(STATUS "  io_uring:        ${SL_HAVE_IO_URING}")
+message(STATUS "  shm:             ${SL_HAVE_SHM}")
 message(STATUS "  TCP_KEEPIDLE:    ${SL_HAVE_TCP_KEEPIDLE}")
 message(STATUS "  SO_NOSIGPIPE:    ${SL_HAVE_SO_NOSIGPIPE}")
 message(STATUS "  MSG_NOSIGNAL:    ${SL_HAVE_MSG_NOSIGNAL}")
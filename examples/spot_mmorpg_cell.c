@@ -160,26 +160,18 @@ int main(void)
      *   (4,7) [5,7] (6,7)  ← (6,7) is managed by Server B!
      *   (4,8) (5,8) (6,8)
      *
-     * We subscribe to:
-     *   - cell(5,8): local cell, inproc communication
-     *   - cell(6,7): remote cell, TCP communication (if Server B running)
+     * We subscribe to the row of cells below us, (4,8)-(6,8), with one
+     * region subscription instead of one subscription per cell. When the
+     * area of interest moves, subscribing again replaces the region with
+     * a single message, and the publisher matches cells against it in a
+     * spatial index. Cells in the region need not exist yet.
      */
     printf("STEP 4: Subscribing to adjacent cells (Area of Interest)\n\n");
 
-    const char *subscribe_cells[] = {
-        "zone1:cell:5,8",   /* Adjacent local cell */
-        /* "zone1:cell:6,7" would be remote - skipped in demo */
-        NULL
-    };
-
-    for (int i = 0; subscribe_cells[i] != NULL; i++) {
-        if (slk_spot_subscribe(spot, subscribe_cells[i]) < 0) {
-            fprintf(stderr, "Failed to subscribe: %s\n", slk_strerror(slk_errno()));
-        } else {
-            int is_local = slk_spot_topic_is_local(spot, subscribe_cells[i]);
-            printf("  ✓ Subscribed to %s [%s]\n",
-                   subscribe_cells[i], is_local ? "LOCAL" : "REMOTE");
-        }
+    if (slk_spot_subscribe_region(spot, "zone1:cell", 4, 8, 6, 8) < 0) {
+        fprintf(stderr, "Failed to subscribe: %s\n", slk_strerror(slk_errno()));
+    } else {
+        printf("  ✓ Subscribed to region zone1:cell (4,8)-(6,8)\n");
     }
     printf("\n");
     printf("  ℹ When Server B is running, we would also subscribe to cell(6,7)\n");
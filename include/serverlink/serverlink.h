@@ -68,6 +68,13 @@ SL_EXPORT void SL_CALL slk_version(int *major, int *minor, int *patch);
 #define SLK_SNDTIMEO            28
 #define SLK_SUBSCRIBE           6
 #define SLK_UNSUBSCRIBE         7
+/* Pattern subscriptions travel upstream as messages starting with byte 3
+ * (subscribe) or 2 (cancel), region subscriptions with 5 or 4, next to the
+ * ZMTP prefix bytes 1 and 0. Unlike libzmq, XSUB and XPUB consume such
+ * upstream messages instead of passing them on as user messages, so user
+ * messages must not start with bytes 0 to 5. Publishers that do not announce
+ * pattern filtering in the handshake (libzmq) instead get the empty prefix
+ * while any pattern is subscribed, and the SUB filters locally. */
 #define SLK_PSUBSCRIBE          81
 #define SLK_PUNSUBSCRIBE        82
 #define SLK_XPUB_VERBOSE        40
@@ -78,8 +85,20 @@ SL_EXPORT void SL_CALL slk_version(int *major, int *minor, int *patch);
 #define SLK_XPUB_WELCOME_MSG    72
 #define SLK_ONLY_FIRST_SUBSCRIBE    108
 #define SLK_TOPICS_COUNT        80
+#define SLK_XPUB_CONFLATE_TOPIC     120  /* Keep only the newest message per topic for slow peers */
+#define SLK_XPUB_UNCONFLATE_TOPIC   121
+#define SLK_SUBSCRIBE_REGION    122  /* grid name + int32 x0,y0,x1,y1 (big-endian) */
+#define SLK_UNSUBSCRIBE_REGION  123  /* grid name */
+#define SLK_XPUB_CONFLATE_EXACT     124  /* As CONFLATE_TOPIC, for this topic only */
+#define SLK_XPUB_UNCONFLATE_EXACT   125
 #define SLK_INVERT_MATCHING     60
 #define SLK_XSUB_VERBOSE_UNSUBSCRIBE 73
+#define SLK_IN_BATCH_SIZE       101  /* Initial receive buffer size */
+#define SLK_IN_BATCH_MAX        115  /* Receive buffer growth limit */
+#define SLK_INBOUND_POLL_RATE   116  /* Messages received between command checks */
+#define SLK_COMMAND_DELAY       117  /* CPU ticks sends may defer command checks */
+#define SLK_COMMAND_BATCH       118  /* Commands per fast-path check, 0 = all */
+#define SLK_COMMANDS_PROCESSED  119  /* Commands processed so far (uint64_t, read-only) */
 
 /****************************************************************************/
 /*  Message Flags                                                           */
@@ -119,6 +138,13 @@ SL_EXPORT void SL_CALL slk_version(int *major, int *minor, int *patch);
 #define SLK_THREAD_NAME_PREFIX          10
 #define SLK_MAX_MSGSZ                   13
 #define SLK_MSG_T_SIZE                  14
+#define SLK_IO_BACKEND                  16
+
+/* SLK_IO_BACKEND values. Takes effect for I/O threads started afterwards,
+ * i.e. set it before creating the first socket. io_uring falls back to
+ * asio on kernels without io_uring support. */
+#define SLK_IO_BACKEND_ASIO             0
+#define SLK_IO_BACKEND_IO_URING         1
 
 /****************************************************************************/
 /*  Error Codes                                                             */
@@ -146,6 +172,7 @@ SL_EXPORT const char* SL_CALL slk_strerror(int errnum);
 typedef struct slk_ctx_t slk_ctx_t;
 typedef struct slk_socket_t slk_socket_t;
 typedef struct slk_msg_t slk_msg_t;
+typedef void (slk_free_fn)(void *data, void *hint);
 
 SL_EXPORT slk_ctx_t* SL_CALL slk_ctx_new(void);
 SL_EXPORT void SL_CALL slk_ctx_destroy(slk_ctx_t *ctx);
@@ -170,6 +197,11 @@ SL_EXPORT slk_msg_t* SL_CALL slk_msg_new_data(const void *data, size_t size);
 SL_EXPORT void SL_CALL slk_msg_destroy(slk_msg_t *msg);
 SL_EXPORT int SL_CALL slk_msg_init(slk_msg_t *msg);
 SL_EXPORT int SL_CALL slk_msg_init_data(slk_msg_t *msg, const void *data, size_t size);
+/* Wrap a caller-owned buffer without copying. ffn(data, hint) is called once
+ * the last reference is released; with ffn == NULL the buffer must outlive
+ * every copy of the message. */
+SL_EXPORT int SL_CALL slk_msg_init_zerocopy(slk_msg_t *msg, void *data, size_t size,
+                                             slk_free_fn *ffn, void *hint);
 SL_EXPORT int SL_CALL slk_msg_close(slk_msg_t *msg);
 SL_EXPORT void* SL_CALL slk_msg_data(slk_msg_t *msg);
 SL_EXPORT size_t SL_CALL slk_msg_size(slk_msg_t *msg);
@@ -191,6 +223,33 @@ SL_EXPORT int SL_CALL slk_msg_recv(slk_msg_t *msg, slk_socket_t *socket, int fla
 SL_EXPORT int SL_CALL slk_send_to(slk_socket_t *socket, const void *routing_id, size_t id_len,
                                    const void *data, size_t data_len, int flags);
 
+/* One frame of a multipart message */
+typedef struct slk_iovec_t {
+    void *data;
+    size_t len;
+} slk_iovec_t;
+
+/* Send count frames as a single multipart message. Returns the total
+ * number of bytes sent. SLK_SNDMORE in flags applies to the last frame. */
+SL_EXPORT int SL_CALL slk_sendv(slk_socket_t *socket, const slk_iovec_t *frames,
+                                 size_t count, int flags);
+
+/* Receive one multipart message into up to *count frames. Each frame is
+ * truncated to its buffer and frames[i].len is set to its actual size;
+ * frames beyond *count are discarded. On return *count holds the number of
+ * frames stored. Returns the total number of frames in the message. */
+SL_EXPORT int SL_CALL slk_recvv(slk_socket_t *socket, slk_iovec_t *frames,
+                                 size_t *count, int flags);
+
+/* Send count routed messages (routing_ids[i], payloads[i]) with a single
+ * command-processing pass and one pipe flush per destination. Returns the
+ * number of messages sent; stops early and returns the partial count if a
+ * message could not be sent, or -1 if none were. */
+SL_EXPORT int SL_CALL slk_send_to_many(slk_socket_t *socket,
+                                        const slk_iovec_t *routing_ids,
+                                        const slk_iovec_t *payloads,
+                                        size_t count, int flags);
+
 /****************************************************************************/
 /*  Polling API                                                             */
 /****************************************************************************/
@@ -271,6 +330,26 @@ SL_EXPORT int SL_CALL slk_get_peer_stats(slk_socket_t *socket, const void *routi
 SL_EXPORT int SL_CALL slk_get_peers(slk_socket_t *socket, void **peer_ids, size_t *id_lens, size_t *num_peers);
 SL_EXPORT void SL_CALL slk_free_peers(void **peer_ids, size_t *id_lens, size_t num_peers);
 
+/* Sampled message latency, in microseconds. SEND covers slk_send until the
+ * I/O thread takes the message for the wire, RECV covers decoding until
+ * slk_recv returns it. Percentiles are accurate to about 6%. */
+#define SLK_LATENCY_SEND 0
+#define SLK_LATENCY_RECV 1
+
+typedef struct slk_latency_histogram_t {
+    uint64_t count;
+    uint64_t min_us;
+    uint64_t max_us;
+    uint64_t mean_us;
+    uint64_t p50_us;
+    uint64_t p90_us;
+    uint64_t p99_us;
+    uint64_t p999_us;
+} slk_latency_histogram_t;
+
+SL_EXPORT int SL_CALL slk_socket_get_latency_histogram(slk_socket_t *socket, int direction,
+                                                        slk_latency_histogram_t *hist);
+
 /****************************************************************************/
 /*  Utility Functions                                                       */
 /****************************************************************************/
@@ -279,6 +358,16 @@ SL_EXPORT uint64_t SL_CALL slk_clock(void);
 SL_EXPORT void SL_CALL slk_sleep(int ms);
 SL_EXPORT int SL_CALL slk_has(const char *capability);
 
+/* Message allocator counters, summed over all threads */
+typedef struct slk_alloc_stats_t {
+    uint64_t hits;          /* allocations served from a thread cache */
+    uint64_t misses;        /* allocations that fell through to malloc */
+    uint64_t remote_frees;  /* blocks freed by a thread other than their owner */
+    uint64_t cached_bytes;  /* bytes currently held in thread caches */
+} slk_alloc_stats_t;
+
+SL_EXPORT int SL_CALL slk_alloc_stats(slk_alloc_stats_t *stats);
+
 /****************************************************************************/
 /*  Atomic Counter API                                                      */
 /****************************************************************************/
@@ -318,19 +407,43 @@ SL_EXPORT unsigned long SL_CALL slk_stopwatch_stop(void *watch);
 /****************************************************************************/
 
 typedef struct slk_spot_s slk_spot_t;
+typedef struct slk_spot_topic_s slk_spot_topic_handle_t;
 
 SL_EXPORT slk_spot_t* SL_CALL slk_spot_new(slk_ctx_t *ctx);
+/* Publishes through `shards` XPUBs (1-64), each topic through the one its
+ * ID hashes to, so topics on different shards publish in parallel. Every
+ * node of a cluster must use the same count. */
+SL_EXPORT slk_spot_t* SL_CALL slk_spot_new_sharded(slk_ctx_t *ctx, int shards);
 SL_EXPORT void SL_CALL slk_spot_destroy(slk_spot_t **spot);
 SL_EXPORT int SL_CALL slk_spot_topic_create(slk_spot_t *spot, const char *topic_id);
+/* Flags for slk_spot_topic_create_ex */
+#define SLK_SPOT_TOPIC_CONFLATE 1  /* Slow subscribers get only the newest message */
+SL_EXPORT int SL_CALL slk_spot_topic_create_ex(slk_spot_t *spot, const char *topic_id, int flags);
 SL_EXPORT int SL_CALL slk_spot_topic_route(slk_spot_t *spot, const char *topic_id, const char *endpoint);
 SL_EXPORT int SL_CALL slk_spot_topic_destroy(slk_spot_t *spot, const char *topic_id);
 SL_EXPORT int SL_CALL slk_spot_subscribe(slk_spot_t *spot, const char *topic_id);
 SL_EXPORT int SL_CALL slk_spot_subscribe_pattern(slk_spot_t *spot, const char *pattern);
+/* Area-of-interest subscription to the cells "<grid>:<x>,<y>" with
+ * x0 <= x <= x1 and y0 <= y <= y1. One region per grid; subscribing again
+ * moves it, which costs a single message instead of per-cell churn. */
+SL_EXPORT int SL_CALL slk_spot_subscribe_region(slk_spot_t *spot, const char *grid,
+                                                int x0, int y0, int x1, int y1);
+SL_EXPORT int SL_CALL slk_spot_unsubscribe_region(slk_spot_t *spot, const char *grid);
 SL_EXPORT int SL_CALL slk_spot_unsubscribe(slk_spot_t *spot, const char *topic_id);
 SL_EXPORT int SL_CALL slk_spot_publish(slk_spot_t *spot, const char *topic_id, const void *data, size_t len);
 SL_EXPORT int SL_CALL slk_spot_recv(slk_spot_t *spot, char *topic, size_t topic_size,
                                      size_t *topic_len, void *data, size_t data_size,
                                      size_t *data_len, int flags);
+/* Zero-copy variants. publish_msg takes ownership of msg on success (it is
+ * left empty); recv_msg moves both frames into caller-initialised messages. */
+SL_EXPORT int SL_CALL slk_spot_publish_msg(slk_spot_t *spot, const char *topic_id, slk_msg_t *msg);
+SL_EXPORT int SL_CALL slk_spot_recv_msg(slk_spot_t *spot, slk_msg_t *topic, slk_msg_t *data, int flags);
+/* Pre-resolved LOCAL topic handles. A handle is owned by its spot and stays
+ * valid memory until slk_spot_destroy(); publishing through it skips the
+ * topic registry and fails with ENOENT once the topic is destroyed. */
+SL_EXPORT slk_spot_topic_handle_t* SL_CALL slk_spot_topic_lookup(slk_spot_t *spot, const char *topic_id);
+SL_EXPORT int SL_CALL slk_spot_publish_handle(slk_spot_topic_handle_t *topic, const void *data, size_t len);
+SL_EXPORT int SL_CALL slk_spot_publish_handle_msg(slk_spot_topic_handle_t *topic, slk_msg_t *msg);
 SL_EXPORT int SL_CALL slk_spot_bind(slk_spot_t *spot, const char *endpoint);
 SL_EXPORT int SL_CALL slk_spot_cluster_add(slk_spot_t *spot, const char *endpoint);
 SL_EXPORT int SL_CALL slk_spot_cluster_remove(slk_spot_t *spot, const char *endpoint);
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+ServerLink Benchmark Regression Gate
+
+Compares a bench_suite JSON result against a stored baseline and exits
+non-zero when the run regressed beyond its thresholds:
+  - throughput (msgs/sec) dropped by more than --threshold percent
+  - p50 or p99 latency rose by more than --latency-threshold percent
+  - CPU time per message rose by more than --cpu-threshold percent
+
+Thresholds apply to the geometric mean of the per-configuration ratios,
+which averages out the run-to-run noise of individual configurations on
+shared CI machines. A single configuration fails the gate on its own
+only when it regresses by more than --config-factor times the threshold
+(tail latencies are too noisy for that and are only checked overall).
+Latency increases smaller than --min-latency-delta microseconds are
+ignored, so sub-microsecond noise on fast transports cannot fail a run.
+
+Usage:
+    python bench_gate.py baseline.json current.json [--threshold 10]
+        [--latency-threshold 25] [--cpu-threshold 15]
+        [--config-factor 3] [--min-latency-delta 5] [--summary report.md]
+
+Exit codes: 0 = no regression, 1 = regression, 2 = invalid input.
+"""
+
+import argparse
+import json
+import math
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+Key = Tuple[str, int, int, int]
+
+
+def load_results(path: Path) -> Optional[Dict[Key, dict]]:
+    """Load a bench_suite JSON file, keyed by configuration."""
+    try:
+        with open(path, 'r', encoding='utf-8') as f:
+            data = json.load(f)
+    except (OSError, json.JSONDecodeError) as e:
+        print(f"Error: Cannot read '{path}': {e}", file=sys.stderr)
+        return None
+
+    if data.get('schema') != 1 or 'results' not in data:
+        print(f"Error: '{path}' is not a bench_suite result (schema 1)", file=sys.stderr)
+        return None
+
+    results = {}
+    for entry in data['results']:
+        key = (entry['transport'], int(entry['message_size']),
+               int(entry['peers']), int(entry['io_threads']))
+        results[key] = entry
+    return results
+
+
+def format_key(key: Key) -> str:
+    transport, size, peers, io_threads = key
+    return f"{transport} {size}B peers={peers} io={io_threads}"
+
+
+def change_pct(baseline: float, current: float) -> float:
+    if baseline <= 0:
+        return 0.0
+    return (current - baseline) / baseline * 100.0
+
+
+# (label, section, field, higher_is_better, threshold option, checked per configuration)
+METRICS = [
+    ("msgs/sec", 'throughput', 'msgs_per_sec', True, 'threshold', True),
+    ("throughput cpu us/msg", 'throughput', 'cpu_us_per_msg', False, 'cpu_threshold', True),
+    ("latency p50 us", 'latency', 'p50_us', False, 'latency_threshold', True),
+    ("latency p99 us", 'latency', 'p99_us', False, 'latency_threshold', False),
+    ("latency cpu us/msg", 'latency', 'cpu_us_per_msg', False, 'cpu_threshold', True),
+]
+
+
+class Gate:
+    """Collects per-metric comparisons and regressions."""
+
+    def __init__(self, args: argparse.Namespace):
+        self.args = args
+        self.rows: List[Tuple[str, str, float, float, float, bool]] = []
+        self.overall: List[Tuple[str, float, float, bool]] = []
+        self.regressions: List[str] = []
+        self.log_ratios: Dict[str, List[float]] = {m[0]: [] for m in METRICS}
+
+    def compare(self, key: Key, base: dict, cur: dict):
+        for label, section, field, higher_is_better, option, per_config in METRICS:
+            b = float(base[section][field])
+            c = float(cur[section][field])
+            threshold = getattr(self.args, option)
+            pct = change_pct(b, c)
+            worse = -pct if higher_is_better else pct
+
+            # Latency moves below the noise floor count as unchanged
+            ignored = section == 'latency' and field != 'cpu_us_per_msg' \
+                and abs(c - b) < self.args.min_latency_delta
+            if b > 0 and c > 0:
+                self.log_ratios[label].append(0.0 if ignored else math.log(c / b))
+
+            regressed = per_config and not ignored \
+                and worse > threshold * self.args.config_factor
+            self.rows.append((format_key(key), label, b, c, pct, regressed))
+            if regressed:
+                self.regressions.append(
+                    f"{format_key(key)}: {label} {b:.2f} -> {c:.2f} "
+                    f"({pct:+.1f}%, limit {threshold * self.args.config_factor:.0f}%)")
+
+    def finish(self):
+        for label, _, _, higher_is_better, option, _ in METRICS:
+            ratios = self.log_ratios[label]
+            if not ratios:
+                continue
+            pct = (math.exp(sum(ratios) / len(ratios)) - 1.0) * 100.0
+            worse = -pct if higher_is_better else pct
+            threshold = getattr(self.args, option)
+            regressed = worse > threshold
+            self.overall.append((label, pct, threshold, regressed))
+            if regressed:
+                self.regressions.append(
+                    f"overall: {label} {pct:+.1f}% (geometric mean, threshold {threshold:.0f}%)")
+
+    def write_summary(self, path: Path, missing: List[Key]):
+        lines = ["## Benchmark Regression Gate", ""]
+        if self.regressions:
+            lines.append(f"**{len(self.regressions)} regression(s) beyond threshold**")
+        else:
+            lines.append("No regressions beyond threshold.")
+        lines += ["",
+                  "| Metric | Change (geometric mean) | Threshold | |",
+                  "|---|---:|---:|---|"]
+        for label, pct, threshold, regressed in self.overall:
+            mark = ":x:" if regressed else ""
+            lines.append(f"| {label} | {pct:+.1f}% | {threshold:.0f}% | {mark} |")
+        lines += ["",
+                  f"Single configurations fail beyond {self.args.config_factor:g}x the threshold; "
+                  f"latency changes under {self.args.min_latency_delta:g} us are ignored.",
+                  "",
+                  "<details><summary>Per-configuration results</summary>",
+                  "",
+                  "| Configuration | Metric | Baseline | Current | Change | |",
+                  "|---|---|---:|---:|---:|---|"]
+        for config, metric, base, cur, pct, regressed in self.rows:
+            mark = ":x:" if regressed else ""
+            lines.append(f"| {config} | {metric} | {base:.2f} | {cur:.2f} | {pct:+.1f}% | {mark} |")
+        lines += ["", "</details>"]
+        if missing:
+            lines += ["", "Configurations without a baseline: "
+                      + ", ".join(format_key(k) for k in missing)]
+        path.write_text("\n".join(lines) + "\n", encoding='utf-8')
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Fail when a benchmark run regresses against a baseline")
+    parser.add_argument('baseline', type=Path, help="Baseline bench_suite JSON")
+    parser.add_argument('current', type=Path, help="Current bench_suite JSON")
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help="Max throughput drop in percent (default: 10)")
+    parser.add_argument('--latency-threshold', type=float, default=25.0,
+                        help="Max p50/p99 latency increase in percent (default: 25)")
+    parser.add_argument('--cpu-threshold', type=float, default=15.0,
+                        help="Max CPU-per-message increase in percent (default: 15)")
+    parser.add_argument('--config-factor', type=float, default=3.0,
+                        help="A single configuration fails beyond this multiple of the threshold (default: 3)")
+    parser.add_argument('--min-latency-delta', type=float, default=5.0,
+                        help="Ignore latency increases below this many microseconds (default: 5)")
+    parser.add_argument('--summary', type=Path, help="Write a Markdown report to this file")
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+    if baseline is None or current is None:
+        return 2
+
+    gate = Gate(args)
+    missing = []
+    for key in sorted(current):
+        if key not in baseline:
+            missing.append(key)
+            print(f"Warning: no baseline for {format_key(key)}", file=sys.stderr)
+            continue
+        gate.compare(key, baseline[key], current[key])
+
+    if not gate.rows:
+        print("Error: No configurations in common with the baseline", file=sys.stderr)
+        return 2
+    gate.finish()
+
+    if args.summary:
+        gate.write_summary(args.summary, missing)
+
+    compared = len(current) - len(missing)
+    if gate.regressions:
+        print(f"FAIL: {len(gate.regressions)} regression(s) in {compared} configuration(s)")
+        for line in gate.regressions:
+            print(f"  {line}")
+        return 1
+
+    print(f"PASS: {compared} configuration(s) within thresholds")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -118,6 +118,14 @@ size_t slk::mechanism_t::property_len (const char *name_, size_t value_len_)
 
 #define ZMTP_PROPERTY_SOCKET_TYPE "Socket-Type"
 #define ZMTP_PROPERTY_IDENTITY "Identity"
+//  Publishers that apply pattern subscriptions announce it, so that
+//  subscribers fall back to local filtering with any other publisher.
+#define ZMTP_PROPERTY_PATTERN_FILTER "X-Pattern-Filter"
+
+static bool filters_patterns (int socket_type_)
+{
+    return socket_type_ == slk::SL_PUB || socket_type_ == slk::SL_XPUB;
+}
 
 size_t slk::mechanism_t::add_basic_properties (unsigned char *ptr_,
                                                size_t ptr_capacity_) const
@@ -136,6 +144,11 @@ size_t slk::mechanism_t::add_basic_properties (unsigned char *ptr_,
                              options.routing_id_size);
     }
 
+    //  Add pattern filtering property for publishers
+    if (filters_patterns (options.type))
+        ptr += add_property (ptr, ptr_capacity_ - (ptr - ptr_),
+                             ZMTP_PROPERTY_PATTERN_FILTER, "1", 1);
+
     //  Add application metadata
     for (std::map<std::string, std::string>::const_iterator
            it = options.app_metadata.begin (),
@@ -166,6 +179,9 @@ size_t slk::mechanism_t::basic_properties_len () const
            + meta_len
            + (options.type == SL_ROUTER
                 ? property_len (ZMTP_PROPERTY_IDENTITY, options.routing_id_size)
+                : 0)
+           + (filters_patterns (options.type)
+                ? property_len (ZMTP_PROPERTY_PATTERN_FILTER, 1)
                 : 0);
 }
 
@@ -239,6 +255,12 @@ int slk::mechanism_t::parse_metadata (const unsigned char *ptr_,
     return 0;
 }
 
+bool slk::mechanism_t::peer_filters_patterns () const
+{
+    return _zmtp_properties.find (ZMTP_PROPERTY_PATTERN_FILTER)
+           != _zmtp_properties.end ();
+}
+
 int slk::mechanism_t::property (const std::string & /* name_ */,
                                 const void * /* value_ */,
                                 size_t /* length_ */)
@@ -59,6 +59,10 @@ class mechanism_t
         return _zmtp_properties;
     }
 
+    //  Returns true if the peer announced that it filters on pattern
+    //  subscriptions itself.
+    bool peer_filters_patterns () const;
+
   protected:
     //  Only used to identify the socket for the Socket-Type
     //  property in the wire protocol.
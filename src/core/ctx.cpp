@@ -26,6 +26,7 @@ slk::ctx_t::ctx_t () :
     _max_msgsz (INT_MAX),
     _io_thread_count (SL_IO_THREADS_DFLT),
     _blocky (true),
+    _io_backend (SL_IO_BACKEND_ASIO),
     _ipv6 (false),
     _zero_copy (false)
 {
@@ -106,6 +107,26 @@ int slk::ctx_t::set (int option_, const void *optval_, size_t optvallen_)
             }
             _blocky = (*((int *) optval_) != 0);
             return 0;
+        case SL_IO_BACKEND:
+            if (optvallen_ != sizeof (int)) {
+                errno = EINVAL;
+                return -1;
+            }
+            if (*((int *) optval_) == SL_IO_BACKEND_ASIO) {
+                _io_backend = SL_IO_BACKEND_ASIO;
+                return 0;
+            }
+            if (*((int *) optval_) == SL_IO_BACKEND_IO_URING) {
+#ifdef SL_HAVE_IO_URING
+                _io_backend = SL_IO_BACKEND_IO_URING;
+                return 0;
+#else
+                errno = ENOTSUP;
+                return -1;
+#endif
+            }
+            errno = EINVAL;
+            return -1;
     }
 
     return thread_ctx_t::set (option_, optval_, optvallen_);
@@ -127,6 +148,10 @@ int slk::ctx_t::get (int option_, void *optval_, const size_t *optvallen_)
             if (*optvallen_ != sizeof (int)) return -1;
             *((int *) optval_) = _max_sockets;
             return 0;
+        case SL_IO_BACKEND:
+            if (*optvallen_ != sizeof (int)) return -1;
+            *((int *) optval_) = _io_backend;
+            return 0;
     }
     return thread_ctx_t::get(option_, optval_, optvallen_);
 }
@@ -142,6 +167,8 @@ int slk::ctx_t::get (int option_)
             return _ipv6 ? 1 : 0;
         case SL_BLOCKY:
             return _blocky ? 1 : 0;
+        case SL_IO_BACKEND:
+            return _io_backend;
     }
     return -1;
 }
@@ -215,6 +242,14 @@ slk::io_thread_t *slk::ctx_t::choose_io_thread (uint64_t affinity_)
     return selected_io_thread;
 }
 
+int slk::ctx_t::get_io_thread_load (int index_)
+{
+    scoped_lock_t locker (_slot_sync);
+    if (index_ < 0 || static_cast<size_t> (index_) >= _io_threads.size ())
+        return -1;
+    return _io_threads[index_]->get_load ();
+}
+
 bool slk::ctx_t::start ()
 {
     if (!_starting) return true;
@@ -258,7 +293,8 @@ void slk::ctx_t::send_command (uint32_t tid_, const command_t &command_)
 int slk::ctx_t::register_endpoint (const char *addr_, const endpoint_t &endpoint_)
 {
     scoped_lock_t locker (_endpoints_sync);
-    _endpoints[addr_] = endpoint_;
+    _endpoints.erase (addr_);
+    _endpoints.emplace (addr_, endpoint_);
     return 0;
 }
 
@@ -297,10 +333,8 @@ void slk::ctx_t::pend_connection (const std::string &addr_,
                                   pipe_t **pipes_)
 {
     scoped_lock_t locker (_endpoints_sync);
-    pending_connection_t pending_connection;
-    pending_connection.endpoint = endpoint_;
-    pending_connection.connect_pipe = pipes_[0];
-    pending_connection.bind_pipe = pipes_[1];
+    const pending_connection_t pending_connection = {endpoint_, pipes_[0],
+                                                      pipes_[1]};
     _pending_connections.insert(std::make_pair(addr_, pending_connection));
 }
 
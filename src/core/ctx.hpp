@@ -105,6 +105,10 @@ class ctx_t : public thread_ctx_t
     // Returns NULL if no I/O thread is available
     slk::io_thread_t *choose_io_thread (uint64_t affinity_);
 
+    // Returns the current load of the I/O thread with the given index, or
+    // -1 if there is no such thread (yet). For diagnostics and tests
+    int get_io_thread_load (int index_);
+
     // Returns reaper thread object
     slk::object_t *get_reaper () const;
 
@@ -209,6 +213,9 @@ class ctx_t : public thread_ctx_t
     // Does context wait (possibly forever) on termination?
     bool _blocky;
 
+    // Stream backend of the I/O threads (SL_IO_BACKEND_*)
+    int _io_backend;
+
     // Is IPv6 enabled on this context?
     bool _ipv6;
 
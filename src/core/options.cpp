@@ -140,8 +140,12 @@ slk::options_t::options_t () :
     use_fd (-1),
     loopback_fastpath (false),
     in_batch_size (8192),
+    in_batch_max (256 * 1024),
     out_batch_size (8192),
     zero_copy (true),
+    inbound_poll_rate (slk::inbound_poll_rate),
+    command_delay (max_command_delay),
+    command_batch (max_command_batch),
     router_notify (0),
     monitor_event_version (1),
     hello_msg (),
@@ -391,6 +395,13 @@ int slk::options_t::setsockopt (int option_,
             }
             break;
 
+        case SL_IN_BATCH_MAX:
+            if (is_int && value > 0) {
+                in_batch_max = value;
+                return 0;
+            }
+            break;
+
         case SL_OUT_BATCH_SIZE:
             if (is_int && value > 0) {
                 out_batch_size = value;
@@ -405,6 +416,27 @@ int slk::options_t::setsockopt (int option_,
             }
             break;
 
+        case SL_INBOUND_POLL_RATE:
+            if (is_int && value > 0) {
+                inbound_poll_rate = value;
+                return 0;
+            }
+            break;
+
+        case SL_COMMAND_DELAY:
+            if (is_int && value >= 0) {
+                command_delay = value;
+                return 0;
+            }
+            break;
+
+        case SL_COMMAND_BATCH:
+            if (is_int && value >= 0) {
+                command_batch = value;
+                return 0;
+            }
+            break;
+
         case SL_HELLO_MSG:
             if (optvallen_ > 0) {
                 unsigned char *bytes = (unsigned char *) optval_;
@@ -691,6 +723,13 @@ int slk::options_t::getsockopt (int option_,
             }
             break;
 
+        case SL_IN_BATCH_MAX:
+            if (is_int) {
+                *value = in_batch_max;
+                return 0;
+            }
+            break;
+
         case SL_OUT_BATCH_SIZE:
             if (is_int) {
                 *value = out_batch_size;
@@ -712,6 +751,27 @@ int slk::options_t::getsockopt (int option_,
             }
             break;
 
+        case SL_INBOUND_POLL_RATE:
+            if (is_int) {
+                *value = inbound_poll_rate;
+                return 0;
+            }
+            break;
+
+        case SL_COMMAND_DELAY:
+            if (is_int) {
+                *value = command_delay;
+                return 0;
+            }
+            break;
+
+        case SL_COMMAND_BATCH:
+            if (is_int) {
+                *value = command_batch;
+                return 0;
+            }
+            break;
+
         default:
             break;
     }
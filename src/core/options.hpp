@@ -130,14 +130,23 @@ struct options_t
     // Use of loopback fastpath
     bool loopback_fastpath;
 
-    // Maximal batching size for engines with receiving functionality
+    // Initial batching size for engines with receiving functionality
     int in_batch_size;
+    // Size the receive buffer may grow to while a connection is busy
+    int in_batch_max;
     // Maximal batching size for engines with sending functionality
     int out_batch_size;
 
     // Use zero copy strategy for storing message content when decoding
     bool zero_copy;
 
+    // Messages received between two checks for pending commands
+    int inbound_poll_rate;
+    // How long (in CPU ticks) sends may skip checking for commands
+    int command_delay;
+    // Commands processed per check on the send/recv fast path, 0 = all
+    int command_batch;
+
     // Router socket connect/disconnect notifications
     int router_notify;
 
@@ -12,7 +12,7 @@
 #include "../util/clock.hpp"
 #include "../monitor/connection_manager.hpp"
 #include "../monitor/event_dispatcher.hpp"
-#include "../monitor/heartbeat.hpp"
+#include <algorithm>
 #include <new>
 
 slk::router_t::router_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
@@ -29,7 +29,8 @@ slk::router_t::router_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     // raw_socket functionality in ROUTER is deprecated
     _raw_socket (false),
     _probe_router (false),
-    _handover (false)
+    _handover (false),
+    _batch_send (false)
 #ifdef SL_ENABLE_MONITORING
     ,_conn_manager (NULL),
     _event_dispatcher (NULL)
@@ -223,6 +224,9 @@ void slk::router_t::xpipe_terminated (pipe_t *pipe_)
 
         erase_out_pipe (pipe_);
         _fq.pipe_terminated (pipe_);
+        _batch_flush.erase (
+          std::remove (_batch_flush.begin (), _batch_flush.end (), pipe_),
+          _batch_flush.end ());
         pipe_->rollback ();
         if (pipe_ == _current_out)
             _current_out = NULL;
@@ -317,6 +321,9 @@ int slk::router_t::xsend (msg_t *msg_)
             return 0;
         }
 
+#ifdef SL_ENABLE_MONITORING
+        const size_t msg_size = msg_->size ();
+#endif
         const bool ok = _current_out->write (msg_);
         if (unlikely (!ok)) {
             // Message failed to send - we must close it ourselves
@@ -327,8 +334,17 @@ int slk::router_t::xsend (msg_t *msg_)
             _current_out->rollback ();
             _current_out = NULL;
         } else {
+#ifdef SL_ENABLE_MONITORING
+            count_send (_current_out, msg_size, !_more_out);
+#endif
             if (!_more_out) {
-                _current_out->flush ();
+                // Within a batch, flush each destination once at the end.
+                // Consecutive messages to the same peer are the common case.
+                if (!_batch_send)
+                    _current_out->flush ();
+                else if (_batch_flush.empty ()
+                         || _batch_flush.back () != _current_out)
+                    _batch_flush.push_back (_current_out);
                 _current_out = NULL;
             }
         }
@@ -344,6 +360,26 @@ int slk::router_t::xsend (msg_t *msg_)
     return 0;
 }
 
+void slk::router_t::xbegin_send_batch ()
+{
+    _batch_send = true;
+}
+
+void slk::router_t::xflush_send_batch ()
+{
+    // A pipe may appear more than once; flushing it again is a no-op
+    for (std::vector<pipe_t *>::size_type i = 0; i != _batch_flush.size ();
+         ++i)
+        _batch_flush[i]->flush ();
+    _batch_flush.clear ();
+}
+
+void slk::router_t::xend_send_batch ()
+{
+    xflush_send_batch ();
+    _batch_send = false;
+}
+
 int slk::router_t::xrecv (msg_t *msg_)
 {
     if (_prefetched) {
@@ -382,6 +418,9 @@ int slk::router_t::xrecv (msg_t *msg_)
         return -1;
 
     slk_assert (pipe != NULL);
+#ifdef SL_ENABLE_MONITORING
+    count_recv (pipe, *msg_);
+#endif
 
     // If we are in the middle of reading a message, just return the next part
     if (_more_in) {
@@ -405,20 +444,6 @@ int slk::router_t::xrecv (msg_t *msg_)
 
         const blob_t &routing_id = pipe->get_routing_id ();
 
-#ifdef SL_ENABLE_MONITORING
-        // Check if this is a heartbeat message - handle internally
-        if (heartbeat_t::is_heartbeat (msg_)) {
-            process_heartbeat_message (routing_id, msg_);
-
-            // Reset state and try to get next message
-            _prefetched = false;
-            _current_in = NULL;
-
-            // Recursively call to get the next message
-            return xrecv (msg_);
-        }
-#endif
-
         rc = msg_->init_size (routing_id.size ());
         errno_assert (rc == 0);
         memcpy (msg_->data (), routing_id.data (), routing_id.size ());
@@ -467,6 +492,9 @@ bool slk::router_t::xhas_in ()
         return false;
 
     slk_assert (pipe != NULL);
+#ifdef SL_ENABLE_MONITORING
+    count_recv (pipe, _prefetched_msg);
+#endif
 
     const blob_t &routing_id = pipe->get_routing_id ();
     rc = _prefetched_id.init_size (routing_id.size ());
@@ -594,11 +622,14 @@ bool slk::router_t::identify_peer (pipe_t *pipe_, bool locally_initiated_)
     add_out_pipe (SL_MOVE (routing_id), pipe_);
 
 #ifdef SL_ENABLE_MONITORING
-    // Notify monitoring system of new connection
+    // Notify monitoring system of new connection. The engine reports
+    // heartbeat results through the pipe's link.
     if (_conn_manager) {
+        const blob_t &peer_id = pipe_->get_routing_id ();
         const int64_t now = clock_t::now_us ();
-        _conn_manager->peer_connected (routing_id, now);
-        dispatch_event (EVENT_PEER_CONNECTED, routing_id, now);
+        pipe_->set_peer_counters (_conn_manager->peer_connected (
+          peer_id, now, pipe_->get_heartbeat_link ()));
+        dispatch_event (EVENT_PEER_CONNECTED, peer_id, now);
     }
 #endif
 
@@ -636,88 +667,6 @@ void slk::router_t::set_monitor_callback (monitor_callback_fn callback,
         _event_dispatcher->register_callback (callback, user_data, event_mask);
 }
 
-int slk::router_t::send_ping (const blob_t &routing_id)
-{
-    // Create PING message
-    msg_t ping_msg;
-    const int64_t now = clock_t::now_us ();
-
-    if (!heartbeat_t::create_ping (&ping_msg, now)) {
-        errno = ENOMEM;
-        return -1;
-    }
-
-    // Create routing frame
-    msg_t routing_frame;
-    int rc = routing_frame.init_size (routing_id.size ());
-    if (rc != 0) {
-        ping_msg.close ();
-        return -1;
-    }
-    memcpy (routing_frame.data (), routing_id.data (), routing_id.size ());
-    routing_frame.set_flags (msg_t::more);
-
-    // Send routing frame
-    rc = xsend (&routing_frame);
-    if (rc != 0) {
-        ping_msg.close ();
-        return -1;
-    }
-
-    // Send PING message
-    rc = xsend (&ping_msg);
-    if (rc != 0)
-        return -1;
-
-    // Mark ping as sent
-    if (_conn_manager)
-        _conn_manager->mark_ping_sent (routing_id, now);
-
-    return 0;
-}
-
-void slk::router_t::process_heartbeat_message (const blob_t &routing_id,
-                                                msg_t *msg)
-{
-    if (!msg)
-        return;
-
-    const int64_t now = clock_t::now_us ();
-
-    if (heartbeat_t::is_ping (msg)) {
-        // Respond with PONG
-        const int64_t ping_timestamp =
-            heartbeat_t::extract_ping_timestamp (msg);
-
-        msg_t pong_msg;
-        if (heartbeat_t::create_pong (&pong_msg, ping_timestamp)) {
-            // Create routing frame
-            msg_t routing_frame;
-            int rc = routing_frame.init_size (routing_id.size ());
-            if (rc == 0) {
-                memcpy (routing_frame.data (), routing_id.data (),
-                        routing_id.size ());
-                routing_frame.set_flags (msg_t::more);
-
-                // Send PONG response
-                xsend (&routing_frame);
-                xsend (&pong_msg);
-            } else {
-                pong_msg.close ();
-            }
-        }
-
-        // Record heartbeat received
-        if (_conn_manager)
-            _conn_manager->record_heartbeat (routing_id, now);
-
-    } else if (heartbeat_t::is_pong (msg)) {
-        // PONG received - update RTT
-        if (_conn_manager)
-            _conn_manager->mark_pong_received (routing_id, now);
-    }
-}
-
 void slk::router_t::dispatch_event (event_type_t type,
                                      const blob_t &routing_id,
                                      int64_t timestamp_us)
@@ -728,19 +677,22 @@ void slk::router_t::dispatch_event (event_type_t type,
     }
 }
 
-void slk::router_t::record_send_stats (const blob_t &routing_id, size_t size)
+void slk::router_t::count_send (pipe_t *pipe, size_t size, bool last_part)
 {
-    if (_conn_manager) {
-        const int64_t now = clock_t::now_us ();
-        _conn_manager->record_send (routing_id, size, now);
+    peer_counters_t *counters = pipe->get_peer_counters ();
+    if (counters) {
+        const int64_t now = static_cast<int64_t> (clock_t::now_cached_us ());
+        counters->record_send (size, last_part, now);
     }
 }
 
-void slk::router_t::record_recv_stats (const blob_t &routing_id, size_t size)
+void slk::router_t::count_recv (pipe_t *pipe, const msg_t &msg)
 {
-    if (_conn_manager) {
-        const int64_t now = clock_t::now_us ();
-        _conn_manager->record_recv (routing_id, size, now);
+    peer_counters_t *counters = pipe->get_peer_counters ();
+    if (counters) {
+        const int64_t now = static_cast<int64_t> (clock_t::now_cached_us ());
+        counters->record_recv (msg.size (),
+                               !(msg.flags () & msg_t::more), now);
     }
 }
 #endif // SL_ENABLE_MONITORING
@@ -37,6 +37,9 @@ class router_t final : public routing_socket_base_t
     int xgetsockopt (int option_, void *optval_,
                      size_t *optvallen_) final;
     int xsend (msg_t *msg_) override;
+    void xbegin_send_batch () override;
+    void xflush_send_batch () override;
+    void xend_send_batch () override;
     int xrecv (msg_t *msg_) override;
     bool xhas_in () override;
     bool xhas_out () override;
@@ -53,10 +56,6 @@ class router_t final : public routing_socket_base_t
     void set_monitor_callback (monitor_callback_fn callback, void *user_data,
                                int event_mask);
 
-    // Heartbeat API
-    int send_ping (const blob_t &routing_id);
-    void process_heartbeat_message (const blob_t &routing_id, msg_t *msg);
-
   protected:
     // Rollback any message parts that were sent but not yet flushed
     int rollback ();
@@ -116,6 +115,11 @@ class router_t final : public routing_socket_base_t
     // will be terminated
     bool _handover;
 
+    // While a batched send is in progress, completed messages are not
+    // flushed right away; their pipes are collected here instead
+    bool _batch_send;
+    std::vector<pipe_t *> _batch_flush;
+
 #ifdef SL_ENABLE_MONITORING
     // Monitoring system components
     class connection_manager_t *_conn_manager;
@@ -125,9 +129,10 @@ class router_t final : public routing_socket_base_t
     void dispatch_event (event_type_t type, const blob_t &routing_id,
                          int64_t timestamp_us);
 
-    // Helper: record send/recv statistics
-    void record_send_stats (const blob_t &routing_id, size_t size);
-    void record_recv_stats (const blob_t &routing_id, size_t size);
+    // Helper: count a frame on the peer's traffic counters. These run on
+    // every frame, so they touch only the counters attached to the pipe.
+    void count_send (pipe_t *pipe, size_t size, bool last_part);
+    void count_recv (pipe_t *pipe, const msg_t &msg);
 #endif
 
     SL_NON_COPYABLE_NOR_MOVABLE (router_t)
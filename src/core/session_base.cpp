@@ -12,9 +12,14 @@
 #if defined SL_HAVE_IPC
 #include "../transport/ipc_connecter.hpp"
 #endif
+#if defined SL_HAVE_SHM
+#include "../transport/shm_connecter.hpp"
+#endif
 #include "../transport/address.hpp"
+#include "../monitor/heartbeat.hpp"
 
 #include "ctx.hpp"
+#include "../io/io_thread.hpp"
 #include <new>
 
 slk::session_base_t *slk::session_base_t::create (class io_thread_t *io_thread_,
@@ -41,6 +46,8 @@ slk::session_base_t::session_base_t (class io_thread_t *io_thread_,
     _active (active_),
     _pipe (NULL),
     _incomplete_in (false),
+    _peer_filters_patterns (true),
+    _empty_prefix_subscribed (false),
     _pending (false),
     _engine (NULL),
     _socket (socket_),
@@ -48,6 +55,12 @@ slk::session_base_t::session_base_t (class io_thread_t *io_thread_,
     _has_linger_timer (false),
     _addr (addr_)
 {
+    //  Engines run on their session's I/O thread; account for them so
+    //  that choose_io_thread spreads connections across threads.
+    _io_thread->get_poller ()->adjust_load (1);
+
+    if (options_.heartbeat_interval > 0)
+        _heartbeat_link = std::make_shared<heartbeat_link_t> ();
 }
 
 const slk::endpoint_uri_pair_t &slk::session_base_t::get_endpoint () const
@@ -55,6 +68,12 @@ const slk::endpoint_uri_pair_t &slk::session_base_t::get_endpoint () const
     return _engine->get_endpoint ();
 }
 
+const std::shared_ptr<slk::heartbeat_link_t> &
+slk::session_base_t::get_heartbeat_link () const
+{
+    return _heartbeat_link;
+}
+
 slk::session_base_t::~session_base_t ()
 {
     slk_assert (!_pipe);
@@ -70,6 +89,8 @@ slk::session_base_t::~session_base_t ()
         _engine->terminate ();
 
     SL_DELETE (_addr);
+
+    _io_thread->get_poller ()->adjust_load (-1);
 }
 
 void slk::session_base_t::attach_pipe (pipe_t *pipe_)
@@ -83,14 +104,68 @@ void slk::session_base_t::attach_pipe (pipe_t *pipe_)
 
 int slk::session_base_t::pull_msg (msg_t *msg_)
 {
-    if (!_pipe || !_pipe->read (msg_)) {
-        errno = EAGAIN;
-        return -1;
+    while (true) {
+        if (!_pipe || !_pipe->read (msg_)) {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        const bool first_part = !_incomplete_in;
+        _incomplete_in = (msg_->flags () & msg_t::more) != 0;
+
+        if (likely (_peer_filters_patterns) || !first_part || _incomplete_in
+            || fall_back_to_prefix (msg_))
+            return 0;
+
+        int rc = msg_->close ();
+        errno_assert (rc == 0);
+        rc = msg_->init ();
+        errno_assert (rc == 0);
     }
+}
 
-    _incomplete_in = (msg_->flags () & msg_t::more) != 0;
+bool slk::session_base_t::fall_back_to_prefix (msg_t *msg_)
+{
+    const unsigned char *data =
+      static_cast<const unsigned char *> (msg_->data ());
+    const size_t size = msg_->size ();
+
+    //  The socket's own empty prefix covers the patterns as well, and is
+    //  kept subscribed while they need it.
+    const bool prefix_command = msg_->is_subscribe () || msg_->is_cancel ();
+    if (prefix_command ? size == 0
+                       : size == 1 && (*data == 0 || *data == 1)) {
+        _empty_prefix_subscribed =
+          prefix_command ? msg_->is_subscribe () : *data == 1;
+        return _empty_prefix_subscribed || _fallback_patterns.empty ();
+    }
 
-    return 0;
+    if (prefix_command || size == 0 || (msg_->flags () & msg_t::command)
+        || (*data != SL_PATTERN_SUBSCRIBE_BYTE
+            && *data != SL_PATTERN_CANCEL_BYTE))
+        return true;
+
+    //  Patterns mean nothing to the peer; only the first and the last one
+    //  change what it sends.
+    const std::string pattern (reinterpret_cast<const char *> (data + 1),
+                               size - 1);
+    bool changed;
+    if (*data == SL_PATTERN_SUBSCRIBE_BYTE)
+        changed = _fallback_patterns.insert (pattern).second
+                  && _fallback_patterns.size () == 1;
+    else
+        changed =
+          _fallback_patterns.erase (pattern) == 1 && _fallback_patterns.empty ();
+    if (!changed || _empty_prefix_subscribed)
+        return false;
+
+    const bool subscribe = *data == SL_PATTERN_SUBSCRIBE_BYTE;
+    int rc = msg_->close ();
+    errno_assert (rc == 0);
+    rc = subscribe ? msg_->init_subscribe (0, NULL)
+                   : msg_->init_cancel (0, NULL);
+    errno_assert (rc == 0);
+    return true;
 }
 
 int slk::session_base_t::push_msg (msg_t *msg_)
@@ -238,14 +313,21 @@ void slk::session_base_t::process_attach (i_engine *engine_)
     _engine = engine_;
 
     if (!engine_->has_handshake_stage ())
-        engine_ready ();
+        engine_ready (true);
 
     //  Plug in the engine.
     _engine->plug (_io_thread, this);
 }
 
-void slk::session_base_t::engine_ready ()
+void slk::session_base_t::engine_ready (bool peer_filters_patterns_)
 {
+    //  The new peer has none of our subscriptions yet.
+    _peer_filters_patterns = peer_filters_patterns_
+                             || (options.type != SL_SUB
+                                 && options.type != SL_XSUB);
+    _fallback_patterns.clear ();
+    _empty_prefix_subscribed = false;
+
     //  Create the pipe if it does not exist yet.
     if (!_pipe && !is_terminating ()) {
         object_t *parents[2] = {this, _socket};
@@ -271,6 +353,7 @@ void slk::session_base_t::engine_ready ()
         //  events can use them.
         pipes[0]->set_endpoint_pair (_engine->get_endpoint ());
         pipes[1]->set_endpoint_pair (_engine->get_endpoint ());
+        pipes[1]->set_heartbeat_link (_heartbeat_link);
 
         //  DON'T call check_read() on pipes[1] here!
         //  If we do, it will set _in_active=false because there's no data yet.
@@ -409,10 +492,10 @@ void slk::session_base_t::start_connecting (bool wait_)
 {
     slk_assert (_active);
 
-    //  Choose I/O thread to run connecter in. Given that we are already
-    //  running in an I/O thread, there must be at least one available.
-    io_thread_t *io_thread = choose_io_thread (options.affinity);
-    slk_assert (io_thread);
+    //  The connecter runs in our own I/O thread. The socket it connects
+    //  is bound to that thread's io_context and ends up driving the
+    //  engine, which must execute on the session's thread.
+    io_thread_t *io_thread = _io_thread;
 
     //  Create the connecter object.
     own_t *connecter = NULL;
@@ -426,6 +509,12 @@ void slk::session_base_t::start_connecting (bool wait_)
           ipc_connecter_t (io_thread, this, options, _addr, wait_);
     }
 #endif
+#if defined SL_HAVE_SHM
+    else if (_addr->protocol == protocol_name::shm) {
+        connecter = new (std::nothrow)
+          shm_connecter_t (io_thread, this, options, _addr, wait_);
+    }
+#endif
 
     if (connecter != NULL) {
         alloc_assert (connecter);
@@ -5,6 +5,7 @@
 #define SL_SESSION_BASE_HPP_INCLUDED
 
 #include <set>
+#include <string>
 
 #include "own.hpp"
 #include "../io/io_object.hpp"
@@ -37,7 +38,9 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     void flush ();
     void rollback ();
     void engine_error (bool handshaked_, slk::i_engine::error_reason_t reason_);
-    void engine_ready ();
+    //  peer_filters_patterns_ is false if the peer did not announce that it
+    //  applies pattern subscriptions (a libzmq or older publisher).
+    void engine_ready (bool peer_filters_patterns_);
 
     //  i_pipe_events interface implementation.
     void read_activated (slk::pipe_t *pipe_) final;
@@ -57,6 +60,10 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     socket_base_t *get_socket () const;
     const endpoint_uri_pair_t &get_endpoint () const;
 
+    //  Where engines report heartbeat results. NULL unless heartbeats
+    //  are enabled.
+    const std::shared_ptr<heartbeat_link_t> &get_heartbeat_link () const;
+
   protected:
     session_base_t (slk::io_thread_t *io_thread_,
                     bool active_,
@@ -83,6 +90,12 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  Call this function when engine disconnect to get rid of leftovers.
     void clean_pipes ();
 
+    //  For a peer that does not filter on patterns, turn the first pattern
+    //  subscription into an empty prefix subscription and the last pattern
+    //  cancel into its cancel; the subscriber then filters locally.
+    //  Returns false if the message is to be dropped instead of sent.
+    bool fall_back_to_prefix (msg_t *msg_);
+
     //  If true, this session (re)connects to the peer. Otherwise, it's
     //  a transient session created by the listener.
     const bool _active;
@@ -90,6 +103,9 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  Pipe connecting the session to its socket.
     slk::pipe_t *_pipe;
 
+    //  Shared with the socket end of the pipe, so it survives reconnects.
+    std::shared_ptr<heartbeat_link_t> _heartbeat_link;
+
     //  This set is added to with pipes we are disconnecting, but haven't yet completed
     std::set<pipe_t *> _terminating_pipes;
 
@@ -97,6 +113,15 @@ class session_base_t : public own_t, public io_object_t, public i_pipe_events
     //  is still in the in pipe.
     bool _incomplete_in;
 
+    //  False while connected to a publisher that does not filter on
+    //  pattern subscriptions. Always true for other socket types.
+    bool _peer_filters_patterns;
+
+    //  Pattern subscriptions sent as the empty prefix to such a peer, and
+    //  whether the socket subscribed the empty prefix itself.
+    std::set<std::string> _fallback_patterns;
+    bool _empty_prefix_subscribed;
+
     //  True if termination have been suspended to push the pending
     //  messages to the network.
     bool _pending;
@@ -14,6 +14,10 @@
 #if defined SL_HAVE_IPC
 #include "../transport/ipc_listener.hpp"
 #endif
+#if defined SL_HAVE_SHM
+#include "../transport/shm_listener.hpp"
+#include "../io/shm/shm_stream.hpp"
+#endif
 #include "../io/io_thread.hpp"
 #include "session_base.hpp"
 #include "../util/config.hpp"
@@ -35,7 +39,8 @@
 
 namespace slk
 {
-// Note: inbound_poll_rate and max_command_delay are defined in config.hpp
+// Note: the defaults for inbound_poll_rate, max_command_delay and
+// max_command_batch are defined in config.hpp
 }
 
 bool slk::socket_base_t::check_tag () const
@@ -101,6 +106,7 @@ slk::socket_base_t::socket_base_t (ctx_t *parent_,
     _handle (static_cast<poller_t::handle_t> (NULL)),
     _last_tsc (0),
     _ticks (0),
+    _commands_processed (0),
     _rcvmore (false),
     _thread_safe (thread_safe_),
     _disconnected (false)
@@ -195,6 +201,13 @@ int slk::socket_base_t::check_protocol (const std::string &protocol_) const
     }
 #endif
 
+#if defined SL_HAVE_SHM
+    // Shared-memory protocol is supported on Linux
+    if (protocol_ == slk::protocol_name::shm) {
+        return 0;
+    }
+#endif
+
     // Inproc protocol is always supported
     if (protocol_ == slk::protocol_name::inproc) {
         return 0;
@@ -211,6 +224,9 @@ void slk::socket_base_t::attach_pipe (pipe_t *pipe_,
 {
     // First, register the pipe so that we can terminate it later on
     pipe_->set_event_sink (this);
+#ifdef SL_ENABLE_MONITORING
+    pipe_->set_latency_histograms (&_send_latency, &_recv_latency);
+#endif
     _pipes.push_back (pipe_);
 
     // Let the derived socket type know about new pipe
@@ -296,6 +312,11 @@ int slk::socket_base_t::getsockopt (int option_,
         return do_getsockopt<int> (optval_, optvallen_, events);
     }
 
+    if (option_ == SL_COMMANDS_PROCESSED) {
+        return do_getsockopt<uint64_t> (optval_, optvallen_,
+                                        _commands_processed);
+    }
+
     if (option_ == SL_LAST_ENDPOINT) {
         if (*optvallen_ < _last_endpoint.size () + 1) {
             errno = EINVAL;
@@ -382,6 +403,33 @@ int slk::socket_base_t::bind (const char *endpoint_uri_)
         return 0;
     }
 #endif
+#if defined SL_HAVE_SHM
+    else if (protocol == slk::protocol_name::shm) {
+        // Choose the I/O thread to run the listener in
+        io_thread_t *io_thread = choose_io_thread (options.affinity);
+        if (!io_thread) {
+            errno = SL_EMTHREAD;
+            return -1;
+        }
+
+        shm_listener_t *listener =
+          new (std::nothrow) shm_listener_t (io_thread, this, options);
+        alloc_assert (listener);
+        rc = listener->set_local_address (address.c_str ());
+        if (rc != 0) {
+            delete listener;
+            return -1;
+        }
+
+        // Save last endpoint URI
+        listener->get_local_address (_last_endpoint);
+
+        add_endpoint (make_unconnected_bind_endpoint_pair (_last_endpoint),
+                      static_cast<own_t *> (listener), NULL);
+        options.connected = true;
+        return 0;
+    }
+#endif
     else if (protocol == slk::protocol_name::inproc) {
         // inproc: register endpoint in context
         const endpoint_t endpoint (this, options);
@@ -591,6 +639,16 @@ int slk::socket_base_t::connect_internal (const char *endpoint_uri_)
         // Defer resolution until a socket is opened
         paddr->resolved.tcp_addr = NULL;
     }
+#if defined SL_HAVE_SHM
+    else if (protocol == slk::protocol_name::shm) {
+        // The name must map onto a rendezvous socket
+        if (shm_stream_t::control_path (address).empty ()) {
+            errno = EINVAL;
+            delete paddr;
+            return -1;
+        }
+    }
+#endif
 
     // Create session
     session_base_t *session =
@@ -611,6 +669,7 @@ int slk::socket_base_t::connect_internal (const char *endpoint_uri_)
         errno_assert (rc == 0);
 
         // Attach local end of the pipe to the socket object
+        new_pipes[0]->set_heartbeat_link (session->get_heartbeat_link ());
         attach_pipe (new_pipes[0], subscribe_to_all, true);
         newpipe = new_pipes[0];
 
@@ -731,15 +790,42 @@ int slk::socket_base_t::send (msg_t *msg_, int flags_)
         return -1;
     }
 
-    // Check whether message passed to the function is valid
-    if (unlikely (!msg_ || !msg_->check ())) {
-        errno = EFAULT;
+    // Process pending commands, if any.
+    if (unlikely (process_commands (0, true, options.command_batch) != 0)) {
         return -1;
     }
 
-    // Process pending commands, if any.
-    int rc = process_commands (0, true);
-    if (unlikely (rc != 0)) {
+    return send_part (msg_, flags_);
+}
+
+int slk::socket_base_t::begin_send (bool batch_)
+{
+    // Check whether the context hasn't been shut down yet
+    if (unlikely (_ctx_terminated)) {
+        errno = ETERM;
+        return -1;
+    }
+
+    // Process pending commands once for the whole batch
+    if (unlikely (process_commands (0, true, options.command_batch) != 0)) {
+        return -1;
+    }
+
+    if (batch_)
+        xbegin_send_batch ();
+    return 0;
+}
+
+void slk::socket_base_t::end_send ()
+{
+    xend_send_batch ();
+}
+
+int slk::socket_base_t::send_part (msg_t *msg_, int flags_)
+{
+    // Check whether message passed to the function is valid
+    if (unlikely (!msg_ || !msg_->check ())) {
+        errno = EFAULT;
         return -1;
     }
 
@@ -753,7 +839,7 @@ int slk::socket_base_t::send (msg_t *msg_, int flags_)
     msg_->reset_metadata ();
 
     // Try to send the message using method in each socket class
-    rc = xsend (msg_);
+    int rc = xsend (msg_);
     if (rc == 0) {
         return 0;
     }
@@ -772,6 +858,10 @@ int slk::socket_base_t::send (msg_t *msg_, int flags_)
     int timeout = options.sndtimeo;
     const uint64_t end = timeout < 0 ? 0 : (_clock.now_ms () + timeout);
 
+    // Writes held back by a batch must reach the peers before we wait,
+    // otherwise they can never drain the pipe we are blocked on
+    xflush_send_batch ();
+
     // Oops, we couldn't send the message. Wait for the next
     // command, process it and try to send the message again
     // If timeout is reached in the meantime, return EAGAIN
@@ -813,8 +903,9 @@ int slk::socket_base_t::recv (msg_t *msg_, int flags_)
 
     // Once every inbound_poll_rate messages check for signals and process
     // incoming commands
-    if (++_ticks == inbound_poll_rate) {
-        if (unlikely (process_commands (0, false) != 0)) {
+    if (++_ticks >= options.inbound_poll_rate) {
+        if (unlikely (process_commands (0, false, options.command_batch)
+                      != 0)) {
             return -1;
         }
         _ticks = 0;
@@ -929,7 +1020,9 @@ void slk::socket_base_t::start_reaping (poller_t *poller_)
     check_destroy ();
 }
 
-int slk::socket_base_t::process_commands (int timeout_, bool throttle_)
+int slk::socket_base_t::process_commands (int timeout_,
+                                          bool throttle_,
+                                          int max_commands_)
 {
     if (timeout_ == 0) {
         // If we are asked not to wait, check whether we haven't processed
@@ -944,7 +1037,9 @@ int slk::socket_base_t::process_commands (int timeout_, bool throttle_)
             // Check whether TSC haven't jumped backwards (in case of migration
             // between CPU cores) and whether certain time have elapsed since
             // last command processing
-            if (tsc >= _last_tsc && tsc - _last_tsc <= max_command_delay)
+            if (tsc >= _last_tsc
+                && tsc - _last_tsc
+                     <= static_cast<uint64_t> (options.command_delay))
                 return 0;
             _last_tsc = tsc;
         }
@@ -957,15 +1052,27 @@ int slk::socket_base_t::process_commands (int timeout_, bool throttle_)
     if (rc != 0 && errno == EINTR)
         return -1;
 
-    // Process all available commands
+    // Process all available commands, or as many as we were allowed to
+    int processed = 0;
+    bool bounded = false;
     while (rc == 0 || errno == EINTR) {
         if (rc == 0) {
             cmd.destination->process_command (cmd);
+            if (++processed == max_commands_) {
+                bounded = true;
+                break;
+            }
         }
         rc = _mailbox->recv (&cmd, 0);
     }
+    _commands_processed += processed;
 
-    slk_assert (errno == EAGAIN);
+    if (bounded) {
+        // More may be queued. Make sure the throttle does not hold them
+        // back on the next call.
+        _last_tsc = 0;
+    } else
+        slk_assert (errno == EAGAIN);
 
     if (_ctx_terminated) {
         errno = ETERM;
@@ -1124,6 +1231,18 @@ int slk::socket_base_t::xsend (msg_t *)
     return -1;
 }
 
+void slk::socket_base_t::xbegin_send_batch ()
+{
+}
+
+void slk::socket_base_t::xflush_send_batch ()
+{
+}
+
+void slk::socket_base_t::xend_send_batch ()
+{
+}
+
 bool slk::socket_base_t::xhas_in ()
 {
     return false;
@@ -1152,6 +1271,17 @@ bool slk::socket_base_t::is_disconnected () const
     return _disconnected;
 }
 
+#ifdef SL_ENABLE_MONITORING
+void slk::socket_base_t::get_latency (bool send_,
+                                      latency_summary_t *summary_) const
+{
+    if (send_)
+        _send_latency.summarize (summary_);
+    else
+        _recv_latency.summarize (summary_);
+}
+#endif
+
 // routing_socket_base_t implementation
 
 slk::routing_socket_base_t::routing_socket_base_t (class ctx_t *parent_,
@@ -1184,14 +1314,11 @@ int slk::routing_socket_base_t::xsetsockopt (int option_,
 
 void slk::routing_socket_base_t::xwrite_activated (pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    for (out_pipes_t::iterator it = _out_pipes.begin (); it != end; ++it)
-        if (it->second.pipe == pipe_) {
-            slk_assert (!it->second.active);
-            it->second.active = true;
-            return;
-        }
-    slk_assert (false);
+    // Every out pipe is registered under its own routing id.
+    out_pipe_t *const out_pipe = _out_pipes.find (pipe_->get_routing_id ());
+    slk_assert (out_pipe && out_pipe->pipe == pipe_);
+    slk_assert (!out_pipe->active);
+    out_pipe->active = true;
 }
 
 std::string slk::routing_socket_base_t::extract_connect_routing_id ()
@@ -1211,51 +1338,39 @@ void slk::routing_socket_base_t::add_out_pipe (blob_t routing_id_,
 {
     // Add the record into output pipes lookup table
     const out_pipe_t outpipe = {pipe_, true};
-    const bool ok =
-      _out_pipes.SL_MAP_INSERT_OR_EMPLACE (SL_MOVE (routing_id_), outpipe)
-        .second;
+    const bool ok = _out_pipes.insert (SL_MOVE (routing_id_), outpipe);
     slk_assert (ok);
 }
 
 bool slk::routing_socket_base_t::has_out_pipe (const blob_t &routing_id_) const
 {
-    return _out_pipes.find (routing_id_) != _out_pipes.end ();
+    return _out_pipes.find (routing_id_) != NULL;
 }
 
 slk::routing_socket_base_t::out_pipe_t *
 slk::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_)
 {
-    out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 const slk::routing_socket_base_t::out_pipe_t *
 slk::routing_socket_base_t::lookup_out_pipe (const blob_t &routing_id_) const
 {
-    out_pipes_t::const_iterator it = _out_pipes.find (routing_id_);
-    return it == _out_pipes.end () ? NULL : &it->second;
+    return _out_pipes.find (routing_id_);
 }
 
 void slk::routing_socket_base_t::erase_out_pipe (const pipe_t *pipe_)
 {
-    const out_pipes_t::iterator end = _out_pipes.end ();
-    for (out_pipes_t::iterator it = _out_pipes.begin (); it != end; ++it) {
-        if (it->second.pipe == pipe_) {
-            _out_pipes.erase (it);
-            return;
-        }
-    }
+    const blob_t &routing_id = pipe_->get_routing_id ();
+    const out_pipe_t *const out_pipe = _out_pipes.find (routing_id);
+    if (out_pipe && out_pipe->pipe == pipe_)
+        _out_pipes.erase (routing_id);
 }
 
 slk::routing_socket_base_t::out_pipe_t
 slk::routing_socket_base_t::try_erase_out_pipe (const blob_t &routing_id_)
 {
-    const out_pipes_t::iterator it = _out_pipes.find (routing_id_);
-    if (it != _out_pipes.end ()) {
-        const out_pipe_t res = it->second;
-        _out_pipes.erase (it);
-        return res;
-    }
-    const out_pipe_t null_pipe = {NULL, false};
-    return null_pipe;
+    out_pipe_t res = {NULL, false};
+    _out_pipes.erase (routing_id_, &res);
+    return res;
 }
@@ -16,6 +16,10 @@
 #include "../io/poller.hpp"
 #include "../pipe/pipe.hpp"
 #include "../util/clock.hpp"
+#include "../util/routing_table.hpp"
+#ifdef SL_ENABLE_MONITORING
+#include "../monitor/latency_histogram.hpp"
+#endif
 #include "endpoint.hpp"
 
 namespace slk
@@ -60,6 +64,14 @@ class socket_base_t : public own_t,
     int recv (msg_t *msg_, int flags_);
     int close ();
 
+    // Multi-frame send interface for the API layer. begin_send processes
+    // pending commands once; send_part then writes one frame without
+    // touching the mailbox unless it has to block. If batch_ is true the
+    // socket may hold back pipe flushes until end_send is called.
+    int begin_send (bool batch_);
+    int send_part (msg_t *msg_, int flags_);
+    void end_send ();
+
     // These functions are used by the polling mechanism to determine
     // which events are to be reported from this socket
     bool has_in ();
@@ -88,6 +100,14 @@ class socket_base_t : public own_t,
 
     bool is_disconnected () const;
 
+#ifdef SL_ENABLE_MONITORING
+    // Sampled message latency. The send side covers the time from send
+    // until the I/O thread takes the message for the wire, the receive
+    // side from decoding until the application receives it. Only reads
+    // atomics, so it may be called from any thread.
+    void get_latency (bool send_, latency_summary_t *summary_) const;
+#endif
+
     // Signaler support for thread-safe sockets (not yet implemented)
     // These are stub methods that will be implemented when thread-safe sockets are added
     void add_signaler (class signaler_t *signaler_) { (void)signaler_; }
@@ -116,6 +136,13 @@ class socket_base_t : public own_t,
     virtual bool xhas_out ();
     virtual int xsend (msg_t *msg_);
 
+    // Hooks bracketing a batched send. A socket may defer pipe flushes
+    // between begin and end; flush must write out whatever was deferred
+    // so far. The default implementation flushes eagerly in xsend.
+    virtual void xbegin_send_batch ();
+    virtual void xflush_send_batch ();
+    virtual void xend_send_batch ();
+
     // The default implementation assumes that recv in not supported
     virtual bool xhas_in ();
     virtual int xrecv (msg_t *msg_);
@@ -143,8 +170,10 @@ class socket_base_t : public own_t,
     // returns only after at least one command was processed.
     // If throttle argument is true, commands are processed at most once
     // in a predefined time period.
+    // If max_commands is positive, at most that many commands are
+    // processed; the rest stay queued for the next call.
     // This is public so that slk_poll() can process pending commands before polling.
-    int process_commands (int timeout_, bool throttle_);
+    int process_commands (int timeout_, bool throttle_, int max_commands_ = 0);
 
   private:
     // Creates new endpoint ID and adds the endpoint to the map
@@ -214,6 +243,15 @@ class socket_base_t : public own_t,
     // Number of messages received since last command processing
     int _ticks;
 
+    // Number of commands processed over the socket's lifetime
+    uint64_t _commands_processed;
+
+#ifdef SL_ENABLE_MONITORING
+    // Filled by the pipes attached to this socket
+    latency_histogram_t _send_latency;
+    latency_histogram_t _recv_latency;
+#endif
+
     // True if the last message received had MORE flag set
     bool _rcvmore;
 
@@ -274,8 +312,9 @@ class routing_socket_base_t : public socket_base_t
     }
 
   private:
-    // Outbound pipes indexed by the peer IDs
-    typedef std::map<blob_t, out_pipe_t> out_pipes_t;
+    // Outbound pipes indexed by the peer IDs. Hashed rather than
+    // ordered: routed sends look a peer up once per message.
+    typedef routing_table_t<out_pipe_t> out_pipes_t;
     out_pipes_t _out_pipes;
 
     // Next assigned name on a connect() call used by ROUTER socket
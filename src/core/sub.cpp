@@ -26,13 +26,15 @@ int slk::sub_t::xsetsockopt (int option_,
                              size_t optvallen_)
 {
     if (option_ != SL_SUBSCRIBE && option_ != SL_UNSUBSCRIBE
-        && option_ != SL_PSUBSCRIBE && option_ != SL_PUNSUBSCRIBE) {
+        && option_ != SL_PSUBSCRIBE && option_ != SL_PUNSUBSCRIBE
+        && option_ != SL_SUBSCRIBE_REGION
+        && option_ != SL_UNSUBSCRIBE_REGION) {
         errno = EINVAL;
         return -1;
     }
 
-    // Pattern subscriptions are handled directly by xsub_t
-    if (option_ == SL_PSUBSCRIBE || option_ == SL_PUNSUBSCRIBE) {
+    // Pattern and region subscriptions are handled directly by xsub_t
+    if (option_ != SL_SUBSCRIBE && option_ != SL_UNSUBSCRIBE) {
         return xsub_t::xsetsockopt (option_, optval_, optvallen_);
     }
 
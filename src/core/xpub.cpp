@@ -2,6 +2,7 @@
 /* ServerLink - Ported from libzmq */
 
 #include <string.h>
+#include <algorithm>
 #include <utility>
 #include <stdio.h>
 
@@ -12,6 +13,7 @@
 #include "../util/macros.hpp"
 #include "../pipe/mtrie_impl.hpp"  // Required for template instantiation
 #include "ctx.hpp"
+#include "../util/constants.hpp"
 
 slk::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     socket_base_t (parent_, tid_, sid_),
@@ -25,7 +27,9 @@ slk::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
     _manual (false),
     _send_last_pipe (false),
     _pending_pipes (),
-    _welcome_msg ()
+    _welcome_msg (),
+    _conflate_prefixes (0),
+    _conflate_send (false)
 {
     _last_pipe = NULL;
     options.type = SL_XPUB;
@@ -35,6 +39,10 @@ slk::xpub_t::xpub_t (class ctx_t *parent_, uint32_t tid_, int sid_) :
 slk::xpub_t::~xpub_t ()
 {
     _welcome_msg.close ();
+    while (!_held.empty ())
+        drop_held (_held.begin ()->first);
+    for (size_t i = 0; i < _hold_parts.size (); i++)
+        _hold_parts[i].close ();
     for (std::deque<metadata_t *>::iterator it = _pending_metadata.begin (),
                                             end = _pending_metadata.end ();
          it != end; ++it)
@@ -83,6 +91,8 @@ void slk::xpub_t::xread_activated (pipe_t *pipe_)
         size_t size = 0;
         bool subscribe = false;
         bool is_subscribe_or_cancel = false;
+        bool is_pattern = false;
+        bool is_region = false;
         bool notify = false;
 
         const bool first_part = !_more_recv;
@@ -100,6 +110,22 @@ void slk::xpub_t::xread_activated (pipe_t *pipe_)
                 size = msg.size () - 1;
                 subscribe = *msg_data == 1;
                 is_subscribe_or_cancel = true;
+            } else if (msg.size () > 0
+                       && (*msg_data == SL_PATTERN_SUBSCRIBE_BYTE
+                           || *msg_data == SL_PATTERN_CANCEL_BYTE)) {
+                data = msg_data + 1;
+                size = msg.size () - 1;
+                subscribe = *msg_data == SL_PATTERN_SUBSCRIBE_BYTE;
+                is_subscribe_or_cancel = true;
+                is_pattern = true;
+            } else if (msg.size () > 0
+                       && (*msg_data == SL_REGION_SUBSCRIBE_BYTE
+                           || *msg_data == SL_REGION_CANCEL_BYTE)) {
+                data = msg_data + 1;
+                size = msg.size () - 1;
+                subscribe = *msg_data == SL_REGION_SUBSCRIBE_BYTE;
+                is_subscribe_or_cancel = true;
+                is_region = true;
             }
         }
 
@@ -107,7 +133,20 @@ void slk::xpub_t::xread_activated (pipe_t *pipe_)
             _process_subscribe =
               !_only_first_subscribe || is_subscribe_or_cancel;
 
-        if (is_subscribe_or_cancel) {
+        if (is_pattern) {
+            notify = apply_pattern (data, size, subscribe, pipe_)
+                     || (subscribe ? _verbose_subs : _verbose_unsubs);
+
+            // Pattern notifications keep their own leading byte so that
+            // a proxy can forward them to an XSUB unchanged
+            if (!_manual && options.type == SL_XPUB && notify)
+                push_notification (*msg_data, data, size, metadata);
+        } else if (is_region) {
+            notify = apply_region (data, size, subscribe, pipe_)
+                     || (subscribe ? _verbose_subs : _verbose_unsubs);
+            if (!_manual && options.type == SL_XPUB && notify)
+                push_notification (*msg_data, data, size, metadata);
+        } else if (is_subscribe_or_cancel) {
             if (_manual) {
                 // Store manual subscription to use on termination
                 if (!subscribe)
@@ -145,18 +184,7 @@ void slk::xpub_t::xread_activated (pipe_t *pipe_)
                 // the message, so this optimization is not possible.
                 // The pushback makes a copy of the data array anyway, so the
                 // number of buffer copies does not change.
-                blob_t notification (size + 1);
-                if (subscribe)
-                    *notification.data () = 1;
-                else
-                    *notification.data () = 0;
-                memcpy (notification.data () + 1, data, size);
-
-                _pending_data.push_back (std::move (notification));
-                if (metadata)
-                    metadata->add_ref ();
-                _pending_metadata.push_back (metadata);
-                _pending_flags.push_back (0);
+                push_notification (subscribe ? 1 : 0, data, size, metadata);
             }
         } else if (options.type != SL_PUB) {
             // Process user message coming upstream from xsub socket,
@@ -173,9 +201,173 @@ void slk::xpub_t::xread_activated (pipe_t *pipe_)
     }
 }
 
+bool slk::xpub_t::apply_pattern (const unsigned char *data_,
+                                 size_t size_,
+                                 bool subscribe_,
+                                 pipe_t *pipe_)
+{
+    const std::string pattern (reinterpret_cast<const char *> (data_),
+                               size_);
+
+    if (subscribe_) {
+        pattern_pipes_t::iterator it = _pattern_pipes.find (pattern);
+        if (it != _pattern_pipes.end ()) {
+            it->second.insert (pipe_);
+            return false;
+        }
+        // Patterns that fail to compile are ignored
+        _pattern_subscriptions.add (pattern);
+        if (!_pattern_subscriptions.contains (data_, size_))
+            return false;
+        _pattern_pipes[pattern].insert (pipe_);
+        return true;
+    }
+
+    const pattern_pipes_t::iterator it = _pattern_pipes.find (pattern);
+    if (it == _pattern_pipes.end () || it->second.erase (pipe_) == 0)
+        return false;
+    if (!it->second.empty ())
+        return false;
+    _pattern_subscriptions.rm (pattern);
+    _pattern_pipes.erase (it);
+    return true;
+}
+
+bool slk::xpub_t::apply_region (const unsigned char *data_,
+                                size_t size_,
+                                bool subscribe_,
+                                pipe_t *pipe_)
+{
+    if (!subscribe_) {
+        const std::string_view grid (reinterpret_cast<const char *> (data_),
+                                     size_);
+        return _regions.rm (grid, pipe_) && !_regions.has (grid);
+    }
+
+    // Malformed regions are ignored
+    std::string_view grid;
+    region_t region;
+    if (!decode_region (data_, size_, grid, region))
+        return false;
+
+    // Like prefixes, a grid is reported when it gets its first region;
+    // moves are only reported in verbose mode
+    const bool first = !_regions.has (grid);
+    _regions.set (grid, region, pipe_);
+    return first;
+}
+
+void slk::xpub_t::push_notification (unsigned char type_,
+                                     const unsigned char *data_,
+                                     size_t size_,
+                                     metadata_t *metadata_)
+{
+    blob_t notification (size_ + 1);
+    *notification.data () = type_;
+    if (size_ > 0)
+        memcpy (notification.data () + 1, data_, size_);
+
+    _pending_data.push_back (std::move (notification));
+    if (metadata_)
+        metadata_->add_ref ();
+    _pending_metadata.push_back (metadata_);
+    _pending_flags.push_back (0);
+}
+
 void slk::xpub_t::xwrite_activated (pipe_t *pipe_)
 {
     _dist.activated (pipe_);
+
+    // Held messages must not be interleaved with a multipart message
+    if (_held.find (pipe_) != _held.end ()) {
+        if (_more_send)
+            _drained_pipes.push_back (pipe_);
+        else
+            send_held (pipe_);
+    }
+}
+
+void slk::xpub_t::match_pipe (pipe_t *pipe_)
+{
+    // Once anything is held for a pipe, newer messages of conflated
+    // topics queue up behind it to stay in order
+    if (_conflate_send
+        && (_held.find (pipe_) != _held.end () || !pipe_->check_write ())) {
+        if (std::find (_hold_pipes.begin (), _hold_pipes.end (), pipe_)
+            == _hold_pipes.end ())
+            _hold_pipes.push_back (pipe_);
+        return;
+    }
+    _dist.match (pipe_);
+}
+
+void slk::xpub_t::hold_message ()
+{
+    const std::string topic (static_cast<const char *> (_hold_parts[0].data ()),
+                             _hold_parts[0].size ());
+
+    for (size_t i = 0; i < _hold_pipes.size (); i++) {
+        held_queue_t &queue = _held[_hold_pipes[i]];
+        std::unordered_map<std::string,
+                           std::list<held_msg_t>::iterator>::iterator it =
+          queue.topics.find (topic);
+        if (it == queue.topics.end ()) {
+            queue.msgs.push_back (held_msg_t ());
+            queue.msgs.back ().topic = topic;
+            it = queue.topics.emplace (topic, --queue.msgs.end ()).first;
+        }
+
+        // The newest message replaces the held one in its place
+        std::vector<msg_t> &parts = it->second->parts;
+        for (size_t j = 0; j < parts.size (); j++)
+            parts[j].close ();
+        parts.resize (_hold_parts.size ());
+        for (size_t j = 0; j < parts.size (); j++) {
+            int rc = parts[j].init ();
+            errno_assert (rc == 0);
+            rc = parts[j].copy (_hold_parts[j]);
+            errno_assert (rc == 0);
+        }
+    }
+}
+
+void slk::xpub_t::send_held (pipe_t *pipe_)
+{
+    const held_t::iterator it = _held.find (pipe_);
+    if (it == _held.end ())
+        return;
+
+    // The HWM counts whole messages, so once the first part of a message
+    // fits, so do all the others
+    held_queue_t &queue = it->second;
+    bool written = false;
+    while (!queue.msgs.empty () && pipe_->check_write ()) {
+        held_msg_t &held = queue.msgs.front ();
+        for (size_t i = 0; i < held.parts.size (); i++) {
+            const bool ok = pipe_->write (&held.parts[i]);
+            slk_assert (ok);
+        }
+        queue.topics.erase (held.topic);
+        queue.msgs.pop_front ();
+        written = true;
+    }
+    if (written)
+        pipe_->flush ();
+    if (queue.msgs.empty ())
+        _held.erase (it);
+}
+
+void slk::xpub_t::drop_held (pipe_t *pipe_)
+{
+    const held_t::iterator it = _held.find (pipe_);
+    if (it == _held.end ())
+        return;
+
+    for (std::list<held_msg_t>::iterator held = it->second.msgs.begin ();
+         held != it->second.msgs.end (); ++held)
+        for (size_t i = 0; i < held->parts.size (); i++)
+            held->parts[i].close ();
+    _held.erase (it);
 }
 
 int slk::xpub_t::xsetsockopt (int option_,
@@ -213,6 +405,21 @@ int slk::xpub_t::xsetsockopt (int option_,
         if (_last_pipe != NULL)
             _subscriptions.rm ((unsigned char *) optval_, optvallen_,
                                _last_pipe);
+    } else if (option_ == SL_XPUB_CONFLATE_TOPIC) {
+        if (_conflate_topics.add ((unsigned char *) optval_, optvallen_))
+            _conflate_prefixes++;
+    } else if (option_ == SL_XPUB_UNCONFLATE_TOPIC) {
+        if (_conflate_topics.rm ((unsigned char *) optval_, optvallen_))
+            _conflate_prefixes--;
+    } else if (option_ == SL_XPUB_CONFLATE_EXACT) {
+        _conflate_exact.emplace (static_cast<const char *> (optval_),
+                                 optvallen_);
+    } else if (option_ == SL_XPUB_UNCONFLATE_EXACT) {
+        const std::set<std::string, std::less<> >::iterator it =
+          _conflate_exact.find (std::string_view (
+            static_cast<const char *> (optval_), optvallen_));
+        if (it != _conflate_exact.end ())
+            _conflate_exact.erase (it);
     } else if (option_ == SL_XPUB_WELCOME_MSG) {
         _welcome_msg.close ();
 
@@ -306,12 +513,63 @@ void slk::xpub_t::xpipe_terminated (pipe_t *pipe_)
         _subscriptions.rm (pipe_, send_unsubscription, this, !_verbose_unsubs);
     }
 
+    // Drop the pipe from its pattern subscriptions, reporting patterns
+    // nobody is interested in anymore
+    for (pattern_pipes_t::iterator it = _pattern_pipes.begin ();
+         it != _pattern_pipes.end ();) {
+        if (it->second.erase (pipe_) == 0 || !it->second.empty ()) {
+            ++it;
+            continue;
+        }
+        _pattern_subscriptions.rm (it->first);
+        if (!_manual && options.type != SL_PUB)
+            push_notification (
+              SL_PATTERN_CANCEL_BYTE,
+              reinterpret_cast<const unsigned char *> (it->first.data ()),
+              it->first.size (), NULL);
+        _pattern_pipes.erase (it++);
+    }
+
+    _regions.rm (pipe_, send_region_cancel, this);
+
+    drop_held (pipe_);
+    _hold_pipes.erase (
+      std::remove (_hold_pipes.begin (), _hold_pipes.end (), pipe_),
+      _hold_pipes.end ());
+    _drained_pipes.erase (
+      std::remove (_drained_pipes.begin (), _drained_pipes.end (), pipe_),
+      _drained_pipes.end ());
+
     _dist.pipe_terminated (pipe_);
 }
 
 void slk::xpub_t::mark_as_matching (pipe_t *pipe_, xpub_t *self_)
 {
-    self_->_dist.match (pipe_);
+    self_->match_pipe (pipe_);
+}
+
+void slk::xpub_t::mark_pattern_as_matching (const std::string &pattern_,
+                                            void *arg_)
+{
+    xpub_t *self = static_cast<xpub_t *> (arg_);
+    const pattern_pipes_t::const_iterator it =
+      self->_pattern_pipes.find (pattern_);
+    if (it == self->_pattern_pipes.end ())
+        return;
+    for (std::set<pipe_t *>::const_iterator pipe = it->second.begin (),
+                                            end = it->second.end ();
+         pipe != end; ++pipe)
+        self->match_pipe (*pipe);
+}
+
+void slk::xpub_t::send_region_cancel (const std::string &grid_,
+                                      xpub_t *self_)
+{
+    if (!self_->_manual && self_->options.type != SL_PUB)
+        self_->push_notification (
+          SL_REGION_CANCEL_BYTE,
+          reinterpret_cast<const unsigned char *> (grid_.data ()),
+          grid_.size (), NULL);
 }
 
 void slk::xpub_t::mark_last_pipe_as_matching (pipe_t *pipe_, xpub_t *self_)
@@ -328,6 +586,19 @@ int slk::xpub_t::xsend (msg_t *msg_)
     if (!_more_send) {
         // Ensure nothing from previous failed attempt to send is left matched
         _dist.unmatch ();
+        _hold_pipes.clear ();
+
+        // Conflation decides per pipe, which inverted matching cannot
+        _conflate_send =
+          !options.invert_matching
+          && ((_conflate_prefixes > 0
+               && _conflate_topics.check (
+                 static_cast<unsigned char *> (msg_->data ()), msg_->size ()))
+              || (!_conflate_exact.empty ()
+                  && _conflate_exact.find (std::string_view (
+                       static_cast<const char *> (msg_->data ()),
+                       msg_->size ()))
+                       != _conflate_exact.end ()));
 
         if (_manual && _last_pipe && _send_last_pipe) {
             _subscriptions.match (static_cast<unsigned char *> (msg_->data ()),
@@ -337,6 +608,16 @@ int slk::xpub_t::xsend (msg_t *msg_)
         } else {
             _subscriptions.match (static_cast<unsigned char *> (msg_->data ()),
                                   msg_->size (), mark_as_matching, this);
+            if (!_pattern_pipes.empty ())
+                _pattern_subscriptions.match (
+                  static_cast<unsigned char *> (msg_->data ()), msg_->size (),
+                  mark_pattern_as_matching, this);
+            std::string_view grid;
+            int32_t x, y;
+            if (_regions.size () > 0
+                && parse_cell (static_cast<unsigned char *> (msg_->data ()),
+                               msg_->size (), grid, x, y))
+                _regions.match (grid, x, y, mark_as_matching, this);
         }
         // If inverted matching is used, reverse the selection now
         if (options.invert_matching) {
@@ -346,16 +627,43 @@ int slk::xpub_t::xsend (msg_t *msg_)
 
     int rc = -1; // Assume we fail
     if (_lossy || _dist.check_hwm ()) {
+        // Keep a reference to each part for the pipes it is held back for
+        if (!_hold_pipes.empty ()) {
+            _hold_parts.push_back (msg_t ());
+            rc = _hold_parts.back ().init ();
+            errno_assert (rc == 0);
+            rc = _hold_parts.back ().copy (*msg_);
+            errno_assert (rc == 0);
+        }
+
         if (_dist.send_to_matching (msg_) == 0) {
             // If we are at the end of multi-part message we can mark
             // all the pipes as non-matching
-            if (!msg_more)
+            if (!msg_more) {
                 _dist.unmatch ();
+                if (!_hold_parts.empty ())
+                    hold_message ();
+            }
             _more_send = msg_more;
             rc = 0; // Yay, sent successfully
-        }
+        } else
+            rc = -1;
     } else
         errno = EAGAIN;
+
+    if (!_more_send) {
+        for (size_t i = 0; i < _hold_parts.size (); i++)
+            _hold_parts[i].close ();
+        _hold_parts.clear ();
+
+        // Pipes that drained in the middle of the message get their
+        // held messages now
+        while (!_drained_pipes.empty ()) {
+            pipe_t *pipe = _drained_pipes.back ();
+            _drained_pipes.pop_back ();
+            send_held (pipe);
+        }
+    }
     return rc;
 }
 
@@ -5,11 +5,20 @@
 #define SL_XPUB_HPP_INCLUDED
 
 #include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "socket_base.hpp"
 #include "session_base.hpp"
 #include "../pipe/mtrie.hpp"
 #include "../pipe/dist.hpp"
+#include "../pipe/trie.hpp"
+#include "../pattern/pattern_trie.hpp"
+#include "../pattern/region_index.hpp"
 
 namespace slk
 {
@@ -48,12 +57,66 @@ class xpub_t : public socket_base_t
     // Function to be applied to each matching pipes
     static void mark_as_matching (pipe_t *pipe_, xpub_t *self_);
 
+    // Function to be applied to each pattern matching the message
+    static void mark_pattern_as_matching (const std::string &pattern_,
+                                          void *arg_);
+
+    // Apply a pattern subscribe/cancel from the pipe. Returns true if the
+    // pattern was added for the first or removed for the last pipe
+    bool apply_pattern (const unsigned char *data_,
+                        size_t size_,
+                        bool subscribe_,
+                        pipe_t *pipe_);
+
+    // Apply a region subscribe/cancel from the pipe. Returns true if the
+    // grid got its first region or lost its last one
+    bool apply_region (const unsigned char *data_,
+                       size_t size_,
+                       bool subscribe_,
+                       pipe_t *pipe_);
+
+    // Function to be applied to each grid a terminated pipe was the last
+    // with a region on
+    static void send_region_cancel (const std::string &grid_, xpub_t *self_);
+
+    // Queue a (un)subscription notification for the user
+    void push_notification (unsigned char type_,
+                            const unsigned char *data_,
+                            size_t size_,
+                            metadata_t *metadata_);
+
+    // Mark the pipe as matching the message being sent, or as a pipe the
+    // message is held back for if it is conflated and the pipe is full
+    void match_pipe (pipe_t *pipe_);
+
+    // Store the message just sent as the newest one of its topic for
+    // each pipe it was held back for
+    void hold_message ();
+
+    // Write as many held messages to the pipe as it takes
+    void send_held (pipe_t *pipe_);
+
+    // Drop everything held for the pipe
+    void drop_held (pipe_t *pipe_);
+
     // List of all subscriptions mapped to corresponding pipes
     mtrie_t<pipe_t> _subscriptions;
 
     // List of manual subscriptions mapped to corresponding pipes
     mtrie_t<pipe_t> _manual_subscriptions;
 
+    // Pattern (glob) subscriptions forwarded by subscribers, matched next
+    // to the prefix trie so that only matching messages leave the socket.
+    // Patterns are always applied automatically, even in manual mode
+    pattern_trie_t _pattern_subscriptions;
+    typedef std::map<std::string, std::set<pipe_t *> > pattern_pipes_t;
+    pattern_pipes_t _pattern_pipes;
+
+    // Region (area of interest) subscriptions: one rectangle of cells per
+    // pipe and grid, matched against topics of the form "<grid>:<x>,<y>".
+    // Like patterns they are applied automatically, even in manual mode
+    region_index_t<pipe_t> _regions;
+
     // Distributor of messages holding the list of outbound pipes
     dist_t _dist;
 
@@ -110,6 +173,42 @@ class xpub_t : public socket_base_t
     std::deque<metadata_t *> _pending_metadata;
     std::deque<unsigned char> _pending_flags;
 
+    // Topic prefixes set with SLK_XPUB_CONFLATE_TOPIC. The topic of a
+    // message is its first frame. A message of a conflated topic that
+    // meets a pipe at its HWM is held back instead of dropped; each pipe
+    // holds at most the newest message per topic, in first-held order,
+    // and gets them once it drains.
+    trie_t _conflate_topics;
+    int _conflate_prefixes;
+
+    // Topics set with SLK_XPUB_CONFLATE_EXACT, conflated like the above
+    // but only if the first frame is exactly the topic
+    std::set<std::string, std::less<> > _conflate_exact;
+
+    struct held_msg_t
+    {
+        std::string topic;
+        std::vector<msg_t> parts;
+    };
+    struct held_queue_t
+    {
+        std::list<held_msg_t> msgs;
+        std::unordered_map<std::string, std::list<held_msg_t>::iterator>
+          topics;
+    };
+    typedef std::map<pipe_t *, held_queue_t> held_t;
+    held_t _held;
+
+    // True if the message being sent belongs to a conflated topic
+    bool _conflate_send;
+
+    // Pipes the message being sent is held back for, and its parts so far
+    std::vector<pipe_t *> _hold_pipes;
+    std::vector<msg_t> _hold_parts;
+
+    // Pipes that drained while a multipart message was being sent
+    std::vector<pipe_t *> _drained_pipes;
+
     SL_NON_COPYABLE_NOR_MOVABLE (xpub_t)
 };
 }
@@ -46,6 +46,8 @@ void slk::xsub_t::xattach_pipe (pipe_t *pipe_,
 
     // Send all the cached subscriptions to the new upstream peer
     _subscriptions.apply (send_subscription, pipe_);
+    _pattern_subscriptions.apply (send_pattern_subscription, pipe_);
+    send_region_subscriptions (pipe_);
     pipe_->flush ();
 }
 
@@ -69,6 +71,8 @@ void slk::xsub_t::xhiccuped (pipe_t *pipe_)
 {
     // Send all the cached subscriptions to the hiccuped pipe
     _subscriptions.apply (send_subscription, pipe_);
+    _pattern_subscriptions.apply (send_pattern_subscription, pipe_);
+    send_region_subscriptions (pipe_);
     pipe_->flush ();
 }
 
@@ -94,46 +98,45 @@ int slk::xsub_t::xsetsockopt (int option_,
         _verbose_unsubs = (*static_cast<const int *> (optval_) != 0);
         return 0;
     }
-    else if (option_ == SL_PSUBSCRIBE) {
-        // Add pattern subscription
-        const unsigned char *pattern = static_cast<const unsigned char *> (optval_);
-        bool added = _pattern_subscriptions.add (pattern, optvallen_);
-
-        // When first pattern is added, subscribe to empty prefix (receive all messages)
-        // This ensures we receive messages for pattern matching
-        if (added && _pattern_subscriptions.num_patterns () == 1) {
-            bool first_sub = _subscriptions.add (NULL, 0);
-            if (first_sub) {
-                // Send subscription message for empty prefix to all upstream peers
-                msg_t msg;
-                int rc = msg.init_subscribe (0, NULL);
-                errno_assert (rc == 0);
-                _dist.send_to_all (&msg);
-                msg.close ();
-            }
-        }
-
-        return 0;
+    else if (option_ == SL_PSUBSCRIBE || option_ == SL_PUNSUBSCRIBE) {
+        // Pattern subscriptions travel upstream like prefix ones, so that
+        // the publisher can filter on them
+        msg_t msg;
+        int rc = msg.init_size (optvallen_ + 1);
+        errno_assert (rc == 0);
+        unsigned char *data = static_cast<unsigned char *> (msg.data ());
+        data[0] = option_ == SL_PSUBSCRIBE ? SL_PATTERN_SUBSCRIBE_BYTE
+                                           : SL_PATTERN_CANCEL_BYTE;
+        if (optvallen_ > 0)
+            memcpy (data + 1, optval_, optvallen_);
+
+        rc = xsub_t::xsend (&msg);
+        return close_and_return (&msg, rc);
     }
-    else if (option_ == SL_PUNSUBSCRIBE) {
-        // Remove pattern subscription
-        const unsigned char *pattern = static_cast<const unsigned char *> (optval_);
-        bool removed = _pattern_subscriptions.rm (pattern, optvallen_);
-
-        // When last pattern is removed, unsubscribe from empty prefix
-        if (removed && _pattern_subscriptions.num_patterns () == 0) {
-            bool last_unsub = _subscriptions.rm (NULL, 0);
-            if (last_unsub) {
-                // Send unsubscription message for empty prefix to all upstream peers
-                msg_t msg;
-                int rc = msg.init_cancel (0, NULL);
-                errno_assert (rc == 0);
-                _dist.send_to_all (&msg);
-                msg.close ();
-            }
+    else if (option_ == SL_SUBSCRIBE_REGION
+             || option_ == SL_UNSUBSCRIBE_REGION) {
+        // The value is the body of the region message: the grid name,
+        // followed by the rectangle when subscribing
+        std::string_view grid;
+        region_t region;
+        if (option_ == SL_SUBSCRIBE_REGION
+            && !decode_region (static_cast<const unsigned char *> (optval_),
+                               optvallen_, grid, region)) {
+            errno = EINVAL;
+            return -1;
         }
 
-        return 0;
+        msg_t msg;
+        int rc = msg.init_size (optvallen_ + 1);
+        errno_assert (rc == 0);
+        unsigned char *data = static_cast<unsigned char *> (msg.data ());
+        data[0] = option_ == SL_SUBSCRIBE_REGION ? SL_REGION_SUBSCRIBE_BYTE
+                                                 : SL_REGION_CANCEL_BYTE;
+        if (optvallen_ > 0)
+            memcpy (data + 1, optval_, optvallen_);
+
+        rc = xsub_t::xsend (&msg);
+        return close_and_return (&msg, rc);
     }
     errno = EINVAL;
     return -1;
@@ -190,7 +193,55 @@ int slk::xsub_t::xsend (msg_t *msg_)
         _process_subscribe = true;
         return _dist.send_to_all (msg_);
     }
-    if (msg_->is_cancel () || (size > 0 && *data == 0)) {
+    if (size > 0 && !msg_->is_cancel ()
+        && (*data == SL_PATTERN_SUBSCRIBE_BYTE
+            || *data == SL_PATTERN_CANCEL_BYTE)) {
+        // Process pattern subscribe/cancel message. Only the first
+        // subscribe and the last cancel of a pattern travel upstream;
+        // invalid patterns are never stored and thus never forwarded
+        const bool subscribe = *data == SL_PATTERN_SUBSCRIBE_BYTE;
+        _process_subscribe = true;
+        bool forward;
+        if (subscribe) {
+            forward = _pattern_subscriptions.add (data + 1, size - 1);
+        } else {
+            forward = _pattern_subscriptions.rm (data + 1, size - 1)
+                      && (_verbose_unsubs
+                          || !_pattern_subscriptions.contains (data + 1,
+                                                               size - 1));
+        }
+        if (forward)
+            return _dist.send_to_all (msg_);
+    } else if (size > 0 && !msg_->is_cancel ()
+               && (*data == SL_REGION_SUBSCRIBE_BYTE
+                   || *data == SL_REGION_CANCEL_BYTE)) {
+        // Process region subscribe/cancel message. Only changes travel
+        // upstream, so a region that moves costs one message
+        _process_subscribe = true;
+        bool forward = false;
+        if (*data == SL_REGION_SUBSCRIBE_BYTE) {
+            std::string_view grid;
+            region_t region;
+            if (decode_region (data + 1, size - 1, grid, region)) {
+                const regions_t::iterator it = _regions.find (grid);
+                if (it == _regions.end ()) {
+                    _regions.emplace (std::string (grid), region);
+                    forward = true;
+                } else if (!(it->second == region)) {
+                    it->second = region;
+                    forward = true;
+                }
+            }
+        } else {
+            const regions_t::iterator it = _regions.find (std::string_view (
+              reinterpret_cast<const char *> (data + 1), size - 1));
+            forward = it != _regions.end () || _verbose_unsubs;
+            if (it != _regions.end ())
+                _regions.erase (it);
+        }
+        if (forward)
+            return _dist.send_to_all (msg_);
+    } else if (msg_->is_cancel () || (size > 0 && *data == 0)) {
         // Process unsubscribe message
         if (!msg_->is_cancel ()) {
             data = data + 1;
@@ -299,40 +350,23 @@ bool slk::xsub_t::xhas_in ()
 
 bool slk::xsub_t::match (msg_t *msg_)
 {
-    bool has_patterns = (_pattern_subscriptions.num_patterns () > 0);
-
-    // Check prefix-based subscriptions first
-    bool prefix_match = _subscriptions.check (
-      static_cast<unsigned char *> (msg_->data ()), msg_->size ());
-
-    // Check pattern subscriptions
-    bool pattern_match = false;
-    if (has_patterns) {
-        pattern_match = _pattern_subscriptions.check (
-          static_cast<unsigned char *> (msg_->data ()), msg_->size ());
-    }
-
-    // If we have pattern subscriptions and this message matches the empty prefix
-    // (which we subscribe to for pattern matching), only accept if it matches a pattern
-    bool matching;
-    if (has_patterns && prefix_match) {
-        // Check if this is matching due to empty prefix subscription
-        // by checking if there are any non-empty prefix subscriptions
-        bool has_non_empty_prefixes = (_subscriptions.num_prefixes () > 1);
-
-        if (has_non_empty_prefixes) {
-            // We have both prefix and pattern subscriptions
-            // Accept if either matches
-            matching = prefix_match || pattern_match;
-        } else {
-            // Only have empty prefix (for patterns)
-            // Accept only if pattern matches
-            matching = pattern_match;
+    const unsigned char *data = static_cast<unsigned char *> (msg_->data ());
+    const size_t size = msg_->size ();
+
+    // Publishers filter on patterns as well; checking them here only
+    // guards against messages already in flight when a subscription changed
+    bool matching =
+      _subscriptions.check (data, size)
+      || (_pattern_subscriptions.num_patterns () > 0
+          && _pattern_subscriptions.check (data, size));
+
+    if (!matching && !_regions.empty ()) {
+        std::string_view grid;
+        int32_t x, y;
+        if (parse_cell (data, size, grid, x, y)) {
+            const regions_t::const_iterator it = _regions.find (grid);
+            matching = it != _regions.end () && it->second.contains (x, y);
         }
-    } else {
-        // No patterns, or no prefix match
-        // Standard behavior: accept if prefix matches OR pattern matches
-        matching = prefix_match || pattern_match;
     }
 
     return matching ^ options.invert_matching;
@@ -358,3 +392,40 @@ void slk::xsub_t::send_subscription (unsigned char *data_,
     if (!sent)
         msg.close ();
 }
+
+void slk::xsub_t::send_pattern_subscription (const std::string &pattern_,
+                                             void *arg_)
+{
+    pipe_t *pipe = static_cast<pipe_t *> (arg_);
+
+    msg_t msg;
+    const int rc = msg.init_size (pattern_.size () + 1);
+    errno_assert (rc == 0);
+    unsigned char *data = static_cast<unsigned char *> (msg.data ());
+    data[0] = SL_PATTERN_SUBSCRIBE_BYTE;
+    memcpy (data + 1, pattern_.data (), pattern_.size ());
+
+    // Dropped on SNDHWM, the same as prefix subscriptions
+    if (!pipe->write (&msg))
+        msg.close ();
+}
+
+void slk::xsub_t::send_region_subscriptions (pipe_t *pipe_)
+{
+    for (regions_t::const_iterator it = _regions.begin (),
+                                   end = _regions.end ();
+         it != end; ++it) {
+        msg_t msg;
+        const int rc =
+          msg.init_size (1 + it->first.size () + region_wire_size);
+        errno_assert (rc == 0);
+        unsigned char *data = static_cast<unsigned char *> (msg.data ());
+        data[0] = SL_REGION_SUBSCRIBE_BYTE;
+        memcpy (data + 1, it->first.data (), it->first.size ());
+        encode_region (data + 1 + it->first.size (), it->second);
+
+        // Dropped on SNDHWM, the same as prefix subscriptions
+        if (!pipe_->write (&msg))
+            msg.close ();
+    }
+}
@@ -10,6 +10,11 @@
 #include "../pipe/fq.hpp"
 #include "../pipe/trie.hpp"
 #include "../pattern/pattern_trie.hpp"
+#include "../pattern/region_index.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
 
 namespace slk
 {
@@ -49,6 +54,14 @@ class xsub_t : public socket_base_t
     static void
     send_subscription (unsigned char *data_, size_t size_, void *arg_);
 
+    // Function to be applied to the pattern trie to send all the pattern
+    // subscriptions upstream
+    static void send_pattern_subscription (const std::string &pattern_,
+                                           void *arg_);
+
+    // Send all the region subscriptions to the pipe
+    void send_region_subscriptions (pipe_t *pipe_);
+
     // Fair queueing object for inbound pipes
     fq_t _fq;
 
@@ -58,9 +71,15 @@ class xsub_t : public socket_base_t
     // The repository of subscriptions
     trie_with_size_t _subscriptions;
 
-    // The repository of pattern subscriptions (glob patterns)
+    // The repository of pattern subscriptions (glob patterns). They are
+    // forwarded upstream and matched by the publisher as well
     pattern_trie_t _pattern_subscriptions;
 
+    // Region subscriptions, one rectangle of cells per grid. Moving a
+    // region replaces it upstream with a single message
+    typedef std::map<std::string, region_t, std::less<> > regions_t;
+    regions_t _regions;
+
     // If true, send all unsubscription messages upstream, not just
     // unique ones
     bool _verbose_unsubs;
@@ -3,6 +3,8 @@
 #include "../../precompiled.hpp"
 #include "poller.hpp"
 #include "../i_poll_events.hpp"
+#include "../../util/err.hpp"
+#include "../uring/uring.hpp"
 #include <cstdio>
 #include <chrono>
 #include <thread>
@@ -17,26 +19,29 @@
 slk::asio_poller_t::asio_poller_t(ctx_t* ctx_)
     : worker_poller_base_t(ctx_),
       _work_guard(asio::make_work_guard(_io_context.get_executor())),
-      _lifetime_sentinel(std::make_shared<int>(0))
+      _lifetime_sentinel(std::make_shared<int>(0)),
+      _timer(_io_context),
+      _timer_armed(false),
+      _uring(NULL)
 {
 }
 
 slk::asio_poller_t::~asio_poller_t()
 {
+    //  Make sure run() returns even if process_stop was never delivered.
+    _io_context.stop();
     stop_worker();
-    
-    // Explicitly release all native handles to avoid double-close
-    std::lock_guard<std::mutex> lock(_entries_mutex);
-    for (auto& pair : _entries) {
-        if (pair.second.socket) {
-            asio::error_code ec;
-            pair.second.socket->cancel(ec);
-#ifdef _WIN32
-            pair.second.socket->release(ec);
-#else
-            (void)pair.second.socket->release();
+
+#ifdef SL_HAVE_IO_URING
+    //  The thread is gone and its engines with it.
+    SL_DELETE(_uring);
 #endif
-        }
+    
+    // Explicitly release all native handles to avoid double-close.
+    // Pending waits are destroyed with the io_context without running.
+    for (fd_entry_t* entry : _entries) {
+        release_socket(entry);
+        delete entry;
     }
     _entries.clear();
 }
@@ -45,82 +50,75 @@ slk::asio_poller_t::handle_t slk::asio_poller_t::add_fd(fd_t fd_, i_poll_events*
 {
     adjust_load (1);
     
-    handle_t handle = reinterpret_cast<handle_t>(static_cast<uintptr_t>(fd_));
-    
-    fd_entry_t entry;
-    entry.fd = fd_;
-    entry.sink = events_;
-    entry.pollin = false;
-    entry.pollout = false;
-    entry.reading = false;
-    entry.writing = false;
-    entry.socket = nullptr; 
-    
-    {
-        std::lock_guard<std::mutex> lock(_entries_mutex);
-        _entries[handle] = entry;
-    }
-    return handle;
+    fd_entry_t* entry = new (std::nothrow) fd_entry_t;
+    alloc_assert(entry);
+    entry->fd = fd_;
+    entry->sink = events_;
+    entry->pollin = false;
+    entry->pollout = false;
+    entry->reading = false;
+    entry->writing = false;
+    entry->retired = false;
+    _entries.insert(entry);
+
+    return static_cast<handle_t>(entry);
 }
 
 void slk::asio_poller_t::rm_fd(handle_t handle_)
 {
-    std::lock_guard<std::mutex> lock(_entries_mutex);
-    auto it = _entries.find(handle_);
-    if (it != _entries.end()) {
-        if (it->second.socket) {
-            asio::error_code ec;
-            it->second.socket->cancel(ec);
-#ifdef _WIN32
-            it->second.socket->release(ec);
-#else
-            (void)it->second.socket->release();
-#endif
-        }
-        _entries.erase(it);
-        adjust_load (-1);
-    }
+    fd_entry_t* entry = static_cast<fd_entry_t*>(handle_);
+    slk_assert(!entry->retired);
+
+    // Cancelled waits complete later with operation_aborted; the entry
+    // stays around until the last of them has run.
+    release_socket(entry);
+    entry->retired = true;
+    check_retired(entry);
+    adjust_load (-1);
 }
 
 void slk::asio_poller_t::set_pollin(handle_t handle_)
 {
-    {
-        std::lock_guard<std::mutex> lock(_entries_mutex);
-        auto it = _entries.find(handle_);
-        if (it != _entries.end()) {
-            it->second.pollin = true;
-        }
-    }
-    start_polling(handle_);
+    fd_entry_t* entry = static_cast<fd_entry_t*>(handle_);
+    entry->pollin = true;
+    start_polling(entry);
 }
 
 void slk::asio_poller_t::reset_pollin(handle_t handle_)
 {
-    std::lock_guard<std::mutex> lock(_entries_mutex);
-    auto it = _entries.find(handle_);
-    if (it != _entries.end()) {
-        it->second.pollin = false;
-    }
+    static_cast<fd_entry_t*>(handle_)->pollin = false;
 }
 
 void slk::asio_poller_t::set_pollout(handle_t handle_)
 {
-    {
-        std::lock_guard<std::mutex> lock(_entries_mutex);
-        auto it = _entries.find(handle_);
-        if (it != _entries.end()) {
-            it->second.pollout = true;
-        }
-    }
-    start_polling(handle_);
+    fd_entry_t* entry = static_cast<fd_entry_t*>(handle_);
+    entry->pollout = true;
+    start_polling(entry);
 }
 
 void slk::asio_poller_t::reset_pollout(handle_t handle_)
 {
-    std::lock_guard<std::mutex> lock(_entries_mutex);
-    auto it = _entries.find(handle_);
-    if (it != _entries.end()) {
-        it->second.pollout = false;
+    static_cast<fd_entry_t*>(handle_)->pollout = false;
+}
+
+void slk::asio_poller_t::release_socket(fd_entry_t* entry)
+{
+    if (entry->socket) {
+        asio::error_code ec;
+        entry->socket->cancel(ec);
+#ifdef _WIN32
+        entry->socket->release(ec);
+#else
+        (void)entry->socket->release();
+#endif
+    }
+}
+
+void slk::asio_poller_t::check_retired(fd_entry_t* entry)
+{
+    if (entry->retired && !entry->reading && !entry->writing) {
+        _entries.erase(entry);
+        delete entry;
     }
 }
 
@@ -130,6 +128,24 @@ void slk::asio_poller_t::stop()
     _io_context.stop();
 }
 
+int slk::asio_poller_t::init_uring()
+{
+#ifdef SL_HAVE_IO_URING
+    slk_assert(!_uring);
+    uring_t* uring = new (std::nothrow) uring_t(_io_context);
+    alloc_assert(uring);
+    if (uring->init() == -1) {
+        delete uring;
+        return -1;
+    }
+    _uring = uring;
+    return 0;
+#else
+    errno = ENOTSUP;
+    return -1;
+#endif
+}
+
 int slk::asio_poller_t::max_fds()
 {
     return -1;
@@ -137,90 +153,95 @@ int slk::asio_poller_t::max_fds()
 
 void slk::asio_poller_t::loop()
 {
-    while (!_stopping) {
-        // 1. Execute ServerLink timers
-        uint64_t wait_ms = execute_timers();
-
-        // 2. Process all ready Asio handlers
-        if (_io_context.stopped()) _io_context.restart();
-        size_t work_done = _io_context.poll();
-        
-        // 3. If no work was done and no timers are immediately due, 
-        // wait for a short duration or until new work arrives.
-        if (work_done == 0) {
-            if (wait_ms == 0) wait_ms = 10;
-            _io_context.run_one_for(std::chrono::milliseconds(wait_ms));
-        }
-    }
+    //  Mailbox commands, socket readiness and timers all arrive as asio
+    //  handlers; the work guard keeps run() blocked until stop().
+    _io_context.run();
+}
+
+void slk::asio_poller_t::add_timer(int timeout_, i_poll_events* sink_, int id_)
+{
+    poller_base_t::add_timer(timeout_, sink_, id_);
+    schedule_timer(timeout_);
 }
 
-void slk::asio_poller_t::start_polling(handle_t handle)
+void slk::asio_poller_t::schedule_timer(uint64_t timeout_ms_)
 {
-    std::unique_lock<std::mutex> lock(_entries_mutex);
-    auto it = _entries.find(handle);
-    if (it == _entries.end()) return;
+    const asio::steady_timer::time_point deadline =
+      asio::steady_timer::clock_type::now() + std::chrono::milliseconds(timeout_ms_);
+    if (_timer_armed && deadline >= _timer.expiry())
+        return;
+
+    //  Re-arming cancels the pending wait; its handler sees
+    //  operation_aborted and leaves the state alone.
+    _timer_armed = true;
+    _timer.expires_at(deadline);
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _timer.async_wait([this, sentinel](const asio::error_code& ec) {
+        if (sentinel.expired() || ec == asio::error::operation_aborted)
+            return;
+        _timer_armed = false;
+        const uint64_t next = execute_timers();
+        if (next > 0)
+            schedule_timer(next);
+    });
+}
 
-    auto& entry = it->second;
+void slk::asio_poller_t::start_polling(fd_entry_t* entry)
+{
+    if (entry->retired) return;
 
-    if (!entry.socket) {
-        entry.socket = std::make_shared<native_socket_t>(_io_context);
+    if (!entry->socket) {
+        entry->socket.reset(new (std::nothrow) native_socket_t(_io_context));
+        alloc_assert(entry->socket);
         asio::error_code ec;
 #ifdef _WIN32
-        entry.socket->assign(asio::ip::tcp::v4(), entry.fd, ec);
+        entry->socket->assign(asio::ip::tcp::v4(), entry->fd, ec);
 #else
-        entry.socket->assign(entry.fd, ec); 
+        entry->socket->assign(entry->fd, ec); 
 #endif
         if (ec) {
-            entry.socket.reset();
+            entry->socket.reset();
             return;
         }
     }
 
-    if (entry.pollin && !entry.reading) {
-        entry.reading = true;
+    //  The wait flag stays set while the sink runs, so an rm_fd issued
+    //  from inside the event handler defers freeing the entry to us.
+    if (entry->pollin && !entry->reading) {
+        entry->reading = true;
         std::weak_ptr<int> sentinel = _lifetime_sentinel;
-        entry.socket->async_wait(native_socket_t::wait_read,
-            [this, handle, sentinel](const asio::error_code& ec) {
+        entry->socket->async_wait(native_socket_t::wait_read,
+            [this, entry, sentinel](const asio::error_code& ec) {
                 if (sentinel.expired()) return;
-                
-                i_poll_events* sink = nullptr;
-                {
-                    std::lock_guard<std::mutex> lock(_entries_mutex);
-                    if (_entries.count(handle)) {
-                        _entries[handle].reading = false;
-                        if (!ec && _entries[handle].pollin) sink = _entries[handle].sink;
-                    }
-                }
-                
-                if (sink) {
-                    sink->in_event();
-                    // Re-arm
-                    start_polling(handle);
-                }
+
+                const bool fire = !ec && !entry->retired && entry->pollin;
+                if (fire)
+                    entry->sink->in_event();
+                entry->reading = false;
+
+                if (entry->retired)
+                    check_retired(entry);
+                else if (fire)
+                    start_polling(entry);
             });
     }
 
-    if (entry.pollout && !entry.writing) {
-        entry.writing = true;
+    if (entry->pollout && !entry->writing) {
+        entry->writing = true;
         std::weak_ptr<int> sentinel = _lifetime_sentinel;
-        entry.socket->async_wait(native_socket_t::wait_write,
-            [this, handle, sentinel](const asio::error_code& ec) {
+        entry->socket->async_wait(native_socket_t::wait_write,
+            [this, entry, sentinel](const asio::error_code& ec) {
                 if (sentinel.expired()) return;
-                
-                i_poll_events* sink = nullptr;
-                {
-                    std::lock_guard<std::mutex> lock(_entries_mutex);
-                    if (_entries.count(handle)) {
-                        _entries[handle].writing = false;
-                        if (!ec && _entries[handle].pollout) sink = _entries[handle].sink;
-                    }
-                }
-                
-                if (sink) {
-                    sink->out_event();
-                    // Re-arm
-                    start_polling(handle);
-                }
+
+                const bool fire = !ec && !entry->retired && entry->pollout;
+                if (fire)
+                    entry->sink->out_event();
+                entry->writing = false;
+
+                if (entry->retired)
+                    check_retired(entry);
+                else if (fire)
+                    start_polling(entry);
             });
     }
 }
@@ -8,15 +8,19 @@
 #if defined SL_USE_ASIO
 
 #include <asio.hpp>
-#include <map>
 #include <memory>
-#include <mutex>
+#include <unordered_set>
 #include "../poller_base.hpp"
 #include "../fd.hpp"
 
 namespace slk
 {
     class ctx_t;
+    class uring_t;
+
+    //  Each I/O thread owns one poller and its io_context. All fd
+    //  registration calls are made either by the owning thread or before
+    //  the thread is started, so the entries need no locking.
 
     class asio_poller_t final : public worker_poller_base_t
     {
@@ -34,36 +38,61 @@ namespace slk
         void reset_pollout(handle_t handle_);
         void stop();
 
+        //  Registers the timer with poller_base_t and makes sure the asio
+        //  timer fires no later than its expiration.
+        void add_timer(int timeout_, i_poll_events* sink_, int id_);
+
         static int max_fds();
 
         // Accessor for the underlying io_context
         asio::io_context& get_context() { return _io_context; }
 
-    private:
-        void loop() override;
-        void start_polling(handle_t handle);
+        //  Sets up the io_uring used by the streams of this thread's
+        //  engines. Must be called before the thread is started.
+        int init_uring();
 
-        asio::io_context _io_context;
-        asio::executor_work_guard<asio::io_context::executor_type> _work_guard;
-        std::shared_ptr<int> _lifetime_sentinel;
+        //  The ring set up by init_uring, NULL if there is none.
+        uring_t* get_uring() const { return _uring; }
 
+    private:
 #ifdef _WIN32
         typedef asio::ip::tcp::socket native_socket_t;
 #else
         typedef asio::posix::stream_descriptor native_socket_t;
 #endif
 
+        //  The handle returned by add_fd points straight at the entry.
         struct fd_entry_t {
             fd_t fd;
-            std::shared_ptr<native_socket_t> socket;
+            std::unique_ptr<native_socket_t> socket;
             i_poll_events* sink;
             bool pollin;
             bool pollout;
             bool reading;
             bool writing;
+            //  Set by rm_fd; the entry is freed once no wait is pending.
+            bool retired;
         };
-        std::map<handle_t, fd_entry_t> _entries;
-        std::mutex _entries_mutex;
+
+        void loop() override;
+        void schedule_timer(uint64_t timeout_ms_);
+        void start_polling(fd_entry_t* entry);
+        void release_socket(fd_entry_t* entry);
+        void check_retired(fd_entry_t* entry);
+
+        asio::io_context _io_context;
+        asio::executor_work_guard<asio::io_context::executor_type> _work_guard;
+        std::shared_ptr<int> _lifetime_sentinel;
+
+        //  Fires at the earliest poller_base_t timer expiration so that
+        //  loop() can block in run() instead of polling.
+        asio::steady_timer _timer;
+        bool _timer_armed;
+
+        //  All entries not yet freed, live and retired alike.
+        std::unordered_set<fd_entry_t*> _entries;
+
+        uring_t* _uring;
     };
 
     typedef asio_poller_t poller_t;
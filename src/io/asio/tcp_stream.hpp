@@ -10,6 +10,7 @@
 #include "../i_async_stream.hpp"
 #include "asio_context.hpp"
 #include <asio.hpp>
+#include <vector>
 
 namespace slk
 {
@@ -60,6 +61,21 @@ namespace slk
             );
         }
 
+        inline void async_writev(const const_buffer_t* bufs, size_t count, write_handler handler) override
+        {
+            // 한 번의 gather 쓰기(writev)로 모든 조각을 전송
+            _gather.clear();
+            for (size_t i = 0; i < count; ++i)
+                _gather.emplace_back(bufs[i].data, bufs[i].size);
+            asio::async_write(
+                _socket,
+                _gather,
+                [handler](const asio::error_code& ec, size_t bytes_transferred) {
+                    handler(bytes_transferred, ec.value());
+                }
+            );
+        }
+
         inline void close() override
         {
             asio::error_code ec;
@@ -74,6 +90,9 @@ namespace slk
 
     private:
         asio::ip::tcp::socket _socket;
+
+        // async_writev 용 asio 버퍼 시퀀스 (재사용)
+        std::vector<asio::const_buffer> _gather;
     };
 }
 
@@ -16,6 +16,13 @@ namespace slk
         using read_handler = std::function<void(size_t bytes_transferred, int error)>;
         using write_handler = std::function<void(size_t bytes_transferred, int error)>;
 
+        // scatter-gather 쓰기용 버퍼 조각 (iovec 과 동일한 구성)
+        struct const_buffer_t
+        {
+            const void* data;
+            size_t size;
+        };
+
         virtual ~i_async_stream() = default;
 
         // 비동기 읽기
@@ -30,8 +37,36 @@ namespace slk
         // handler: 완료 시 호출될 콜백 (bytes_transferred, error)
         virtual void async_write(const void* buf, size_t len, write_handler handler) = 0;
 
+        // 비동기 벡터 쓰기 (writev)
+        // bufs: 순서대로 전송할 버퍼 조각 배열. 핸들러가 호출될 때까지 유효해야 함
+        // count: 조각 개수
+        // handler: 모든 조각 전송 완료 시 호출될 콜백 (총 bytes_transferred, error)
+        // 기본 구현은 조각마다 async_write 를 순차 호출한다.
+        // 실제 소켓 스트림은 한 번의 gather 쓰기로 재정의해야 한다.
+        virtual void async_writev(const const_buffer_t* bufs, size_t count, write_handler handler)
+        {
+            writev_step(bufs, count, 0, std::move(handler));
+        }
+
         // 스트림 닫기
         virtual void close() = 0;
+
+    private:
+        void writev_step(const const_buffer_t* bufs, size_t count, size_t total, write_handler handler)
+        {
+            if (count == 0) {
+                handler(total, 0);
+                return;
+            }
+            async_write(bufs->data, bufs->size,
+                [this, bufs, count, total, handler](size_t bytes_transferred, int error) {
+                    if (error != 0) {
+                        handler(total + bytes_transferred, error);
+                        return;
+                    }
+                    writev_step(bufs + 1, count - 1, total + bytes_transferred, handler);
+                });
+        }
     };
 }
 
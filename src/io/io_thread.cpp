@@ -21,6 +21,10 @@ slk::io_thread_t::io_thread_t (slk::ctx_t *ctx_, uint32_t tid_) :
 
     _mailbox_handle = _poller->add_fd (_mailbox.get_fd (), this);
     _poller->set_pollin (_mailbox_handle);
+
+    //  Without a ring the streams simply stay on asio
+    if (ctx_->get (SL_IO_BACKEND) == SL_IO_BACKEND_IO_URING)
+        _poller->init_uring ();
 }
 
 slk::io_thread_t::~io_thread_t () 
@@ -61,6 +65,11 @@ asio::io_context& slk::io_thread_t::get_io_context()
 }
 #endif
 
+slk::uring_t *slk::io_thread_t::get_uring () const
+{
+    return _poller->get_uring ();
+}
+
 void slk::io_thread_t::process_stop () 
 {
     _poller->rm_fd (_mailbox_handle);
@@ -15,6 +15,7 @@ namespace asio { class io_context; }
 namespace slk
 {
 class ctx_t;
+class uring_t;
 
 // Generic part of the I/O thread. Polling-mechanism-specific features
 // are implemented in separate "polling objects"
@@ -47,6 +48,10 @@ class io_thread_t : public object_t, public i_poll_events
     // Retrieve the Asio io_context (only available when SL_USE_ASIO is defined)
     asio::io_context& get_io_context();
 
+    // The io_uring for streams of engines on this thread, NULL unless the
+    // context selected the io_uring backend and the kernel supports it
+    uring_t *get_uring () const;
+
     // Command handlers
     void process_stop ();
 
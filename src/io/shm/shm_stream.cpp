@@ -0,0 +1,511 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../../precompiled.hpp"
+#include "shm_stream.hpp"
+
+#ifdef SL_HAVE_SHM
+
+#include "../../util/err.hpp"
+#include <algorithm>
+#include <errno.h>
+#include <new>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+const uint32_t shm_magic = 0x534c5348; // "SLSH"
+const uint32_t shm_version = 1;
+const size_t shm_page_size = 4096;
+
+//  Sent along with the descriptors; the region carries the same values.
+struct hello_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ring_size;
+};
+
+enum
+{
+    fd_region,
+    fd_listener_event,
+    fd_connecter_event,
+    fd_count
+};
+
+void copy_in (char *ring_,
+              uint64_t mask_,
+              uint64_t pos_,
+              const char *src_,
+              size_t size_)
+{
+    //  Never more than one lap, whatever the positions say
+    size_ = std::min (size_, static_cast<size_t> (mask_ + 1));
+    const size_t offset = static_cast<size_t> (pos_ & mask_);
+    const size_t first =
+      std::min (size_, static_cast<size_t> (mask_ + 1 - offset));
+    memcpy (ring_ + offset, src_, first);
+    memcpy (ring_, src_ + first, size_ - first);
+}
+
+void copy_out (const char *ring_,
+               uint64_t mask_,
+               uint64_t pos_,
+               char *dst_,
+               size_t size_)
+{
+    size_ = std::min (size_, static_cast<size_t> (mask_ + 1));
+    const size_t offset = static_cast<size_t> (pos_ & mask_);
+    const size_t first =
+      std::min (size_, static_cast<size_t> (mask_ + 1 - offset));
+    memcpy (dst_, ring_ + offset, first);
+    memcpy (dst_ + first, ring_, size_ - first);
+}
+
+void close_fds (slk::fd_t *fds_, int count_)
+{
+    for (int i = 0; i < count_; i++)
+        if (fds_[i] != -1)
+            close (fds_[i]);
+}
+}
+
+slk::shm_stream_t::shm_stream_t (control_socket_t socket_,
+                                 void *region_,
+                                 size_t region_size_,
+                                 int side_,
+                                 fd_t own_event_,
+                                 fd_t peer_event_) :
+    _control (std::move (socket_)),
+    _region (region_),
+    _region_size (region_size_),
+    _event (_control.get_executor ()),
+    _peer_event (peer_event_),
+    _sleeping (false),
+    _peer_closed (false),
+    _read_buf (NULL),
+    _read_len (0),
+    _write_pos (0),
+    _write_offset (0),
+    _written (0),
+    _lifetime_sentinel (std::make_shared<int> (0))
+{
+    region_t *region = static_cast<region_t *> (region_);
+    const uint64_t ring_size = region->ring_size;
+    char *data = static_cast<char *> (region_) + region_size (0);
+    _tx = &region->rings[side_];
+    _rx = &region->rings[1 - side_];
+    _tx_data = data + side_ * ring_size;
+    _rx_data = data + (1 - side_) * ring_size;
+    _mask = ring_size - 1;
+
+    asio::error_code ec;
+    _event.assign (own_event_, ec);
+    slk_assert (!ec);
+
+    watch_control ();
+}
+
+slk::shm_stream_t::~shm_stream_t ()
+{
+    close ();
+}
+
+size_t slk::shm_stream_t::region_size (uint64_t ring_size_)
+{
+    //  The rings start on the first page after the control block
+    const size_t header = (sizeof (region_t) + shm_page_size - 1)
+                          / shm_page_size * shm_page_size;
+    return header + 2 * static_cast<size_t> (ring_size_);
+}
+
+std::string slk::shm_stream_t::control_path (const std::string &name_)
+{
+    //  The abstract namespace leaves no file behind to clean up
+    std::string path ("\0serverlink-shm.", 16);
+    path += name_;
+    if (name_.empty () || name_ == "*" || name_.find ('\0') != std::string::npos
+        || path.size () >= sizeof (sockaddr_un::sun_path))
+        return std::string ();
+    return path;
+}
+
+std::unique_ptr<slk::i_async_stream>
+slk::shm_stream_t::create (control_socket_t &socket_)
+{
+    static_assert (std::atomic<uint64_t>::is_always_lock_free,
+                   "shared ring positions must be lock-free");
+    static_assert ((shm_ring_size & (shm_ring_size - 1)) == 0,
+                   "shm_ring_size must be a power of two");
+
+    fd_t fds[fd_count] = {memfd_create ("serverlink-shm", MFD_CLOEXEC),
+                          eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC),
+                          eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC)};
+    const size_t size = region_size (shm_ring_size);
+    void *region = MAP_FAILED;
+    if (fds[fd_region] != -1 && ftruncate (fds[fd_region], size) == 0)
+        region = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fds[fd_region], 0);
+    if (region == MAP_FAILED || fds[fd_listener_event] == -1
+        || fds[fd_connecter_event] == -1) {
+        close_fds (fds, fd_count);
+        return std::unique_ptr<i_async_stream> ();
+    }
+
+    region_t *header = new (region) region_t ();
+    header->magic = shm_magic;
+    header->version = shm_version;
+    header->ring_size = shm_ring_size;
+
+    hello_t hello = {shm_magic, shm_version, shm_ring_size};
+    iovec iov = {&hello, sizeof hello};
+    union
+    {
+        cmsghdr align;
+        char buf[CMSG_SPACE (sizeof fds)];
+    } control;
+    memset (&control, 0, sizeof control);
+    msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+    cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN (sizeof fds);
+    memcpy (CMSG_DATA (cmsg), fds, sizeof fds);
+
+    //  A fresh socket has plenty of room for the greeting, so this does
+    //  not block.
+    const ssize_t rc = sendmsg (socket_.native_handle (), &msg, MSG_NOSIGNAL);
+    ::close (fds[fd_region]);
+    if (rc != static_cast<ssize_t> (sizeof hello)) {
+        munmap (region, size);
+        close_fds (fds + 1, fd_count - 1);
+        return std::unique_ptr<i_async_stream> ();
+    }
+
+    shm_stream_t *stream = new (std::nothrow)
+      shm_stream_t (std::move (socket_), region, size, 0,
+                    fds[fd_listener_event], fds[fd_connecter_event]);
+    alloc_assert (stream);
+    return std::unique_ptr<i_async_stream> (stream);
+}
+
+std::unique_ptr<slk::i_async_stream>
+slk::shm_stream_t::attach (control_socket_t &socket_)
+{
+    hello_t hello;
+    iovec iov = {&hello, sizeof hello};
+    union
+    {
+        cmsghdr align;
+        char buf[CMSG_SPACE (fd_count * sizeof (fd_t))];
+    } control;
+    msghdr msg;
+    memset (&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof control.buf;
+
+    const ssize_t rc = recvmsg (socket_.native_handle (), &msg,
+                                MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (rc == -1)
+        return std::unique_ptr<i_async_stream> ();
+
+    fd_t fds[fd_count] = {-1, -1, -1};
+    int received = 0;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR (&msg); cmsg;
+         cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        const int count =
+          static_cast<int> ((cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (fd_t));
+        for (int i = 0; i < count; i++) {
+            fd_t fd;
+            memcpy (&fd, CMSG_DATA (cmsg) + i * sizeof (fd_t), sizeof fd);
+            if (received < fd_count)
+                fds[received] = fd;
+            else
+                ::close (fd);
+            received++;
+        }
+    }
+
+    //  Anything but a complete greeting from a compatible peer is refused
+    const bool valid = rc == static_cast<ssize_t> (sizeof hello)
+                       && !(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))
+                       && received == fd_count && hello.magic == shm_magic
+                       && hello.version == shm_version && hello.ring_size >= 64
+                       && hello.ring_size <= (1u << 30)
+                       && (hello.ring_size & (hello.ring_size - 1)) == 0;
+    const size_t size = valid ? region_size (hello.ring_size) : 0;
+    struct stat st;
+    void *region = MAP_FAILED;
+    if (valid && fstat (fds[fd_region], &st) == 0
+        && static_cast<size_t> (st.st_size) >= size)
+        region = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fds[fd_region], 0);
+    if (region != MAP_FAILED
+        && static_cast<region_t *> (region)->magic != shm_magic) {
+        munmap (region, size);
+        region = MAP_FAILED;
+    }
+    if (region == MAP_FAILED) {
+        close_fds (fds, fd_count);
+        errno = rc == 0 ? ECONNRESET : EPROTO;
+        return std::unique_ptr<i_async_stream> ();
+    }
+    ::close (fds[fd_region]);
+
+    shm_stream_t *stream = new (std::nothrow)
+      shm_stream_t (std::move (socket_), region, size, 1,
+                    fds[fd_connecter_event], fds[fd_listener_event]);
+    alloc_assert (stream);
+    return std::unique_ptr<i_async_stream> (stream);
+}
+
+void slk::shm_stream_t::async_read (void *buf_,
+                                    size_t len_,
+                                    read_handler handler_)
+{
+    _read_buf = buf_;
+    _read_len = len_;
+    _read_handler = std::move (handler_);
+    progress ();
+}
+
+void slk::shm_stream_t::async_write (const void *buf_,
+                                     size_t len_,
+                                     write_handler handler_)
+{
+    const const_buffer_t buf = {buf_, len_};
+    async_writev (&buf, 1, std::move (handler_));
+}
+
+void slk::shm_stream_t::async_writev (const const_buffer_t *bufs_,
+                                      size_t count_,
+                                      write_handler handler_)
+{
+    _write_bufs.assign (bufs_, bufs_ + count_);
+    _write_pos = 0;
+    _write_offset = 0;
+    _written = 0;
+    _write_handler = std::move (handler_);
+    progress ();
+}
+
+void slk::shm_stream_t::close ()
+{
+    if (!_region)
+        return;
+
+    //  The peer sees the control socket close once it has drained the ring
+    asio::error_code ec;
+    _control.close (ec);
+    _event.close (ec);
+    ::close (_peer_event);
+    _peer_event = -1;
+    munmap (_region, _region_size);
+    _region = NULL;
+
+    if (_read_handler) {
+        read_handler handler = std::move (_read_handler);
+        _read_handler = nullptr;
+        asio::post (_control.get_executor (),
+                    [handler] () { handler (0, ECANCELED); });
+    }
+    if (_write_handler) {
+        write_handler handler = std::move (_write_handler);
+        _write_handler = nullptr;
+        const size_t written = _written;
+        asio::post (_control.get_executor (),
+                    [handler, written] () { handler (written, ECANCELED); });
+    }
+}
+
+bool slk::shm_stream_t::read_some ()
+{
+    const uint64_t head = _rx->head.load (std::memory_order_relaxed);
+    const uint64_t available =
+      _rx->tail.load (std::memory_order_acquire) - head;
+    if (available == 0 && !_peer_closed)
+        return false;
+
+    //  The peer can write the positions too; more than a full ring is a
+    //  broken or hostile peer, and nothing of it is consumed.
+    if (available > _mask + 1) {
+        read_handler handler = std::move (_read_handler);
+        _read_handler = nullptr;
+        asio::post (_control.get_executor (),
+                    [handler] () { handler (0, EPROTO); });
+        return true;
+    }
+
+    //  Data the peer wrote before going away is still delivered; after
+    //  that the read reports the end of the stream.
+    const size_t size =
+      static_cast<size_t> (std::min<uint64_t> (available, _read_len));
+    if (size > 0) {
+        copy_out (_rx_data, _mask, head, static_cast<char *> (_read_buf),
+                  size);
+        _rx->head.store (head + size, std::memory_order_release);
+        wake_peer (_rx->writer_waiting);
+    }
+
+    //  Like asio, never run the handler from within the initiating call
+    read_handler handler = std::move (_read_handler);
+    _read_handler = nullptr;
+    asio::post (_control.get_executor (),
+                [handler, size] () { handler (size, 0); });
+    return true;
+}
+
+bool slk::shm_stream_t::write_some ()
+{
+    if (_peer_closed) {
+        write_handler handler = std::move (_write_handler);
+        _write_handler = nullptr;
+        const size_t written = _written;
+        asio::post (_control.get_executor (),
+                    [handler, written] () { handler (written, EPIPE); });
+        return true;
+    }
+
+    uint64_t tail = _tx->tail.load (std::memory_order_relaxed);
+    const uint64_t used = tail - _tx->head.load (std::memory_order_acquire);
+    if (used > _mask + 1) {
+        write_handler handler = std::move (_write_handler);
+        _write_handler = nullptr;
+        const size_t written = _written;
+        asio::post (_control.get_executor (),
+                    [handler, written] () { handler (written, EPROTO); });
+        return true;
+    }
+    uint64_t space = _mask + 1 - used;
+    const uint64_t start = tail;
+    while (_write_pos < _write_bufs.size ()) {
+        const const_buffer_t &buf = _write_bufs[_write_pos];
+        const size_t left = buf.size - _write_offset;
+        if (left > 0 && space == 0)
+            break;
+        const size_t size =
+          static_cast<size_t> (std::min<uint64_t> (left, space));
+        copy_in (_tx_data, _mask, tail,
+                 static_cast<const char *> (buf.data) + _write_offset, size);
+        tail += size;
+        space -= size;
+        _written += size;
+        _write_offset += size;
+        if (_write_offset == buf.size) {
+            _write_pos++;
+            _write_offset = 0;
+        }
+    }
+    if (tail != start) {
+        _tx->tail.store (tail, std::memory_order_release);
+        wake_peer (_tx->reader_waiting);
+    }
+    if (_write_pos < _write_bufs.size ())
+        return false;
+
+    write_handler handler = std::move (_write_handler);
+    _write_handler = nullptr;
+    const size_t written = _written;
+    asio::post (_control.get_executor (),
+                [handler, written] () { handler (written, 0); });
+    return true;
+}
+
+void slk::shm_stream_t::progress ()
+{
+    while (_region) {
+        const bool read_blocked = _read_handler && !read_some ();
+        const bool write_blocked = _write_handler && !write_some ();
+        if (!read_blocked && !write_blocked)
+            return;
+
+        //  Announce the wait, then look again: either the peer sees the
+        //  flag after its next update, or this side sees the update now.
+        if (read_blocked)
+            _rx->reader_waiting.store (1, std::memory_order_relaxed);
+        if (write_blocked)
+            _tx->writer_waiting.store (1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+
+        const bool readable =
+          read_blocked
+          && _rx->tail.load (std::memory_order_acquire)
+               != _rx->head.load (std::memory_order_relaxed);
+        const bool writable =
+          write_blocked
+          && _tx->tail.load (std::memory_order_relaxed)
+                 - _tx->head.load (std::memory_order_acquire)
+               <= _mask;
+        if (!readable && !writable) {
+            wait_for_peer ();
+            return;
+        }
+    }
+}
+
+void slk::shm_stream_t::wait_for_peer ()
+{
+    if (_sleeping)
+        return;
+    _sleeping = true;
+
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _event.async_wait (asio::posix::stream_descriptor::wait_read,
+                       [this, sentinel] (const asio::error_code &ec) {
+                           if (sentinel.expired ()
+                               || ec == asio::error::operation_aborted
+                               || !_region)
+                               return;
+                           _sleeping = false;
+
+                           uint64_t count;
+                           const ssize_t rc = read (_event.native_handle (),
+                                                    &count, sizeof count);
+                           (void) rc;
+                           progress ();
+                       });
+}
+
+void slk::shm_stream_t::watch_control ()
+{
+    //  The peer sends nothing after the greeting, so the control socket
+    //  becomes readable only when it is closed.
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _control.async_wait (control_socket_t::wait_read,
+                         [this, sentinel] (const asio::error_code &ec) {
+                             if (sentinel.expired ()
+                                 || ec == asio::error::operation_aborted
+                                 || !_region)
+                                 return;
+                             _peer_closed = true;
+                             progress ();
+                         });
+}
+
+void slk::shm_stream_t::wake_peer (std::atomic<uint32_t> &flag_)
+{
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    if (flag_.load (std::memory_order_relaxed)
+        && flag_.exchange (0, std::memory_order_relaxed)) {
+        const uint64_t one = 1;
+        const ssize_t rc = write (_peer_event, &one, sizeof one);
+        (void) rc;
+    }
+}
+
+#endif // SL_HAVE_SHM
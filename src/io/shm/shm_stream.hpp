@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SERVERLINK_SHM_STREAM_HPP_INCLUDED
+#define SERVERLINK_SHM_STREAM_HPP_INCLUDED
+
+#include "../../util/config.hpp"
+
+#ifdef SL_HAVE_SHM
+
+#include <asio.hpp>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "../fd.hpp"
+#include "../i_async_stream.hpp"
+#include "../../util/macros.hpp"
+
+namespace slk
+{
+//  Stream between two processes on the same host over a shared memory
+//  region holding one single-producer/single-consumer byte ring per
+//  direction. Data is copied straight from the writer's buffers into the
+//  ring and from the ring into the reader's buffer (for large messages,
+//  the message body itself), so no bytes pass through the kernel.
+//
+//  The region and two eventfds are handed over on a connected UNIX domain
+//  socket, which then only serves to notice the peer going away. A side
+//  sleeps on its own eventfd only when it has nothing to do; the other
+//  side writes to it when it sees the sleeper's waiting flag, so busy
+//  streams make no system calls at all.
+
+class shm_stream_t final : public i_async_stream
+{
+  public:
+    typedef asio::local::stream_protocol::socket control_socket_t;
+
+    ~shm_stream_t () override;
+
+    //  Name of the abstract UNIX domain socket on which the listener of
+    //  shm://name_ accepts. Empty if name_ is not a valid endpoint name.
+    static std::string control_path (const std::string &name_);
+
+    //  Listener side: sets up a new region and passes it to the peer over
+    //  the freshly accepted control socket. Returns NULL on failure.
+    static std::unique_ptr<i_async_stream> create (control_socket_t &socket_);
+
+    //  Connecter side: receives the region once the control socket is
+    //  readable. Returns NULL on failure, with errno set to EAGAIN if the
+    //  region has not arrived yet.
+    static std::unique_ptr<i_async_stream> attach (control_socket_t &socket_);
+
+    //  i_async_stream implementation
+    void async_read (void *buf_, size_t len_, read_handler handler_) override;
+    void
+    async_write (const void *buf_, size_t len_, write_handler handler_) override;
+    void async_writev (const const_buffer_t *bufs_,
+                       size_t count_,
+                       write_handler handler_) override;
+    void close () override;
+
+  private:
+    //  Positions count bytes ever passed through the ring; they are
+    //  masked into offsets. Each sits on its own cache line.
+    struct ring_t
+    {
+        alignas (64) std::atomic<uint64_t> head;
+        alignas (64) std::atomic<uint64_t> tail;
+
+        //  Set by a side about to sleep, cleared by the side waking it.
+        alignas (64) std::atomic<uint32_t> reader_waiting;
+        std::atomic<uint32_t> writer_waiting;
+    };
+
+    //  Ring n is written by side n: the listener is side 0.
+    struct region_t
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_size;
+        ring_t rings[2];
+    };
+
+    shm_stream_t (control_socket_t socket_,
+                  void *region_,
+                  size_t region_size_,
+                  int side_,
+                  fd_t own_event_,
+                  fd_t peer_event_);
+
+    //  Size of a region with rings of the given size; with 0, the offset
+    //  at which the rings start.
+    static size_t region_size (uint64_t ring_size_);
+
+    //  Moves as much data as possible; true once the operation completed.
+    bool read_some ();
+    bool write_some ();
+
+    //  Runs pending operations and goes to sleep if any is left waiting.
+    void progress ();
+    void wait_for_peer ();
+    void watch_control ();
+    void wake_peer (std::atomic<uint32_t> &flag_);
+
+    control_socket_t _control;
+    void *_region;
+    size_t _region_size;
+    ring_t *_tx;
+    ring_t *_rx;
+    char *_tx_data;
+    char *_rx_data;
+    uint64_t _mask;
+
+    asio::posix::stream_descriptor _event;
+    fd_t _peer_event;
+    bool _sleeping;
+    bool _peer_closed;
+
+    void *_read_buf;
+    size_t _read_len;
+    read_handler _read_handler;
+
+    //  The pieces still to be written start _write_offset bytes into
+    //  _write_bufs [_write_pos]
+    std::vector<const_buffer_t> _write_bufs;
+    size_t _write_pos;
+    size_t _write_offset;
+    size_t _written;
+    write_handler _write_handler;
+
+    std::shared_ptr<int> _lifetime_sentinel;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (shm_stream_t)
+};
+}
+
+#endif // SL_HAVE_SHM
+#endif
@@ -10,7 +10,9 @@
 #include "../util/clock.hpp"
 #include "../util/constants.hpp"
 
+#include <algorithm>
 #include <limits.h>
+#include <string.h>
 #include <new>
 
 // Poll event constants - these match the public API defines
@@ -41,7 +43,10 @@ static It find_if2 (It b_, It e_, const T &value, Pred pred)
 slk::socket_poller_t::socket_poller_t () :
     _tag (0xCAFEBABE),
     _signaler (NULL)
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+    ,
+    _epoll_fd (epoll_create1 (EPOLL_CLOEXEC))
+#elif defined SL_POLL_BASED_ON_POLL
     ,
     _pollfds (NULL)
 #elif defined SL_POLL_BASED_ON_SELECT
@@ -49,6 +54,9 @@ slk::socket_poller_t::socket_poller_t () :
     _max_fd (0)
 #endif
 {
+#if defined SL_SOCKET_POLLER_EPOLL
+    errno_assert (_epoll_fd != retired_fd);
+#endif
     rebuild ();
 }
 
@@ -68,7 +76,9 @@ slk::socket_poller_t::~socket_poller_t ()
         delete _signaler;
     }
 
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+    close (_epoll_fd);
+#elif defined SL_POLL_BASED_ON_POLL
     if (_pollfds) {
         free (_pollfds);
         _pollfds = NULL;
@@ -125,7 +135,11 @@ int slk::socket_poller_t::add (socket_base_t *socket_,
         0,
         user_data_,
         events_
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+        ,
+        false,
+        false
+#elif defined SL_POLL_BASED_ON_POLL
         ,
         -1
 #endif
@@ -137,7 +151,21 @@ int slk::socket_poller_t::add (socket_base_t *socket_,
         errno = ENOMEM;
         return -1;
     }
+#if defined SL_SOCKET_POLLER_EPOLL
+    item_t &added = _items.back ();
+    size_t fd_size = sizeof (slk::fd_t);
+    int rc = socket_->getsockopt (SL_FD, &added.fd, &fd_size);
+    slk_assert (rc == 0);
+    rc = update_interest (added);
+    if (rc == -1) {
+        _items.pop_back ();
+        return -1;
+    }
+    // Messages may already be waiting without the fd being signalled.
+    set_pending (added, true);
+#else
     _need_rebuild = true;
+#endif
 
     return 0;
 }
@@ -155,7 +183,11 @@ int slk::socket_poller_t::add_fd (fd_t fd_, void *user_data_, short events_)
         fd_,
         user_data_,
         events_
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+        ,
+        false,
+        false
+#elif defined SL_POLL_BASED_ON_POLL
         ,
         -1
 #endif
@@ -167,7 +199,14 @@ int slk::socket_poller_t::add_fd (fd_t fd_, void *user_data_, short events_)
         errno = ENOMEM;
         return -1;
     }
+#if defined SL_SOCKET_POLLER_EPOLL
+    if (update_interest (_items.back ()) == -1) {
+        _items.pop_back ();
+        return -1;
+    }
+#else
     _need_rebuild = true;
+#endif
 
     return 0;
 }
@@ -183,7 +222,13 @@ int slk::socket_poller_t::modify (const socket_base_t *socket_, short events_)
     }
 
     it->events = events_;
+#if defined SL_SOCKET_POLLER_EPOLL
+    if (update_interest (*it) == -1)
+        return -1;
+    set_pending (*it, events_ != 0);
+#else
     _need_rebuild = true;
+#endif
 
     return 0;
 }
@@ -200,7 +245,12 @@ int slk::socket_poller_t::modify_fd (fd_t fd_, short events_)
     }
 
     it->events = events_;
+#if defined SL_SOCKET_POLLER_EPOLL
+    if (update_interest (*it) == -1)
+        return -1;
+#else
     _need_rebuild = true;
+#endif
 
     return 0;
 }
@@ -216,8 +266,15 @@ int slk::socket_poller_t::remove (socket_base_t *socket_)
         return -1;
     }
 
+#if defined SL_SOCKET_POLLER_EPOLL
+    it->events = 0;
+    update_interest (*it);
+    set_pending (*it, false);
+    _items.erase (it);
+#else
     _items.erase (it);
     _need_rebuild = true;
+#endif
 
     if (is_thread_safe (*socket_)) {
         socket_->remove_signaler (_signaler);
@@ -236,19 +293,81 @@ int slk::socket_poller_t::remove_fd (fd_t fd_)
         return -1;
     }
 
+#if defined SL_SOCKET_POLLER_EPOLL
+    it->events = 0;
+    update_interest (*it);
+    _items.erase (it);
+#else
     _items.erase (it);
     _need_rebuild = true;
+#endif
+
+    return 0;
+}
 
+#if defined SL_SOCKET_POLLER_EPOLL
+int slk::socket_poller_t::update_interest (item_t &item_)
+{
+    epoll_event ev;
+    memset (&ev, 0, sizeof ev);
+    ev.data.ptr = &item_;
+    if (item_.socket)
+        ev.events = EPOLLIN;
+    else
+        ev.events = (item_.events & SLK_POLLIN ? uint32_t (EPOLLIN) : 0)
+                    | (item_.events & SLK_POLLOUT ? uint32_t (EPOLLOUT) : 0)
+                    | (item_.events & SLK_POLLERR ? uint32_t (EPOLLPRI) : 0);
+
+    int op;
+    if (!item_.events) {
+        if (!item_.registered)
+            return 0;
+        op = EPOLL_CTL_DEL;
+    } else
+        op = item_.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+
+    const int rc = epoll_ctl (_epoll_fd, op, item_.fd, &ev);
+    if (rc == -1) {
+        //  The fd may have been closed behind our back, which already
+        //  took it out of the interest set.
+        if (op != EPOLL_CTL_DEL)
+            return -1;
+    }
+
+    if (op == EPOLL_CTL_ADD) {
+        item_.registered = true;
+        _pollset_size++;
+    } else if (op == EPOLL_CTL_DEL) {
+        item_.registered = false;
+        _pollset_size--;
+    }
     return 0;
 }
 
+void slk::socket_poller_t::set_pending (item_t &item_, bool pending_)
+{
+    if (item_.pending == pending_)
+        return;
+    item_.pending = pending_;
+    if (pending_)
+        _pending.push_back (&item_);
+    else
+        _pending.erase (
+          std::find (_pending.begin (), _pending.end (), &item_));
+}
+#endif
+
 int slk::socket_poller_t::rebuild ()
 {
     _use_signaler = false;
     _pollset_size = 0;
     _need_rebuild = false;
 
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+
+    // The interest set is maintained incrementally by add/modify/remove.
+
+#elif defined SL_POLL_BASED_ON_POLL
 
     if (_pollfds) {
         free (_pollfds);
@@ -394,6 +513,80 @@ void slk::socket_poller_t::zero_trail_events (
     }
 }
 
+#if defined SL_SOCKET_POLLER_EPOLL
+int slk::socket_poller_t::check_events (slk::socket_poller_t::event_t *events_,
+                                        int n_events_,
+                                        int n_ready_)
+{
+    int found = 0;
+
+    for (int i = 0; i < n_ready_; ++i) {
+        item_t *item = static_cast<item_t *> (_epoll_events[i].data.ptr);
+
+        // A ServerLink socket's fd only says that commands are waiting;
+        // the SL_EVENTS pass below tells what they amount to.
+        if (item->socket) {
+            set_pending (*item, true);
+            continue;
+        }
+
+        // Raw fds are level-triggered, so anything that does not fit
+        // into the caller's array is reported by the next wait.
+        if (found == n_events_)
+            continue;
+
+        const uint32_t revents = _epoll_events[i].events;
+        short events = 0;
+
+        if (revents & EPOLLIN)
+            events |= SLK_POLLIN;
+        if (revents & EPOLLOUT)
+            events |= SLK_POLLOUT;
+        if (revents & ~(EPOLLIN | EPOLLOUT))
+            events |= SLK_POLLERR;
+
+        events_[found].socket = NULL;
+        events_[found].fd = item->fd;
+        events_[found].user_data = item->user_data;
+        events_[found].events = events;
+        ++found;
+    }
+
+    // Ready sockets stay pending, as their fd will not fire again while
+    // they remain readable or writable.
+    size_t kept = 0;
+    for (size_t i = 0; i != _pending.size (); ++i) {
+        item_t *item = _pending[i];
+        _pending[kept++] = item;
+        if (found == n_events_)
+            continue;
+
+        size_t events_size = sizeof (uint32_t);
+        uint32_t events;
+        if (item->socket->getsockopt (SL_EVENTS, &events, &events_size)
+            == -1) {
+            for (++i; i != _pending.size (); ++i)
+                _pending[kept++] = _pending[i];
+            _pending.resize (kept);
+            return -1;
+        }
+
+        if (item->events & events) {
+            events_[found].socket = item->socket;
+            events_[found].fd = slk::retired_fd;
+            events_[found].user_data = item->user_data;
+            events_[found].events = item->events & events;
+            ++found;
+        } else {
+            item->pending = false;
+            --kept;
+        }
+    }
+    _pending.resize (kept);
+
+    return found;
+}
+#else
 #if defined SL_POLL_BASED_ON_POLL
 int slk::socket_poller_t::check_events (slk::socket_poller_t::event_t *events_,
                                         int n_events_)
@@ -467,6 +660,7 @@ int slk::socket_poller_t::check_events (slk::socket_poller_t::event_t *events_,
 
     return found;
 }
+#endif
 
 // Return 0 if timeout is expired otherwise 1
 int slk::socket_poller_t::adjust_timeout (slk::clock_t &clock_,
@@ -556,7 +750,48 @@ int slk::socket_poller_t::wait (slk::socket_poller_t::event_t *events_,
 #endif
     }
 
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+    slk::clock_t clock;
+    uint64_t now = 0;
+    uint64_t end = 0;
+
+    bool first_pass = true;
+
+    while (true) {
+        // Compute the timeout for the subsequent poll.
+        int timeout;
+        if (first_pass)
+            timeout = 0;
+        else if (timeout_ < 0)
+            timeout = -1;
+        else
+            timeout =
+              static_cast<int> (std::min<uint64_t> (end - now, INT_MAX));
+
+        // Wait for events. Only the items that changed come back.
+        const int rc =
+          epoll_wait (_epoll_fd, _epoll_events, max_io_events, timeout);
+        if (rc == -1 && errno == EINTR) {
+            return -1;
+        }
+        errno_assert (rc >= 0);
+
+        // Check for the events.
+        const int found = check_events (events_, n_events_, rc);
+        if (found) {
+            if (found > 0)
+                zero_trail_events (events_, n_events_, found);
+            return found;
+        }
+
+        // Adjust timeout or break
+        if (adjust_timeout (clock, timeout_, now, end, first_pass) == 0)
+            break;
+    }
+    errno = EAGAIN;
+    return -1;
+
+#elif defined SL_POLL_BASED_ON_POLL
     slk::clock_t clock;
     uint64_t now = 0;
     uint64_t end = 0;
@@ -8,7 +8,12 @@
 
 #include "../io/poller.hpp"
 
-#if defined SL_POLL_BASED_ON_POLL && !defined SL_HAVE_WINDOWS
+// On Linux the poller keeps a persistent epoll interest set instead of
+// handing the whole item list to poll () on every wait.
+#if defined SL_USE_EPOLL && !defined SL_HAVE_WINDOWS
+#define SL_SOCKET_POLLER_EPOLL
+#include <sys/epoll.h>
+#elif defined SL_POLL_BASED_ON_POLL && !defined SL_HAVE_WINDOWS
 #include <poll.h>
 #endif
 
@@ -22,6 +27,7 @@
 #include <unistd.h>
 #endif
 
+#include <list>
 #include <vector>
 
 #include "../core/socket_base.hpp"
@@ -68,7 +74,12 @@ class socket_poller_t
         fd_t fd;
         void *user_data;
         short events;
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+        // Is the fd (the notification fd for sockets) in the interest set?
+        bool registered;
+        // Is the socket queued for an SL_EVENTS check?
+        bool pending;
+#elif defined SL_POLL_BASED_ON_POLL
         int pollfd_index;
 #endif
     };
@@ -76,7 +87,13 @@ class socket_poller_t
     static void zero_trail_events (slk::socket_poller_t::event_t *events_,
                                    int n_events_,
                                    int found_);
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+    int check_events (slk::socket_poller_t::event_t *events_,
+                      int n_events_,
+                      int n_ready_);
+    int update_interest (item_t &item_);
+    void set_pending (item_t &item_, bool pending_);
+#elif defined SL_POLL_BASED_ON_POLL
     int check_events (slk::socket_poller_t::event_t *events_, int n_events_);
 #elif defined SL_POLL_BASED_ON_SELECT
     int check_events (slk::socket_poller_t::event_t *events_,
@@ -107,8 +124,13 @@ class socket_poller_t
     // Signaler used for thread safe sockets polling
     signaler_t *_signaler;
 
-    // List of sockets
+    // List of sockets. The epoll interest set refers to items by address,
+    // so they must not move.
+#if defined SL_SOCKET_POLLER_EPOLL
+    typedef std::list<item_t> items_t;
+#else
     typedef std::vector<item_t> items_t;
+#endif
     items_t _items;
 
     // Does the pollset needs rebuilding?
@@ -120,7 +142,16 @@ class socket_poller_t
     // Size of the pollset
     int _pollset_size;
 
-#if defined SL_POLL_BASED_ON_POLL
+#if defined SL_SOCKET_POLLER_EPOLL
+    fd_t _epoll_fd;
+    epoll_event _epoll_events[max_io_events];
+
+    // Sockets whose notification fd fired, that were just added or
+    // modified, or that were ready last time. A socket leaves the list
+    // once SL_EVENTS reports nothing of interest; after that its
+    // notification fd signals any change.
+    std::vector<item_t *> _pending;
+#elif defined SL_POLL_BASED_ON_POLL
     pollfd *_pollfds;
 #elif defined SL_POLL_BASED_ON_SELECT
     resizable_optimized_fd_set_t _pollset_in;
@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../../precompiled.hpp"
+#include "uring.hpp"
+
+#ifdef SL_HAVE_IO_URING
+
+#include "../../util/err.hpp"
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+inline unsigned load_acquire (const unsigned *p_)
+{
+    return __atomic_load_n (p_, __ATOMIC_ACQUIRE);
+}
+
+inline void store_release (unsigned *p_, unsigned value_)
+{
+    __atomic_store_n (p_, value_, __ATOMIC_RELEASE);
+}
+}
+
+slk::uring_t::uring_t (asio::io_context &io_context_) :
+    _io_context (io_context_),
+    _ring_fd (-1),
+    _event_fd (-1),
+    _sq_ring (MAP_FAILED),
+    _sq_ring_size (0),
+    _cq_ring (MAP_FAILED),
+    _cq_ring_size (0),
+    _sqes (static_cast<io_uring_sqe *> (MAP_FAILED)),
+    _sqes_size (0),
+    _sq_head (NULL),
+    _sq_tail (NULL),
+    _sq_flags (NULL),
+    _sq_mask (0),
+    _sq_entries (0),
+    _cq_head (NULL),
+    _cq_tail (NULL),
+    _cq_mask (0),
+    _cqes (NULL),
+    _sq_local_tail (0),
+    _submit_scheduled (false),
+    _event (io_context_),
+    _lifetime_sentinel (std::make_shared<int> (0))
+{
+}
+
+slk::uring_t::~uring_t ()
+{
+    //  Streams cancel their requests on close, so nothing is in flight
+    //  any more. Pending handlers die with the io_context unexecuted.
+    _lifetime_sentinel.reset ();
+    asio::error_code ec;
+    _event.close (ec);
+    _event_fd = -1;
+
+    if (_sqes != MAP_FAILED)
+        munmap (_sqes, _sqes_size);
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+        munmap (_cq_ring, _cq_ring_size);
+    if (_sq_ring != MAP_FAILED)
+        munmap (_sq_ring, _sq_ring_size);
+    if (_ring_fd != -1)
+        close (_ring_fd);
+}
+
+int slk::uring_t::init ()
+{
+    io_uring_params params;
+    memset (&params, 0, sizeof params);
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 4 * io_uring_entries;
+
+    _ring_fd = static_cast<fd_t> (
+      syscall (__NR_io_uring_setup, io_uring_entries, &params));
+    if (_ring_fd == -1)
+        return -1;
+
+    //  Without fast poll every receive on an idle socket would park a
+    //  kernel worker thread; without NODROP completions could be lost.
+    if (!(params.features & IORING_FEAT_FAST_POLL)
+        || !(params.features & IORING_FEAT_NODROP)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    _cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && _cq_ring_size > _sq_ring_size)
+        _sq_ring_size = _cq_ring_size;
+
+    _sq_ring = mmap (NULL, _sq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED)
+        return -1;
+    if (single_mmap)
+        _cq_ring = _sq_ring;
+    else {
+        _cq_ring = mmap (NULL, _cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, _ring_fd,
+                         IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED)
+            return -1;
+    }
+    _sqes_size = params.sq_entries * sizeof (io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe *> (
+      mmap (NULL, _sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES));
+    if (_sqes == MAP_FAILED)
+        return -1;
+
+    char *sq = static_cast<char *> (_sq_ring);
+    _sq_head = reinterpret_cast<unsigned *> (sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *> (sq + params.sq_off.tail);
+    _sq_flags = reinterpret_cast<unsigned *> (sq + params.sq_off.flags);
+    _sq_mask = *reinterpret_cast<unsigned *> (sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_local_tail = *_sq_tail;
+
+    //  SQE slots are used in ring order, so the index array is fixed
+    unsigned *array = reinterpret_cast<unsigned *> (sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; i++)
+        array[i] = i;
+
+    char *cq = static_cast<char *> (_cq_ring);
+    _cq_head = reinterpret_cast<unsigned *> (cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *> (cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *> (cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *> (cq + params.cq_off.cqes);
+
+    _event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1)
+        return -1;
+    if (syscall (__NR_io_uring_register, _ring_fd, IORING_REGISTER_EVENTFD,
+                 &_event_fd, 1)
+        == -1) {
+        close (_event_fd);
+        _event_fd = -1;
+        return -1;
+    }
+    asio::error_code ec;
+    _event.assign (_event_fd, ec);
+    if (ec) {
+        close (_event_fd);
+        _event_fd = -1;
+        errno = ec.value ();
+        return -1;
+    }
+
+    wait_for_completions ();
+    return 0;
+}
+
+io_uring_sqe *slk::uring_t::get_sqe (op_t *op_)
+{
+    //  A full queue is handed to the kernel right away, which consumes
+    //  all of it before io_uring_enter returns.
+    if (_sq_local_tail - load_acquire (_sq_head) == _sq_entries)
+        submit ();
+    slk_assert (_sq_local_tail - load_acquire (_sq_head) < _sq_entries);
+
+    io_uring_sqe *sqe = &_sqes[_sq_local_tail & _sq_mask];
+    _sq_local_tail++;
+    memset (sqe, 0, sizeof *sqe);
+    sqe->user_data = reinterpret_cast<uint64_t> (op_);
+    if (op_)
+        op_->in_flight = true;
+
+    if (!_submit_scheduled) {
+        _submit_scheduled = true;
+        std::weak_ptr<int> sentinel = _lifetime_sentinel;
+        asio::post (_io_context, [this, sentinel] () {
+            if (sentinel.expired ())
+                return;
+            _submit_scheduled = false;
+            submit ();
+        });
+    }
+    return sqe;
+}
+
+void slk::uring_t::cancel (op_t *op_)
+{
+    if (op_->in_flight) {
+        io_uring_sqe *sqe = get_sqe (NULL);
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = reinterpret_cast<uint64_t> (op_);
+        submit ();
+
+        //  Cancelling a socket request completes it right away; if it was
+        //  already finishing, its own completion follows shortly.
+        reap ();
+        while (op_->in_flight) {
+            enter (0, 1, IORING_ENTER_GETEVENTS);
+            reap ();
+        }
+    }
+
+    for (std::deque<completion_t>::iterator it = _completed.begin ();
+         it != _completed.end (); ++it)
+        if (it->op == op_)
+            it->op = NULL;
+}
+
+void slk::uring_t::submit ()
+{
+    const unsigned pending = _sq_local_tail - load_acquire (_sq_head);
+    if (pending == 0)
+        return;
+    store_release (_sq_tail, _sq_local_tail);
+
+    while (enter (pending, 0, 0) == -1) {
+        //  The kernel refuses new work while it holds overflowed
+        //  completions; making room for them lets it continue.
+        if (errno == EBUSY || errno == EAGAIN) {
+            reap ();
+            continue;
+        }
+        errno_assert (errno == EINTR);
+    }
+}
+
+void slk::uring_t::reap ()
+{
+    while (true) {
+        unsigned head = *_cq_head;
+        const unsigned tail = load_acquire (_cq_tail);
+        for (; head != tail; head++) {
+            const io_uring_cqe &cqe = _cqes[head & _cq_mask];
+            op_t *op = reinterpret_cast<op_t *> (cqe.user_data);
+            if (op) {
+                op->in_flight = false;
+                const completion_t completion = {op, cqe.res};
+                _completed.push_back (completion);
+            }
+        }
+        store_release (_cq_head, head);
+
+        //  Completions that did not fit into the CQ are kept by the
+        //  kernel and flushed into it by the next io_uring_enter.
+        if (!(load_acquire (_sq_flags) & IORING_SQ_CQ_OVERFLOW))
+            break;
+        enter (0, 0, IORING_ENTER_GETEVENTS);
+    }
+}
+
+void slk::uring_t::dispatch ()
+{
+    //  Handlers may queue requests or cancel others, which only appends
+    //  to or clears entries of the queue.
+    while (!_completed.empty ()) {
+        const completion_t completion = _completed.front ();
+        _completed.pop_front ();
+        if (completion.op)
+            completion.op->complete (completion.res);
+    }
+}
+
+void slk::uring_t::wait_for_completions ()
+{
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _event.async_wait (
+      asio::posix::stream_descriptor::wait_read,
+      [this, sentinel] (const asio::error_code &ec) {
+          if (sentinel.expired () || ec == asio::error::operation_aborted)
+              return;
+
+          uint64_t count;
+          const ssize_t rc = read (_event_fd, &count, sizeof count);
+          (void) rc;
+
+          reap ();
+          dispatch ();
+          wait_for_completions ();
+      });
+}
+
+int slk::uring_t::enter (unsigned to_submit_,
+                         unsigned min_complete_,
+                         unsigned flags_)
+{
+    return static_cast<int> (syscall (__NR_io_uring_enter, _ring_fd,
+                                      to_submit_, min_complete_, flags_,
+                                      NULL, 0));
+}
+
+#endif // SL_HAVE_IO_URING
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SERVERLINK_URING_HPP_INCLUDED
+#define SERVERLINK_URING_HPP_INCLUDED
+
+#include "../../util/config.hpp"
+
+#ifdef SL_HAVE_IO_URING
+
+#include <asio.hpp>
+#include <linux/io_uring.h>
+#include <deque>
+#include <memory>
+#include "../fd.hpp"
+#include "../../util/macros.hpp"
+
+namespace slk
+{
+//  One io_uring instance per I/O thread, driven with raw syscalls.
+//
+//  Streams of the engines running on the thread queue their requests
+//  here. Nothing is submitted right away: the first request of a round
+//  posts a flush to the thread's io_context, so every request queued by
+//  the handlers of that round goes to the kernel with a single
+//  io_uring_enter. Completions are announced through an eventfd the
+//  io_context waits on, so the ring needs no thread of its own and sits
+//  next to timers, mailbox and listeners that still use asio.
+//
+//  Apart from construction and init, which happen before the thread is
+//  started, the ring is only used by its I/O thread.
+
+class uring_t
+{
+  public:
+    //  A request in flight. Its owner keeps it alive until complete has
+    //  run or cancel has returned.
+    struct op_t
+    {
+        op_t () : in_flight (false) {}
+        virtual ~op_t () {}
+
+        //  res_ is the CQE result: bytes transferred or -errno
+        virtual void complete (int res_) = 0;
+
+        bool in_flight;
+    };
+
+    explicit uring_t (asio::io_context &io_context_);
+    ~uring_t ();
+
+    //  Sets up the ring. Fails with errno set if the kernel lacks
+    //  io_uring or the features the streams rely on.
+    int init ();
+
+    //  Returns a cleared SQE for op_ (NULL for requests whose completion
+    //  is of no interest) and schedules the flush.
+    io_uring_sqe *get_sqe (op_t *op_);
+
+    //  Cancels op_ and waits until the kernel has let go of it, so its
+    //  buffers may be freed once this returns. The op's completion is
+    //  dropped; completions of other ops reaped meanwhile are kept.
+    void cancel (op_t *op_);
+
+    asio::io_context &get_io_context () { return _io_context; }
+
+  private:
+    struct completion_t
+    {
+        op_t *op;
+        int res;
+    };
+
+    void submit ();
+    void reap ();
+    void dispatch ();
+    void wait_for_completions ();
+    int enter (unsigned to_submit_, unsigned min_complete_, unsigned flags_);
+
+    asio::io_context &_io_context;
+
+    fd_t _ring_fd;
+    fd_t _event_fd;
+
+    //  Ring memory shared with the kernel
+    void *_sq_ring;
+    size_t _sq_ring_size;
+    void *_cq_ring;
+    size_t _cq_ring_size;
+    io_uring_sqe *_sqes;
+    size_t _sqes_size;
+
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned *_sq_flags;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned _cq_mask;
+    io_uring_cqe *_cqes;
+
+    //  SQ tail including the SQEs not yet handed to the kernel
+    unsigned _sq_local_tail;
+
+    bool _submit_scheduled;
+
+    //  Completions reaped but not dispatched yet
+    std::deque<completion_t> _completed;
+
+    asio::posix::stream_descriptor _event;
+    std::shared_ptr<int> _lifetime_sentinel;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (uring_t)
+};
+}
+
+#endif // SL_HAVE_IO_URING
+#endif
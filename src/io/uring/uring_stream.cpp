@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "../../precompiled.hpp"
+#include "uring_stream.hpp"
+
+#ifdef SL_HAVE_IO_URING
+
+#include "../../util/err.hpp"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+slk::uring_stream_t::uring_stream_t (uring_t *ring_, fd_t fd_) :
+    _ring (ring_),
+    _fd (fd_),
+    _read_op (this),
+    _read_buf (NULL),
+    _read_len (0),
+    _write_op (this),
+    _iov_pos (0),
+    _written (0)
+{
+    memset (&_msg, 0, sizeof _msg);
+}
+
+slk::uring_stream_t::~uring_stream_t ()
+{
+    close ();
+}
+
+void slk::uring_stream_t::async_read (void *buf_,
+                                      size_t len_,
+                                      read_handler handler_)
+{
+    _read_buf = buf_;
+    _read_len = len_;
+    _read_handler = std::move (handler_);
+    submit_recv ();
+}
+
+void slk::uring_stream_t::async_write (const void *buf_,
+                                       size_t len_,
+                                       write_handler handler_)
+{
+    const const_buffer_t buf = {buf_, len_};
+    async_writev (&buf, 1, std::move (handler_));
+}
+
+void slk::uring_stream_t::async_writev (const const_buffer_t *bufs_,
+                                        size_t count_,
+                                        write_handler handler_)
+{
+    _iov.resize (count_);
+    for (size_t i = 0; i < count_; i++) {
+        _iov[i].iov_base = const_cast<void *> (bufs_[i].data);
+        _iov[i].iov_len = bufs_[i].size;
+    }
+    _iov_pos = 0;
+    _written = 0;
+    _write_handler = std::move (handler_);
+    submit_send ();
+}
+
+void slk::uring_stream_t::close ()
+{
+    if (_fd == -1)
+        return;
+
+    //  The kernel may still be writing into the caller's read buffer or
+    //  reading its write buffers; wait until it no longer is. Like asio,
+    //  report the aborted operations afterwards, never from within close.
+    _ring->cancel (&_read_op);
+    _ring->cancel (&_write_op);
+    ::close (_fd);
+    _fd = -1;
+
+    if (_read_handler) {
+        read_handler handler = std::move (_read_handler);
+        _read_handler = nullptr;
+        asio::post (_ring->get_io_context (),
+                    [handler] () { handler (0, ECANCELED); });
+    }
+    if (_write_handler) {
+        write_handler handler = std::move (_write_handler);
+        _write_handler = nullptr;
+        const size_t written = _written;
+        asio::post (_ring->get_io_context (),
+                    [handler, written] () { handler (written, ECANCELED); });
+    }
+}
+
+void slk::uring_stream_t::submit_recv ()
+{
+    io_uring_sqe *sqe = _ring->get_sqe (&_read_op);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = _fd;
+    sqe->addr = reinterpret_cast<uint64_t> (_read_buf);
+    sqe->len = static_cast<uint32_t> (_read_len);
+}
+
+void slk::uring_stream_t::submit_send ()
+{
+    _msg.msg_iov = &_iov[_iov_pos];
+    _msg.msg_iovlen = _iov.size () - _iov_pos;
+
+    io_uring_sqe *sqe = _ring->get_sqe (&_write_op);
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = _fd;
+    sqe->addr = reinterpret_cast<uint64_t> (&_msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+}
+
+void slk::uring_stream_t::read_completed (int res_)
+{
+    if (res_ == -EINTR || res_ == -EAGAIN) {
+        submit_recv ();
+        return;
+    }
+
+    //  The handler usually starts the next read right away
+    read_handler handler = std::move (_read_handler);
+    _read_handler = nullptr;
+    if (res_ < 0)
+        handler (0, -res_);
+    else
+        handler (static_cast<size_t> (res_), 0);
+}
+
+void slk::uring_stream_t::write_completed (int res_)
+{
+    if (res_ == -EINTR || res_ == -EAGAIN) {
+        submit_send ();
+        return;
+    }
+
+    if (res_ >= 0) {
+        //  Skip what was sent; resubmit the rest after a short send
+        size_t sent = static_cast<size_t> (res_);
+        _written += sent;
+        while (_iov_pos < _iov.size () && sent >= _iov[_iov_pos].iov_len) {
+            sent -= _iov[_iov_pos].iov_len;
+            _iov_pos++;
+        }
+        if (_iov_pos < _iov.size ()) {
+            _iov[_iov_pos].iov_base =
+              static_cast<char *> (_iov[_iov_pos].iov_base) + sent;
+            _iov[_iov_pos].iov_len -= sent;
+            submit_send ();
+            return;
+        }
+    }
+
+    write_handler handler = std::move (_write_handler);
+    _write_handler = nullptr;
+    handler (_written, res_ < 0 ? -res_ : 0);
+}
+
+#endif // SL_HAVE_IO_URING
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SERVERLINK_URING_STREAM_HPP_INCLUDED
+#define SERVERLINK_URING_STREAM_HPP_INCLUDED
+
+#include "../../util/config.hpp"
+
+#ifdef SL_HAVE_IO_URING
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <memory>
+#include <vector>
+#include "../fd.hpp"
+#include "../i_async_stream.hpp"
+#include "uring.hpp"
+
+namespace slk
+{
+//  Stream on a connected TCP or IPC socket whose reads and writes are
+//  io_uring requests. A read is one RECV straight into the caller's
+//  buffer; a write is one SENDMSG over all its pieces, resubmitted for
+//  the remainder after a short send. Both complete on the I/O thread
+//  owning the ring, like the asio handlers of tcp_stream_t.
+
+class uring_stream_t final : public i_async_stream
+{
+  public:
+    uring_stream_t (uring_t *ring_, fd_t fd_);
+    ~uring_stream_t () override;
+
+    //  Takes over the descriptor of a connected asio socket. Returns NULL
+    //  (leaving the socket as it was) if the socket cannot let go of it.
+    template <typename Socket>
+    static std::unique_ptr<i_async_stream> adopt (uring_t *ring_,
+                                                  Socket &socket_)
+    {
+        asio::error_code ec;
+        const fd_t fd = socket_.release (ec);
+        if (ec)
+            return std::unique_ptr<i_async_stream> ();
+        return std::unique_ptr<i_async_stream> (
+          new (std::nothrow) uring_stream_t (ring_, fd));
+    }
+
+    //  i_async_stream implementation
+    void async_read (void *buf_, size_t len_, read_handler handler_) override;
+    void
+    async_write (const void *buf_, size_t len_, write_handler handler_) override;
+    void async_writev (const const_buffer_t *bufs_,
+                       size_t count_,
+                       write_handler handler_) override;
+    void close () override;
+
+  private:
+    struct read_op_t final : uring_t::op_t
+    {
+        explicit read_op_t (uring_stream_t *stream_) : stream (stream_) {}
+        void complete (int res_) override { stream->read_completed (res_); }
+        uring_stream_t *stream;
+    };
+
+    struct write_op_t final : uring_t::op_t
+    {
+        explicit write_op_t (uring_stream_t *stream_) : stream (stream_) {}
+        void complete (int res_) override { stream->write_completed (res_); }
+        uring_stream_t *stream;
+    };
+
+    void submit_recv ();
+    void submit_send ();
+    void read_completed (int res_);
+    void write_completed (int res_);
+
+    uring_t *_ring;
+    fd_t _fd;
+
+    read_op_t _read_op;
+    void *_read_buf;
+    size_t _read_len;
+    read_handler _read_handler;
+
+    //  The pieces still to be sent start at _iov [_iov_pos]
+    write_op_t _write_op;
+    std::vector<iovec> _iov;
+    size_t _iov_pos;
+    msghdr _msg;
+    size_t _written;
+    write_handler _write_handler;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (uring_stream_t)
+};
+}
+
+#endif // SL_HAVE_IO_URING
+#endif
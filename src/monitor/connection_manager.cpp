@@ -15,26 +15,37 @@ slk::connection_manager_t::~connection_manager_t ()
     _stats.clear ();
 }
 
-void slk::connection_manager_t::peer_connected (const blob_t &routing_id,
-                                                 int64_t timestamp_us)
+std::shared_ptr<slk::peer_counters_t>
+slk::connection_manager_t::peer_connected (
+  const blob_t &routing_id,
+  int64_t timestamp_us,
+  std::shared_ptr<heartbeat_link_t> link)
 {
     scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_or_create_stats (routing_id);
+    peer_entry_t *entry = get_or_create_entry (routing_id);
 
-    stats->state = SLK_STATE_CONNECTED;
-    stats->connection_time = timestamp_us;
-    stats->last_recv_time = timestamp_us;
+    entry->stats.state = SLK_STATE_CONNECTED;
+    entry->stats.connection_time = timestamp_us;
+    entry->stats.last_recv_time = timestamp_us;
+    entry->heartbeat = SL_MOVE (link);
+
+    if (!entry->counters)
+        entry->counters = std::make_shared<peer_counters_t> ();
+    return entry->counters;
 }
 
 void slk::connection_manager_t::peer_disconnected (const blob_t &routing_id,
                                                     int64_t timestamp_us)
 {
     scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_stats_internal (routing_id);
+    peer_entry_t *entry = get_entry (routing_id);
 
-    if (stats) {
-        stats->state = SLK_STATE_DISCONNECTED;
-        stats->last_heartbeat_time = timestamp_us;
+    if (entry) {
+        // Keep the final heartbeat results, the link goes away with the pipe
+        snapshot (*entry, &entry->stats);
+        entry->heartbeat.reset ();
+        entry->stats.state = SLK_STATE_DISCONNECTED;
+        entry->stats.last_heartbeat_time = timestamp_us;
     }
 }
 
@@ -42,57 +53,28 @@ void slk::connection_manager_t::peer_reconnecting (const blob_t &routing_id,
                                                     int64_t timestamp_us)
 {
     scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_stats_internal (routing_id);
-
-    if (stats) {
-        stats->state = SLK_STATE_RECONNECTING;
-        stats->reconnect_count++;
-        stats->last_heartbeat_time = timestamp_us;
-    }
-}
-
-void slk::connection_manager_t::record_send (const blob_t &routing_id,
-                                              uint64_t bytes,
-                                              int64_t timestamp_us)
-{
-    scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_or_create_stats (routing_id);
-    stats->record_send (bytes, timestamp_us);
-}
-
-void slk::connection_manager_t::record_recv (const blob_t &routing_id,
-                                              uint64_t bytes,
-                                              int64_t timestamp_us)
-{
-    scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_or_create_stats (routing_id);
-    stats->record_recv (bytes, timestamp_us);
-}
+    peer_entry_t *entry = get_entry (routing_id);
 
-void slk::connection_manager_t::record_heartbeat (const blob_t &routing_id,
-                                                   int64_t timestamp_us)
-{
-    scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_stats_internal (routing_id);
-
-    if (stats) {
-        stats->record_heartbeat (timestamp_us);
+    if (entry) {
+        entry->stats.state = SLK_STATE_RECONNECTING;
+        entry->stats.reconnect_count++;
+        entry->stats.last_heartbeat_time = timestamp_us;
     }
 }
 
 bool slk::connection_manager_t::is_connected (const blob_t &routing_id) const
 {
     scoped_lock_t lock (_mutex);
-    const peer_stats_t *stats = get_stats_internal (routing_id);
-    return stats && stats->state == SLK_STATE_CONNECTED;
+    const peer_entry_t *entry = get_entry (routing_id);
+    return entry && entry->stats.state == SLK_STATE_CONNECTED;
 }
 
 slk::peer_state_t
 slk::connection_manager_t::get_state (const blob_t &routing_id) const
 {
     scoped_lock_t lock (_mutex);
-    const peer_stats_t *stats = get_stats_internal (routing_id);
-    return stats ? static_cast<peer_state_t> (stats->state)
+    const peer_entry_t *entry = get_entry (routing_id);
+    return entry ? static_cast<peer_state_t> (entry->stats.state)
                  : SLK_STATE_DISCONNECTED;
 }
 
@@ -100,10 +82,10 @@ bool slk::connection_manager_t::get_stats (const blob_t &routing_id,
                                             peer_stats_t *stats) const
 {
     scoped_lock_t lock (_mutex);
-    const peer_stats_t *peer_stats = get_stats_internal (routing_id);
+    const peer_entry_t *entry = get_entry (routing_id);
 
-    if (peer_stats && stats) {
-        *stats = *peer_stats;
+    if (entry && stats) {
+        snapshot (*entry, stats);
         return true;
     }
 
@@ -121,7 +103,7 @@ void slk::connection_manager_t::get_connected_peers (
 
         for (stats_map_t::const_iterator it = _stats.begin ();
              it != _stats.end (); ++it) {
-            if (it->second.state == SLK_STATE_CONNECTED) {
+            if (it->second.stats.state == SLK_STATE_CONNECTED) {
                 // Create a copy and move it into the vector
                 blob_t id_copy;
                 id_copy.set_deep_copy (it->first);
@@ -138,7 +120,7 @@ size_t slk::connection_manager_t::get_peer_count () const
     size_t count = 0;
     for (stats_map_t::const_iterator it = _stats.begin ();
          it != _stats.end (); ++it) {
-        if (it->second.state == SLK_STATE_CONNECTED) {
+        if (it->second.stats.state == SLK_STATE_CONNECTED) {
             count++;
         }
     }
@@ -146,36 +128,15 @@ size_t slk::connection_manager_t::get_peer_count () const
     return count;
 }
 
-void slk::connection_manager_t::mark_ping_sent (const blob_t &routing_id,
-                                                 int64_t timestamp_us)
-{
-    scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_stats_internal (routing_id);
-
-    if (stats) {
-        stats->last_ping_sent = timestamp_us;
-        stats->ping_timestamp = timestamp_us;
-        stats->ping_outstanding = true;
-    }
-}
-
-void slk::connection_manager_t::mark_pong_received (const blob_t &routing_id,
-                                                     int64_t timestamp_us)
-{
-    scoped_lock_t lock (_mutex);
-    peer_stats_t *stats = get_stats_internal (routing_id);
-
-    if (stats) {
-        stats->update_rtt (timestamp_us);
-        stats->record_heartbeat (timestamp_us);
-    }
-}
-
 int slk::connection_manager_t::get_rtt (const blob_t &routing_id) const
 {
     scoped_lock_t lock (_mutex);
-    const peer_stats_t *stats = get_stats_internal (routing_id);
-    return stats ? stats->rtt_us : 0;
+    const peer_entry_t *entry = get_entry (routing_id);
+    if (!entry)
+        return 0;
+    if (entry->heartbeat)
+        return entry->heartbeat->rtt_us.load (std::memory_order_relaxed);
+    return entry->stats.rtt_us;
 }
 
 void slk::connection_manager_t::cleanup_stale_peers (int64_t timeout_us)
@@ -184,9 +145,10 @@ void slk::connection_manager_t::cleanup_stale_peers (int64_t timeout_us)
 
     stats_map_t::iterator it = _stats.begin ();
     while (it != _stats.end ()) {
-        if (it->second.state == SLK_STATE_DISCONNECTED &&
-            it->second.last_heartbeat_time > 0 &&
-            (timeout_us - it->second.last_heartbeat_time) > timeout_us) {
+        const peer_stats_t &stats = it->second.stats;
+        if (stats.state == SLK_STATE_DISCONNECTED &&
+            stats.last_heartbeat_time > 0 &&
+            (timeout_us - stats.last_heartbeat_time) > timeout_us) {
             stats_map_t::iterator to_erase = it;
             ++it;
             _stats.erase (to_erase);
@@ -202,8 +164,8 @@ void slk::connection_manager_t::remove_peer (const blob_t &routing_id)
     _stats.erase (routing_id);
 }
 
-slk::peer_stats_t *
-slk::connection_manager_t::get_or_create_stats (const blob_t &routing_id)
+slk::connection_manager_t::peer_entry_t *
+slk::connection_manager_t::get_or_create_entry (const blob_t &routing_id)
 {
     // Note: Assumes lock is already held
     stats_map_t::iterator it = _stats.find (routing_id);
@@ -214,25 +176,47 @@ slk::connection_manager_t::get_or_create_stats (const blob_t &routing_id)
         id_copy.set_deep_copy (routing_id);
 
         std::pair<stats_map_t::iterator, bool> result =
-            _stats.emplace (SL_MOVE (id_copy), peer_stats_t ());
+            _stats.emplace (SL_MOVE (id_copy), peer_entry_t ());
         return &result.first->second;
     }
 
     return &it->second;
 }
 
-slk::peer_stats_t *
-slk::connection_manager_t::get_stats_internal (const blob_t &routing_id)
+slk::connection_manager_t::peer_entry_t *
+slk::connection_manager_t::get_entry (const blob_t &routing_id)
 {
     // Note: Assumes lock is already held
     stats_map_t::iterator it = _stats.find (routing_id);
     return (it != _stats.end ()) ? &it->second : NULL;
 }
 
-const slk::peer_stats_t *
-slk::connection_manager_t::get_stats_internal (const blob_t &routing_id) const
+const slk::connection_manager_t::peer_entry_t *
+slk::connection_manager_t::get_entry (const blob_t &routing_id) const
 {
     // Note: Assumes lock is already held
     stats_map_t::const_iterator it = _stats.find (routing_id);
     return (it != _stats.end ()) ? &it->second : NULL;
 }
+
+void slk::connection_manager_t::snapshot (const peer_entry_t &entry,
+                                           peer_stats_t *stats)
+{
+    // Note: Assumes lock is already held
+    const int64_t connected_at = entry.stats.last_recv_time;
+    *stats = entry.stats;
+
+    if (entry.counters) {
+        entry.counters->read (stats);
+        if (stats->last_recv_time < connected_at)
+            stats->last_recv_time = connected_at;
+    }
+
+    if (entry.heartbeat) {
+        const int64_t last =
+          entry.heartbeat->last_heartbeat_us.load (std::memory_order_relaxed);
+        if (last > stats->last_heartbeat_time)
+            stats->last_heartbeat_time = last;
+        stats->rtt_us = entry.heartbeat->rtt_us.load (std::memory_order_relaxed);
+    }
+}
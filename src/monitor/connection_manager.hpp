@@ -5,8 +5,10 @@
 #define SL_CONNECTION_MANAGER_HPP_INCLUDED
 
 #include <map>
+#include <memory>
 #include <vector>
 #include "peer_stats.hpp"
+#include "heartbeat.hpp"
 #include "../msg/blob.hpp"
 #include "../util/mutex.hpp"
 #include "../util/macros.hpp"
@@ -23,18 +25,16 @@ class connection_manager_t
     connection_manager_t ();
     ~connection_manager_t ();
 
-    // Connection state management
-    void peer_connected (const blob_t &routing_id, int64_t timestamp_us);
+    // Connection state management. The link, if any, is where the peer's
+    // engine reports heartbeat results. Returns the peer's traffic
+    // counters, which the socket updates directly from then on; they are
+    // kept across reconnects of the same routing id.
+    std::shared_ptr<peer_counters_t>
+    peer_connected (const blob_t &routing_id, int64_t timestamp_us,
+                    std::shared_ptr<heartbeat_link_t> link = NULL);
     void peer_disconnected (const blob_t &routing_id, int64_t timestamp_us);
     void peer_reconnecting (const blob_t &routing_id, int64_t timestamp_us);
 
-    // Statistics tracking
-    void record_send (const blob_t &routing_id, uint64_t bytes,
-                      int64_t timestamp_us);
-    void record_recv (const blob_t &routing_id, uint64_t bytes,
-                      int64_t timestamp_us);
-    void record_heartbeat (const blob_t &routing_id, int64_t timestamp_us);
-
     // State queries
     bool is_connected (const blob_t &routing_id) const;
     peer_state_t get_state (const blob_t &routing_id) const;
@@ -44,11 +44,7 @@ class connection_manager_t
     void get_connected_peers (std::vector<blob_t> *peers) const;
     size_t get_peer_count () const;
 
-    // Heartbeat management
-    void mark_ping_sent (const blob_t &routing_id, int64_t timestamp_us);
-    void mark_pong_received (const blob_t &routing_id, int64_t timestamp_us);
-
-    // RTT calculation
+    // Last heartbeat round-trip time in microseconds
     int get_rtt (const blob_t &routing_id) const;
 
     // Clean up disconnected peers (optional, for memory management)
@@ -58,15 +54,28 @@ class connection_manager_t
     void remove_peer (const blob_t &routing_id);
 
   private:
-    // Thread-safe access to peer statistics
-    typedef std::map<blob_t, peer_stats_t> stats_map_t;
+    struct peer_entry_t
+    {
+        // Connection state; the traffic fields are filled in on read
+        peer_stats_t stats;
+        std::shared_ptr<peer_counters_t> counters;
+        // Only set while the peer is connected with heartbeats enabled
+        std::shared_ptr<heartbeat_link_t> heartbeat;
+    };
+
+    // The mutex guards the map and connection state only; traffic and
+    // heartbeat results are read from the shared blocks without it.
+    typedef std::map<blob_t, peer_entry_t> stats_map_t;
     stats_map_t _stats;
     mutable mutex_t _mutex;
 
     // Helper: get or create stats entry
-    peer_stats_t *get_or_create_stats (const blob_t &routing_id);
-    peer_stats_t *get_stats_internal (const blob_t &routing_id);
-    const peer_stats_t *get_stats_internal (const blob_t &routing_id) const;
+    peer_entry_t *get_or_create_entry (const blob_t &routing_id);
+    peer_entry_t *get_entry (const blob_t &routing_id);
+    const peer_entry_t *get_entry (const blob_t &routing_id) const;
+
+    // Helper: snapshot of an entry with the live results merged in
+    static void snapshot (const peer_entry_t &entry, peer_stats_t *stats);
 
     SL_NON_COPYABLE_NOR_MOVABLE (connection_manager_t)
 };
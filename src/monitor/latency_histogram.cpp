@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Monitoring System */
+
+#include "../precompiled.hpp"
+#include "latency_histogram.hpp"
+
+slk::latency_histogram_t::latency_histogram_t () :
+    _count (0),
+    _sum (0),
+    _min (UINT64_MAX),
+    _max (0)
+{
+    for (int i = 0; i != bucket_count; i++)
+        _buckets[i].store (0, std::memory_order_relaxed);
+}
+
+uint64_t slk::latency_histogram_t::bucket_upper_bound (int index)
+{
+    const int shift = index < 2 * sub_buckets ? 0 : index / sub_buckets - 1;
+    const uint64_t base = static_cast<uint64_t> (index - shift * sub_buckets);
+    return ((base + 1) << shift) - 1;
+}
+
+void slk::latency_histogram_t::summarize (latency_summary_t *summary) const
+{
+    // Concurrent recording may leave the total slightly off the sum of
+    // the buckets; the percentiles are computed from the buckets alone.
+    uint64_t counts[bucket_count];
+    uint64_t total = 0;
+    for (int i = 0; i != bucket_count; i++) {
+        counts[i] = _buckets[i].load (std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    summary->count = total;
+    summary->min_us = 0;
+    summary->max_us = 0;
+    summary->mean_us = 0;
+    summary->p50_us = 0;
+    summary->p90_us = 0;
+    summary->p99_us = 0;
+    summary->p999_us = 0;
+    if (total == 0)
+        return;
+
+    const uint64_t max_us = _max.load (std::memory_order_relaxed);
+    const uint64_t recorded = _count.load (std::memory_order_relaxed);
+    const uint64_t min_us = _min.load (std::memory_order_relaxed);
+    summary->min_us = min_us < max_us ? min_us : max_us;
+    summary->max_us = max_us;
+    if (recorded)
+        summary->mean_us = _sum.load (std::memory_order_relaxed) / recorded;
+
+    // Percentiles in tenths of a percent, in ascending order
+    const uint64_t permille[] = {500, 900, 990, 999};
+    uint64_t *results[] = {&summary->p50_us, &summary->p90_us,
+                           &summary->p99_us, &summary->p999_us};
+    const int percentiles = sizeof permille / sizeof permille[0];
+
+    uint64_t seen = 0;
+    int next = 0;
+    for (int i = 0; i != bucket_count && next != percentiles; i++) {
+        seen += counts[i];
+        while (next != percentiles && seen * 1000 >= permille[next] * total) {
+            const uint64_t bound = bucket_upper_bound (i);
+            *results[next] = bound < max_us ? bound : max_us;
+            next++;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Monitoring System */
+
+#ifndef SL_LATENCY_HISTOGRAM_HPP_INCLUDED
+#define SL_LATENCY_HISTOGRAM_HPP_INCLUDED
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include "../util/macros.hpp"
+
+namespace slk
+{
+// Summary of a latency histogram, all values in microseconds
+struct latency_summary_t
+{
+    uint64_t count;
+    uint64_t min_us;
+    uint64_t max_us;
+    uint64_t mean_us;
+    uint64_t p50_us;
+    uint64_t p90_us;
+    uint64_t p99_us;
+    uint64_t p999_us;
+};
+
+// Log-bucketed latency histogram in the style of HdrHistogram. Every
+// power of two is split into sub_buckets linear buckets, so a recorded
+// value is reported within 1/sub_buckets of its true size, and the whole
+// range up to max_value_bits fits in a few kilobytes. Recording is a
+// couple of relaxed atomic adds and may happen on any thread.
+class latency_histogram_t
+{
+  public:
+    static const int sub_bucket_bits = 4;
+    static const int sub_buckets = 1 << sub_bucket_bits;
+
+    // Larger values (over an hour) are clamped into the last bucket
+    static const int max_value_bits = 32;
+    static const int bucket_count =
+      (max_value_bits - sub_bucket_bits + 1) * sub_buckets;
+
+    latency_histogram_t ();
+
+    void record (uint64_t value_us)
+    {
+        const uint64_t max_value = (uint64_t (1) << max_value_bits) - 1;
+        if (value_us > max_value)
+            value_us = max_value;
+
+        _buckets[bucket_index (value_us)].fetch_add (
+          1, std::memory_order_relaxed);
+        _count.fetch_add (1, std::memory_order_relaxed);
+        _sum.fetch_add (value_us, std::memory_order_relaxed);
+
+        uint64_t current = _min.load (std::memory_order_relaxed);
+        while (value_us < current
+               && !_min.compare_exchange_weak (current, value_us,
+                                               std::memory_order_relaxed))
+            ;
+        current = _max.load (std::memory_order_relaxed);
+        while (value_us > current
+               && !_max.compare_exchange_weak (current, value_us,
+                                               std::memory_order_relaxed))
+            ;
+    }
+
+    // Percentiles are reported as the highest value of their bucket,
+    // capped at the largest value recorded
+    void summarize (latency_summary_t *summary) const;
+
+    // Bucket layout
+    static int bucket_index (uint64_t value_us)
+    {
+        // Values below 2 * sub_buckets map one to one; above that every
+        // power of two gets sub_buckets buckets, each twice as wide as
+        // the ones of the previous power
+        const int width = std::bit_width (value_us);
+        const int shift = width > sub_bucket_bits + 1
+                            ? width - sub_bucket_bits - 1
+                            : 0;
+        return shift * sub_buckets + static_cast<int> (value_us >> shift);
+    }
+    static uint64_t bucket_upper_bound (int index);
+
+  private:
+    std::atomic<uint64_t> _buckets[bucket_count];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _min;
+    std::atomic<uint64_t> _max;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (latency_histogram_t)
+};
+
+}
+
+#endif
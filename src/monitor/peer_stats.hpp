@@ -4,6 +4,7 @@
 #ifndef SL_PEER_STATS_HPP_INCLUDED
 #define SL_PEER_STATS_HPP_INCLUDED
 
+#include <atomic>
 #include <cstdint>
 
 namespace slk
@@ -45,12 +46,7 @@ struct peer_stats_t
     // Connection state
     int state;              // peer_state_t
     int reconnect_count;
-    int rtt_us;             // Round-trip time in microseconds
-
-    // Heartbeat tracking
-    int64_t last_ping_sent;
-    int64_t ping_timestamp; // Timestamp in PING message (for RTT calc)
-    bool ping_outstanding;  // Waiting for PONG response
+    int rtt_us;             // Heartbeat round-trip time in microseconds
 
     peer_stats_t ()
         : last_send_time (0),
@@ -63,10 +59,7 @@ struct peer_stats_t
           messages_recv (0),
           state (SLK_STATE_DISCONNECTED),
           reconnect_count (0),
-          rtt_us (0),
-          last_ping_sent (0),
-          ping_timestamp (0),
-          ping_outstanding (false)
+          rtt_us (0)
     {
     }
 
@@ -82,41 +75,99 @@ struct peer_stats_t
         messages_sent = 0;
         messages_recv = 0;
         rtt_us = 0;
-        last_ping_sent = 0;
-        ping_timestamp = 0;
-        ping_outstanding = false;
+    }
+};
+
+// Traffic counters of one peer, attached to its pipe. Only the socket's
+// thread updates them, from the send and receive paths, with relaxed
+// stores and no lookups. A sequence counter lets readers on any thread
+// take a consistent snapshot: they retry while an update is in progress.
+class peer_counters_t
+{
+  public:
+    peer_counters_t () :
+        _seq (0),
+        _last_send_time (0),
+        _last_recv_time (0),
+        _bytes_sent (0),
+        _bytes_recv (0),
+        _messages_sent (0),
+        _messages_recv (0)
+    {
+    }
+
+    // Counts a frame; a message is counted with its last frame
+    void record_send (uint64_t bytes, bool last_part, int64_t timestamp_us)
+    {
+        begin_update ();
+        bump (_bytes_sent, bytes);
+        if (last_part)
+            bump (_messages_sent, 1);
+        _last_send_time.store (timestamp_us, std::memory_order_relaxed);
+        end_update ();
     }
 
-    // Update traffic statistics
-    void record_send (uint64_t bytes, int64_t timestamp_us)
+    void record_recv (uint64_t bytes, bool last_part, int64_t timestamp_us)
     {
-        bytes_sent += bytes;
-        messages_sent++;
-        last_send_time = timestamp_us;
+        begin_update ();
+        bump (_bytes_recv, bytes);
+        if (last_part)
+            bump (_messages_recv, 1);
+        _last_recv_time.store (timestamp_us, std::memory_order_relaxed);
+        end_update ();
     }
 
-    void record_recv (uint64_t bytes, int64_t timestamp_us)
+    // Copies the traffic fields into stats
+    void read (peer_stats_t *stats) const
     {
-        bytes_recv += bytes;
-        messages_recv++;
-        last_recv_time = timestamp_us;
+        uint32_t before, after;
+        do {
+            before = _seq.load (std::memory_order_acquire);
+            stats->last_send_time =
+              _last_send_time.load (std::memory_order_relaxed);
+            stats->last_recv_time =
+              _last_recv_time.load (std::memory_order_relaxed);
+            stats->bytes_sent = _bytes_sent.load (std::memory_order_relaxed);
+            stats->bytes_recv = _bytes_recv.load (std::memory_order_relaxed);
+            stats->messages_sent =
+              _messages_sent.load (std::memory_order_relaxed);
+            stats->messages_recv =
+              _messages_recv.load (std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_acquire);
+            after = _seq.load (std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
     }
 
-    // Update heartbeat
-    void record_heartbeat (int64_t timestamp_us)
+  private:
+    // Single writer, so plain load/store pairs are enough
+    static void bump (std::atomic<uint64_t> &counter, uint64_t delta)
     {
-        last_heartbeat_time = timestamp_us;
-        ping_outstanding = false;
+        counter.store (counter.load (std::memory_order_relaxed) + delta,
+                       std::memory_order_relaxed);
     }
 
-    // Calculate and update RTT
-    void update_rtt (int64_t current_time_us)
+    void begin_update ()
     {
-        if (ping_outstanding && ping_timestamp > 0) {
-            rtt_us = static_cast<int> (current_time_us - ping_timestamp);
-            ping_outstanding = false;
-        }
+        _seq.store (_seq.load (std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
     }
+
+    void end_update ()
+    {
+        _seq.store (_seq.load (std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    // Odd while an update is in progress
+    std::atomic<uint32_t> _seq;
+
+    std::atomic<int64_t> _last_send_time;
+    std::atomic<int64_t> _last_recv_time;
+    std::atomic<uint64_t> _bytes_sent;
+    std::atomic<uint64_t> _bytes_recv;
+    std::atomic<uint64_t> _messages_sent;
+    std::atomic<uint64_t> _messages_recv;
 };
 
 }
@@ -11,6 +11,7 @@
 #include "../util/macros.hpp"
 #include "metadata.hpp"
 #include "../util/err.hpp"
+#include "../util/slab_allocator.hpp"
 
 // Message property constant
 #define SL_MSG_PROPERTY_ROUTING_ID "Routing-Id"
@@ -71,19 +72,24 @@ int slk::msg_t::init_size (size_t size_)
         _u.lmsg.group.type = group_type_short;
         _u.lmsg.routing_id = 0;
         _u.lmsg.content = NULL;
-        if (sizeof (content_t) + size_ > size_)
+        const size_t block_size = sizeof (content_t) + wire_headroom + size_;
+        if (block_size > size_)
             _u.lmsg.content =
-              static_cast<content_t *> (malloc (sizeof (content_t) + size_));
+              static_cast<content_t *> (slab_alloc (block_size));
         if (unlikely (!_u.lmsg.content)) {
             errno = ENOMEM;
             return -1;
         }
 
-        _u.lmsg.content->data = _u.lmsg.content + 1;
+        _u.lmsg.content->data =
+          reinterpret_cast<unsigned char *> (_u.lmsg.content + 1)
+          + wire_headroom;
         _u.lmsg.content->size = size_;
         _u.lmsg.content->ffn = NULL;
         _u.lmsg.content->hint = NULL;
         new (&_u.lmsg.content->refcnt) slk::atomic_counter_t ();
+        new (&_u.lmsg.content->wire_hdr) std::atomic<unsigned char> (0);
+        _u.lmsg.content->headroom = wire_headroom;
     }
     return 0;
 }
@@ -124,6 +130,8 @@ int slk::msg_t::init_external_storage (content_t *content_,
     _u.zclmsg.content->ffn = ffn_;
     _u.zclmsg.content->hint = hint_;
     new (&_u.zclmsg.content->refcnt) slk::atomic_counter_t ();
+    new (&_u.zclmsg.content->wire_hdr) std::atomic<unsigned char> (0);
+    _u.zclmsg.content->headroom = 0;
 
     return 0;
 }
@@ -155,7 +163,7 @@ int slk::msg_t::init_data (void *data_,
         _u.lmsg.group.type = group_type_short;
         _u.lmsg.routing_id = 0;
         _u.lmsg.content =
-          static_cast<content_t *> (malloc (sizeof (content_t)));
+          static_cast<content_t *> (slab_alloc (sizeof (content_t)));
         if (!_u.lmsg.content) {
             errno = ENOMEM;
             return -1;
@@ -166,6 +174,8 @@ int slk::msg_t::init_data (void *data_,
         _u.lmsg.content->ffn = ffn_;
         _u.lmsg.content->hint = hint_;
         new (&_u.lmsg.content->refcnt) slk::atomic_counter_t ();
+        new (&_u.lmsg.content->wire_hdr) std::atomic<unsigned char> (0);
+        _u.lmsg.content->headroom = 0;
     }
     return 0;
 }
@@ -253,7 +263,7 @@ int slk::msg_t::close ()
             if (_u.lmsg.content->ffn)
                 _u.lmsg.content->ffn (_u.lmsg.content->data,
                                       _u.lmsg.content->hint);
-            free (_u.lmsg.content);
+            slab_free (_u.lmsg.content);
         }
     }
 
@@ -395,6 +405,35 @@ size_t slk::msg_t::size () const
     }
 }
 
+const unsigned char *slk::msg_t::wire_frame (const unsigned char *hdr_,
+                                             size_t hdr_size_)
+{
+    //  Marks a header that is being written by another thread.
+    const unsigned char wire_busy = 0xff;
+
+    if (_u.base.type != type_lmsg || hdr_size_ == 0
+        || hdr_size_ > _u.lmsg.content->headroom)
+        return NULL;
+
+    content_t *content = _u.lmsg.content;
+    unsigned char *frame = static_cast<unsigned char *> (content->data) - hdr_size_;
+
+    unsigned char state = content->wire_hdr.load (std::memory_order_acquire);
+    if (state == 0
+        && content->wire_hdr.compare_exchange_strong (
+          state, wire_busy, std::memory_order_acquire)) {
+        memcpy (frame, hdr_, hdr_size_);
+        content->wire_hdr.store (static_cast<unsigned char> (hdr_size_),
+                                 std::memory_order_release);
+        return frame;
+    }
+
+    //  Reuse the stored header only if it is the one we would send.
+    if (state != hdr_size_ || memcmp (frame, hdr_, hdr_size_) != 0)
+        return NULL;
+    return frame;
+}
+
 void slk::msg_t::shrink (size_t new_size_)
 {
     //  Check the validity of the message.
@@ -601,7 +640,7 @@ bool slk::msg_t::rm_refs (int refs_)
 
         if (_u.lmsg.content->ffn)
             _u.lmsg.content->ffn (_u.lmsg.content->data, _u.lmsg.content->hint);
-        free (_u.lmsg.content);
+        slab_free (_u.lmsg.content);
 
         return false;
     }
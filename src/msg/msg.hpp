@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <atomic>
 #include <cstddef>
 
 #include "../util/config.hpp"
@@ -49,6 +50,10 @@ class msg_t
     //  used to deallocate the data. If the buffer is actually shared (there
     //  are at least 2 references to it) refcnt member contains number of
     //  references.
+    //  Blocks allocated by init_size also reserve wire_headroom bytes in
+    //  front of the data, where the first engine to send the message
+    //  stores its frame header (see wire_frame). wire_hdr holds the size of
+    //  that header once it is written, 0 before and wire_busy meanwhile.
     struct content_t
     {
         void *data;
@@ -56,8 +61,15 @@ class msg_t
         msg_free_fn *ffn;
         void *hint;
         slk::atomic_counter_t refcnt;
+        std::atomic<unsigned char> wire_hdr;
+        unsigned char headroom;
     };
 
+    //  Bytes reserved in front of the data of messages allocated by
+    //  init_size. Large enough for any ZMTP frame header, and a multiple
+    //  of 16 so it does not change the alignment of the data.
+    static const size_t wire_headroom = 16;
+
     //  Message flags.
     enum
     {
@@ -103,6 +115,16 @@ class msg_t
     void *data ();
     size_t size () const;
 
+    //  Stores the encoded frame header hdr_ right in front of the data,
+    //  unless an identical header is already there, and returns a pointer
+    //  to it so that header and body can be sent as one contiguous chunk.
+    //  The header is written once, by whichever engine gets there first,
+    //  and shared by every copy of the message fanned out to other peers.
+    //  Returns NULL if the message has no headroom or holds a different
+    //  header, in which case the caller emits its own header.
+    const unsigned char *wire_frame (const unsigned char *hdr_,
+                                     size_t hdr_size_);
+
 #if SL_HAVE_SPAN
     //  Returns a span view over the message data as std::byte (mutable).
     //  Provides modern C++20 interface for buffer manipulation.
@@ -110,6 +110,31 @@ size_t slk::glob_pattern_t::parse_char_class (const std::string &pattern,
     return i; // Returns position of ']'
 }
 
+void slk::glob_pattern_t::steps (std::vector<step_t> &steps_) const
+{
+    steps_.clear ();
+    for (size_t i = 0; i < _segments.size (); ++i) {
+        const segment_t &seg = _segments[i];
+        if (seg.type == STAR && !steps_.empty () && steps_.back ().star)
+            continue;
+
+        step_t step;
+        step.star = seg.type == STAR;
+        memset (step.bits, 0, sizeof step.bits);
+        if (seg.type == LITERAL) {
+            step.bits[seg.literal_char >> 6] |= uint64_t (1)
+                                                << (seg.literal_char & 63);
+        } else if (seg.type == QUESTION) {
+            memset (step.bits, 0xff, sizeof step.bits);
+        } else if (seg.type == CHAR_CLASS) {
+            for (unsigned ch = 0; ch < 256; ++ch)
+                if (char_class_match (static_cast<unsigned char> (ch), seg))
+                    step.bits[ch >> 6] |= uint64_t (1) << (ch & 63);
+        }
+        steps_.push_back (step);
+    }
+}
+
 bool slk::glob_pattern_t::match (const unsigned char *data, size_t size) const
 {
     if (!_valid)
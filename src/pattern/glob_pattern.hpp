@@ -6,6 +6,7 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
 #include <serverlink/serverlink_export.h>
 #include "../util/macros.hpp"
 
@@ -45,6 +46,21 @@ class SL_EXPORT glob_pattern_t
     // Check if pattern is valid (compiled successfully)
     bool is_valid () const { return _valid; }
 
+    // Compiled form for automaton builders (see pattern_trie_t). Each step
+    // is either a star or the set of bytes it accepts; consecutive stars
+    // are collapsed into one
+    struct step_t
+    {
+        bool star;
+        uint64_t bits[4];
+
+        bool test (unsigned char ch) const
+        {
+            return (bits[ch >> 6] >> (ch & 63)) & 1;
+        }
+    };
+    void steps (std::vector<step_t> &steps_) const;
+
   private:
     // Pattern segment types
     enum segment_type_t
@@ -2,21 +2,86 @@
 /* ServerLink - Pattern trie for efficient pattern matching */
 
 #include "pattern_trie.hpp"
+#include "../util/err.hpp"
 #include <algorithm>
 #include <cstring>
+#include <stdexcept>
+#include <thread>
 
-slk::pattern_trie_t::pattern_entry_t::pattern_entry_t (const std::string &pat) :
-    pattern_str (pat), refcount (1)
+struct slk::pattern_trie_t::node_t
 {
-    matcher.reset (new glob_pattern_t (pat));
+    typedef std::pair<unsigned char, node_t *> literal_edge_t;
+
+    struct class_edge_t
+    {
+        glob_pattern_t::step_t step;
+        node_t *child;
+    };
+
+    // Edges on a single byte, sorted by byte
+    std::vector<literal_edge_t> literals;
+
+    // Edges on a set of bytes ('?' and '[...]')
+    std::vector<class_edge_t> classes;
+
+    // Child reached through '*'. It is active whenever this node is
+    node_t *star;
+
+    // True for star children: the node consumes any byte and stays active
+    bool loop;
+
+    // Patterns ending here. Different strings can compile to the same
+    // steps, e.g. "[a]" and "a"
+    std::vector<std::string> accepts;
+
+    explicit node_t (bool loop_) : star (NULL), loop (loop_) {}
+
+    bool empty () const
+    {
+        return literals.empty () && classes.empty () && !star
+               && accepts.empty ();
+    }
+};
+
+namespace
+{
+bool is_literal (const slk::glob_pattern_t::step_t &step_, unsigned char *ch_)
+{
+    if (step_.star)
+        return false;
+
+    int bits = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (step_.bits[i]) {
+            // More than one bit set in this word or in an earlier one
+            if (bits || (step_.bits[i] & (step_.bits[i] - 1)))
+                return false;
+            bits = 1;
+            for (unsigned b = 0; b < 64; ++b)
+                if ((step_.bits[i] >> b) & 1)
+                    *ch_ = static_cast<unsigned char> (i * 64 + b);
+        }
+    }
+    return bits == 1;
 }
 
-slk::pattern_trie_t::pattern_trie_t ()
+bool same_class (const slk::glob_pattern_t::step_t &a_,
+                 const slk::glob_pattern_t::step_t &b_)
 {
+    return memcmp (a_.bits, b_.bits, sizeof a_.bits) == 0;
+}
+}
+
+slk::pattern_trie_t::pattern_trie_t () :
+    _root (NULL), _epoch (0), _num_patterns (0)
+{
+    _readers[0].store (0);
+    _readers[1].store (0);
 }
 
 slk::pattern_trie_t::~pattern_trie_t ()
 {
+    destroy (_root.load ());
 }
 
 bool slk::pattern_trie_t::add (const std::string &pattern)
@@ -24,21 +89,29 @@ bool slk::pattern_trie_t::add (const std::string &pattern)
     std::lock_guard<std::mutex> lock (_mutex);
 
     // Check if pattern already exists
-    auto it = find_pattern (pattern);
+    const std::map<std::string, uint32_t>::iterator it =
+      _patterns.find (pattern);
     if (it != _patterns.end ()) {
         // Pattern exists, increment refcount
-        it->refcount++;
+        it->second++;
         return false;
     }
 
-    // Add new pattern
+    steps_t steps;
     try {
-        _patterns.push_back (pattern_entry_t (pattern));
-        return true;
+        const glob_pattern_t matcher (pattern);
+        matcher.steps (steps);
     } catch (const std::exception &) {
         // Pattern compilation failed
         return false;
     }
+
+    std::vector<const node_t *> retired;
+    node_t *root = insert (_root.load (), steps, 0, false, pattern, retired);
+    _patterns.insert (std::make_pair (pattern, 1u));
+    _num_patterns.store (_patterns.size ());
+    publish (root, retired);
+    return true;
 }
 
 bool slk::pattern_trie_t::add (const unsigned char *pattern, size_t size)
@@ -51,19 +124,27 @@ bool slk::pattern_trie_t::rm (const std::string &pattern)
 {
     std::lock_guard<std::mutex> lock (_mutex);
 
-    auto it = find_pattern (pattern);
+    const std::map<std::string, uint32_t>::iterator it =
+      _patterns.find (pattern);
     if (it == _patterns.end ()) {
         return false;
     }
 
-    // Decrement refcount
-    it->refcount--;
-
-    // Remove if refcount reaches zero
-    if (it->refcount == 0) {
-        _patterns.erase (it);
+    // Remove from the automaton once refcount reaches zero
+    if (--it->second > 0) {
+        return true;
     }
+    _patterns.erase (it);
+    _num_patterns.store (_patterns.size ());
 
+    // Only valid patterns are ever stored, so this cannot throw
+    steps_t steps;
+    const glob_pattern_t matcher (pattern);
+    matcher.steps (steps);
+
+    std::vector<const node_t *> retired;
+    node_t *root = remove (_root.load (), steps, 0, pattern, retired);
+    publish (root, retired);
     return true;
 }
 
@@ -75,16 +156,11 @@ bool slk::pattern_trie_t::rm (const unsigned char *pattern, size_t size)
 
 bool slk::pattern_trie_t::check (const unsigned char *data, size_t size) const
 {
-    std::lock_guard<std::mutex> lock (_mutex);
-
-    // Check against all patterns
-    for (const auto &entry : _patterns) {
-        if (entry.matcher && entry.matcher->match (data, size)) {
-            return true;
-        }
-    }
-
-    return false;
+    const unsigned idx = enter ();
+    const node_t *root = _root.load ();
+    const bool matched = root && run (root, data, size, NULL, NULL);
+    leave (idx);
+    return matched;
 }
 
 bool slk::pattern_trie_t::check (const std::string &str) const
@@ -92,10 +168,31 @@ bool slk::pattern_trie_t::check (const std::string &str) const
     return check (reinterpret_cast<const unsigned char *> (str.data ()), str.size ());
 }
 
-size_t slk::pattern_trie_t::num_patterns () const
+void slk::pattern_trie_t::match (
+  const unsigned char *data,
+  size_t size,
+  void (*func) (const std::string &pattern, void *arg),
+  void *arg) const
+{
+    const unsigned idx = enter ();
+    const node_t *root = _root.load ();
+    if (root)
+        run (root, data, size, func, arg);
+    leave (idx);
+}
+
+bool slk::pattern_trie_t::contains (const unsigned char *pattern,
+                                    size_t size) const
 {
+    std::string pattern_str (reinterpret_cast<const char *> (pattern), size);
+
     std::lock_guard<std::mutex> lock (_mutex);
-    return _patterns.size ();
+    return _patterns.find (pattern_str) != _patterns.end ();
+}
+
+size_t slk::pattern_trie_t::num_patterns () const
+{
+    return _num_patterns.load ();
 }
 
 void slk::pattern_trie_t::apply (
@@ -103,25 +200,242 @@ void slk::pattern_trie_t::apply (
 {
     std::lock_guard<std::mutex> lock (_mutex);
 
-    for (const auto &entry : _patterns) {
-        func (entry.pattern_str, arg);
+    for (std::map<std::string, uint32_t>::const_iterator
+           it = _patterns.begin (),
+           end = _patterns.end ();
+         it != end; ++it) {
+        func (it->first, arg);
     }
 }
 
-std::vector<slk::pattern_trie_t::pattern_entry_t>::iterator
-slk::pattern_trie_t::find_pattern (const std::string &pattern)
+slk::pattern_trie_t::node_t *
+slk::pattern_trie_t::insert (const node_t *node_,
+                             const steps_t &steps_,
+                             size_t pos_,
+                             bool loop_,
+                             const std::string &pattern_,
+                             std::vector<const node_t *> &retired_)
 {
-    return std::find_if (_patterns.begin (), _patterns.end (),
-                         [&pattern] (const pattern_entry_t &entry) {
-                             return entry.pattern_str == pattern;
-                         });
+    node_t *copy = node_ ? new node_t (*node_) : new node_t (loop_);
+    if (node_)
+        retired_.push_back (node_);
+
+    if (pos_ == steps_.size ()) {
+        copy->accepts.push_back (pattern_);
+        return copy;
+    }
+
+    const glob_pattern_t::step_t &step = steps_[pos_];
+    unsigned char ch;
+    if (step.star) {
+        copy->star =
+          insert (copy->star, steps_, pos_ + 1, true, pattern_, retired_);
+    } else if (is_literal (step, &ch)) {
+        std::vector<node_t::literal_edge_t>::iterator it =
+          std::lower_bound (copy->literals.begin (), copy->literals.end (),
+                            node_t::literal_edge_t (ch, NULL));
+        if (it == copy->literals.end () || it->first != ch)
+            it = copy->literals.insert (it, node_t::literal_edge_t (ch, NULL));
+        it->second =
+          insert (it->second, steps_, pos_ + 1, false, pattern_, retired_);
+    } else {
+        std::vector<node_t::class_edge_t>::iterator it =
+          copy->classes.begin ();
+        while (it != copy->classes.end () && !same_class (it->step, step))
+            ++it;
+        if (it == copy->classes.end ()) {
+            const node_t::class_edge_t edge = {step, NULL};
+            it = copy->classes.insert (it, edge);
+        }
+        it->child =
+          insert (it->child, steps_, pos_ + 1, false, pattern_, retired_);
+    }
+    return copy;
+}
+
+slk::pattern_trie_t::node_t *
+slk::pattern_trie_t::remove (const node_t *node_,
+                             const steps_t &steps_,
+                             size_t pos_,
+                             const std::string &pattern_,
+                             std::vector<const node_t *> &retired_)
+{
+    slk_assert (node_);
+    node_t *copy = new node_t (*node_);
+    retired_.push_back (node_);
+
+    if (pos_ == steps_.size ()) {
+        const std::vector<std::string>::iterator it =
+          std::find (copy->accepts.begin (), copy->accepts.end (), pattern_);
+        slk_assert (it != copy->accepts.end ());
+        copy->accepts.erase (it);
+    } else {
+        const glob_pattern_t::step_t &step = steps_[pos_];
+        unsigned char ch;
+        if (step.star) {
+            copy->star =
+              remove (copy->star, steps_, pos_ + 1, pattern_, retired_);
+        } else if (is_literal (step, &ch)) {
+            const std::vector<node_t::literal_edge_t>::iterator it =
+              std::lower_bound (copy->literals.begin (),
+                                copy->literals.end (),
+                                node_t::literal_edge_t (ch, NULL));
+            slk_assert (it != copy->literals.end () && it->first == ch);
+            it->second =
+              remove (it->second, steps_, pos_ + 1, pattern_, retired_);
+            if (!it->second)
+                copy->literals.erase (it);
+        } else {
+            std::vector<node_t::class_edge_t>::iterator it =
+              copy->classes.begin ();
+            while (it != copy->classes.end () && !same_class (it->step, step))
+                ++it;
+            slk_assert (it != copy->classes.end ());
+            it->child = remove (it->child, steps_, pos_ + 1, pattern_, retired_);
+            if (!it->child)
+                copy->classes.erase (it);
+        }
+    }
+
+    // The copy was never published, so it can go right away
+    if (copy->empty ()) {
+        delete copy;
+        return NULL;
+    }
+    return copy;
+}
+
+namespace
+{
+// node_t is private to pattern_trie_t, so the sets hold untyped pointers
+typedef std::vector<const void *> states_t;
+
+// Scratch state sets, reused across calls on the same thread. run()
+// swaps them out while it works, so a nested call gets fresh ones
+thread_local states_t current_states;
+thread_local states_t next_states;
 }
 
-std::vector<slk::pattern_trie_t::pattern_entry_t>::const_iterator
-slk::pattern_trie_t::find_pattern (const std::string &pattern) const
+bool slk::pattern_trie_t::run (
+  const node_t *root_,
+  const unsigned char *data_,
+  size_t size_,
+  void (*func_) (const std::string &pattern, void *arg),
+  void *arg_)
 {
-    return std::find_if (_patterns.begin (), _patterns.end (),
-                         [&pattern] (const pattern_entry_t &entry) {
-                             return entry.pattern_str == pattern;
-                         });
+    states_t current, next;
+    current.swap (current_states);
+    next.swap (next_states);
+    current.clear ();
+
+    // Entering a node also enters its star child
+    current.push_back (root_);
+    if (root_->star)
+        current.push_back (root_->star);
+
+    for (size_t i = 0; i < size_ && !current.empty (); ++i) {
+        const unsigned char ch = data_[i];
+        next.clear ();
+
+        for (states_t::const_iterator it = current.begin (),
+                                      end = current.end ();
+             it != end; ++it) {
+            const node_t *node = static_cast<const node_t *> (*it);
+            if (node->loop)
+                next.push_back (node);
+
+            const std::vector<node_t::literal_edge_t>::const_iterator lit =
+              std::lower_bound (node->literals.begin (), node->literals.end (),
+                                node_t::literal_edge_t (ch, NULL));
+            if (lit != node->literals.end () && lit->first == ch) {
+                next.push_back (lit->second);
+                if (lit->second->star)
+                    next.push_back (lit->second->star);
+            }
+
+            for (std::vector<node_t::class_edge_t>::const_iterator
+                   cls = node->classes.begin (),
+                   cls_end = node->classes.end ();
+                 cls != cls_end; ++cls) {
+                if (cls->step.test (ch)) {
+                    next.push_back (cls->child);
+                    if (cls->child->star)
+                        next.push_back (cls->child->star);
+                }
+            }
+        }
+
+        // Patterns sharing a star reach the same nodes on several paths
+        if (next.size () > 1) {
+            std::sort (next.begin (), next.end ());
+            next.erase (std::unique (next.begin (), next.end ()), next.end ());
+        }
+        current.swap (next);
+    }
+
+    bool matched = false;
+    for (states_t::const_iterator it = current.begin (), end = current.end ();
+         it != end; ++it) {
+        const node_t *node = static_cast<const node_t *> (*it);
+        if (node->accepts.empty ())
+            continue;
+        matched = true;
+        if (!func_)
+            break;
+        for (std::vector<std::string>::const_iterator
+               pattern = node->accepts.begin (),
+               pattern_end = node->accepts.end ();
+             pattern != pattern_end; ++pattern)
+            func_ (*pattern, arg_);
+    }
+
+    current.swap (current_states);
+    next.swap (next_states);
+    return matched;
+}
+
+void slk::pattern_trie_t::destroy (const node_t *node_)
+{
+    if (!node_)
+        return;
+    for (size_t i = 0; i < node_->literals.size (); ++i)
+        destroy (node_->literals[i].second);
+    for (size_t i = 0; i < node_->classes.size (); ++i)
+        destroy (node_->classes[i].child);
+    destroy (node_->star);
+    delete node_;
+}
+
+void slk::pattern_trie_t::publish (node_t *root_,
+                                   std::vector<const node_t *> &retired_)
+{
+    _root.store (root_);
+    synchronize ();
+
+    // Replaced nodes only; their untouched children live on in root_
+    for (size_t i = 0; i < retired_.size (); ++i)
+        delete retired_[i];
+}
+
+unsigned slk::pattern_trie_t::enter () const
+{
+    const unsigned idx = _epoch.load () & 1;
+    _readers[idx].fetch_add (1);
+    return idx;
+}
+
+void slk::pattern_trie_t::leave (unsigned idx_) const
+{
+    _readers[idx_].fetch_sub (1);
+}
+
+void slk::pattern_trie_t::synchronize ()
+{
+    // Flip the epoch and drain the readers of the previous one, twice: a
+    // reader may have sampled the old epoch right before the first flip
+    for (int phase = 0; phase < 2; ++phase) {
+        const unsigned idx = _epoch.fetch_add (1) & 1;
+        while (_readers[idx].load () != 0)
+            std::this_thread::yield ();
+    }
 }
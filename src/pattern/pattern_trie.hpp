@@ -4,9 +4,10 @@
 #ifndef SL_PATTERN_TRIE_HPP_INCLUDED
 #define SL_PATTERN_TRIE_HPP_INCLUDED
 
+#include <atomic>
+#include <map>
 #include <string>
 #include <vector>
-#include <memory>
 #include <mutex>
 #include <serverlink/serverlink_export.h>
 #include "glob_pattern.hpp"
@@ -14,10 +15,22 @@
 
 namespace slk
 {
-// Thread-safe trie for storing and matching glob patterns
-// Uses std::shared_mutex for reader-writer lock pattern
-// - Multiple threads can check patterns concurrently (shared lock)
-// - Pattern add/remove operations use exclusive lock
+// Set of glob patterns compiled into one shared-prefix automaton
+//
+// Every pattern is split into steps (glob_pattern_t::steps) and inserted
+// into a trie whose edges are single bytes, byte classes ('?', '[...]')
+// or a star. Matching runs the trie as an NFA over the data, so its cost
+// depends on the data length and the number of live states, not on the
+// number of patterns.
+//
+// Thread safety:
+// - check and match are lock-free. They read an immutable version of
+//   the trie published through an atomic root pointer
+// - add and rm are serialised by a mutex. They build a new version by
+//   copying the path they change, publish it, and free the replaced
+//   nodes once no reader can still see them (two-phase epochs, RCU-style)
+// - Writers wait for in-flight readers, so a match callback must not
+//   modify the same trie
 class SL_EXPORT pattern_trie_t
 {
   public:
@@ -26,56 +39,92 @@ class SL_EXPORT pattern_trie_t
 
     // Add a glob pattern to the trie
     // Returns true if pattern was newly added, false if it already existed
-    // Thread-safe: uses exclusive lock
+    // or is not a valid pattern
     bool add (const std::string &pattern);
     bool add (const unsigned char *pattern, size_t size);
 
     // Remove a glob pattern from the trie
     // Returns true if pattern was removed, false if it didn't exist
-    // Thread-safe: uses exclusive lock
     bool rm (const std::string &pattern);
     bool rm (const unsigned char *pattern, size_t size);
 
     // Check if data matches any stored pattern
     // Returns true if at least one pattern matches
-    // Thread-safe: uses shared lock (multiple readers allowed)
     bool check (const unsigned char *data, size_t size) const;
     bool check (const std::string &str) const;
 
+    // Call func for every stored pattern that matches data
+    void match (const unsigned char *data,
+                size_t size,
+                void (*func) (const std::string &pattern, void *arg),
+                void *arg) const;
+
+    // Check whether the exact pattern string is stored
+    bool contains (const unsigned char *pattern, size_t size) const;
+
     // Get number of patterns stored
-    // Thread-safe: uses shared lock
     size_t num_patterns () const;
 
     // Apply a function to all patterns
-    // Thread-safe: uses shared lock
     // func(pattern_string, arg)
     void apply (void (*func) (const std::string &pattern, void *arg),
                 void *arg) const;
 
   private:
-    // Pattern entry with compiled matcher
-    struct pattern_entry_t
-    {
-        std::string pattern_str;
-        std::unique_ptr<glob_pattern_t> matcher;
-        uint32_t refcount; // For duplicate tracking
-
-        pattern_entry_t (const std::string &pat);
-    };
-
-    // Storage for patterns
-    std::vector<pattern_entry_t> _patterns;
-
-    // Mutex for thread safety
-    // Using regular mutex (C++11 compatible)
-    // For C++17, we would use std::shared_mutex for better read concurrency
+    struct node_t;
+    typedef std::vector<glob_pattern_t::step_t> steps_t;
+
+    // Build a copy of node_ with pattern_ added below it. Replaced nodes
+    // are appended to retired_
+    static node_t *insert (const node_t *node_,
+                           const steps_t &steps_,
+                           size_t pos_,
+                           bool loop_,
+                           const std::string &pattern_,
+                           std::vector<const node_t *> &retired_);
+
+    // Build a copy of node_ with pattern_ removed below it. Returns NULL
+    // if nothing is left
+    static node_t *remove (const node_t *node_,
+                           const steps_t &steps_,
+                           size_t pos_,
+                           const std::string &pattern_,
+                           std::vector<const node_t *> &retired_);
+
+    // Run the automaton over data. With func_ set, report every matching
+    // pattern; otherwise stop at the first one
+    static bool run (const node_t *root_,
+                     const unsigned char *data_,
+                     size_t size_,
+                     void (*func_) (const std::string &pattern, void *arg),
+                     void *arg_);
+
+    static void destroy (const node_t *node_);
+
+    // Publish a new root and free the nodes it replaced
+    void publish (node_t *root_, std::vector<const node_t *> &retired_);
+
+    // Reader registration for the epoch scheme
+    unsigned enter () const;
+    void leave (unsigned idx_) const;
+
+    // Wait until no reader can still observe a replaced version
+    void synchronize ();
+
+    // Current version of the automaton, NULL when empty
+    std::atomic<node_t *> _root;
+
+    // Reader epochs: readers count themselves in the slot of the current
+    // epoch's parity
+    mutable std::atomic<unsigned> _epoch;
+    mutable std::atomic<int> _readers[2];
+
+    std::atomic<size_t> _num_patterns;
+
+    // Writer side: stored patterns with their reference counts
+    std::map<std::string, uint32_t> _patterns;
     mutable std::mutex _mutex;
 
-    // Find pattern by string (caller must hold lock)
-    std::vector<pattern_entry_t>::iterator find_pattern (const std::string &pattern);
-    std::vector<pattern_entry_t>::const_iterator
-    find_pattern (const std::string &pattern) const;
-
     SL_NON_COPYABLE_NOR_MOVABLE (pattern_trie_t)
 };
 
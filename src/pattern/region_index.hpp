@@ -0,0 +1,354 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Spatial index of area-of-interest subscriptions */
+
+#ifndef SL_REGION_INDEX_HPP_INCLUDED
+#define SL_REGION_INDEX_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../protocol/wire.hpp"
+#include "../util/macros.hpp"
+
+namespace slk
+{
+// Inclusive rectangle of cells on a grid
+struct region_t
+{
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+
+    bool contains (int32_t x_, int32_t y_) const
+    {
+        return x_ >= x0 && x_ <= x1 && y_ >= y0 && y_ <= y1;
+    }
+
+    bool operator== (const region_t &) const = default;
+};
+
+// A region subscription carries the grid name followed by x0, y0, x1 and
+// y1 as 32-bit big-endian integers
+static const size_t region_wire_size = 16;
+
+inline void encode_region (unsigned char *buf_, const region_t &region_)
+{
+    put_uint32 (buf_, static_cast<uint32_t> (region_.x0));
+    put_uint32 (buf_ + 4, static_cast<uint32_t> (region_.y0));
+    put_uint32 (buf_ + 8, static_cast<uint32_t> (region_.x1));
+    put_uint32 (buf_ + 12, static_cast<uint32_t> (region_.y1));
+}
+
+// Split a region subscription into grid name and rectangle. Fails on
+// short data and on empty rectangles
+inline bool decode_region (const unsigned char *data_,
+                           size_t size_,
+                           std::string_view &grid_,
+                           region_t &region_)
+{
+    if (size_ < region_wire_size)
+        return false;
+
+    const unsigned char *rect = data_ + size_ - region_wire_size;
+    region_.x0 = static_cast<int32_t> (get_uint32 (rect));
+    region_.y0 = static_cast<int32_t> (get_uint32 (rect + 4));
+    region_.x1 = static_cast<int32_t> (get_uint32 (rect + 8));
+    region_.y1 = static_cast<int32_t> (get_uint32 (rect + 12));
+    if (region_.x0 > region_.x1 || region_.y0 > region_.y1)
+        return false;
+
+    grid_ = std::string_view (reinterpret_cast<const char *> (data_),
+                              size_ - region_wire_size);
+    return true;
+}
+
+// Parse a cell topic, "<grid>:<x>,<y>" with decimal coordinates. The
+// grid name may itself contain colons
+inline bool parse_cell (const unsigned char *data_,
+                        size_t size_,
+                        std::string_view &grid_,
+                        int32_t &x_,
+                        int32_t &y_)
+{
+    const char *begin = reinterpret_cast<const char *> (data_);
+    const char *end = begin + size_;
+
+    const char *colon = end;
+    while (colon != begin && *(colon - 1) != ':')
+        colon--;
+    if (colon == begin)
+        return false;
+
+    const char *pos = colon;
+    int32_t *coords[2] = {&x_, &y_};
+    for (int i = 0; i < 2; i++) {
+        if (i == 1) {
+            if (pos == end || *pos != ',')
+                return false;
+            pos++;
+        }
+        const bool negative = pos != end && *pos == '-';
+        if (negative)
+            pos++;
+        const char *digits = pos;
+        int64_t value = 0;
+        while (pos != end && *pos >= '0' && *pos <= '9' && pos - digits < 10)
+            value = value * 10 + (*pos++ - '0');
+        if (pos == digits)
+            return false;
+        if (negative)
+            value = -value;
+        if (value < INT32_MIN || value > INT32_MAX)
+            return false;
+        *coords[i] = static_cast<int32_t> (value);
+    }
+    if (pos != end)
+        return false;
+
+    grid_ = std::string_view (begin, colon - 1 - begin);
+    return true;
+}
+
+// Areas of interest of subscribers on named grids, one rectangle per
+// subscriber and grid.
+//
+// Every rectangle is listed in each fixed-size tile it overlaps, so
+// matching a cell only looks at the rectangles of its own tile. Moving a
+// rectangle only touches the tiles it leaves or enters. Rectangles that
+// span too many tiles are kept aside and checked on every match.
+template <typename T> class region_index_t
+{
+  public:
+    region_index_t () : _count (0) {}
+
+    // Set the region of owner_ on grid_, moving it if it has one already.
+    // Returns false if it was already set to exactly this rectangle.
+    bool set (std::string_view grid_, const region_t &region_, T *owner_)
+    {
+        typename grids_t::iterator git = _grids.find (grid_);
+        if (git == _grids.end ())
+            git = _grids.emplace (std::string (grid_), grid_t ()).first;
+        grid_t &grid = git->second;
+
+        const typename regions_t::iterator it = grid.regions.find (owner_);
+        if (it == grid.regions.end ()) {
+            grid.regions.emplace (owner_, region_);
+            insert (grid, region_, owner_);
+            _count++;
+            return true;
+        }
+        if (it->second == region_)
+            return false;
+
+        move (grid, it->second, region_, owner_);
+        it->second = region_;
+        return true;
+    }
+
+    // Remove the region of owner_ on grid_. Returns true if it had one
+    bool rm (std::string_view grid_, T *owner_)
+    {
+        const typename grids_t::iterator git = _grids.find (grid_);
+        if (git == _grids.end ())
+            return false;
+        const bool removed = rm (git->second, owner_);
+        if (git->second.regions.empty ())
+            _grids.erase (git);
+        return removed;
+    }
+
+    // Remove every region of owner_, calling func_ for each grid nobody
+    // has a region on anymore
+    template <typename Arg>
+    void rm (T *owner_,
+             void (*func_) (const std::string &grid_, Arg arg_),
+             Arg arg_)
+    {
+        for (typename grids_t::iterator git = _grids.begin ();
+             git != _grids.end ();) {
+            if (rm (git->second, owner_) && git->second.regions.empty ()) {
+                func_ (git->first, arg_);
+                _grids.erase (git++);
+            } else
+                ++git;
+        }
+    }
+
+    // Call func_ for every owner whose region on grid_ contains the cell
+    template <typename Arg>
+    void match (std::string_view grid_,
+                int32_t x_,
+                int32_t y_,
+                void (*func_) (T *owner_, Arg arg_),
+                Arg arg_) const
+    {
+        const typename grids_t::const_iterator git = _grids.find (grid_);
+        if (git == _grids.end ())
+            return;
+        const grid_t &grid = git->second;
+
+        const typename tiles_t::const_iterator tit =
+          grid.tiles.find (tile_key (x_ >> tile_shift, y_ >> tile_shift));
+        if (tit != grid.tiles.end ())
+            for (size_t i = 0; i < tit->second.size (); i++)
+                if (grid.regions.find (tit->second[i])->second.contains (x_,
+                                                                          y_))
+                    func_ (tit->second[i], arg_);
+
+        for (size_t i = 0; i < grid.large.size (); i++)
+            if (grid.regions.find (grid.large[i])->second.contains (x_, y_))
+                func_ (grid.large[i], arg_);
+    }
+
+    // True if any owner has a region on grid_
+    bool has (std::string_view grid_) const
+    {
+        return _grids.find (grid_) != _grids.end ();
+    }
+
+    // Number of regions over all grids and owners
+    size_t size () const { return _count; }
+
+  private:
+    // Tiles are 16 x 16 cells
+    static const int tile_shift = 4;
+
+    // Rectangles over more tiles than this are not listed in tiles
+    static const int64_t max_tiles = 64;
+
+    typedef std::unordered_map<uint64_t, std::vector<T *> > tiles_t;
+    typedef std::map<T *, region_t> regions_t;
+
+    struct grid_t
+    {
+        regions_t regions;
+        tiles_t tiles;
+        std::vector<T *> large;
+    };
+    typedef std::map<std::string, grid_t, std::less<> > grids_t;
+
+    static uint64_t tile_key (int32_t tx_, int32_t ty_)
+    {
+        return (uint64_t (uint32_t (tx_)) << 32) | uint32_t (ty_);
+    }
+
+    // The tiles a region overlaps, inclusive
+    static region_t tiles_of (const region_t &region_)
+    {
+        const region_t tiles = {
+          region_.x0 >> tile_shift, region_.y0 >> tile_shift,
+          region_.x1 >> tile_shift, region_.y1 >> tile_shift};
+        return tiles;
+    }
+
+    static bool is_large (const region_t &tiles_)
+    {
+        return (int64_t (tiles_.x1) - tiles_.x0 + 1)
+                 * (int64_t (tiles_.y1) - tiles_.y0 + 1)
+               > max_tiles;
+    }
+
+    static void remove_from (std::vector<T *> &owners_, T *owner_)
+    {
+        for (size_t i = 0; i < owners_.size (); i++)
+            if (owners_[i] == owner_) {
+                owners_[i] = owners_.back ();
+                owners_.pop_back ();
+                return;
+            }
+    }
+
+    // Add owner_ to the tiles in tiles_ that are not in except_
+    static void add_tiles (grid_t &grid_,
+                           const region_t &tiles_,
+                           const region_t *except_,
+                           T *owner_)
+    {
+        for (int64_t tx = tiles_.x0; tx <= tiles_.x1; tx++)
+            for (int64_t ty = tiles_.y0; ty <= tiles_.y1; ty++)
+                if (!except_
+                    || !except_->contains (int32_t (tx), int32_t (ty)))
+                    grid_.tiles[tile_key (int32_t (tx), int32_t (ty))]
+                      .push_back (owner_);
+    }
+
+    // Remove owner_ from the tiles in tiles_ that are not in except_
+    static void rm_tiles (grid_t &grid_,
+                          const region_t &tiles_,
+                          const region_t *except_,
+                          T *owner_)
+    {
+        for (int64_t tx = tiles_.x0; tx <= tiles_.x1; tx++)
+            for (int64_t ty = tiles_.y0; ty <= tiles_.y1; ty++) {
+                if (except_ && except_->contains (int32_t (tx), int32_t (ty)))
+                    continue;
+                const typename tiles_t::iterator it =
+                  grid_.tiles.find (tile_key (int32_t (tx), int32_t (ty)));
+                remove_from (it->second, owner_);
+                if (it->second.empty ())
+                    grid_.tiles.erase (it);
+            }
+    }
+
+    static void insert (grid_t &grid_, const region_t &region_, T *owner_)
+    {
+        const region_t tiles = tiles_of (region_);
+        if (is_large (tiles))
+            grid_.large.push_back (owner_);
+        else
+            add_tiles (grid_, tiles, NULL, owner_);
+    }
+
+    static void erase (grid_t &grid_, const region_t &region_, T *owner_)
+    {
+        const region_t tiles = tiles_of (region_);
+        if (is_large (tiles))
+            remove_from (grid_.large, owner_);
+        else
+            rm_tiles (grid_, tiles, NULL, owner_);
+    }
+
+    // Move owner_ from its old region's tiles to the new one's, leaving
+    // the tiles both overlap alone
+    static void move (grid_t &grid_,
+                      const region_t &old_,
+                      const region_t &new_,
+                      T *owner_)
+    {
+        const region_t old_tiles = tiles_of (old_);
+        const region_t new_tiles = tiles_of (new_);
+        if (is_large (old_tiles) || is_large (new_tiles)) {
+            erase (grid_, old_, owner_);
+            insert (grid_, new_, owner_);
+            return;
+        }
+        rm_tiles (grid_, old_tiles, &new_tiles, owner_);
+        add_tiles (grid_, new_tiles, &old_tiles, owner_);
+    }
+
+    bool rm (grid_t &grid_, T *owner_)
+    {
+        const typename regions_t::iterator it = grid_.regions.find (owner_);
+        if (it == grid_.regions.end ())
+            return false;
+        erase (grid_, it->second, owner_);
+        grid_.regions.erase (it);
+        _count--;
+        return true;
+    }
+
+    grids_t _grids;
+    size_t _count;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (region_index_t)
+};
+}
+
+#endif
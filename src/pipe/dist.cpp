@@ -105,6 +105,11 @@ void slk::dist_t::pipe_terminated (pipe_t *pipe_)
 
 void slk::dist_t::activated (pipe_t *pipe_)
 {
+    // A pipe its owner found full before writing to it never left the
+    // eligible pipes.
+    if (_pipes.index (pipe_) < _eligible)
+        return;
+
     // Move the pipe from passive to eligible state.
     if (_eligible < _pipes.size ()) SL_LIKELY_ATTR {
         _pipes.swap (_pipes.index (pipe_), _eligible);
@@ -12,6 +12,10 @@
 #include "../util/ypipe.hpp"
 #include "../util/ypipe_conflate.hpp"
 #include "../util/likely.hpp"
+#ifdef SL_ENABLE_MONITORING
+#include "../util/clock.hpp"
+#include "../monitor/latency_histogram.hpp"
+#endif
 
 int slk::pipepair (object_t *parents_[2],
                    pipe_t *pipes_[2],
@@ -98,6 +102,13 @@ slk::pipe_t::pipe_t (object_t *parent_,
     _delay (true),
     _server_socket_routing_id (0),
     _conflate (conflate_)
+#ifdef SL_ENABLE_MONITORING
+    ,_sample_seq (0),
+    _sample_time (0),
+    _sample_histogram (NULL),
+    _send_histogram (NULL),
+    _recv_histogram (NULL)
+#endif
 {
     _disconnect_msg.init ();
 }
@@ -197,8 +208,12 @@ bool slk::pipe_t::read (msg_t *msg_)
         return false;
     }
 
-    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ())
+    if (!(msg_->flags () & msg_t::more) && !msg_->is_routing_id ()) {
         _msgs_read++;
+#ifdef SL_ENABLE_MONITORING
+        take_sample ();
+#endif
+    }
 
     if (_lwm > 0 && _msgs_read % _lwm == 0)
         send_activate_write (_peer, _msgs_read);
@@ -229,8 +244,18 @@ bool slk::pipe_t::write (const msg_t *msg_)
     const bool more = (msg_->flags () & msg_t::more) != 0;
     const bool is_routing_id = msg_->is_routing_id ();
     _out_pipe->write (*msg_, more);
-    if (!more && !is_routing_id)
+    if (!more && !is_routing_id) {
         _msgs_written++;
+#ifdef SL_ENABLE_MONITORING
+        //  Conflating pipes drop messages, so sequence numbers would not
+        //  line up on the reading end.
+        if (!_conflate && _sample_seq.load (std::memory_order_acquire) == 0) {
+            _sample_time = clock_t::now_us ();
+            _sample_histogram = _send_histogram;
+            _sample_seq.store (_msgs_written, std::memory_order_release);
+        }
+#endif
+    }
 
     return true;
 }
@@ -294,6 +319,13 @@ void slk::pipe_t::process_hiccup (void *pipe_)
     }
     SL_DELETE (_out_pipe);
 
+#ifdef SL_ENABLE_MONITORING
+    //  A sampled message that was just dropped will never be read. If it
+    //  was read, the peer frees the slot itself.
+    if (_sample_seq.load (std::memory_order_acquire) > _msgs_written)
+        _sample_seq.store (0, std::memory_order_relaxed);
+#endif
+
     //  Plug in the new outpipe.
     slk_assert (pipe_);
     _out_pipe = static_cast<upipe_t *> (pipe_);
@@ -557,6 +589,55 @@ const slk::endpoint_uri_pair_t &slk::pipe_t::get_endpoint_pair () const
     return _endpoint_pair;
 }
 
+void slk::pipe_t::set_heartbeat_link (
+  std::shared_ptr<heartbeat_link_t> link_)
+{
+    _heartbeat_link = SL_MOVE (link_);
+}
+
+const std::shared_ptr<slk::heartbeat_link_t> &
+slk::pipe_t::get_heartbeat_link () const
+{
+    return _heartbeat_link;
+}
+
+void slk::pipe_t::set_peer_counters (
+  std::shared_ptr<peer_counters_t> counters_)
+{
+    _peer_counters = SL_MOVE (counters_);
+}
+
+slk::peer_counters_t *slk::pipe_t::get_peer_counters () const
+{
+    return _peer_counters.get ();
+}
+
+#ifdef SL_ENABLE_MONITORING
+void slk::pipe_t::set_latency_histograms (latency_histogram_t *send_,
+                                          latency_histogram_t *recv_)
+{
+    _send_histogram = send_;
+    _recv_histogram = recv_;
+}
+
+void slk::pipe_t::take_sample ()
+{
+    const uint64_t seq = _peer->_sample_seq.load (std::memory_order_acquire);
+    if (seq == 0 || seq > _msgs_read)
+        return;
+
+    const uint64_t now = clock_t::now_us ();
+    const uint64_t elapsed =
+      now > _peer->_sample_time ? now - _peer->_sample_time : 0;
+    if (_recv_histogram)
+        _recv_histogram->record (elapsed);
+    if (_peer->_sample_histogram)
+        _peer->_sample_histogram->record (elapsed);
+
+    _peer->_sample_seq.store (0, std::memory_order_release);
+}
+#endif
+
 slk::pipe_t *slk::pipe_t::get_peer () const
 {
     return _peer;
@@ -13,6 +13,8 @@
 #include "../msg/msg.hpp"
 #include "../util/macros.hpp"
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <stdint.h>
 
@@ -21,6 +23,9 @@ namespace slk
 // Forward declarations
 class pipe_t;
 struct options_t;
+struct heartbeat_link_t;
+class peer_counters_t;
+class latency_histogram_t;
 
 //  Create a pipepair for bi-directional transfer of messages.
 //  First HWM is for messages passed from first pipe to the second pipe.
@@ -123,6 +128,22 @@ class pipe_t final : public object_t,
     void set_endpoint_pair (endpoint_uri_pair_t endpoint_pair_);
     const endpoint_uri_pair_t &get_endpoint_pair () const;
 
+    //  Heartbeat results of the connection behind this pipe, if any.
+    void set_heartbeat_link (std::shared_ptr<heartbeat_link_t> link_);
+    const std::shared_ptr<heartbeat_link_t> &get_heartbeat_link () const;
+
+    //  Traffic counters of the peer behind this pipe, if monitored.
+    void set_peer_counters (std::shared_ptr<peer_counters_t> counters_);
+    peer_counters_t *get_peer_counters () const;
+
+#ifdef SL_ENABLE_MONITORING
+    //  Histograms of the socket owning this end of the pipe, if any.
+    //  Messages written here are sampled into send_, messages read here
+    //  into recv_. Must be set before the socket uses the pipe.
+    void set_latency_histograms (latency_histogram_t *send_,
+                                 latency_histogram_t *recv_);
+#endif
+
     void send_stats_to_peer (own_t *socket_base_);
 
     void send_disconnect_msg ();
@@ -243,9 +264,33 @@ class pipe_t final : public object_t,
     // The endpoints of this pipe.
     endpoint_uri_pair_t _endpoint_pair;
 
+    // Shared with the session that feeds this pipe.
+    std::shared_ptr<heartbeat_link_t> _heartbeat_link;
+
+    // Shared with the socket's connection manager.
+    std::shared_ptr<peer_counters_t> _peer_counters;
+
     // Disconnect msg
     msg_t _disconnect_msg;
 
+#ifdef SL_ENABLE_MONITORING
+    //  Latency sampling. One message per direction is timed at a time:
+    //  the writer stamps a complete message in its own slot, keyed by its
+    //  sequence number, and the reader on the peer end records the
+    //  elapsed time once it has read that many messages, then frees the
+    //  slot. Time and histogram are published by the release store of
+    //  the sequence number, which is 0 while the slot is free.
+    std::atomic<uint64_t> _sample_seq;
+    uint64_t _sample_time;
+    latency_histogram_t *_sample_histogram;
+
+    latency_histogram_t *_send_histogram;
+    latency_histogram_t *_recv_histogram;
+
+    //  Called by the reader after each complete message.
+    void take_sample ();
+#endif
+
     SL_NON_COPYABLE_NOR_MOVABLE (pipe_t)
 };
 
@@ -94,6 +94,12 @@ class decoder_base_t : public i_decoder
             return 0;
         }
 
+        // A fresh read into our own buffer tells the allocator how busy
+        // the connection is.
+        if (data == m_buf) {
+            m_allocator.observe_read(size);
+        }
+
         while (bytes_used < size) {
             // Copy the data from buffer to the message.
             // Use parentheses around std::min to avoid Windows min/max macro conflict
@@ -4,19 +4,41 @@
 #include "../msg/msg.hpp"
 #include "../util/atomic_counter.hpp"
 #include "../util/err.hpp"
+#include "../util/slab_allocator.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <new>
 
 namespace slk
 {
 
+namespace
+{
+// Reads in a row that must use little of the peak size before it halves.
+const unsigned int shrink_after_reads = 8;
+
+// Largest ZMTP frame header, so a grown buffer holds the frame in one piece.
+const std::size_t max_frame_header = 9;
+
+std::size_t counters_for(std::size_t bufsize)
+{
+    return (bufsize + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size;
+}
+}
+
 shared_message_memory_allocator::shared_message_memory_allocator(
     std::size_t bufsize)
     : m_buf(nullptr),
       m_buf_size(0),
+      m_capacity(bufsize),
+      m_target(bufsize),
+      m_min_size(bufsize),
       m_max_size(bufsize),
       m_msg_content(nullptr),
-      m_max_counters((m_max_size + msg_t::max_vsm_size - 1) / msg_t::max_vsm_size)
+      m_max_counters(counters_for(bufsize)),
+      m_fixed_counters(false),
+      m_peak(bufsize),
+      m_sparse_reads(0)
 {
 }
 
@@ -25,9 +47,15 @@ shared_message_memory_allocator::shared_message_memory_allocator(
     std::size_t max_messages)
     : m_buf(nullptr),
       m_buf_size(0),
+      m_capacity(bufsize),
+      m_target(bufsize),
+      m_min_size(bufsize),
       m_max_size(bufsize),
       m_msg_content(nullptr),
-      m_max_counters(max_messages)
+      m_max_counters(max_messages),
+      m_fixed_counters(true),
+      m_peak(bufsize),
+      m_sparse_reads(0)
 {
 }
 
@@ -48,17 +76,27 @@ unsigned char* shared_message_memory_allocator::allocate()
         if (c->sub(1)) {
             // Buffer is still in use as message data. "Release" it and create a new one
             release();
+        } else if (m_capacity != m_target) {
+            // Unused, but the wrong size for the traffic we are seeing
+            c->~atomic_counter_t();
+            slab_free(m_buf);
+            clear();
         }
     }
 
     // If buf != nullptr it is not used by any message so we can re-use it for the next run
     if (!m_buf) {
+        m_capacity = m_target;
+        if (!m_fixed_counters) {
+            m_max_counters = counters_for(m_capacity);
+        }
+
         // Allocate memory for reference counter together with reception buffer
         std::size_t const allocationsize =
-            m_max_size + sizeof(atomic_counter_t) +
+            m_capacity + sizeof(atomic_counter_t) +
             m_max_counters * sizeof(msg_t::content_t);
 
-        m_buf = static_cast<unsigned char*>(std::malloc(allocationsize));
+        m_buf = static_cast<unsigned char*>(slab_alloc(allocationsize));
         alloc_assert(m_buf);
 
         new (m_buf) atomic_counter_t(1);
@@ -68,9 +106,9 @@ unsigned char* shared_message_memory_allocator::allocate()
         c->set(1);
     }
 
-    m_buf_size = m_max_size;
+    m_buf_size = m_capacity;
     m_msg_content = reinterpret_cast<msg_t::content_t*>(
-        m_buf + sizeof(atomic_counter_t) + m_max_size);
+        m_buf + sizeof(atomic_counter_t) + m_capacity);
 
     return m_buf + sizeof(atomic_counter_t);
 }
@@ -81,7 +119,7 @@ void shared_message_memory_allocator::deallocate()
         atomic_counter_t* c = reinterpret_cast<atomic_counter_t*>(m_buf);
         if (!c->sub(1)) {
             c->~atomic_counter_t();
-            std::free(m_buf);
+            slab_free(m_buf);
         }
     }
     clear();
@@ -114,8 +152,58 @@ void shared_message_memory_allocator::call_dec_ref(void* /*data*/, void* hint)
 
     if (!c->sub(1)) {
         c->~atomic_counter_t();
-        std::free(buf);
+        slab_free(buf);
+    }
+}
+
+void shared_message_memory_allocator::set_max_size(std::size_t max_size)
+{
+    if (!m_fixed_counters) {
+        m_max_size = (std::max)(max_size, m_min_size);
+    }
+}
+
+void shared_message_memory_allocator::observe_read(std::size_t bytes)
+{
+    if (bytes >= m_capacity) {
+        // The socket had more queued than we could take in one read; go
+        // straight back to what the last bursts needed
+        m_sparse_reads = 0;
+        grow((std::max)(m_capacity * 2, m_peak));
+        return;
+    }
+
+    // Nothing was queued behind this read, so the connection is idle until
+    // the next one arrives; wait for it in the smallest buffer
+    m_target = m_min_size;
+
+    if (bytes <= m_peak / 4) {
+        if (++m_sparse_reads >= shrink_after_reads) {
+            m_sparse_reads = 0;
+            m_peak = (std::max)(m_peak / 2, m_min_size);
+        }
+    } else {
+        m_sparse_reads = 0;
+    }
+}
+
+void shared_message_memory_allocator::observe_message(std::size_t msg_size)
+{
+    // Messages beyond the limit are read straight into their own storage
+    // anyway, so growing for them would only waste memory.
+    if (msg_size + max_frame_header <= m_max_size) {
+        grow(msg_size + max_frame_header);
+    }
+}
+
+void shared_message_memory_allocator::grow(std::size_t wanted)
+{
+    std::size_t target = m_target;
+    while (target < wanted && target < m_max_size) {
+        target *= 2;
     }
+    m_target = (std::min)(target, m_max_size);
+    m_peak = (std::max)(m_peak, m_target);
 }
 
 std::size_t shared_message_memory_allocator::size() const
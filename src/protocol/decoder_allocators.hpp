@@ -50,6 +50,15 @@ class c_single_allocator
         // No-op
     }
 
+    // The buffer never adapts to the traffic
+    void observe_read(std::size_t /*bytes*/)
+    {
+    }
+
+    void observe_message(std::size_t /*msg_size*/)
+    {
+    }
+
   private:
     std::size_t m_buf_size;
     unsigned char* m_buf;
@@ -65,6 +74,15 @@ class c_single_allocator
 // The buffer is allocated with a reference count of 1 to ensure it stays alive while
 // decoding messages. The buffer may be allocated longer than necessary because it is
 // only deleted when allocate is called the next time.
+//
+// Once given a growth limit, the buffer adapts to the traffic: it doubles when
+// a read fills it completely or a message does not fit, up to the largest size
+// a recent burst needed. A read that leaves room in the buffer has drained the
+// socket, so the engine waits for more data in a buffer of the initial size
+// and idle connections hold no more memory than that. The size recent bursts
+// needed halves after a run of reads that use only a fraction of it. The new
+// size takes effect the next time a buffer is allocated, which the engine does
+// right before each read.
 class shared_message_memory_allocator
 {
   public:
@@ -108,6 +126,16 @@ class shared_message_memory_allocator
         m_buf_size = new_size;
     }
 
+    // Let the buffer grow up to max_size bytes. Allocators created for a
+    // fixed number of messages never grow.
+    void set_max_size(std::size_t max_size);
+
+    // Report how many bytes a read placed into the current buffer.
+    void observe_read(std::size_t bytes);
+
+    // Report a message that did not fit into the remaining buffer.
+    void observe_message(std::size_t msg_size);
+
     msg_t::content_t* provide_content()
     {
         return m_msg_content;
@@ -120,12 +148,23 @@ class shared_message_memory_allocator
 
   private:
     void clear();
+    void grow(std::size_t wanted);
 
     unsigned char* m_buf;
     std::size_t m_buf_size;
-    const std::size_t m_max_size;
+    // Capacity of the current buffer and of the next one to allocate.
+    std::size_t m_capacity;
+    std::size_t m_target;
+    const std::size_t m_min_size;
+    std::size_t m_max_size;
     msg_t::content_t* m_msg_content;
     std::size_t m_max_counters;
+    const bool m_fixed_counters;
+    // Largest buffer recent bursts needed, restored as soon as one fills
+    // the buffer again.
+    std::size_t m_peak;
+    // Consecutive reads that used at most a quarter of the peak size.
+    unsigned int m_sparse_reads;
 
     SL_NON_COPYABLE_NOR_MOVABLE(shared_message_memory_allocator)
 };
@@ -98,6 +98,33 @@ class encoder_base_t : public i_encoder
         return pos;
     }
 
+    std::size_t next_chunk(const unsigned char** data) final
+    {
+        if (in_progress() == nullptr) {
+            return 0;
+        }
+
+        // Run the state machine until it has something to emit. A
+        // zero-length body is skipped over the same way encode() does.
+        while (!m_to_write) {
+            if (m_new_msg_flag) {
+                int rc = m_in_progress->close();
+                errno_assert(rc == 0);
+                rc = m_in_progress->init();
+                errno_assert(rc == 0);
+                m_in_progress = nullptr;
+                return 0;
+            }
+            (static_cast<T*>(this)->*m_next)();
+        }
+
+        *data = m_write_pos;
+        const std::size_t size = m_to_write;
+        m_write_pos += size;
+        m_to_write = 0;
+        return size;
+    }
+
     void load_msg(msg_t* msg) final
     {
         slk_assert(in_progress() == nullptr);
@@ -132,6 +159,26 @@ class encoder_base_t : public i_encoder
         return m_in_progress;
     }
 
+    // Schedules header and body of a plain frame as a single chunk if the
+    // message can keep the header in front of its data. The header is then
+    // encoded once and shared by every engine sending the same message.
+    // Returns false if the caller has to write the header on its own.
+    bool next_frame_step(const unsigned char* header,
+                         std::size_t header_size,
+                         step_t next)
+    {
+        const unsigned char* frame =
+            m_in_progress->wire_frame(header, header_size);
+        if (!frame) {
+            return false;
+        }
+        next_step(const_cast<unsigned char*>(frame),
+                  header_size + m_in_progress->size(),
+                  next,
+                  true);
+        return true;
+    }
+
   private:
     // Where to get the data to write from.
     unsigned char* m_write_pos;
@@ -25,6 +25,12 @@ struct i_encoder
     // Returns 0 when a new message is required (call load_msg).
     virtual std::size_t encode(unsigned char** data, std::size_t size) = 0;
 
+    // Zero-copy variant of encode(). Returns the next contiguous chunk
+    // (frame header or message body) of the message in progress without
+    // copying it. The chunk stays valid until the following call.
+    // Returns 0 once the message has been fully emitted.
+    virtual std::size_t next_chunk(const unsigned char** data) = 0;
+
     // Load a new message into the encoder for encoding.
     virtual void load_msg(msg_t* msg) = 0;
 
@@ -19,6 +19,10 @@
 #include "../protocol/wire.hpp"
 #include <asio.hpp>
 
+//  Upper bound of a ZMTP frame header as produced by the encoders: flags,
+//  8-byte size and the SUBSCRIBE command name.
+static const size_t max_frame_header_size = 32;
+
 // TODO: Peer address retrieval needs to be adapted for Asio
 static std::string get_peer_address (const slk::options_t &options_) 
 {
@@ -59,10 +63,17 @@ slk::stream_engine_base_t::stream_engine_base_t (
     _session (NULL),
     _socket (NULL),
     _has_handshake_stage (has_handshake_stage_),
-    _lifetime_sentinel (std::make_shared<int> (0))
+    _lifetime_sentinel (std::make_shared<int> (0)),
+    _out_arena_size ((std::max) (
+      static_cast<size_t> (options_.out_batch_size),
+      static_cast<size_t> (out_batch_gather_threshold) + max_frame_header_size))
 {
     const int rc = _tx_msg.init ();
     errno_assert (rc == 0);
+
+    _out_arena.reset (new (std::nothrow) unsigned char[_out_arena_size]);
+    alloc_assert (_out_arena);
+    _out_iov.reserve (out_batch_max_segments);
 }
 
 slk::stream_engine_base_t::~stream_engine_base_t () 
@@ -75,6 +86,8 @@ slk::stream_engine_base_t::~stream_engine_base_t ()
     const int rc = _tx_msg.close ();
     errno_assert (rc == 0);
 
+    release_out_batch ();
+
     //  Drop reference to metadata and destroy it if we are the only user.
     if (_metadata != NULL) {
         if (_metadata->drop_ref ()) {
@@ -99,6 +112,12 @@ void slk::stream_engine_base_t::plug (io_thread_t *io_thread_,
     _session = session_;
     _socket = _session->get_socket ();
 
+    //  The TTL timer is armed by the peer's PINGs, so the timers exist
+    //  even when this side sends no heartbeats of its own.
+    for (size_t i = 0; i != 3; i++)
+        _heartbeat_timers[i].reset (
+          new asio::steady_timer (io_thread_->get_io_context ()));
+
     //  Internal plugging.
     plug_internal ();
 
@@ -110,8 +129,20 @@ void slk::stream_engine_base_t::unplug ()
 {
     slk_assert (_plugged);
     _plugged = false;
-    
-    // Cancel timers if any (TODO: move to Asio timers)
+
+    //  Cancel all timers.
+    if (_has_heartbeat_timer) {
+        cancel_timer (heartbeat_ivl_timer_id);
+        _has_heartbeat_timer = false;
+    }
+    if (_has_ttl_timer) {
+        cancel_timer (heartbeat_ttl_timer_id);
+        _has_ttl_timer = false;
+    }
+    if (_has_timeout_timer) {
+        cancel_timer (heartbeat_timeout_timer_id);
+        _has_timeout_timer = false;
+    }
 
     // Close the stream, which will cancel any pending async operations.
     if (_stream)
@@ -231,7 +262,7 @@ void slk::stream_engine_base_t::handle_read(size_t bytes_transferred, int error_
 
 void slk::stream_engine_base_t::start_write()
 {
-    if (unlikely(_io_error) || !_outsize) {
+    if (unlikely(_io_error) || (!_outsize && _out_iov.empty ())) {
         _output_stopped = true;
         return;
     }
@@ -239,11 +270,17 @@ void slk::stream_engine_base_t::start_write()
     _output_stopped = false;
 
     std::weak_ptr<int> sentinel = _lifetime_sentinel;
-    _stream->async_write(_outpos, _outsize,
-        [this, sentinel](size_t bytes_transferred, int error_code) {
-            if (sentinel.expired()) return;
-            handle_write(bytes_transferred, error_code);
-        });
+    auto handler = [this, sentinel](size_t bytes_transferred, int error_code) {
+        if (sentinel.expired()) return;
+        handle_write(bytes_transferred, error_code);
+    };
+
+    //  Raw bytes (the greeting) go out as a single buffer, encoded
+    //  messages as one vectored write over the gathered batch.
+    if (_outsize)
+        _stream->async_write(_outpos, _outsize, handler);
+    else
+        _stream->async_writev(_out_iov.data (), _out_iov.size (), handler);
 }
 
 void slk::stream_engine_base_t::handle_write(size_t bytes_transferred, int error_code)
@@ -257,13 +294,18 @@ void slk::stream_engine_base_t::handle_write(size_t bytes_transferred, int error
         return;
     }
 
-    _outpos += bytes_transferred;
-    _outsize -= bytes_transferred;
+    if (_outsize) {
+        _outpos += bytes_transferred;
+        _outsize -= bytes_transferred;
 
-    // If there is more data in the buffer, continue writing.
-    if (_outsize > 0) {
-        start_write();
-        return;
+        // If there is more data in the buffer, continue writing.
+        if (_outsize > 0) {
+            start_write();
+            return;
+        }
+    } else {
+        //  The composed write completes only once every segment is out.
+        release_out_batch ();
     }
 
     // All buffered data sent. Try to get more from the encoder.
@@ -272,36 +314,87 @@ void slk::stream_engine_base_t::handle_write(size_t bytes_transferred, int error
         return;
     }
 
-    // Batching: Pull as many messages as possible into the encoder
-    std::weak_ptr<int> sentinel = _lifetime_sentinel;
-    _outsize = 0;
-    _outpos = NULL;
+    if (!fill_out_batch ())
+        return;
+
+    if (!_out_iov.empty ()) {
+        start_write();
+        return;
+    }
     
-    while (_outsize < static_cast<size_t>(_options.out_batch_size)) {
-        if (_encoder->is_empty()) {
+    // No more data to send, output is now stopped.
+    _output_stopped = true;
+}
+
+bool slk::stream_engine_base_t::fill_out_batch ()
+{
+    slk_assert (_out_iov.empty ());
+
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    unsigned char *const arena = _out_arena.get ();
+    size_t arena_used = 0;
+
+    while (true) {
+        if (_encoder->is_empty ()) {
+            //  Only start a new message if its header and a copied body
+            //  are guaranteed to fit, and two more segments are available.
+            if (_out_arena_size - arena_used
+                  < out_batch_gather_threshold + max_frame_header_size
+                || _out_iov.size () + 2 > out_batch_max_segments)
+                break;
             if ((this->*_next_msg) (&_tx_msg) == -1)
                 break;
-            if (sentinel.expired()) return;
+            if (sentinel.expired ())
+                return false;
+
+            //  Large bodies are written straight from the message content,
+            //  possibly together with a header stored in front of them.
+            //  Take a reference so that it outlives the encoder's close.
+            if (_tx_msg.size () + msg_t::wire_headroom
+                >= out_batch_gather_threshold) {
+                _out_pinned.emplace_back ();
+                msg_t &pinned = _out_pinned.back ();
+                int rc = pinned.init ();
+                errno_assert (rc == 0);
+                rc = pinned.copy (_tx_msg);
+                errno_assert (rc == 0);
+            }
             _encoder->load_msg (&_tx_msg);
         }
-        
-        unsigned char* buffer_ptr = _outpos ? (_outpos + _outsize) : NULL;
-        size_t n = _encoder->encode(&buffer_ptr, static_cast<size_t>(_options.out_batch_size) - _outsize);
-        
-        if (!_outpos) _outpos = buffer_ptr;
-        _outsize += n;
-        
-        if (!_encoder->is_empty()) // Message too large for remaining batch space or zero-copy
-            break;
+
+        const unsigned char *chunk;
+        size_t chunk_size;
+        while ((chunk_size = _encoder->next_chunk (&chunk)) > 0) {
+            if (chunk_size >= out_batch_gather_threshold) {
+                _out_iov.push_back ({chunk, chunk_size});
+                continue;
+            }
+
+            //  Copy into the arena, extending the previous segment if it
+            //  ends right where this chunk is going to be placed.
+            unsigned char *dst = arena + arena_used;
+            memcpy (dst, chunk, chunk_size);
+            arena_used += chunk_size;
+            if (!_out_iov.empty ()
+                && static_cast<const unsigned char *> (_out_iov.back ().data)
+                       + _out_iov.back ().size
+                     == dst)
+                _out_iov.back ().size += chunk_size;
+            else
+                _out_iov.push_back ({dst, chunk_size});
+        }
     }
+    return true;
+}
 
-    if (_outsize > 0) {
-        start_write();
-        return;
+void slk::stream_engine_base_t::release_out_batch ()
+{
+    _out_iov.clear ();
+    for (size_t i = 0, n = _out_pinned.size (); i != n; i++) {
+        const int rc = _out_pinned[i].close ();
+        errno_assert (rc == 0);
     }
-    
-    // No more data to send, output is now stopped.
-    _output_stopped = true;
+    _out_pinned.clear ();
 }
 
 
@@ -313,36 +406,17 @@ void slk::stream_engine_base_t::restart_output ()
     // If output was stopped, try to start it again.
     if (likely (_output_stopped)) {
         //  If write buffer is empty, try to read new data from the encoder.
-        if (!_outsize) {
+        if (!_outsize && _out_iov.empty ()) {
             if (unlikely (_encoder == NULL)) {
                 slk_assert (_handshaking);
                 return;
             }
 
-            // Batching: Pull as many messages as possible into the encoder
-            _outsize = 0;
-            _outpos = NULL;
-            while (_outsize < static_cast<size_t>(_options.out_batch_size)) {
-                if (_encoder->is_empty()) {
-                    if ((this->*_next_msg) (&_tx_msg) == -1)
-                        break;
-                    _encoder->load_msg (&_tx_msg);
-                }
-                
-                unsigned char* buffer_ptr = _outpos ? (_outpos + _outsize) : NULL;
-                size_t n = _encoder->encode(&buffer_ptr, static_cast<size_t>(_options.out_batch_size) - _outsize);
-                
-                if (!_outpos) _outpos = buffer_ptr;
-                _outsize += n;
-                
-                if (!_encoder->is_empty())
-                    break;
-            }
+            if (!fill_out_batch ())
+                return;
         }
 
-        if (_outsize > 0) {
-            start_write();
-        }
+        start_write();
     }
 }
 
@@ -429,6 +503,55 @@ void slk::stream_engine_base_t::set_handshake_timer ()
     // }
 }
 
+void slk::stream_engine_base_t::add_timer (int timeout_, int id_)
+{
+    asio::steady_timer *timer =
+      _heartbeat_timers[id_ - heartbeat_ivl_timer_id].get ();
+    slk_assert (timer);
+
+    timer->expires_after (std::chrono::milliseconds (timeout_));
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    timer->async_wait ([this, sentinel, timer,
+                        id_] (const asio::error_code &ec) {
+        if (sentinel.expired () || ec == asio::error::operation_aborted)
+            return;
+        //  A wait that completed just before the timer was cancelled or
+        //  re-armed is stale.
+        if (timer->expiry () > asio::steady_timer::clock_type::now ())
+            return;
+        timer_event (id_);
+    });
+}
+
+void slk::stream_engine_base_t::cancel_timer (int id_)
+{
+    asio::steady_timer *timer =
+      _heartbeat_timers[id_ - heartbeat_ivl_timer_id].get ();
+    if (timer)
+        timer->cancel ();
+}
+
+void slk::stream_engine_base_t::timer_event (int id_)
+{
+    if (id_ == heartbeat_ivl_timer_id) {
+        _next_msg = &stream_engine_base_t::produce_ping_message;
+        restart_output ();
+        add_timer (_options.heartbeat_interval, heartbeat_ivl_timer_id);
+    } else if (id_ == heartbeat_ttl_timer_id) {
+        if (!_has_ttl_timer)
+            return;
+        _has_ttl_timer = false;
+        error (timeout_error);
+    } else if (id_ == heartbeat_timeout_timer_id) {
+        if (!_has_timeout_timer)
+            return;
+        _has_timeout_timer = false;
+        error (timeout_error);
+    } else
+        // There are no other valid timer ids!
+        slk_assert (false);
+}
+
 int slk::stream_engine_base_t::next_handshake_command (msg_t *msg_)
 {
     slk_assert (_mechanism != NULL);
@@ -494,7 +617,18 @@ int slk::stream_engine_base_t::decode_and_push (msg_t *msg_)
         return -1;
     }
 
+    //  Any traffic from the peer proves it is alive.
+    if (_has_timeout_timer) {
+        _has_timeout_timer = false;
+        cancel_timer (heartbeat_timeout_timer_id);
+    }
+    if (_has_ttl_timer) {
+        _has_ttl_timer = false;
+        cancel_timer (heartbeat_ttl_timer_id);
+    }
+
     // Process command messages (SUBSCRIBE, CANCEL, PING, PONG, etc.)
+    //  Heartbeats are answered here; the session drops them.
     if (msg_->flags () & msg_t::command) {
         process_command_message (msg_);
     }
@@ -543,16 +677,15 @@ int slk::stream_engine_base_t::write_credential (msg_t *msg_)
 
 void slk::stream_engine_base_t::mechanism_ready ()
 {
-    // TODO: Port timers
-    // if (_options.heartbeat_interval > 0 && !_has_heartbeat_timer) {
-    //     add_timer (_options.heartbeat_interval, heartbeat_ivl_timer_id);
-    //     _has_heartbeat_timer = true;
-    // }
+    if (_options.heartbeat_interval > 0 && !_has_heartbeat_timer) {
+        add_timer (_options.heartbeat_interval, heartbeat_ivl_timer_id);
+        _has_heartbeat_timer = true;
+    }
 
     //  Notify session that engine is ready - creates the pipe
     //  MUST be called before push_msg
     if (_has_handshake_stage) {
-        _session->engine_ready ();
+        _session->engine_ready (_mechanism->peer_filters_patterns ());
     }
 
     bool flush_session = false;
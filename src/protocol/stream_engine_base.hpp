@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 #include <memory>
+#include <vector>
+#include <asio/steady_timer.hpp>
 
 #include "../core/i_engine.hpp"
 #include "i_encoder.hpp"
@@ -79,6 +81,12 @@ class stream_engine_base_t : public i_engine
 
     void set_handshake_timer ();
 
+    //  Heartbeat timers, keyed by the ids below. They run on the engine's
+    //  I/O thread and call timer_event when they expire.
+    void add_timer (int timeout_, int id_);
+    void cancel_timer (int id_);
+    virtual void timer_event (int id_);
+
     virtual void plug_internal (){};
 
     virtual int process_command_message (msg_t *msg_)
@@ -156,6 +164,7 @@ class stream_engine_base_t : public i_engine
     bool _has_ttl_timer;
     bool _has_timeout_timer;
     bool _has_heartbeat_timer;
+    std::unique_ptr<asio::steady_timer> _heartbeat_timers[3];
 
 
     const std::string _peer_address;
@@ -170,6 +179,13 @@ class stream_engine_base_t : public i_engine
     //  Unplug the engine from the session.
     void unplug ();
 
+    //  Pulls messages from the session into the vectored output batch.
+    //  Returns false if the engine was destroyed in the meantime.
+    bool fill_out_batch ();
+
+    //  Drops the references held on behalf of the last written batch.
+    void release_out_batch ();
+
     int write_credential (msg_t *msg_);
 
   protected:
@@ -183,6 +199,14 @@ class stream_engine_base_t : public i_engine
 
     msg_t _tx_msg;
 
+    //  Vectored output batch. Frame headers and small bodies are copied
+    //  into _out_arena; large bodies are referenced in place and kept
+    //  alive by the copies in _out_pinned until the write completes.
+    std::vector<i_async_stream::const_buffer_t> _out_iov;
+    std::vector<msg_t> _out_pinned;
+    std::unique_ptr<unsigned char[]> _out_arena;
+    size_t _out_arena_size;
+
     bool _io_error;
 
     //  The session this engine is attached to.
@@ -13,6 +13,7 @@ namespace slk
 {
 
 v2_decoder_t::v2_decoder_t(std::size_t bufsize,
+                           std::size_t max_bufsize,
                            int64_t maxmsgsize,
                            bool zero_copy)
     : decoder_base_t<v2_decoder_t, shared_message_memory_allocator>(bufsize),
@@ -23,6 +24,8 @@ v2_decoder_t::v2_decoder_t(std::size_t bufsize,
     int rc = m_in_progress.init();
     errno_assert(rc == 0);
 
+    get_allocator().set_max_size(max_bufsize);
+
     // At the beginning, read one byte and go to flags_ready state.
     next_step(m_tmpbuf, 1, &v2_decoder_t::flags_ready);
 }
@@ -96,6 +99,9 @@ int v2_decoder_t::size_ready(uint64_t msg_size, const unsigned char* read_pos)
                      allocator.data() + allocator.size() - read_pos))) {
         // A new message has started, but the size would exceed the pre-allocated arena
         // this happens every time when a message does not fit completely into the buffer
+        if (m_zero_copy) {
+            allocator.observe_message(static_cast<std::size_t>(msg_size));
+        }
         rc = m_in_progress.init_size(static_cast<std::size_t>(msg_size));
     } else {
         // Construct message using n bytes from the buffer as storage
@@ -17,7 +17,12 @@ class v2_decoder_t final
     : public decoder_base_t<v2_decoder_t, shared_message_memory_allocator>
 {
   public:
-    v2_decoder_t(std::size_t bufsize, int64_t maxmsgsize, bool zero_copy);
+    // The read buffer starts at bufsize bytes and may grow up to
+    // max_bufsize while the connection is busy.
+    v2_decoder_t(std::size_t bufsize,
+                 std::size_t max_bufsize,
+                 int64_t maxmsgsize,
+                 bool zero_copy);
     ~v2_decoder_t();
 
     // i_decoder interface.
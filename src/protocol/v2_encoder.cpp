@@ -65,6 +65,13 @@ void v2_encoder_t::message_ready()
         m_tmp_buf[header_size++] = 0;
     }
 
+    // Plain frames of a message fanned out to many peers share one header.
+    if (!(in_progress()->flags() & msg_t::command) &&
+        !in_progress()->is_subscribe() && !in_progress()->is_cancel() &&
+        next_frame_step(m_tmp_buf, header_size, &v2_encoder_t::message_ready)) {
+        return;
+    }
+
     next_step(m_tmp_buf, header_size, &v2_encoder_t::size_ready, false);
 }
 
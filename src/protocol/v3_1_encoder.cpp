@@ -74,6 +74,13 @@ void v3_1_encoder_t::message_ready()
         header_size += msg_t::cancel_cmd_name_size;
     }
 
+    // Plain frames of a message fanned out to many peers share one header.
+    if (!(in_progress()->flags() & msg_t::command) &&
+        !in_progress()->is_subscribe() && !in_progress()->is_cancel() &&
+        next_frame_step(m_tmp_buf, header_size, &v3_1_encoder_t::message_ready)) {
+        return;
+    }
+
     next_step(m_tmp_buf, header_size, &v3_1_encoder_t::size_ready, false);
 }
 
@@ -26,6 +26,8 @@
 #include "../util/err.hpp"
 #include "../util/likely.hpp"
 #include "../protocol/wire.hpp"
+#include "../monitor/heartbeat.hpp"
+#include "../util/clock.hpp"
 
 slk::zmtp_engine_t::zmtp_engine_t (
   std::unique_ptr<i_async_stream> stream_,
@@ -57,7 +59,9 @@ slk::zmtp_engine_t::zmtp_engine_t (
 
 slk::zmtp_engine_t::~zmtp_engine_t ()
 {
-    const int rc = _routing_id_msg.close ();
+    int rc = _routing_id_msg.close ();
+    errno_assert (rc == 0);
+    rc = _pong_msg.close ();
     errno_assert (rc == 0);
 }
 
@@ -221,7 +225,8 @@ bool slk::zmtp_engine_t::handshake_v3_0 ()
     alloc_assert (_encoder);
 
     _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+      _options.in_batch_size, _options.in_batch_max, _options.maxmsgsize,
+      _options.zero_copy);
     alloc_assert (_decoder);
 
     return slk::zmtp_engine_t::handshake_v3_x ();
@@ -233,7 +238,8 @@ bool slk::zmtp_engine_t::handshake_v3_1 ()
     alloc_assert (_encoder);
 
     _decoder = new (std::nothrow) v2_decoder_t (
-      _options.in_batch_size, _options.maxmsgsize, _options.zero_copy);
+      _options.in_batch_size, _options.in_batch_max, _options.maxmsgsize,
+      _options.zero_copy);
     alloc_assert (_decoder);
 
     return slk::zmtp_engine_t::handshake_v3_x ();
@@ -272,47 +278,96 @@ int slk::zmtp_engine_t::process_routing_id_msg (msg_t *msg_)
 
 int slk::zmtp_engine_t::produce_ping_message (msg_t *msg_)
 {
-    // Heartbeat PING support
-    const int rc = msg_->init_size (7);
+    //  16-bit TTL + \4PING == 7, followed by our clock as the context
+    const size_t ping_ttl_len = msg_t::ping_cmd_name_size + 2;
+    int rc = msg_->init_size (ping_ttl_len + ping_context_size);
     errno_assert (rc == 0);
-
-    unsigned char *data = static_cast<unsigned char *> (msg_->data ());
-    put_uint16 (data, 0); // TTL
-    memcpy (data + 2, "\4PING", 5);
     msg_->set_flags (msg_t::command);
 
-    return 0;
+    unsigned char *data = static_cast<unsigned char *> (msg_->data ());
+    memcpy (data, "\4PING", msg_t::ping_cmd_name_size);
+    put_uint16 (data + msg_t::ping_cmd_name_size, _options.heartbeat_ttl);
+    put_uint64 (data + ping_ttl_len, clock_t::now_us ());
+
+    rc = _mechanism->encode (msg_);
+    _next_msg = &zmtp_engine_t::pull_and_encode;
+    if (!_has_timeout_timer && _heartbeat_timeout > 0) {
+        add_timer (_heartbeat_timeout, heartbeat_timeout_timer_id);
+        _has_timeout_timer = true;
+    }
+    return rc;
 }
 
 int slk::zmtp_engine_t::process_heartbeat_message (msg_t *msg_)
 {
-    const unsigned char *data = static_cast<unsigned char *> (msg_->data ());
+    const unsigned char *data =
+      static_cast<const unsigned char *> (msg_->data ());
     const size_t data_size = msg_->size ();
-
-    if (data_size >= 6 && memcmp (data + 2, "\4PING", 5) == 0) {
-        // Received PING, prepare PONG
-        const int rc = _pong_msg.close ();
+    heartbeat_link_t *link = session ()->get_heartbeat_link ().get ();
+    const uint64_t now = clock_t::now_us ();
+
+    if (msg_->is_ping ()) {
+        //  16-bit TTL + \4PING == 7
+        const size_t ping_ttl_len = msg_t::ping_cmd_name_size + 2;
+        const size_t ping_max_ctx_len = 16;
+        if (data_size < ping_ttl_len)
+            return 0;
+
+        //  The peer's TTL is in deciseconds.
+        const int remote_heartbeat_ttl =
+          get_uint16 (data + msg_t::ping_cmd_name_size) * 100;
+        if (!_has_ttl_timer && remote_heartbeat_ttl > 0) {
+            add_timer (remote_heartbeat_ttl, heartbeat_ttl_timer_id);
+            _has_ttl_timer = true;
+        }
+
+        //  As per ZMTP 3.1 the PING command might contain an up to 16 bytes
+        //  context which needs to be PONGed back, so build the pong message
+        //  here and store it. Truncate it if it's too long.
+        const size_t context_len =
+          std::min (data_size - ping_ttl_len, ping_max_ctx_len);
+        int rc = _pong_msg.close ();
+        errno_assert (rc == 0);
+        rc = _pong_msg.init_size (msg_t::ping_cmd_name_size + context_len);
         errno_assert (rc == 0);
-        produce_pong_message (&_pong_msg);
+        _pong_msg.set_flags (msg_t::command);
+        unsigned char *pong = static_cast<unsigned char *> (_pong_msg.data ());
+        memcpy (pong, "\4PONG", msg_t::ping_cmd_name_size);
+        if (context_len > 0)
+            memcpy (pong + msg_t::ping_cmd_name_size, data + ping_ttl_len,
+                    context_len);
+
+        _next_msg = static_cast<int (stream_engine_base_t::*) (msg_t *)> (
+          &zmtp_engine_t::produce_pong_message);
+        restart_output ();
+
+        if (link)
+            link->last_heartbeat_us.store (static_cast<int64_t> (now),
+                                           std::memory_order_relaxed);
+    } else if (msg_->is_pong () && link) {
+        //  Only our own PINGs carry a timestamp we can trust.
+        if (data_size == msg_t::ping_cmd_name_size + ping_context_size) {
+            const uint64_t sent =
+              get_uint64 (data + msg_t::ping_cmd_name_size);
+            if (sent <= now)
+                link->rtt_us.store (static_cast<int> (now - sent),
+                                    std::memory_order_relaxed);
+        }
+        link->last_heartbeat_us.store (static_cast<int64_t> (now),
+                                       std::memory_order_relaxed);
     }
 
-    const int rc = msg_->close ();
-    errno_assert (rc == 0);
-
     return 0;
 }
 
 int slk::zmtp_engine_t::produce_pong_message (msg_t *msg_)
 {
-    const int rc = msg_->init_size (7);
+    int rc = msg_->move (_pong_msg);
     errno_assert (rc == 0);
 
-    unsigned char *data = static_cast<unsigned char *> (msg_->data ());
-    put_uint16 (data, 0); // TTL
-    memcpy (data + 2, "\4PONG", 5);
-    msg_->set_flags (msg_t::command);
-
-    return 0;
+    rc = _mechanism->encode (msg_);
+    _next_msg = &zmtp_engine_t::pull_and_encode;
+    return rc;
 }
 
 int slk::zmtp_engine_t::process_command_message (msg_t *msg_)
@@ -68,6 +68,9 @@ class zmtp_engine_t final : public stream_engine_base_t
     //  Need to store PING payload for PONG
     msg_t _pong_msg;
 
+    //  Our PINGs carry the send time in microseconds as their context.
+    static constexpr size_t ping_context_size = 8;
+
     // C++20: Use static constexpr for compile-time size constants
     static constexpr size_t signature_size = 10;
 
@@ -32,6 +32,7 @@
 #include "util/atomic_counter.hpp"
 #include "util/timers.hpp"
 #include "util/stopwatch.hpp"
+#include "util/slab_allocator.hpp"
 #include "io/ip.hpp"
 
 #ifdef SL_ENABLE_MONITORING
@@ -104,6 +105,20 @@ static int map_errno(int internal_errno)
         } \
     } while(0)
 
+// msg_t objects handed out by slk_msg_new* live in slab memory, like the
+// content blocks they usually point to.
+static slk::msg_t *new_msg()
+{
+    void *storage = slk::slab_alloc(sizeof(slk::msg_t));
+    return storage ? new (storage) slk::msg_t() : nullptr;
+}
+
+static void delete_msg(slk::msg_t *msg)
+{
+    msg->~msg_t();
+    slk::slab_free(msg);
+}
+
 extern "C" {
 
 /****************************************************************************/
@@ -413,9 +428,13 @@ int SL_CALL slk_getsockopt(slk_socket_t *socket_, int option, void *value, size_
 slk_msg_t* SL_CALL slk_msg_new(void)
 {
     try {
-        slk::msg_t *msg = new slk::msg_t();
+        slk::msg_t *msg = new_msg();
+        if (!msg) {
+            set_errno(SLK_ENOMEM);
+            return nullptr;
+        }
         if (msg->init() != 0) {
-            delete msg;
+            delete_msg(msg);
             set_errno(SLK_ENOMEM);
             return nullptr;
         }
@@ -438,9 +457,13 @@ slk_msg_t* SL_CALL slk_msg_new_data(const void *data, size_t size)
     }
 
     try {
-        slk::msg_t *msg = new slk::msg_t();
+        slk::msg_t *msg = new_msg();
+        if (!msg) {
+            set_errno(SLK_ENOMEM);
+            return nullptr;
+        }
         if (msg->init_buffer(data, size) != 0) {
-            delete msg;
+            delete_msg(msg);
             set_errno(SLK_ENOMEM);
             return nullptr;
         }
@@ -464,10 +487,10 @@ void SL_CALL slk_msg_destroy(slk_msg_t *msg_)
 
     try {
         msg->close();
-        delete msg;
+        delete_msg(msg);
     } catch (...) {
         // Best effort cleanup
-        delete msg;
+        delete_msg(msg);
     }
 }
 
@@ -509,6 +532,28 @@ int SL_CALL slk_msg_init_data(slk_msg_t *msg_, const void *data, size_t size)
     }
 }
 
+int SL_CALL slk_msg_init_zerocopy(slk_msg_t *msg_, void *data, size_t size,
+                                  slk_free_fn *ffn, void *hint)
+{
+    CHECK_PTR(msg_, -1);
+    // Allow NULL data pointer only when size is 0 (empty message)
+    if (size > 0 && !data) {
+        return set_errno(SLK_EINVAL);
+    }
+
+    slk::msg_t *msg = reinterpret_cast<slk::msg_t*>(msg_);
+
+    try {
+        int rc = msg->init_data(data, size, ffn, hint);
+        if (rc != 0) {
+            return set_errno(SLK_ENOMEM);
+        }
+        return 0;
+    } catch (...) {
+        return set_errno(SLK_EPROTO);
+    }
+}
+
 int SL_CALL slk_msg_close(slk_msg_t *msg_)
 {
     CHECK_PTR(msg_, -1);
@@ -806,13 +851,18 @@ int SL_CALL slk_send_to(slk_socket_t *socket_, const void *routing_id, size_t id
     slk::socket_base_t *socket = reinterpret_cast<slk::socket_base_t*>(socket_);
 
     try {
+        // Both frames go out under a single command-processing pass
+        if (socket->begin_send(false) != 0) {
+            return set_errno(map_errno(errno));
+        }
+
         // Send routing ID frame
         slk::msg_t id_msg;
         if (id_msg.init_buffer(routing_id, id_len) != 0) {
             return set_errno(SLK_ENOMEM);
         }
 
-        int rc = socket->send(&id_msg, SLK_SNDMORE);
+        int rc = socket->send_part(&id_msg, SLK_SNDMORE);
         id_msg.close();
 
         if (rc < 0) {
@@ -825,7 +875,7 @@ int SL_CALL slk_send_to(slk_socket_t *socket_, const void *routing_id, size_t id
             return set_errno(SLK_ENOMEM);
         }
 
-        rc = socket->send(&data_msg, flags);
+        rc = socket->send_part(&data_msg, flags);
         data_msg.close();
 
         if (rc < 0) {
@@ -838,6 +888,167 @@ int SL_CALL slk_send_to(slk_socket_t *socket_, const void *routing_id, size_t id
     }
 }
 
+int SL_CALL slk_sendv(slk_socket_t *socket_, const slk_iovec_t *frames, size_t count,
+                      int flags)
+{
+    CHECK_PTR(socket_, -1);
+    CHECK_PTR(frames, -1);
+
+    if (count == 0) {
+        return set_errno(SLK_EINVAL);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (frames[i].len > 0 && !frames[i].data) {
+            return set_errno(SLK_EINVAL);
+        }
+    }
+
+    slk::socket_base_t *socket = reinterpret_cast<slk::socket_base_t*>(socket_);
+
+    try {
+        if (socket->begin_send(false) != 0) {
+            return set_errno(map_errno(errno));
+        }
+
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            slk::msg_t msg;
+            if (msg.init_buffer(frames[i].data, frames[i].len) != 0) {
+                return set_errno(SLK_ENOMEM);
+            }
+
+            const int frame_flags = (i + 1 < count) ? (flags | SLK_SNDMORE) : flags;
+            const int rc = socket->send_part(&msg, frame_flags);
+            msg.close();
+
+            if (rc < 0) {
+                return set_errno(map_errno(errno));
+            }
+            total += frames[i].len;
+        }
+
+        return static_cast<int>(total);
+    } catch (...) {
+        return set_errno(SLK_EPROTO);
+    }
+}
+
+int SL_CALL slk_recvv(slk_socket_t *socket_, slk_iovec_t *frames, size_t *count, int flags)
+{
+    CHECK_PTR(socket_, -1);
+    CHECK_PTR(count, -1);
+    if (*count > 0 && !frames) {
+        return set_errno(SLK_EINVAL);
+    }
+
+    slk::socket_base_t *socket = reinterpret_cast<slk::socket_base_t*>(socket_);
+
+    try {
+        slk::msg_t msg;
+        size_t nframes = 0;
+        bool more = true;
+
+        while (more) {
+            if (msg.init() != 0) {
+                return set_errno(SLK_ENOMEM);
+            }
+
+            // Later frames of a multipart message are already queued
+            const int rc = socket->recv(&msg, flags);
+            if (rc < 0) {
+                msg.close();
+                return set_errno(map_errno(errno));
+            }
+
+            if (nframes < *count) {
+                const size_t msg_size = msg.size();
+                const size_t copy_size =
+                  (msg_size < frames[nframes].len) ? msg_size : frames[nframes].len;
+                if (copy_size > 0) {
+                    memcpy(frames[nframes].data, msg.data(), copy_size);
+                }
+                frames[nframes].len = msg_size;
+            }
+
+            more = (msg.flags() & slk::msg_t::more) != 0;
+            msg.close();
+            nframes++;
+        }
+
+        if (nframes < *count) {
+            *count = nframes;
+        }
+        return static_cast<int>(nframes);
+    } catch (...) {
+        return set_errno(SLK_EPROTO);
+    }
+}
+
+int SL_CALL slk_send_to_many(slk_socket_t *socket_, const slk_iovec_t *routing_ids,
+                             const slk_iovec_t *payloads, size_t count, int flags)
+{
+    CHECK_PTR(socket_, -1);
+    CHECK_PTR(routing_ids, -1);
+    CHECK_PTR(payloads, -1);
+
+    if (count == 0) {
+        return set_errno(SLK_EINVAL);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!routing_ids[i].data || (payloads[i].len > 0 && !payloads[i].data)) {
+            return set_errno(SLK_EINVAL);
+        }
+    }
+
+    slk::socket_base_t *socket = reinterpret_cast<slk::socket_base_t*>(socket_);
+
+    try {
+        // Commands are processed once and every destination pipe is
+        // flushed once, when the batch ends
+        if (socket->begin_send(true) != 0) {
+            return set_errno(map_errno(errno));
+        }
+
+        size_t sent = 0;
+        int err = 0;
+        for (; sent < count; sent++) {
+            slk::msg_t id_msg;
+            if (id_msg.init_buffer(routing_ids[sent].data, routing_ids[sent].len) != 0) {
+                err = SLK_ENOMEM;
+                break;
+            }
+            int rc = socket->send_part(&id_msg, SLK_SNDMORE | flags);
+            id_msg.close();
+            if (rc < 0) {
+                err = map_errno(errno);
+                break;
+            }
+
+            slk::msg_t data_msg;
+            if (data_msg.init_buffer(payloads[sent].data, payloads[sent].len) != 0) {
+                err = SLK_ENOMEM;
+                break;
+            }
+            rc = socket->send_part(&data_msg, flags & ~SLK_SNDMORE);
+            data_msg.close();
+            if (rc < 0) {
+                err = map_errno(errno);
+                break;
+            }
+        }
+
+        socket->end_send();
+
+        if (sent == 0 && err != 0) {
+            return set_errno(err);
+        }
+        return static_cast<int>(sent);
+    } catch (...) {
+        socket->end_send();
+        return set_errno(SLK_EPROTO);
+    }
+}
+
 /****************************************************************************/
 /*  Polling API                                                             */
 /****************************************************************************/
@@ -1271,6 +1482,37 @@ int SL_CALL slk_get_peer_stats(slk_socket_t *socket_, const void *routing_id,
 #endif
 }
 
+int SL_CALL slk_socket_get_latency_histogram(slk_socket_t *socket_, int direction,
+                                              slk_latency_histogram_t *hist)
+{
+    CHECK_PTR(socket_, -1);
+    CHECK_PTR(hist, -1);
+
+    if (direction != SLK_LATENCY_SEND && direction != SLK_LATENCY_RECV)
+        return set_errno(SLK_EINVAL);
+
+#ifdef SL_ENABLE_MONITORING
+    slk::socket_base_t *socket = reinterpret_cast<slk::socket_base_t*>(socket_);
+
+    slk::latency_summary_t summary;
+    socket->get_latency(direction == SLK_LATENCY_SEND, &summary);
+
+    hist->count = summary.count;
+    hist->min_us = summary.min_us;
+    hist->max_us = summary.max_us;
+    hist->mean_us = summary.mean_us;
+    hist->p50_us = summary.p50_us;
+    hist->p90_us = summary.p90_us;
+    hist->p99_us = summary.p99_us;
+    hist->p999_us = summary.p999_us;
+    return 0;
+#else
+    // Monitoring not enabled at compile time
+    errno = ENOTSUP;
+    return set_errno(SLK_EPROTO);
+#endif
+}
+
 int SL_CALL slk_get_peers(slk_socket_t *socket_, void **peer_ids, size_t *id_lens,
                           size_t *num_peers)
 {
@@ -1433,6 +1675,22 @@ int SL_CALL slk_has(const char *capability)
 #endif
     }
 
+    if (strcmp(capability, "io_uring") == 0) {
+#ifdef SL_HAVE_IO_URING
+        return 1;
+#else
+        return 0;
+#endif
+    }
+
+    if (strcmp(capability, "shm") == 0) {
+#ifdef SL_HAVE_SHM
+        return 1;
+#else
+        return 0;
+#endif
+    }
+
     // Unsupported capabilities
     if (strcmp(capability, "curve") == 0 ||
         strcmp(capability, "gssapi") == 0 ||
@@ -1447,6 +1705,19 @@ int SL_CALL slk_has(const char *capability)
     return 0;
 }
 
+int SL_CALL slk_alloc_stats(slk_alloc_stats_t *stats)
+{
+    CHECK_PTR(stats, -1);
+
+    slk::slab_stats_t slab;
+    slk::slab_get_stats(&slab);
+    stats->hits = slab.hits;
+    stats->misses = slab.misses;
+    stats->remote_frees = slab.remote_frees;
+    stats->cached_bytes = slab.cached_bytes;
+    return 0;
+}
+
 /****************************************************************************/
 /*  Atomic Counter API                                                      */
 /****************************************************************************/
@@ -1875,6 +2146,23 @@ slk_spot_t* SL_CALL slk_spot_new(slk_ctx_t *ctx_)
     }
 }
 
+slk_spot_t* SL_CALL slk_spot_new_sharded(slk_ctx_t *ctx_, int shards_)
+{
+    CHECK_PTR(ctx_, nullptr);
+
+    try {
+        slk::ctx_t *ctx = reinterpret_cast<slk::ctx_t*>(ctx_);
+        slk::spot_pubsub_t *spot = new slk::spot_pubsub_t(ctx, shards_);
+        return reinterpret_cast<slk_spot_t*>(spot);
+    } catch (const std::bad_alloc &) {
+        errno = ENOMEM;
+        return nullptr;
+    } catch (...) {
+        errno = EINVAL;
+        return nullptr;
+    }
+}
+
 void SL_CALL slk_spot_destroy(slk_spot_t **spot_)
 {
     if (!spot_ || !*spot_) {
@@ -1905,6 +2193,22 @@ int SL_CALL slk_spot_topic_create(slk_spot_t *spot_, const char *topic_id_)
     }
 }
 
+int SL_CALL slk_spot_topic_create_ex(slk_spot_t *spot_, const char *topic_id_,
+                                      int flags_)
+{
+    CHECK_PTR(spot_, -1);
+    CHECK_PTR(topic_id_, -1);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        std::string topic_id(topic_id_);
+        return spot->topic_create(topic_id, flags_);
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
 int SL_CALL slk_spot_topic_route(slk_spot_t *spot_, const char *topic_id_,
                                   const char *endpoint_)
 {
@@ -1968,6 +2272,35 @@ int SL_CALL slk_spot_subscribe_pattern(slk_spot_t *spot_, const char *pattern_)
     }
 }
 
+int SL_CALL slk_spot_subscribe_region(slk_spot_t *spot_, const char *grid_,
+                                      int x0_, int y0_, int x1_, int y1_)
+{
+    CHECK_PTR(spot_, -1);
+    CHECK_PTR(grid_, -1);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        return spot->subscribe_region(grid_, x0_, y0_, x1_, y1_);
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+int SL_CALL slk_spot_unsubscribe_region(slk_spot_t *spot_, const char *grid_)
+{
+    CHECK_PTR(spot_, -1);
+    CHECK_PTR(grid_, -1);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        return spot->unsubscribe_region(grid_);
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
 int SL_CALL slk_spot_unsubscribe(slk_spot_t *spot_, const char *topic_id_)
 {
     CHECK_PTR(spot_, -1);
@@ -2020,6 +2353,86 @@ int SL_CALL slk_spot_recv(slk_spot_t *spot_, char *topic_, size_t topic_size_,
     }
 }
 
+int SL_CALL slk_spot_publish_msg(slk_spot_t *spot_, const char *topic_id_,
+                                  slk_msg_t *msg_)
+{
+    CHECK_PTR(spot_, -1);
+    CHECK_PTR(topic_id_, -1);
+    CHECK_PTR(msg_, -1);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        std::string topic_id(topic_id_);
+        return spot->publish_msg(topic_id, reinterpret_cast<slk::msg_t*>(msg_));
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+int SL_CALL slk_spot_recv_msg(slk_spot_t *spot_, slk_msg_t *topic_,
+                              slk_msg_t *data_, int flags_)
+{
+    CHECK_PTR(spot_, -1);
+    CHECK_PTR(topic_, -1);
+    CHECK_PTR(data_, -1);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        return spot->recv_msg(reinterpret_cast<slk::msg_t*>(topic_),
+                              reinterpret_cast<slk::msg_t*>(data_), flags_);
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+slk_spot_topic_handle_t* SL_CALL slk_spot_topic_lookup(slk_spot_t *spot_,
+                                                       const char *topic_id_)
+{
+    CHECK_PTR(spot_, nullptr);
+    CHECK_PTR(topic_id_, nullptr);
+
+    try {
+        slk::spot_pubsub_t *spot = reinterpret_cast<slk::spot_pubsub_t*>(spot_);
+        std::string topic_id(topic_id_);
+        return reinterpret_cast<slk_spot_topic_handle_t*>(spot->topic_lookup(topic_id));
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return nullptr;
+    }
+}
+
+int SL_CALL slk_spot_publish_handle(slk_spot_topic_handle_t *topic_,
+                                    const void *data_, size_t len_)
+{
+    CHECK_PTR(topic_, -1);
+    CHECK_PTR(data_, -1);
+
+    try {
+        slk::spot_topic_t *topic = reinterpret_cast<slk::spot_topic_t*>(topic_);
+        return topic->spot->publish(topic, data_, len_);
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+int SL_CALL slk_spot_publish_handle_msg(slk_spot_topic_handle_t *topic_,
+                                        slk_msg_t *msg_)
+{
+    CHECK_PTR(topic_, -1);
+    CHECK_PTR(msg_, -1);
+
+    try {
+        slk::spot_topic_t *topic = reinterpret_cast<slk::spot_topic_t*>(topic_);
+        return topic->spot->publish(topic, reinterpret_cast<slk::msg_t*>(msg_));
+    } catch (const std::exception &) {
+        errno = EINVAL;
+        return -1;
+    }
+}
+
 int SL_CALL slk_spot_bind(slk_spot_t *spot_, const char *endpoint_)
 {
     CHECK_PTR(spot_, -1);
@@ -9,15 +9,17 @@
 #include "../msg/msg.hpp"
 #include "../util/err.hpp"
 #include "../util/constants.hpp"
+#include "../pattern/region_index.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
-#include <chrono>
-#include <thread>
 #include <atomic>
+#include <new>
 
 namespace slk
 {
@@ -32,12 +34,11 @@ static std::string generate_instance_id ()
     return buf;
 }
 
-spot_pubsub_t::spot_pubsub_t (ctx_t *ctx_)
+spot_pubsub_t::spot_pubsub_t (ctx_t *ctx_, int shards_)
     : _ctx (ctx_)
     , _registry (new topic_registry_t ())
     , _sub_manager (new subscription_manager_t ())
     , _recv_socket (nullptr)
-    , _pub_socket (nullptr)
     , _sndhwm (1000)
     , _rcvhwm (1000)
     , _rcvtimeo (-1)
@@ -45,44 +46,68 @@ spot_pubsub_t::spot_pubsub_t (ctx_t *ctx_)
     if (!_ctx) {
         throw std::invalid_argument ("Context pointer is null");
     }
+    if (shards_ < 1 || shards_ > max_shards) {
+        throw std::invalid_argument ("Invalid shard count");
+    }
 
     // Generate unique inproc endpoint for this instance
     _inproc_endpoint = "inproc://" + generate_instance_id ();
 
-    // Create shared XPUB socket for publishing (all topics go through this)
-    _pub_socket = _ctx->create_socket (SL_XPUB);
-    if (!_pub_socket) {
-        throw std::runtime_error ("Failed to create XPUB socket");
-    }
+    // Create one PUB socket per shard for publishing. Unlike an XPUB, a
+    // PUB queues no subscription notifications, which nobody would read.
+    // Pinning shard i to I/O thread i (modulo their count) spreads the TCP
+    // sessions of the shards over all of them.
+    const int io_threads = std::min (_ctx->get (SL_IO_THREADS), max_shards);
+    for (int i = 0; i < shards_; i++) {
+        _shards.emplace_back (new shard_t ());
+        shard_t &shard = *_shards.back ();
+
+        shard.pub_socket = _ctx->create_socket (SL_PUB);
+        if (!shard.pub_socket) {
+            close_sockets ();
+            throw std::runtime_error ("Failed to create PUB socket");
+        }
 
-    // Set HWM for publisher socket
-    _pub_socket->setsockopt (SL_SNDHWM, &_sndhwm, sizeof (_sndhwm));
+        // Set HWM for publisher socket
+        shard.pub_socket->setsockopt (SL_SNDHWM, &_sndhwm, sizeof (_sndhwm));
 
-    // Bind to inproc endpoint (local subscriptions will connect here)
-    if (_pub_socket->bind (_inproc_endpoint.c_str ()) != 0) {
-        _pub_socket->close ();
-        throw std::runtime_error ("Failed to bind XPUB socket to inproc");
+        if (io_threads > 1) {
+            const uint64_t affinity = uint64_t (1) << (i % io_threads);
+            shard.pub_socket->setsockopt (SL_AFFINITY, &affinity,
+                                          sizeof (affinity));
+        }
+
+        // Bind to inproc endpoint (local subscriptions will connect here)
+        const std::string endpoint = shard_endpoint (_inproc_endpoint, i);
+        if (shard.pub_socket->bind (endpoint.c_str ()) != 0) {
+            close_sockets ();
+            throw std::runtime_error ("Failed to bind PUB socket to inproc");
+        }
     }
 
     // Create receive socket (XSUB) for all subscriptions
     _recv_socket = _ctx->create_socket (SL_XSUB);
     if (!_recv_socket) {
-        _pub_socket->close ();
+        close_sockets ();
         throw std::runtime_error ("Failed to create XSUB socket");
     }
 
     // Set HWM for receive socket
     _recv_socket->setsockopt (SL_RCVHWM, &_rcvhwm, sizeof (_rcvhwm));
 
-    // Connect XSUB to local XPUB for receiving local messages
-    if (_recv_socket->connect (_inproc_endpoint.c_str ()) != 0) {
-        _recv_socket->close ();
-        _pub_socket->close ();
-        throw std::runtime_error ("Failed to connect XSUB to local XPUB");
+    // Connect XSUB to the local PUBs for receiving local messages
+    if (connect_node (_inproc_endpoint) != 0) {
+        close_sockets ();
+        throw std::runtime_error ("Failed to connect XSUB to local PUB");
     }
 }
 
 spot_pubsub_t::~spot_pubsub_t ()
+{
+    close_sockets ();
+}
+
+void spot_pubsub_t::close_sockets ()
 {
     // Destroy receive socket
     if (_recv_socket) {
@@ -90,21 +115,96 @@ spot_pubsub_t::~spot_pubsub_t ()
         _recv_socket = nullptr;
     }
 
-    // Destroy publish socket
-    if (_pub_socket) {
-        _pub_socket->close ();
-        _pub_socket = nullptr;
+    // Destroy publish sockets
+    for (auto &shard : _shards) {
+        if (shard->pub_socket) {
+            shard->pub_socket->close ();
+            shard->pub_socket = nullptr;
+        }
+    }
+}
+
+// ============================================================================
+// Sharding
+// ============================================================================
+
+size_t spot_pubsub_t::shard_of (const std::string &topic_id) const
+{
+    if (_shards.size () == 1) {
+        return 0;
+    }
+
+    // FNV-1a: unlike std::hash, the same on every node
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < topic_id.size (); i++) {
+        hash ^= static_cast<unsigned char> (topic_id[i]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t> (hash % _shards.size ());
+}
+
+std::string spot_pubsub_t::shard_endpoint (const std::string &endpoint,
+                                           size_t shard) const
+{
+    if (shard == 0) {
+        return endpoint;
+    }
+
+    if (endpoint.compare (0, 6, "tcp://") == 0) {
+        const size_t colon = endpoint.rfind (':');
+        if (colon == std::string::npos || colon < 6) {
+            return std::string ();
+        }
+
+        // Wildcard and ephemeral ports cannot be derived from
+        const char *port_str = endpoint.c_str () + colon + 1;
+        char *end = nullptr;
+        const unsigned long port = strtoul (port_str, &end, 10);
+        if (end == port_str || *end != '\0' || port == 0
+            || port + shard > 65535) {
+            return std::string ();
+        }
+        return endpoint.substr (0, colon + 1) + std::to_string (port + shard);
+    }
+
+    return endpoint + "." + std::to_string (shard);
+}
+
+int spot_pubsub_t::connect_node (const std::string &endpoint)
+{
+    for (size_t i = 0; i < _shards.size (); i++) {
+        const std::string shard_ep = shard_endpoint (endpoint, i);
+        int rc = -1;
+        if (shard_ep.empty ()) {
+            errno = EINVAL;
+        } else {
+            rc = _recv_socket->connect (shard_ep.c_str ());
+        }
+        if (rc != 0) {
+            const int err = errno;
+            for (size_t j = 0; j < i; j++) {
+                _recv_socket->term_endpoint (shard_endpoint (endpoint, j).c_str ());
+            }
+            errno = err;
+            return -1;
+        }
     }
+    return 0;
 }
 
 // ============================================================================
 // Topic Ownership
 // ============================================================================
 
-int spot_pubsub_t::topic_create (const std::string &topic_id)
+int spot_pubsub_t::topic_create (const std::string &topic_id, int flags)
 {
     std::unique_lock<std::shared_mutex> lock (_mutex);
 
+    if ((flags & ~topic_conflate) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
     // Check if topic already exists
     if (_registry->has_topic (topic_id)) {
         errno = EEXIST;
@@ -118,6 +218,33 @@ int spot_pubsub_t::topic_create (const std::string &topic_id)
         return -1; // errno already set by registry
     }
 
+    // A topic is an exact ID, so conflation must not spill over to other
+    // topics it happens to be a prefix of
+    const size_t shard = shard_of (topic_id);
+    if (flags & topic_conflate) {
+        std::lock_guard<std::mutex> pub_lock (_shards[shard]->pub_sync);
+        if (_shards[shard]->pub_socket->setsockopt (
+              SL_XPUB_CONFLATE_EXACT, topic_id.data (), topic_id.size ())
+            != 0) {
+            const int err = errno;
+            _registry->unregister (topic_id);
+            errno = err;
+            return -1;
+        }
+        _shards[shard]->conflated++;
+        _conflated_topics.insert (topic_id);
+    }
+
+    // Bring the topic handle to life (odd epoch)
+    auto it = _handles.find (topic_id);
+    if (it == _handles.end ()) {
+        it = _handles
+               .emplace (topic_id, std::unique_ptr<spot_topic_t> (
+                                     new spot_topic_t (this, topic_id, shard)))
+               .first;
+    }
+    it->second->epoch.fetch_add (1, std::memory_order_release);
+
     return 0;
 }
 
@@ -140,9 +267,37 @@ int spot_pubsub_t::topic_destroy (const std::string &topic_id)
     // Unregister from topic registry
     _registry->unregister (topic_id);
 
+    if (_conflated_topics.erase (topic_id) > 0) {
+        shard_t &shard = *_shards[shard_of (topic_id)];
+        std::lock_guard<std::mutex> pub_lock (shard.pub_sync);
+        shard.pub_socket->setsockopt (SL_XPUB_UNCONFLATE_EXACT,
+                                      topic_id.data (), topic_id.size ());
+        shard.conflated--;
+    }
+
+    // Invalidate outstanding handles (even epoch)
+    auto it = _handles.find (topic_id);
+    if (it != _handles.end ()) {
+        it->second->epoch.fetch_add (1, std::memory_order_release);
+    }
+
     return 0;
 }
 
+spot_topic_t *spot_pubsub_t::topic_lookup (const std::string &topic_id) const
+{
+    std::shared_lock<std::shared_mutex> lock (_mutex);
+
+    auto it = _handles.find (topic_id);
+    if (it != _handles.end () && it->second->live ()) {
+        return it->second.get ();
+    }
+
+    // Not a live LOCAL topic
+    errno = _registry->has_topic (topic_id) ? EINVAL : ENOENT;
+    return nullptr;
+}
+
 int spot_pubsub_t::topic_route (const std::string &topic_id,
                                  const std::string &endpoint)
 {
@@ -208,7 +363,7 @@ int spot_pubsub_t::subscribe (const std::string &topic_id)
     }
 
     if (entry->location == topic_registry_t::topic_location_t::LOCAL) {
-        // LOCAL topic: XSUB is already connected to local XPUB
+        // LOCAL topic: XSUB is already connected to local PUB
         // Just need to send subscription filter
 
         // Add LOCAL subscription to manager
@@ -224,7 +379,7 @@ int spot_pubsub_t::subscribe (const std::string &topic_id)
             return -1;
         }
 
-        // Send subscription message to XPUB (topic filter)
+        // Send subscription message to PUB (topic filter)
         msg_t msg;
         if (msg.init_subscribe (topic_id.size (),
                                 reinterpret_cast<const unsigned char *> (topic_id.data ())) != 0) {
@@ -237,13 +392,13 @@ int spot_pubsub_t::subscribe (const std::string &topic_id)
         return rc;
 
     } else {
-        // REMOTE topic: Connect XSUB to remote XPUB endpoint
+        // REMOTE topic: Connect XSUB to remote PUB endpoint
         const std::string &remote_endpoint = entry->endpoint;
 
         // Check if already connected to this endpoint
         if (_connected_endpoints.find (remote_endpoint) == _connected_endpoints.end ()) {
-            // Connect XSUB to remote XPUB
-            if (_recv_socket->connect (remote_endpoint.c_str ()) != 0) {
+            // Connect XSUB to the remote PUBs
+            if (connect_node (remote_endpoint) != 0) {
                 return -1;
             }
             _connected_endpoints.insert (remote_endpoint);
@@ -262,7 +417,7 @@ int spot_pubsub_t::subscribe (const std::string &topic_id)
             return -1;
         }
 
-        // Send subscription message to remote XPUB
+        // Send subscription message to remote PUB
         msg_t msg;
         if (msg.init_subscribe (topic_id.size (),
                                 reinterpret_cast<const unsigned char *> (topic_id.data ())) != 0) {
@@ -289,8 +444,8 @@ int spot_pubsub_t::subscribe_pattern (const std::string &pattern)
         return -1;
     }
 
-    // Convert glob pattern to XPUB prefix filter
-    // XPUB uses prefix matching, not glob patterns
+    // Convert glob pattern to PUB prefix filter
+    // PUB uses prefix matching, not glob patterns
     // "events:*" -> "events:" (matches anything starting with "events:")
     // "events:*:data" -> "events:" (only prefix up to first *)
     std::string prefix = pattern;
@@ -312,6 +467,47 @@ int spot_pubsub_t::subscribe_pattern (const std::string &pattern)
     return rc;
 }
 
+int spot_pubsub_t::subscribe_region (const std::string &grid,
+                                     int32_t x0,
+                                     int32_t y0,
+                                     int32_t x1,
+                                     int32_t y1)
+{
+    std::unique_lock<std::shared_mutex> lock (_mutex);
+
+    // Regions are matched by the PUBs; the XSUB forwards them to the
+    // local and every remote node, and again on reconnect
+    std::vector<unsigned char> value (grid.size () + region_wire_size);
+    memcpy (value.data (), grid.data (), grid.size ());
+    const region_t region = {x0, y0, x1, y1};
+    encode_region (value.data () + grid.size (), region);
+
+    if (_recv_socket->setsockopt (SL_SUBSCRIBE_REGION, value.data (),
+                                  value.size ())
+        != 0) {
+        return -1;
+    }
+    _region_grids.insert (grid);
+    return 0;
+}
+
+int spot_pubsub_t::unsubscribe_region (const std::string &grid)
+{
+    std::unique_lock<std::shared_mutex> lock (_mutex);
+
+    if (_region_grids.find (grid) == _region_grids.end ()) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (_recv_socket->setsockopt (SL_UNSUBSCRIBE_REGION, grid.data (),
+                                  grid.size ())
+        != 0) {
+        return -1;
+    }
+    _region_grids.erase (grid);
+    return 0;
+}
+
 int spot_pubsub_t::subscribe_many (const std::vector<std::string> &topics)
 {
     int failed_count = 0;
@@ -352,7 +548,7 @@ int spot_pubsub_t::unsubscribe (const std::string &topic_id)
         return -1; // errno already set
     }
 
-    // Send unsubscription message to XPUB
+    // Send unsubscription message to PUB
     msg_t msg;
     if (msg.init_cancel (topic_id.size (),
                          reinterpret_cast<const unsigned char *> (topic_id.data ())) != 0) {
@@ -373,46 +569,171 @@ int spot_pubsub_t::publish (const std::string &topic_id,
                              const void *data,
                              size_t len)
 {
-    std::shared_lock<std::shared_mutex> lock (_mutex);
+    msg_t data_msg;
+    if (data_msg.init_buffer (data, len) != 0) {
+        return -1;
+    }
 
-    // Lookup topic in registry
-    auto entry = _registry->lookup (topic_id);
-    if (!entry.has_value ()) {
+    int rc = publish_msg (topic_id, &data_msg);
+    data_msg.close ();
+
+    return rc;
+}
+
+int spot_pubsub_t::publish_msg (const std::string &topic_id, msg_t *msg)
+{
+    // Only LOCAL topics have a handle, so this also rejects REMOTE topics
+    spot_topic_t *topic = topic_lookup (topic_id);
+    if (!topic) {
+        return -1;
+    }
+
+    return publish (topic, msg);
+}
+
+int spot_pubsub_t::publish (spot_topic_t *topic, msg_t *msg)
+{
+    if (!topic || topic->spot != this || !msg || !msg->check ()) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    if (!topic->live ()) {
         errno = ENOENT;
         return -1;
     }
 
-    if (entry->location != topic_registry_t::topic_location_t::LOCAL) {
-        // Can only publish to LOCAL topics
-        errno = EINVAL;
+    return send_frames (topic->shard, topic->topic_id, msg);
+}
+
+int spot_pubsub_t::publish (spot_topic_t *topic, const void *data, size_t len)
+{
+    msg_t data_msg;
+    if (data_msg.init_buffer (data, len) != 0) {
         return -1;
     }
 
-    // Send message through shared XPUB: [topic_id][data]
+    int rc = publish (topic, &data_msg);
+    data_msg.close ();
+
+    return rc;
+}
+
+struct spot_pubsub_t::shard_t::pending_t
+{
+    // Points into the topic's handle, which outlives the shard's sockets
+    const std::string *topic_id;
+    msg_t msg;
+    pending_t *next;
+};
+
+spot_pubsub_t::shard_t::~shard_t ()
+{
+    // A sender only leaves once the queue is empty, so this frees nothing
+    // unless a publisher raced with the destruction
+    pending_t *p = pending.exchange (nullptr);
+    while (p) {
+        pending_t *next = p->next;
+        p->msg.close ();
+        delete p;
+        p = next;
+    }
+}
+
+// Send message through the shard's PUB: [topic_id][data]
+static int send_on (socket_base_t *pub_socket,
+                    const std::string &topic_id,
+                    msg_t *msg)
+{
     // Frame 1: Topic ID
     msg_t topic_msg;
     if (topic_msg.init_buffer (topic_id.data (), topic_id.size ()) != 0) {
         return -1;
     }
 
-    if (_pub_socket->send (&topic_msg, SL_SNDMORE) != 0) {
+    if (pub_socket->send (&topic_msg, SL_SNDMORE) != 0) {
         topic_msg.close ();
         return -1;
     }
     topic_msg.close ();
 
-    // Frame 2: Data
-    msg_t data_msg;
-    if (data_msg.init_buffer (data, len) != 0) {
-        return -1;
+    // Frame 2: Data, handed over without copying
+    return pub_socket->send (msg, 0);
+}
+
+int spot_pubsub_t::send_frames (size_t shard,
+                                const std::string &topic_id,
+                                msg_t *msg)
+{
+    shard_t &s = *_shards[shard];
+
+    // Flat combining: the publisher that raises the unsent count from zero
+    // becomes the sender and sends its own message directly. Anyone else
+    // queues the message and returns, and the sender sends it before
+    // leaving, so publishers never block on each other. A message is
+    // counted before it is queued, so the sender never sends more than it
+    // accounts for; it may have to wait for a counted one to show up.
+    size_t idle = 0;
+    if (!s.unsent.compare_exchange_strong (idle, 1)) {
+        shard_t::pending_t *p = new (std::nothrow) shard_t::pending_t;
+        if (!p) {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (s.unsent.fetch_add (1) != 0) {
+            p->topic_id = &topic_id;
+            p->msg.init ();
+            p->msg.move (*msg);
+            p->next = s.pending.load (std::memory_order_relaxed);
+            while (!s.pending.compare_exchange_weak (p->next, p)) {
+            }
+            return 0;
+        }
+
+        // The sender left in the meantime; take over
+        delete p;
     }
 
-    int rc = _pub_socket->send (&data_msg, 0);
-    data_msg.close ();
+    std::lock_guard<std::mutex> lock (s.pub_sync);
+    const int rc = send_on (s.pub_socket, topic_id, msg);
 
+    // Leave once every counted publish has been sent
+    size_t sent = 1;
+    while (s.unsent.fetch_sub (sent) != sent) {
+        sent = send_pending (s);
+    }
     return rc;
 }
 
+size_t spot_pubsub_t::send_pending (shard_t &shard)
+{
+    shard_t::pending_t *p = shard.pending.exchange (nullptr);
+
+    // The queue is newest first
+    shard_t::pending_t *fifo = nullptr;
+    while (p) {
+        shard_t::pending_t *next = p->next;
+        p->next = fifo;
+        fifo = p;
+        p = next;
+    }
+
+    size_t sent = 0;
+    while (fifo) {
+        shard_t::pending_t *next = fifo->next;
+
+        // The publisher has already returned; a PUB send only fails when
+        // the context terminates, and then the message is dropped
+        if (send_on (shard.pub_socket, *fifo->topic_id, &fifo->msg) != 0) {
+            fifo->msg.close ();
+        }
+        delete fifo;
+        fifo = next;
+        sent++;
+    }
+    return sent;
+}
+
 // ============================================================================
 // Receiving API
 // ============================================================================
@@ -423,89 +744,88 @@ int spot_pubsub_t::recv (char *topic_buf, size_t topic_buf_size,
                           size_t *data_len,
                           int flags)
 {
-    std::shared_lock<std::shared_mutex> lock (_mutex);
-
-    // Determine if we should use non-blocking mode or timeout
-    bool use_timeout = !(flags & SL_DONTWAIT) && _rcvtimeo != 0;
-
-    // Calculate deadline for timeout
-    int timeout = _rcvtimeo;
-    uint64_t deadline = 0;
-    if (use_timeout && timeout > 0) {
-        deadline = _clock.now_ms () + timeout;
+    msg_t topic_msg;
+    if (topic_msg.init () != 0) {
+        return -1;
+    }
+    msg_t data_msg;
+    if (data_msg.init () != 0) {
+        topic_msg.close ();
+        return -1;
     }
 
-    // Retry loop for blocking mode with timeout
-    while (true) {
-        // Try to receive from XSUB
-        msg_t topic_msg;
-        if (topic_msg.init () != 0) {
-            return -1;
-        }
-
-        int rc = _recv_socket->recv (&topic_msg, SL_DONTWAIT);
-        if (rc == 0) {
-            // Got message
-            // Copy topic to buffer
-            size_t topic_size = topic_msg.size ();
-            if (topic_size > topic_buf_size) {
-                topic_msg.close ();
-                errno = EMSGSIZE;
-                return -1;
-            }
-
+    int rc = recv_msg (&topic_msg, &data_msg, flags);
+    if (rc == 0) {
+        size_t topic_size = topic_msg.size ();
+        size_t data_size = data_msg.size ();
+        if (topic_size > topic_buf_size || data_size > data_buf_size) {
+            errno = EMSGSIZE;
+            rc = -1;
+        } else {
             memcpy (topic_buf, topic_msg.data (), topic_size);
             *topic_len = topic_size;
-            topic_msg.close ();
+            memcpy (data_buf, data_msg.data (), data_size);
+            *data_len = data_size;
+        }
+    }
 
-            // Receive Frame 2: Data
-            msg_t data_msg;
-            if (data_msg.init () != 0) {
-                return -1;
-            }
+    int err = errno;
+    topic_msg.close ();
+    data_msg.close ();
+    errno = err;
 
-            if (_recv_socket->recv (&data_msg, 0) != 0) {
-                data_msg.close ();
-                return -1;
-            }
+    return rc;
+}
 
-            // Copy data to buffer
-            size_t data_size = data_msg.size ();
-            if (data_size > data_buf_size) {
-                data_msg.close ();
-                errno = EMSGSIZE;
-                return -1;
-            }
+int spot_pubsub_t::recv_msg (msg_t *topic, msg_t *data, int flags)
+{
+    std::shared_lock<std::shared_mutex> lock (_mutex);
 
-            memcpy (data_buf, data_msg.data (), data_size);
-            *data_len = data_size;
-            data_msg.close ();
+    if (!topic || !topic->check () || !data || !data->check ()) {
+        errno = EFAULT;
+        return -1;
+    }
 
-            return 0;
+    // Blocking and timed receives wait inside the XSUB itself, which sleeps
+    // on its mailbox and wakes as soon as a pipe becomes readable. The
+    // socket's SL_RCVTIMEO mirrors ours (see setsockopt).
+    //
+    // Frame 1: Topic ID. A message held back by conflation only leaves
+    // its PUB while that processes commands, which it otherwise does on
+    // the next publish; so once the XSUB runs dry, release it before
+    // waiting.
+    int rc;
+    if (_conflated_topics.empty ()) {
+        rc = _recv_socket->recv (topic, flags);
+    } else {
+        rc = _recv_socket->recv (topic, flags | SL_DONTWAIT);
+        if (rc != 0 && errno == EAGAIN) {
+            release_held ();
+            rc = _recv_socket->recv (topic, flags);
         }
+    }
+    if (rc != 0) {
+        return -1;
+    }
 
-        topic_msg.close ();
+    // Frame 2: Data. A publisher always sends it, but keep the socket in
+    // sync if a single-frame message slips through.
+    if (!(topic->flags () & msg_t::more)) {
+        data->close ();
+        return data->init ();
+    }
 
-        // No message available
-        if (flags & SL_DONTWAIT) {
-            errno = EAGAIN;
-            return -1;
-        }
+    return _recv_socket->recv (data, 0);
+}
 
-        // Check timeout
-        if (timeout > 0) {
-            uint64_t now = _clock.now_ms ();
-            if (now >= deadline) {
-                errno = EAGAIN;
-                return -1;
-            }
-        } else if (timeout == 0) {
-            errno = EAGAIN;
-            return -1;
+void spot_pubsub_t::release_held ()
+{
+    for (auto &shard : _shards) {
+        if (shard->conflated == 0) {
+            continue;
         }
-
-        // If we reach here in blocking mode, sleep briefly to avoid busy-waiting
-        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        std::lock_guard<std::mutex> pub_lock (shard->pub_sync);
+        shard->pub_socket->process_commands (0, false);
     }
 }
 
@@ -555,9 +875,10 @@ int spot_pubsub_t::set_hwm (int sndhwm, int rcvhwm)
         }
     }
 
-    // Apply to publish socket
-    if (_pub_socket) {
-        if (_pub_socket->setsockopt (SL_SNDHWM, &_sndhwm, sizeof (_sndhwm)) != 0) {
+    // Apply to publish sockets
+    for (auto &shard : _shards) {
+        std::lock_guard<std::mutex> pub_lock (shard->pub_sync);
+        if (shard->pub_socket->setsockopt (SL_SNDHWM, &_sndhwm, sizeof (_sndhwm)) != 0) {
             return -1;
         }
     }
@@ -578,8 +899,15 @@ int spot_pubsub_t::setsockopt (int option, const void *value, size_t len)
                 errno = EINVAL;
                 return -1;
             }
+        {
+            std::unique_lock<std::shared_mutex> lock (_mutex);
+
+            if (_recv_socket->setsockopt (SL_RCVTIMEO, value, len) != 0) {
+                return -1;
+            }
             _rcvtimeo = *static_cast<const int *> (value);
             return 0;
+        }
         default:
             errno = EINVAL;
             return -1;
@@ -622,9 +950,36 @@ int spot_pubsub_t::bind (const std::string &endpoint)
         return -1;
     }
 
-    // Bind shared XPUB to the endpoint (in addition to inproc)
-    if (_pub_socket->bind (endpoint.c_str ()) != 0) {
-        return -1;
+    // Derive every shard's endpoint before binding any
+    std::vector<std::string> endpoints;
+    for (size_t i = 0; i < _shards.size (); i++) {
+        endpoints.push_back (shard_endpoint (endpoint, i));
+        if (endpoints.back ().empty ()) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    // Bind the PUBs to the endpoints (in addition to inproc). Unbinding
+    // needs the resolved endpoint, as for a wildcard address.
+    for (size_t i = 0; i < _shards.size (); i++) {
+        std::lock_guard<std::mutex> pub_lock (_shards[i]->pub_sync);
+        socket_base_t *pub_socket = _shards[i]->pub_socket;
+        if (pub_socket->bind (endpoints[i].c_str ()) != 0) {
+            const int err = errno;
+            for (size_t j = 0; j < i; j++) {
+                std::lock_guard<std::mutex> rollback_lock (_shards[j]->pub_sync);
+                _shards[j]->pub_socket->term_endpoint (endpoints[j].c_str ());
+            }
+            errno = err;
+            return -1;
+        }
+
+        char last_endpoint[256];
+        size_t len = sizeof (last_endpoint);
+        if (pub_socket->getsockopt (SL_LAST_ENDPOINT, last_endpoint, &len) == 0) {
+            endpoints[i] = last_endpoint;
+        }
     }
 
     _bind_endpoints.insert (endpoint);
@@ -647,8 +1002,8 @@ int spot_pubsub_t::cluster_add (const std::string &endpoint)
         return -1;
     }
 
-    // Connect XSUB to remote XPUB
-    if (_recv_socket->connect (endpoint.c_str ()) != 0) {
+    // Connect XSUB to the remote PUBs
+    if (connect_node (endpoint) != 0) {
         return -1;
     }
 
@@ -667,11 +1022,14 @@ int spot_pubsub_t::cluster_remove (const std::string &endpoint)
         return -1;
     }
 
-    // Disconnect XSUB from remote XPUB using term_endpoint
-    if (_recv_socket->term_endpoint (endpoint.c_str ()) != 0) {
-        // Endpoint might already be disconnected, continue anyway
-        if (errno != ENOENT) {
-            return -1;
+    // Disconnect XSUB from the remote PUBs using term_endpoint
+    for (size_t i = 0; i < _shards.size (); i++) {
+        const std::string shard_ep = shard_endpoint (endpoint, i);
+        if (_recv_socket->term_endpoint (shard_ep.c_str ()) != 0) {
+            // Endpoint might already be disconnected, continue anyway
+            if (errno != ENOENT) {
+                return -1;
+            }
         }
     }
 
@@ -682,7 +1040,7 @@ int spot_pubsub_t::cluster_remove (const std::string &endpoint)
 
 int spot_pubsub_t::cluster_sync (int timeout_ms)
 {
-    // With the simplified XPUB/XSUB architecture, cluster sync is not needed
+    // With the simplified PUB/XSUB architecture, cluster sync is not needed
     // Topics are discovered through subscription messages
     (void) timeout_ms;
     return 0;
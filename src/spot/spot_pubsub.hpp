@@ -5,18 +5,47 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <atomic>
 #include <cstdint>
-#include "util/clock.hpp"
 
 namespace slk
 {
 class ctx_t;
 class socket_base_t;
+class msg_t;
 class topic_registry_t;
 class subscription_manager_t;
+class spot_pubsub_t;
+
+/**
+ * @brief Pre-resolved handle to a LOCAL topic
+ *
+ * Handles are owned by their spot_pubsub_t and stay allocated until it is
+ * destroyed, so a stale handle is always safe to use. The epoch is odd
+ * while the topic exists and even after topic_destroy(); publishing through
+ * a handle only checks it, without touching the registry or the instance
+ * lock. Re-creating the topic makes existing handles valid again.
+ */
+struct spot_topic_t
+{
+    spot_topic_t (spot_pubsub_t *spot_, const std::string &topic_id_,
+                  size_t shard_)
+        : spot (spot_), topic_id (topic_id_), shard (shard_), epoch (0)
+    {
+    }
+
+    bool live () const { return (epoch.load (std::memory_order_acquire) & 1) != 0; }
+
+    spot_pubsub_t *const spot;
+    const std::string topic_id;
+    const size_t shard;
+    std::atomic<uint32_t> epoch;
+};
 
 /**
  * @brief SPOT PUB/SUB - Single Point Of Topic
@@ -27,16 +56,28 @@ class subscription_manager_t;
  * - Position-transparent publish/subscribe (inproc/tcp)
  *
  * Architecture:
- *   - One shared XPUB socket per SPOT instance (bound to inproc + optional TCP)
- *   - One shared XSUB socket per SPOT instance (connects to local and remote XPUBs)
- *   - topic_create() → registers topic, publishes through shared XPUB
- *   - subscribe()    → connects XSUB to XPUB (local or remote)
- *   - publish()      → sends to shared XPUB
+ *   - One PUB socket per shard (bound to inproc + optional TCP); a topic
+ *     always publishes through the shard its ID hashes to
+ *   - One shared XSUB socket per SPOT instance (connects to every local
+ *     shard and to remote PUBs), fair-queuing across them
+ *   - topic_create() → registers topic, publishes through its shard's PUB
+ *   - subscribe()    → connects XSUB to PUB (local or remote)
+ *   - publish()      → sends to shared PUB
  *   - recv()         → receives from XSUB
  *
  * Thread-safety:
  *   - All public methods are thread-safe
  *   - Internal state protected by shared_mutex
+ *   - Handle-based publishing never takes the shared_mutex, and
+ *     publishers never wait for each other: one thread at a time sends on
+ *     a shard's PUB, and a publisher that finds it busy queues its message
+ *     for that thread to send (see send_frames())
+ *
+ * Sharding:
+ *   Shard i binds and connects to endpoints derived from the ones given:
+ *   port + i for TCP, ".i" appended for other transports (shard 0 uses
+ *   the endpoint as is). Topics hash to shards the same way on every
+ *   node, so all nodes of a cluster must use the same shard count.
  */
 class spot_pubsub_t
 {
@@ -45,8 +86,10 @@ class spot_pubsub_t
      * @brief Construct a new SPOT PUB/SUB instance
      *
      * @param ctx Context for creating sockets
+     * @param shards Number of publishing shards (1 to max_shards); shard i
+     *        prefers I/O thread i modulo the context's I/O threads
      */
-    explicit spot_pubsub_t (ctx_t *ctx);
+    explicit spot_pubsub_t (ctx_t *ctx, int shards = 1);
 
     /**
      * @brief Destroy the SPOT PUB/SUB instance
@@ -65,15 +108,24 @@ class spot_pubsub_t
     // Topic Ownership
     // ========================================================================
 
+    // topic_create() flags
+    static constexpr int topic_conflate = 1;
+
+    // Shard count limit (one bit of SL_AFFINITY each)
+    static constexpr int max_shards = 64;
+
     /**
      * @brief Create a local topic (this node is the publisher)
      *
-     * Registers the topic. Messages are published through the shared XPUB.
+     * Registers the topic. Messages are published through the shared PUB.
+     * With topic_conflate, a subscriber that falls behind by the send HWM
+     * only gets the newest message of the topic once it catches up.
      *
      * @param topic_id Topic identifier
+     * @param flags 0 or topic_conflate
      * @return 0 on success, -1 on error (sets errno to EEXIST if already exists)
      */
-    int topic_create (const std::string &topic_id);
+    int topic_create (const std::string &topic_id, int flags = 0);
 
     /**
      * @brief Destroy a topic
@@ -97,6 +149,19 @@ class spot_pubsub_t
      */
     int topic_route (const std::string &topic_id, const std::string &endpoint);
 
+    /**
+     * @brief Look up a pre-resolved handle for a LOCAL topic
+     *
+     * The handle remains owned by this instance and can be passed to
+     * publish() from any thread for the lifetime of the instance.
+     *
+     * @param topic_id Topic identifier
+     * @return Topic handle, or nullptr on error
+     *         errno = ENOENT if topic not found
+     *         errno = EINVAL if topic is not LOCAL
+     */
+    spot_topic_t *topic_lookup (const std::string &topic_id) const;
+
     // ========================================================================
     // Subscription API
     // ========================================================================
@@ -104,8 +169,8 @@ class spot_pubsub_t
     /**
      * @brief Subscribe to a topic
      *
-     * For LOCAL topics: sends subscription filter to local XPUB.
-     * For REMOTE topics: connects XSUB to remote XPUB and sends subscription filter.
+     * For LOCAL topics: sends subscription filter to local PUB.
+     * For REMOTE topics: connects XSUB to remote PUB and sends subscription filter.
      *
      * @param topic_id Topic identifier
      * @return 0 on success, -1 on error (sets errno to ENOENT if topic not found)
@@ -123,6 +188,36 @@ class spot_pubsub_t
      */
     int subscribe_pattern (const std::string &pattern);
 
+    /**
+     * @brief Subscribe to a rectangle of cells on a grid
+     *
+     * Cell topics are named "<grid>:<x>,<y>" with decimal coordinates.
+     * The rectangle is inclusive and need not consist of existing topics.
+     * Publishers match it in a spatial index, so moving an area of
+     * interest is a single call per grid: calling this again replaces the
+     * grid's rectangle instead of adding one.
+     *
+     * @param grid Grid name (the topic part before the last ':')
+     * @param x0 First column
+     * @param y0 First row
+     * @param x1 Last column
+     * @param y1 Last row
+     * @return 0 on success, -1 on error (EINVAL if x0 > x1 or y0 > y1)
+     */
+    int subscribe_region (const std::string &grid,
+                          int32_t x0,
+                          int32_t y0,
+                          int32_t x1,
+                          int32_t y1);
+
+    /**
+     * @brief Drop the region subscription on a grid
+     *
+     * @param grid Grid name
+     * @return 0 on success, -1 on error (ENOENT if no region is set)
+     */
+    int unsubscribe_region (const std::string &grid);
+
     /**
      * @brief Subscribe to multiple topics at once
      *
@@ -146,7 +241,7 @@ class spot_pubsub_t
     /**
      * @brief Publish a message to a topic
      *
-     * Sends message to shared XPUB socket.
+     * Sends message to shared PUB socket.
      * Message format: [topic_id][data]
      *
      * @param topic_id Topic identifier
@@ -158,6 +253,47 @@ class spot_pubsub_t
      */
     int publish (const std::string &topic_id, const void *data, size_t len);
 
+    /**
+     * @brief Publish a caller-built message to a topic without copying it
+     *
+     * The payload is handed to the PUB as is, so a message initialised
+     * over an external buffer (msg_t::init_data) is delivered to inproc
+     * subscribers without any copy. On success the message is emptied and
+     * ownership of its content passes to the library, exactly as with
+     * socket_base_t::send. On failure the caller still owns the message.
+     *
+     * @param topic_id Topic identifier
+     * @param msg Message to publish (payload frame)
+     * @return 0 on success, -1 on error
+     *         errno = ENOENT if topic not found
+     *         errno = EAGAIN if HWM reached (non-blocking)
+     */
+    int publish_msg (const std::string &topic_id, msg_t *msg);
+
+    /**
+     * @brief Publish through a pre-resolved topic handle
+     *
+     * Skips the registry lookup and the instance lock. Ownership of msg
+     * follows publish_msg().
+     *
+     * @param topic Handle returned by topic_lookup() on this instance
+     * @param msg Message to publish (payload frame)
+     * @return 0 on success, -1 on error
+     *         errno = ENOENT if the topic was destroyed
+     *         errno = EAGAIN if HWM reached (non-blocking)
+     */
+    int publish (spot_topic_t *topic, msg_t *msg);
+
+    /**
+     * @brief Publish a copied buffer through a pre-resolved topic handle
+     *
+     * @param topic Handle returned by topic_lookup() on this instance
+     * @param data Message data
+     * @param len Message length
+     * @return 0 on success, -1 on error (see publish (spot_topic_t *, msg_t *))
+     */
+    int publish (spot_topic_t *topic, const void *data, size_t len);
+
     // ========================================================================
     // Receiving API
     // ========================================================================
@@ -181,6 +317,21 @@ class spot_pubsub_t
               void *data_buf, size_t data_buf_size, size_t *data_len,
               int flags);
 
+    /**
+     * @brief Receive a message into caller-owned msg_t objects
+     *
+     * Both frames are moved into the given messages without copying, so
+     * there is no size limit on the topic or the payload. Previous contents
+     * of the messages are released.
+     *
+     * @param topic [out] Initialised message receiving the topic frame
+     * @param data [out] Initialised message receiving the data frame
+     * @param flags Receive flags (SLK_DONTWAIT)
+     * @return 0 on success, -1 on error
+     *         errno = EAGAIN if no message available (non-blocking)
+     */
+    int recv_msg (msg_t *topic, msg_t *data, int flags);
+
     // ========================================================================
     // Introspection API
     // ========================================================================
@@ -224,6 +375,9 @@ class spot_pubsub_t
     /**
      * @brief Set socket option
      *
+     * SLK_RCVTIMEO is applied to the underlying XSUB and takes effect for
+     * the next recv() call; it waits for a recv() in progress to return.
+     *
      * @param option Option identifier (e.g., SLK_RCVTIMEO)
      * @param value Option value
      * @param len Value size
@@ -246,9 +400,10 @@ class spot_pubsub_t
     // ========================================================================
 
     /**
-     * @brief Bind XPUB to an endpoint for remote subscribers
+     * @brief Bind PUB to an endpoint for remote subscribers
      *
-     * Binds the shared XPUB socket to accept remote connections.
+     * Binds every shard's PUB socket to accept remote connections. With
+     * more than one shard, a TCP endpoint needs an explicit port.
      *
      * @param endpoint Bind endpoint (e.g., "tcp://*:5555")
      * @return 0 on success, -1 on error
@@ -256,7 +411,7 @@ class spot_pubsub_t
     int bind (const std::string &endpoint);
 
     /**
-     * @brief Add a cluster node (connect XSUB to remote XPUB)
+     * @brief Add a cluster node (connect XSUB to remote PUB)
      *
      * @param endpoint Remote node endpoint (e.g., "tcp://192.168.1.100:5555")
      * @return 0 on success, -1 on error
@@ -265,7 +420,7 @@ class spot_pubsub_t
     int cluster_add (const std::string &endpoint);
 
     /**
-     * @brief Remove a cluster node (disconnect XSUB from remote XPUB)
+     * @brief Remove a cluster node (disconnect XSUB from remote PUB)
      *
      * @param endpoint Remote node endpoint
      * @return 0 on success, -1 on error
@@ -276,7 +431,7 @@ class spot_pubsub_t
     /**
      * @brief Synchronize topics with cluster nodes
      *
-     * With XPUB/XSUB architecture, this is a no-op (topics discovered via subscription).
+     * With PUB/XSUB architecture, this is a no-op (topics discovered via subscription).
      *
      * @param timeout_ms Timeout in milliseconds (unused)
      * @return 0 always
@@ -299,6 +454,52 @@ class spot_pubsub_t
     int fd (int *fd) const;
 
   private:
+    // Publish socket (PUB) of one shard - bound to inproc and optionally TCP
+    struct shard_t
+    {
+        ~shard_t ();
+
+        socket_base_t *pub_socket = nullptr;
+
+        // Serialises every use of pub_socket (the PUB is not thread-safe)
+        std::mutex pub_sync;
+
+        // Messages queued by publishers that found the shard busy, newest
+        // first, and the number of publishes not yet sent. The publisher
+        // that raises the count from zero sends until it drops back to it
+        struct pending_t;
+        std::atomic<pending_t *> pending{nullptr};
+        std::atomic<size_t> unsent{0};
+
+        // Conflated topics publishing through this shard
+        int conflated = 0;
+    };
+
+    // Send [topic_id][msg] through the PUB of the given shard, or queue it
+    // for the thread sending on it. Takes ownership of msg on success
+    int send_frames (size_t shard, const std::string &topic_id, msg_t *msg);
+
+    // Send the queued messages of a shard in publish order; returns how
+    // many were sent. Called with pub_sync held
+    static size_t send_pending (shard_t &shard);
+
+    // Shard a topic publishes through; stable across nodes and builds
+    size_t shard_of (const std::string &topic_id) const;
+
+    // Endpoint of the given shard derived from a node endpoint, or an
+    // empty string if a TCP endpoint has no port to derive from
+    std::string shard_endpoint (const std::string &endpoint, size_t shard) const;
+
+    // Let the shards with conflated topics write out the messages they
+    // hold back for subscribers that have caught up since
+    void release_held ();
+
+    // Connect the XSUB to every shard of a node (all or nothing)
+    int connect_node (const std::string &endpoint);
+
+    // Close all sockets (constructor failure and destructor)
+    void close_sockets ();
+
     // Context
     ctx_t *_ctx;
 
@@ -306,13 +507,16 @@ class spot_pubsub_t
     std::unique_ptr<topic_registry_t> _registry;
     std::unique_ptr<subscription_manager_t> _sub_manager;
 
-    // Shared publish socket (XPUB) - bound to inproc and optionally TCP
-    socket_base_t *_pub_socket;
+    // Publishing shards, fixed for the lifetime of the instance
+    std::vector<std::unique_ptr<shard_t>> _shards;
+
+    // LOCAL topic handles, kept for the lifetime of the instance
+    std::unordered_map<std::string, std::unique_ptr<spot_topic_t>> _handles;
 
-    // Receive socket (XSUB) - connects to local XPUB and remote XPUBs
+    // Receive socket (XSUB) - connects to local PUB and remote PUBs
     socket_base_t *_recv_socket;
 
-    // Endpoints
+    // Endpoints (node endpoints; see shard_endpoint())
     std::string _inproc_endpoint;  // Local inproc endpoint (always set)
     std::string _bind_endpoint;    // Primary TCP bind endpoint (first TCP bind)
     std::unordered_set<std::string> _bind_endpoints;  // All bound endpoints
@@ -320,13 +524,18 @@ class spot_pubsub_t
     // Connected remote endpoints (for deduplication)
     std::unordered_set<std::string> _connected_endpoints;
 
+    // LOCAL topics created with topic_conflate
+    std::unordered_set<std::string> _conflated_topics;
+
+    // Grids with a region subscription
+    std::unordered_set<std::string> _region_grids;
+
     // High water marks
     int _sndhwm;
     int _rcvhwm;
 
     // Timeout support
     int _rcvtimeo;     // Receive timeout in milliseconds (-1 = infinite)
-    clock_t _clock;    // Clock for timeout calculation
 
     // Thread safety
     mutable std::shared_mutex _mutex;
@@ -30,6 +30,9 @@ inline constexpr char tcp[] = "tcp";
 #if defined SL_HAVE_IPC
 inline constexpr char ipc[] = "ipc";
 #endif
+#if defined SL_HAVE_SHM
+inline constexpr char shm[] = "shm";
+#endif
 inline constexpr char inproc[] = "inproc";
 }
 
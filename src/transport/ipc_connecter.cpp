@@ -10,6 +10,7 @@
 
 #include "ipc_connecter.hpp"
 #include "../io/asio/ipc_stream.hpp"
+#include "../io/uring/uring_stream.hpp"
 #include "../io/io_thread.hpp"
 #include "../util/config.hpp"
 #include "../util/err.hpp"
@@ -62,7 +63,13 @@ void slk::ipc_connecter_t::handle_connect(const asio::error_code& ec)
     }
 
     // Create stream and engine
-    auto stream = std::make_unique<ipc_stream_t>(std::move(_socket));
+    std::unique_ptr<i_async_stream> stream;
+#ifdef SL_HAVE_IO_URING
+    if (uring_t *uring = _io_thread->get_uring())
+        stream = uring_stream_t::adopt(uring, _socket);
+#endif
+    if (!stream)
+        stream = std::make_unique<ipc_stream_t>(std::move(_socket));
     
     create_engine(std::move(stream), _endpoint);
 }
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+
+#if defined SL_HAVE_SHM
+
+#include <new>
+#include <string>
+#include <memory>
+
+#include "shm_connecter.hpp"
+#include "../io/shm/shm_stream.hpp"
+#include "../io/io_thread.hpp"
+#include "../util/config.hpp"
+#include "../util/err.hpp"
+#include "../core/session_base.hpp"
+#include "address.hpp"
+
+slk::shm_connecter_t::shm_connecter_t(io_thread_t *io_thread_,
+                                       session_base_t *session_,
+                                       const options_t &options_,
+                                       address_t *addr_,
+                                       bool delayed_start_) :
+    stream_connecter_base_t(io_thread_, session_, options_, addr_, delayed_start_),
+    _socket(io_thread_->get_io_context())
+{
+    _path = shm_stream_t::control_path(_addr->address);
+}
+
+slk::shm_connecter_t::~shm_connecter_t()
+{
+}
+
+void slk::shm_connecter_t::close()
+{
+    if (_socket.is_open()) {
+        asio::error_code ec;
+        _socket.close(ec);
+    }
+}
+
+void slk::shm_connecter_t::start_connecting()
+{
+    asio::local::stream_protocol::endpoint endpoint(_path);
+
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _socket.async_connect(endpoint,
+        [this, sentinel](const asio::error_code& ec) {
+            if (sentinel.expired()) return;
+            handle_connect(ec);
+        });
+}
+
+void slk::shm_connecter_t::handle_connect(const asio::error_code& ec)
+{
+    if (ec) {
+        if (ec != asio::error::operation_aborted) {
+            close();
+            add_reconnect_timer();
+        }
+        return;
+    }
+
+    wait_for_region();
+}
+
+void slk::shm_connecter_t::wait_for_region()
+{
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _socket.async_wait(asio::local::stream_protocol::socket::wait_read,
+        [this, sentinel](const asio::error_code& ec) {
+            if (sentinel.expired()) return;
+            handle_region(ec);
+        });
+}
+
+void slk::shm_connecter_t::handle_region(const asio::error_code& ec)
+{
+    if (ec == asio::error::operation_aborted)
+        return;
+
+    std::unique_ptr<i_async_stream> stream;
+    if (!ec) {
+        stream = shm_stream_t::attach(_socket);
+        if (!stream && errno == EAGAIN) {
+            wait_for_region();
+            return;
+        }
+    }
+    if (!stream) {
+        close();
+        add_reconnect_timer();
+        return;
+    }
+
+    create_engine(std::move(stream), _endpoint);
+}
+
+#endif  // SL_HAVE_SHM
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SERVERLINK_SHM_CONNECTER_HPP_INCLUDED
+#define SERVERLINK_SHM_CONNECTER_HPP_INCLUDED
+
+#include "../util/config.hpp"
+
+#if defined SL_HAVE_SHM
+
+#include <asio.hpp>
+#include <string>
+#include "../util/constants.hpp"
+#include "stream_connecter_base.hpp"
+
+namespace slk
+{
+
+class io_thread_t;
+class session_base_t;
+
+class shm_connecter_t final : public stream_connecter_base_t
+{
+  public:
+    // If 'delayed_start' is true connecter first waits for a while,
+    // then starts connection process.
+    shm_connecter_t(slk::io_thread_t *io_thread_,
+                    slk::session_base_t *session_,
+                    const options_t &options_,
+                    address_t *addr_,
+                    bool delayed_start_);
+    ~shm_connecter_t() override;
+
+  protected:
+    // Overrides from stream_connecter_base_t
+    void start_connecting() override;
+    void close() override;
+
+  private:
+    // Handlers for async operations
+    void handle_connect(const asio::error_code& ec);
+
+    //  Waits for the listener to pass the shared memory region.
+    void wait_for_region();
+    void handle_region(const asio::error_code& ec);
+
+    // Control socket to the listener
+    asio::local::stream_protocol::socket _socket;
+    std::string _path;
+
+    SL_NON_COPYABLE_NOR_MOVABLE(shm_connecter_t)
+};
+
+}  // namespace slk
+
+#endif  // SL_HAVE_SHM
+#endif  // SERVERLINK_SHM_CONNECTER_HPP_INCLUDED
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "precompiled.hpp"
+
+#if defined SL_HAVE_SHM
+
+#include <new>
+#include <string>
+#include <memory>
+
+#include "shm_listener.hpp"
+#include "../io/shm/shm_stream.hpp"
+#include "../io/io_thread.hpp"
+#include "../util/config.hpp"
+#include "../util/err.hpp"
+#include "../core/socket_base.hpp"
+#include "address.hpp"
+
+slk::shm_listener_t::shm_listener_t(io_thread_t *io_thread_,
+                                     socket_base_t *socket_,
+                                     const options_t &options_) :
+    stream_listener_base_t(io_thread_, socket_, options_),
+    _acceptor(io_thread_->get_io_context()),
+    _lifetime_sentinel(std::make_shared<int>(0))
+{
+}
+
+slk::shm_listener_t::~shm_listener_t()
+{
+}
+
+void slk::shm_listener_t::close()
+{
+    if (_acceptor.is_open()) {
+        asio::error_code ec;
+        _acceptor.close(ec);
+    }
+}
+
+int slk::shm_listener_t::set_local_address(const char *addr_)
+{
+    const std::string path = shm_stream_t::control_path(addr_);
+    if (path.empty()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    try {
+        asio::local::stream_protocol::endpoint endpoint(path);
+        _acceptor.open(endpoint.protocol());
+        _acceptor.bind(endpoint);
+        _acceptor.listen(_options.backlog);
+    } catch (const asio::system_error& e) {
+        close();
+        errno = e.code().value();
+        return -1;
+    }
+
+    _endpoint = std::string(protocol_name::shm) + "://" + addr_;
+
+    start_accept();
+
+    return 0;
+}
+
+void slk::shm_listener_t::start_accept()
+{
+    std::weak_ptr<int> sentinel = _lifetime_sentinel;
+    _acceptor.async_accept(
+        [this, sentinel](const asio::error_code& ec, asio::local::stream_protocol::socket socket) {
+            if (sentinel.expired()) return;
+            handle_accept(ec, std::move(socket));
+        });
+}
+
+void slk::shm_listener_t::handle_accept(const asio::error_code& ec, asio::local::stream_protocol::socket socket)
+{
+    if (ec)
+        return;
+
+    // Re-home the socket onto the least loaded I/O thread, as for ipc://
+    io_thread_t *io_thread = choose_session_thread();
+    asio::local::stream_protocol::socket migrated(io_thread->get_io_context());
+    if (&io_thread->get_io_context() != &_acceptor.get_executor().context()) {
+        asio::error_code mec;
+        const asio::local::stream_protocol::socket::native_handle_type fd =
+          socket.release(mec);
+        if (!mec)
+            migrated.assign(asio::local::stream_protocol(), fd, mec);
+        if (mec) {
+            start_accept();
+            return;
+        }
+    } else {
+        migrated = std::move(socket);
+    }
+
+    // Hand the peer its region; a peer that cannot take it is dropped
+    std::unique_ptr<i_async_stream> stream = shm_stream_t::create(migrated);
+    if (stream)
+        create_engine(std::move(stream), io_thread);
+
+    // Continue the accept loop
+    start_accept();
+}
+
+#endif  // SL_HAVE_SHM
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SERVERLINK_SHM_LISTENER_HPP_INCLUDED
+#define SERVERLINK_SHM_LISTENER_HPP_INCLUDED
+
+#include "../util/config.hpp"
+
+#if defined SL_HAVE_SHM
+
+#include <asio.hpp>
+#include <string>
+#include "stream_listener_base.hpp"
+
+namespace slk
+{
+
+class io_thread_t;
+class socket_base_t;
+
+//  Accepts shm:// connections. Each accepted control socket gets a fresh
+//  shared memory region, which then carries all of its traffic.
+
+class shm_listener_t final : public stream_listener_base_t
+{
+  public:
+    shm_listener_t(slk::io_thread_t *io_thread_,
+                   slk::socket_base_t *socket_,
+                   const options_t &options_);
+    ~shm_listener_t() override;
+
+    // Set the endpoint name to listen on
+    int set_local_address(const char *addr_);
+
+  private:
+    //  Start the accept loop.
+    void start_accept();
+
+    //  Handler for a new connection.
+    void handle_accept(const asio::error_code& ec, asio::local::stream_protocol::socket socket);
+
+    // Close the listening socket
+    void close() override;
+
+    //  Asio acceptor for incoming control connections.
+    asio::local::stream_protocol::acceptor _acceptor;
+
+    // Lifetime sentinel for async handlers.
+    std::shared_ptr<int> _lifetime_sentinel;
+
+    SL_NON_COPYABLE_NOR_MOVABLE(shm_listener_t)
+};
+
+}  // namespace slk
+
+#endif  // SL_HAVE_SHM
+#endif  // SERVERLINK_SHM_LISTENER_HPP_INCLUDED
@@ -21,6 +21,7 @@ slk::stream_connecter_base_t::stream_connecter_base_t (
     own_t (io_thread_, options_),
     _addr (addr_),
     _socket (session_->get_socket ()),
+    _io_thread (io_thread_),
     _reconnect_timer(io_thread_->get_io_context()),
     _delayed_start (delayed_start_),
     _current_reconnect_ivl (-1),
@@ -58,6 +58,9 @@ class stream_connecter_base_t : public own_t
 
     // Socket
     slk::socket_base_t *const _socket;
+
+    //  I/O thread the connecter and the engine it creates run in.
+    slk::io_thread_t *const _io_thread;
     
     //  Asio timer for reconnect logic.
     asio::steady_timer _reconnect_timer;
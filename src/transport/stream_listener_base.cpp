@@ -43,7 +43,17 @@ void slk::stream_listener_base_t::process_term (int linger_)
     own_t::process_term (linger_);
 }
 
-void slk::stream_listener_base_t::create_engine (std::unique_ptr<i_async_stream> stream)
+slk::io_thread_t *slk::stream_listener_base_t::choose_session_thread ()
+{
+    //  Given that we are already running in an I/O thread, there must be
+    //  at least one available.
+    io_thread_t *io_thread = choose_io_thread (_options.affinity);
+    slk_assert (io_thread);
+    return io_thread;
+}
+
+void slk::stream_listener_base_t::create_engine (std::unique_ptr<i_async_stream> stream,
+                                                 io_thread_t *io_thread_)
 {
     // TODO: The endpoint retrieval needs to be done within the Asio-specific
     // listener and passed along. For now, using the stored endpoint.
@@ -54,14 +64,9 @@ void slk::stream_listener_base_t::create_engine (std::unique_ptr<i_async_stream>
       new (std::nothrow) zmtp_engine_t (std::move(stream), _options, endpoint_pair);
     alloc_assert (engine);
 
-    //  Choose I/O thread to run session in. Given that we are already
-    //  running in an I/O thread, there must be at least one available.
-    io_thread_t *io_thread = choose_io_thread (_options.affinity);
-    slk_assert (io_thread);
-
     //  Create and launch a session object.
     session_base_t *session =
-      session_base_t::create (io_thread, false, _socket, _options, NULL);
+      session_base_t::create (io_thread_, false, _socket, _options, NULL);
     errno_assert (session);
     session->inc_seqnum ();
     launch_child (session);
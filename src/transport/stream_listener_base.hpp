@@ -28,8 +28,14 @@ class stream_listener_base_t : public own_t
     int get_local_address (std::string &addr_) const;
 
   protected:
-    // This method is now responsible for creating the engine with an async stream
-    void create_engine (std::unique_ptr<i_async_stream> stream);
+    //  Chooses the I/O thread that will run the session and engine of
+    //  a newly accepted connection.
+    slk::io_thread_t *choose_session_thread ();
+
+    // This method is now responsible for creating the engine with an async stream.
+    // The stream must already be bound to io_thread_'s io_context.
+    void create_engine (std::unique_ptr<i_async_stream> stream,
+                        slk::io_thread_t *io_thread_);
 
     // Socket the listener belongs to.
     slk::socket_base_t *_socket;
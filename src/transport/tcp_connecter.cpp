@@ -15,6 +15,7 @@
 #include "tcp_address.hpp"
 #include "../core/session_base.hpp"
 #include "../io/asio/tcp_stream.hpp"
+#include "../io/uring/uring_stream.hpp"
 
 slk::tcp_connecter_t::tcp_connecter_t (class io_thread_t *io_thread_,
                                        class session_base_t *session_,
@@ -106,7 +107,13 @@ void slk::tcp_connecter_t::handle_connect(const asio::error_code& ec, const asio
     }
 
     // Create stream and engine
-    auto stream = std::make_unique<tcp_stream_t>(std::move(_socket));
+    std::unique_ptr<i_async_stream> stream;
+#ifdef SL_HAVE_IO_URING
+    if (uring_t *uring = _io_thread->get_uring())
+        stream = uring_stream_t::adopt(uring, _socket);
+#endif
+    if (!stream)
+        stream = std::make_unique<tcp_stream_t>(std::move(_socket));
     std::string local_addr = "tcp://" + endpoint.address().to_string() + ":" + std::to_string(endpoint.port()); // Actually remote addr, but used for endpoint pair
     
     create_engine(std::move(stream), local_addr);
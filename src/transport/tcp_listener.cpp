@@ -6,6 +6,7 @@
 
 #include "tcp_listener.hpp"
 #include "../io/asio/tcp_stream.hpp"
+#include "../io/uring/uring_stream.hpp"
 #include "../io/io_thread.hpp"
 #include "../util/err.hpp"
 #include "tcp.hpp"
@@ -107,11 +108,34 @@ void slk::tcp_listener_t::handle_accept(const asio::error_code& ec, asio::ip::tc
         // Ignore errors, proceed with default options
     }
 
+    // Re-home the socket onto the least loaded I/O thread so that
+    // connections accepted by one listener spread across all threads.
+    io_thread_t *io_thread = choose_session_thread();
+    asio::ip::tcp::socket migrated(io_thread->get_io_context());
+    if (&io_thread->get_io_context() != &_acceptor.get_executor().context()) {
+        asio::error_code mec;
+        const asio::ip::tcp::socket::native_handle_type fd = socket.release(mec);
+        if (!mec)
+            migrated.assign(_acceptor.local_endpoint().protocol(), fd, mec);
+        if (mec) {
+            start_accept();
+            return;
+        }
+    } else {
+        migrated = std::move(socket);
+    }
+
     // Create the async stream wrapper for the socket
-    auto stream = std::make_unique<tcp_stream_t>(std::move(socket));
+    std::unique_ptr<i_async_stream> stream;
+#ifdef SL_HAVE_IO_URING
+    if (uring_t *uring = io_thread->get_uring())
+        stream = uring_stream_t::adopt(uring, migrated);
+#endif
+    if (!stream)
+        stream = std::make_unique<tcp_stream_t>(std::move(migrated));
     
     // Hand off the new stream to the base class to create the engine
-    create_engine(std::move(stream));
+    create_engine(std::move(stream), io_thread);
 
     // Continue the accept loop
     start_accept();
@@ -179,6 +179,34 @@ uint64_t slk::clock_t::now_ms()
     return _last_time;
 }
 
+uint64_t slk::clock_t::now_cached_us()
+{
+    // Per-thread cache, so no synchronisation is needed.
+    static thread_local uint64_t last_tsc = 0;
+    static thread_local uint64_t last_time = 0;
+
+    const uint64_t tsc = rdtsc();
+
+    if (!tsc) {
+#if defined(CLOCK_MONOTONIC_COARSE)
+        // Without a TSC the kernel's coarse clock is the next cheapest
+        // source; it shares the time base of CLOCK_MONOTONIC.
+        struct timespec tv;
+        if (clock_gettime(CLOCK_MONOTONIC_COARSE, &tv) == 0)
+            return tv.tv_sec * usecs_per_sec + tv.tv_nsec / nsecs_per_usec;
+#endif
+        return now_us();
+    }
+
+    if (likely(last_time && tsc >= last_tsc
+               && tsc - last_tsc <= cached_clock_precision))
+        return last_time;
+
+    last_tsc = tsc;
+    last_time = now_us();
+    return last_time;
+}
+
 uint64_t slk::clock_t::rdtsc()
 {
 #if (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
@@ -33,6 +33,12 @@ class clock_t {
     // High precision timestamp in microseconds.
     static uint64_t now_us();
 
+    // Coarse timestamp in microseconds, on the same time base as now_us()
+    // but refreshed only every cached_clock_precision CPU ticks (per
+    // thread). Meant for per-message bookkeeping; anything that measures
+    // intervals, such as RTT, should keep using now_us().
+    static uint64_t now_cached_us();
+
     // Low precision timestamp in milliseconds. In tight loops generating it
     // can be 10 to 100 times faster than the high precision timestamp.
     uint64_t now_ms();
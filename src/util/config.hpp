@@ -32,12 +32,25 @@ inline constexpr int max_wm_delta = 1024;
 // Maximum number of events the I/O thread can process in one go.
 inline constexpr int max_io_events = 256;
 
+// Message bodies of at least this many bytes are not copied into the
+// engine's output batch. They are passed to the socket by reference as a
+// separate segment of a single vectored (writev) write instead.
+inline constexpr int out_batch_gather_threshold = 1024;
+
+// Maximum number of segments gathered into one vectored write.
+inline constexpr int out_batch_max_segments = 64;
+
 // Maximal delay to process command in API thread (in CPU ticks).
 // 3,000,000 ticks equals to 1 - 2 milliseconds on current CPUs.
 // Note that delay is only applied when there is continuous stream of
 // messages to process. If not so, commands are processed immediately.
 inline constexpr int max_command_delay = 3000000;
 
+// Maximal number of commands processed by one non-blocking check on the
+// send/recv fast path. Whatever is left is handled by the next call, so a
+// burst of commands (e.g. a reconnect storm) cannot stall a single send.
+inline constexpr int max_command_batch = 256;
+
 // Low-precision clock precision in CPU ticks. 1ms. Value of 1000000
 // should be OK for CPU frequencies above 1GHz. If should work
 // reasonably well for CPU frequencies above 500MHz. For lower CPU
@@ -45,6 +58,18 @@ inline constexpr int max_command_delay = 3000000;
 // possible latencies.
 inline constexpr int clock_precision = 1000000;
 
+// Refresh interval of the cached microsecond clock in CPU ticks, about
+// 100us at 1GHz. Only used where per-message timestamps are taken.
+inline constexpr int cached_clock_precision = 100000;
+
+// Submission queue size of the per I/O thread io_uring. The completion
+// queue is four times larger; requests beyond it are held by the kernel.
+inline constexpr int io_uring_entries = 1024;
+
+// Size of each of the two byte rings of a shm:// connection. Must be a
+// power of two; pages are only committed once the ring wraps onto them.
+inline constexpr int shm_ring_size = 1024 * 1024;
+
 // On some OSes the signaler has to be emulated using a TCP
 // connection. In such cases following port is used.
 // If 0, it lets the OS choose a free port without requiring use of a
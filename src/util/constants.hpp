@@ -46,6 +46,11 @@ constexpr int SL_HELLO_MSG = 110;
 constexpr int SL_DISCONNECT_MSG = 111;
 constexpr int SL_PRIORITY = 112;
 constexpr int SL_HICCUP_MSG = 114;
+constexpr int SL_IN_BATCH_MAX = 115;
+constexpr int SL_INBOUND_POLL_RATE = 116;
+constexpr int SL_COMMAND_DELAY = 117;
+constexpr int SL_COMMAND_BATCH = 118;
+constexpr int SL_COMMANDS_PROCESSED = 119;
 
 // Router-specific options
 constexpr int SL_ROUTER_MANDATORY = 33;
@@ -69,8 +74,23 @@ constexpr int SL_XPUB_WELCOME_MSG = 72;
 constexpr int SL_XSUB_VERBOSE_UNSUBSCRIBE = 73;
 constexpr int SL_ONLY_FIRST_SUBSCRIBE = 108;
 constexpr int SL_TOPICS_COUNT = 80;
+constexpr int SL_XPUB_CONFLATE_TOPIC = 120;
+constexpr int SL_XPUB_UNCONFLATE_TOPIC = 121;
+constexpr int SL_SUBSCRIBE_REGION = 122;
+constexpr int SL_UNSUBSCRIBE_REGION = 123;
+constexpr int SL_XPUB_CONFLATE_EXACT = 124;
+constexpr int SL_XPUB_UNCONFLATE_EXACT = 125;
 constexpr int SL_INVERT_MATCHING = 60;
 
+// Leading byte of pattern (glob) subscribe/cancel messages sent upstream.
+// Bytes 0 and 1 are the ZMTP cancel/subscribe bytes for prefixes.
+constexpr unsigned char SL_PATTERN_CANCEL_BYTE = 2;
+constexpr unsigned char SL_PATTERN_SUBSCRIBE_BYTE = 3;
+
+// Leading byte of region (area of interest) subscribe/cancel messages
+constexpr unsigned char SL_REGION_CANCEL_BYTE = 4;
+constexpr unsigned char SL_REGION_SUBSCRIBE_BYTE = 5;
+
 // Socket types
 constexpr int SL_PAIR = 0;
 constexpr int SL_PUB = 1;
@@ -107,12 +127,17 @@ constexpr int SL_THREAD_NAME_PREFIX = 10;
 constexpr int SL_MAX_MSGSZ = 13;
 constexpr int SL_MSG_T_SIZE = 14;
 constexpr int SL_ZERO_COPY_RECV = 15;
+constexpr int SL_IO_BACKEND = 16;
 constexpr int SL_BLOCKY = 70;
 
 // Default values
 constexpr int SL_IO_THREADS_DFLT = 1;
 constexpr int SL_MAX_SOCKETS_DFLT = 1023;
 
+// I/O backends (SL_IO_BACKEND)
+constexpr int SL_IO_BACKEND_ASIO = 0;
+constexpr int SL_IO_BACKEND_IO_URING = 1;
+
 // Router notify flags
 constexpr int SL_NOTIFY_CONNECT = 1;
 constexpr int SL_NOTIFY_DISCONNECT = 2;
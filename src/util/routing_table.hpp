@@ -0,0 +1,254 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SL_ROUTING_TABLE_HPP_INCLUDED
+#define SL_ROUTING_TABLE_HPP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <utility>
+
+#include "../msg/blob.hpp"
+#include "err.hpp"
+#include "macros.hpp"
+
+namespace slk
+{
+//  Open-addressing hash table keyed on routing-id bytes.
+//
+//  Linear probing with backward-shift deletion, so there are no
+//  tombstones and a lookup stops at the first empty slot. Each slot
+//  keeps the full hash of its key next to it; probes compare hashes
+//  first and only memcmp the bytes when they match.
+//
+//  Slots are moved on insert (growth) and erase, so pointers returned
+//  by find() are only valid until the table is next modified.
+
+template <typename T> class routing_table_t
+{
+  public:
+    struct slot_t
+    {
+        //  Same shape as std::map's value_type so call sites can keep
+        //  using it->first / it->second.
+        std::pair<blob_t, T> kv;
+        size_t hash;
+        bool used;
+    };
+
+    class iterator
+    {
+      public:
+        iterator (slot_t *slot_, slot_t *end_) : _slot (slot_), _end (end_)
+        {
+            skip ();
+        }
+
+        std::pair<blob_t, T> &operator* () const { return _slot->kv; }
+        std::pair<blob_t, T> *operator-> () const { return &_slot->kv; }
+
+        iterator &operator++ ()
+        {
+            ++_slot;
+            skip ();
+            return *this;
+        }
+
+        bool operator== (const iterator &other_) const
+        {
+            return _slot == other_._slot;
+        }
+        bool operator!= (const iterator &other_) const
+        {
+            return _slot != other_._slot;
+        }
+
+      private:
+        void skip ()
+        {
+            while (_slot != _end && !_slot->used)
+                ++_slot;
+        }
+
+        slot_t *_slot;
+        slot_t *_end;
+
+        friend class routing_table_t;
+    };
+
+    routing_table_t () : _slots (NULL), _mask (0), _size (0) {}
+
+    ~routing_table_t () { destroy (); }
+
+    size_t size () const { return _size; }
+    bool empty () const { return _size == 0; }
+
+    iterator begin () { return iterator (_slots, _slots + capacity ()); }
+    iterator end ()
+    {
+        return iterator (_slots + capacity (), _slots + capacity ());
+    }
+
+    static size_t hash (const unsigned char *data_, size_t size_)
+    {
+        //  FNV-1a followed by a murmur3 finalizer. The finalizer spreads
+        //  the generated 5-byte integral ids, which differ only in their
+        //  last bytes, over the whole mask.
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i != size_; i++) {
+            h ^= data_[i];
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t> (h);
+    }
+
+    T *find (const unsigned char *data_, size_t size_)
+    {
+        const size_t pos = locate (data_, size_, hash (data_, size_));
+        return pos == npos ? NULL : &_slots[pos].kv.second;
+    }
+
+    T *find (const blob_t &key_) { return find (key_.data (), key_.size ()); }
+
+    const T *find (const blob_t &key_) const
+    {
+        return const_cast<routing_table_t *> (this)->find (key_);
+    }
+
+    //  Returns false, leaving the table untouched, if the key exists.
+    bool insert (blob_t key_, const T &value_)
+    {
+        const size_t h = hash (key_.data (), key_.size ());
+        if (locate (key_.data (), key_.size (), h) != npos)
+            return false;
+
+        //  Keep the load factor at or below 1/2.
+        if ((_size + 1) * 2 > capacity ())
+            rehash (capacity () ? capacity () * 2 : min_capacity);
+
+        size_t pos = h & _mask;
+        while (_slots[pos].used)
+            pos = (pos + 1) & _mask;
+        new (&_slots[pos].kv) std::pair<blob_t, T> (SL_MOVE (key_), value_);
+        _slots[pos].hash = h;
+        _slots[pos].used = true;
+        _size++;
+        return true;
+    }
+
+    //  Removes the key, storing its value in value_ if not NULL.
+    bool erase (const blob_t &key_, T *value_ = NULL)
+    {
+        const size_t pos =
+          locate (key_.data (), key_.size (), hash (key_.data (), key_.size ()));
+        if (pos == npos)
+            return false;
+        if (value_)
+            *value_ = _slots[pos].kv.second;
+        erase_at (pos);
+        return true;
+    }
+
+    void erase (iterator it_) { erase_at (it_._slot - _slots); }
+
+  private:
+    static const size_t npos = static_cast<size_t> (-1);
+    static const size_t min_capacity = 16;
+
+    size_t capacity () const { return _slots ? _mask + 1 : 0; }
+
+    size_t locate (const unsigned char *data_, size_t size_, size_t h_) const
+    {
+        if (!_slots)
+            return npos;
+        for (size_t pos = h_ & _mask;; pos = (pos + 1) & _mask) {
+            const slot_t &slot = _slots[pos];
+            if (!slot.used)
+                return npos;
+            if (slot.hash == h_ && slot.kv.first.size () == size_
+                && (size_ == 0
+                    || memcmp (slot.kv.first.data (), data_, size_) == 0))
+                return pos;
+        }
+    }
+
+    void erase_at (size_t pos_)
+    {
+        _slots[pos_].kv.~pair ();
+        _slots[pos_].used = false;
+        _size--;
+
+        //  Backward-shift the rest of the cluster into the hole so that
+        //  probe sequences stay unbroken.
+        size_t hole = pos_;
+        for (size_t pos = (pos_ + 1) & _mask; _slots[pos].used;
+             pos = (pos + 1) & _mask) {
+            const size_t home = _slots[pos].hash & _mask;
+            //  Move the entry if its home lies cyclically in (pos, hole].
+            const bool movable = hole <= pos ? (home <= hole || home > pos)
+                                             : (home <= hole && home > pos);
+            if (!movable)
+                continue;
+            new (&_slots[hole].kv)
+              std::pair<blob_t, T> (SL_MOVE (_slots[pos].kv));
+            _slots[hole].hash = _slots[pos].hash;
+            _slots[hole].used = true;
+            _slots[pos].kv.~pair ();
+            _slots[pos].used = false;
+            hole = pos;
+        }
+    }
+
+    void rehash (size_t new_capacity_)
+    {
+        slot_t *const old_slots = _slots;
+        const size_t old_capacity = capacity ();
+
+        _slots = static_cast<slot_t *> (malloc (new_capacity_ * sizeof (slot_t)));
+        alloc_assert (_slots);
+        for (size_t i = 0; i != new_capacity_; i++)
+            _slots[i].used = false;
+        _mask = new_capacity_ - 1;
+
+        for (size_t i = 0; i != old_capacity; i++) {
+            if (!old_slots[i].used)
+                continue;
+            size_t pos = old_slots[i].hash & _mask;
+            while (_slots[pos].used)
+                pos = (pos + 1) & _mask;
+            new (&_slots[pos].kv)
+              std::pair<blob_t, T> (SL_MOVE (old_slots[i].kv));
+            _slots[pos].hash = old_slots[i].hash;
+            _slots[pos].used = true;
+            old_slots[i].kv.~pair ();
+        }
+        free (old_slots);
+    }
+
+    void destroy ()
+    {
+        for (size_t i = 0, n = capacity (); i != n; i++)
+            if (_slots[i].used)
+                _slots[i].kv.~pair ();
+        free (_slots);
+        _slots = NULL;
+        _mask = 0;
+        _size = 0;
+    }
+
+    slot_t *_slots;
+    size_t _mask;
+    size_t _size;
+
+    SL_NON_COPYABLE_NOR_MOVABLE (routing_table_t)
+};
+}
+
+#endif
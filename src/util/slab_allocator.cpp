@@ -0,0 +1,345 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#include "slab_allocator.hpp"
+#include "err.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace slk
+{
+namespace
+{
+//  Size classes are powers of two from min_block to max_block bytes,
+//  block header included.
+const size_t min_block_shift = 7;
+const size_t class_count = 10;
+const size_t min_block = size_t (1) << min_block_shift;
+const size_t max_block = min_block << (class_count - 1);
+
+//  Upper bound on the bytes a thread keeps cached per size class. Small
+//  classes are allowed at least this many blocks regardless.
+const size_t max_cached_bytes = 256 * 1024;
+const size_t min_cached_blocks = 4;
+
+struct thread_cache_t;
+
+//  Precedes every block. While the block sits on a free list or on a
+//  remote stack its owner is implied, and the same word links the list.
+struct alignas (16) block_header_t
+{
+    union
+    {
+        thread_cache_t *owner; //  NULL for blocks taken straight from malloc
+        block_header_t *next;
+    };
+    uint32_t size_class;
+};
+
+struct thread_cache_t
+{
+    thread_cache_t () :
+        remote (NULL),
+        hits (0),
+        misses (0),
+        cached_bytes (0),
+        remote_frees (0),
+        in_use (false),
+        next_cache (NULL)
+    {
+        for (size_t i = 0; i != class_count; i++) {
+            free_list[i] = NULL;
+            free_count[i] = 0;
+        }
+    }
+
+    //  Owner thread only.
+    block_header_t *free_list[class_count];
+    size_t free_count[class_count];
+
+    //  Blocks returned by other threads (multi-producer, single consumer).
+    std::atomic<block_header_t *> remote;
+
+    //  Written by the owner only, read by slab_get_stats.
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> cached_bytes;
+
+    //  Also bumped by threads freeing into a parked cache.
+    std::atomic<uint64_t> remote_frees;
+
+    //  Changed under the registry mutex; read without it by slab_free to
+    //  tell whether anyone will drain the remote stack.
+    std::atomic<bool> in_use;
+    thread_cache_t *next_cache;
+};
+
+//  All caches ever created. A cache is never deleted: blocks it owns may
+//  still be in flight when its thread exits, so it is parked and adopted
+//  by the next thread that needs one.
+struct registry_t
+{
+    std::mutex sync;
+    thread_cache_t *head = NULL;
+};
+
+registry_t &registry ()
+{
+    //  Leaked on purpose so that it outlives thread-local destructors
+    //  running during process exit.
+    static registry_t *instance = new registry_t;
+    return *instance;
+}
+
+inline void bump (std::atomic<uint64_t> &counter_, uint64_t delta_ = 1)
+{
+    counter_.store (counter_.load (std::memory_order_relaxed) + delta_,
+                    std::memory_order_relaxed);
+}
+
+inline size_t block_size (uint32_t size_class_)
+{
+    return min_block << size_class_;
+}
+
+inline size_t max_cached_blocks (uint32_t size_class_)
+{
+    const size_t n = max_cached_bytes / block_size (size_class_);
+    return n < min_cached_blocks ? min_cached_blocks : n;
+}
+
+//  Puts a block on the local free list, or frees it if the list is full.
+void cache_block (thread_cache_t *cache_, block_header_t *block_)
+{
+    const uint32_t size_class = block_->size_class;
+    if (cache_->free_count[size_class] >= max_cached_blocks (size_class)) {
+        std::free (block_);
+        return;
+    }
+    block_->next = cache_->free_list[size_class];
+    cache_->free_list[size_class] = block_;
+    cache_->free_count[size_class]++;
+    bump (cache_->cached_bytes, block_size (size_class));
+}
+
+//  Moves blocks freed by other threads onto the local free lists.
+void drain_remote (thread_cache_t *cache_)
+{
+    block_header_t *block =
+      cache_->remote.exchange (NULL, std::memory_order_acquire);
+    uint64_t drained = 0;
+    while (block) {
+        block_header_t *next = block->next;
+        cache_block (cache_, block);
+        block = next;
+        drained++;
+    }
+    if (drained)
+        cache_->remote_frees.fetch_add (drained, std::memory_order_relaxed);
+}
+
+//  Gives everything on the remote stack of a parked cache back to the
+//  system. Any thread may call it; the exchange hands each block to
+//  exactly one caller.
+void free_remote (thread_cache_t *cache_)
+{
+    block_header_t *block =
+      cache_->remote.exchange (NULL, std::memory_order_acquire);
+    uint64_t freed = 0;
+    while (block) {
+        block_header_t *next = block->next;
+        std::free (block);
+        block = next;
+        freed++;
+    }
+    if (freed)
+        cache_->remote_frees.fetch_add (freed, std::memory_order_relaxed);
+}
+
+thread_cache_t *acquire_cache ()
+{
+    registry_t &r = registry ();
+    std::lock_guard<std::mutex> lock (r.sync);
+
+    thread_cache_t *cache = r.head;
+    while (cache && cache->in_use.load (std::memory_order_relaxed))
+        cache = cache->next_cache;
+
+    if (!cache) {
+        cache = new (std::nothrow) thread_cache_t;
+        if (!cache)
+            return NULL;
+        cache->next_cache = r.head;
+        r.head = cache;
+    }
+    //  Whatever reached the remote stack while the cache was parked is
+    //  drained by the first slab_alloc of the new owner.
+    cache->in_use.store (true);
+    return cache;
+}
+
+void release_cache (thread_cache_t *cache_)
+{
+    //  Give the cached memory back. Blocks still in flight are freed
+    //  straight to the system by whichever thread releases them.
+    for (size_t i = 0; i != class_count; i++) {
+        block_header_t *block = cache_->free_list[i];
+        while (block) {
+            block_header_t *next = block->next;
+            std::free (block);
+            block = next;
+        }
+        cache_->free_list[i] = NULL;
+        cache_->free_count[i] = 0;
+    }
+    cache_->cached_bytes.store (0, std::memory_order_relaxed);
+
+    {
+        registry_t &r = registry ();
+        std::lock_guard<std::mutex> lock (r.sync);
+        cache_->in_use.store (false);
+    }
+
+    //  A concurrent slab_free either pushed before the store above and its
+    //  block is collected here, or it sees the cache parked and cleans up
+    //  itself.
+    free_remote (cache_);
+}
+
+struct cache_holder_t
+{
+    ~cache_holder_t ();
+    thread_cache_t *cache = NULL;
+};
+
+//  Trivially destructible, so it can still be read after the holder of
+//  the exiting thread has been destroyed.
+thread_local bool tls_exited = false;
+thread_local cache_holder_t tls_holder;
+
+cache_holder_t::~cache_holder_t ()
+{
+    tls_exited = true;
+    if (cache)
+        release_cache (cache);
+    cache = NULL;
+}
+
+inline thread_cache_t *current_cache ()
+{
+    if (tls_exited)
+        return NULL;
+    if (!tls_holder.cache)
+        tls_holder.cache = acquire_cache ();
+    return tls_holder.cache;
+}
+}
+
+void *slab_alloc (size_t size_)
+{
+    const size_t total = size_ + sizeof (block_header_t);
+    if (total < size_)
+        return NULL;
+
+    thread_cache_t *cache = total <= max_block ? current_cache () : NULL;
+    if (!cache) {
+        //  Too large for the caches, or the thread is shutting down.
+        block_header_t *block =
+          static_cast<block_header_t *> (std::malloc (total));
+        if (!block)
+            return NULL;
+        block->owner = NULL;
+        block->size_class = class_count;
+        return block + 1;
+    }
+
+    uint32_t size_class = 0;
+    while (block_size (size_class) < total)
+        size_class++;
+
+    //  Drain eagerly rather than when the local list runs dry, so that
+    //  blocks of other size classes do not pile up on the remote stack.
+    //  cache_block gives back whatever exceeds the per-class limit.
+    if (cache->remote.load (std::memory_order_relaxed))
+        drain_remote (cache);
+
+    block_header_t *block = cache->free_list[size_class];
+    if (block) {
+        cache->free_list[size_class] = block->next;
+        cache->free_count[size_class]--;
+        bump (cache->hits);
+        cache->cached_bytes.store (
+          cache->cached_bytes.load (std::memory_order_relaxed)
+            - block_size (size_class),
+          std::memory_order_relaxed);
+    } else {
+        block = static_cast<block_header_t *> (
+          std::malloc (block_size (size_class)));
+        if (!block)
+            return NULL;
+        bump (cache->misses);
+    }
+
+    block->owner = cache;
+    block->size_class = size_class;
+    return block + 1;
+}
+
+void slab_free (void *ptr_)
+{
+    if (!ptr_)
+        return;
+
+    block_header_t *block = static_cast<block_header_t *> (ptr_) - 1;
+    thread_cache_t *owner = block->owner;
+    if (!owner) {
+        std::free (block);
+        return;
+    }
+
+    if (!tls_exited && tls_holder.cache == owner) {
+        cache_block (owner, block);
+        return;
+    }
+
+    //  Nobody drains the remote stack of a parked cache.
+    if (!owner->in_use.load ()) {
+        std::free (block);
+        owner->remote_frees.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    //  Freed on behalf of another thread: push onto its remote stack.
+    block->next = owner->remote.load (std::memory_order_relaxed);
+    while (!owner->remote.compare_exchange_weak (block->next, block,
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed))
+        ;
+
+    //  The owner may have exited between the check and the push, after
+    //  its final sweep of the stack; sweep it again on its behalf.
+    if (!owner->in_use.load ())
+        free_remote (owner);
+}
+
+void slab_get_stats (slab_stats_t *stats_)
+{
+    slk_assert (stats_);
+    stats_->hits = 0;
+    stats_->misses = 0;
+    stats_->remote_frees = 0;
+    stats_->cached_bytes = 0;
+
+    registry_t &r = registry ();
+    std::lock_guard<std::mutex> lock (r.sync);
+    for (thread_cache_t *cache = r.head; cache; cache = cache->next_cache) {
+        stats_->hits += cache->hits.load (std::memory_order_relaxed);
+        stats_->misses += cache->misses.load (std::memory_order_relaxed);
+        stats_->remote_frees +=
+          cache->remote_frees.load (std::memory_order_relaxed);
+        stats_->cached_bytes +=
+          cache->cached_bytes.load (std::memory_order_relaxed);
+    }
+}
+}
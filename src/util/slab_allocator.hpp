@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+#ifndef SL_SLAB_ALLOCATOR_HPP_INCLUDED
+#define SL_SLAB_ALLOCATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace slk
+{
+//  Size-classed slab allocator for message storage (msg_t content blocks,
+//  decoder receive buffers and msg_t objects handed out by the C API).
+//
+//  Every thread - I/O threads and application threads alike - gets its own
+//  cache of free blocks per power-of-two size class, so allocation and
+//  freeing on the owning thread never synchronise. A block freed by any
+//  other thread is pushed onto a lock-free stack of its owner and moved
+//  to the local lists on the owner's next allocation. When a thread
+//  exits its cache is parked for reuse by a later thread; blocks freed
+//  into a parked cache go straight back to the system. Requests larger
+//  than the biggest class go straight to malloc.
+//
+//  Returned memory is aligned to 16 bytes.
+
+void *slab_alloc (size_t size_);
+
+//  Returns a block obtained from slab_alloc. NULL is ignored.
+void slab_free (void *ptr_);
+
+struct slab_stats_t
+{
+    //  Allocations served from a thread cache.
+    uint64_t hits;
+    //  Allocations that had to call malloc.
+    uint64_t misses;
+    //  Blocks freed by a thread other than the one that allocated them.
+    uint64_t remote_frees;
+    //  Bytes currently held in thread caches.
+    uint64_t cached_bytes;
+};
+
+//  Sums the counters of all thread caches. The result is a snapshot; the
+//  counters keep moving while it is taken.
+void slab_get_stats (slab_stats_t *stats_);
+}
+
+#endif
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+// ROUTER routing-id lookup benchmark
+//
+// Measures the cost of slk_send_to() on a ROUTER socket as the number of
+// connected peers grows. Peers are inproc pipes opened by the ROUTER
+// itself with SLK_CONNECT_ROUTING_ID, so the peer count is not bounded by
+// file descriptors and the measured cost is dominated by the routing-id
+// lookup and the pipe write.
+//
+// Usage: bench_router_lookup [max_peers]   (default: 100000)
+//
+// Every pipe preallocates its queue chunks, so 100k peers need about 2 GB
+// of memory. Pass a smaller max_peers on constrained machines.
+
+#include <serverlink/config.h>
+#include "bench_common.hpp"
+#include <random>
+
+static const size_t peer_counts[] = {10, 100, 1000, 10000, 100000};
+static const size_t sends_per_run = 1000000;
+
+static void make_routing_id(char *buf, size_t index) {
+    snprintf(buf, 16, "peer-%08zu", index);
+}
+
+static void drain(slk_socket_t *sink, char *buf, size_t len) {
+    while (slk_recv(sink, buf, len, SLK_DONTWAIT) >= 0) {
+    }
+}
+
+static void bench_router_lookup(size_t peers) {
+    slk_ctx_t *ctx = slk_ctx_new();
+    BENCH_ASSERT(ctx);
+
+    slk_socket_t *router = slk_socket(ctx, SLK_ROUTER);
+    slk_socket_t *sink = slk_socket(ctx, SLK_ROUTER);
+    BENCH_ASSERT(router && sink);
+
+    int mandatory = 1;
+    int rc = slk_setsockopt(router, SLK_ROUTER_MANDATORY, &mandatory, sizeof(mandatory));
+    BENCH_CHECK(rc, "slk_setsockopt(SLK_ROUTER_MANDATORY)");
+
+    rc = slk_bind(sink, "inproc://bench_router_lookup");
+    BENCH_CHECK(rc, "slk_bind");
+
+    // One inproc pipe per peer, each registered under its own routing id
+    std::vector<char> ids(peers * 16);
+    for (size_t i = 0; i < peers; i++) {
+        make_routing_id(&ids[i * 16], i);
+        rc = slk_setsockopt(router, SLK_CONNECT_ROUTING_ID, &ids[i * 16], 13);
+        BENCH_CHECK(rc, "slk_setsockopt(SLK_CONNECT_ROUTING_ID)");
+        rc = slk_connect(router, "inproc://bench_router_lookup");
+        BENCH_CHECK(rc, "slk_connect");
+    }
+
+    // Visit the peers in random order so lookups do not walk the table
+    // (or tree) in insertion order.
+    std::vector<size_t> order(peers);
+    for (size_t i = 0; i < peers; i++)
+        order[i] = i;
+    std::mt19937 rng(42);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    const char payload[16] = "x";
+    char buf[64];
+
+    // Warm up: touch every peer once
+    for (size_t i = 0; i < peers; i++) {
+        rc = slk_send_to(router, &ids[order[i] * 16], 13, payload, sizeof(payload), 0);
+        BENCH_ASSERT(rc == static_cast<int>(sizeof(payload)));
+    }
+    drain(sink, buf, sizeof(buf));
+
+    // Each round sends one message to every peer, then drains the sink
+    // outside the timed section so no pipe ever reaches its HWM.
+    const size_t rounds = std::max<size_t>(1, sends_per_run / peers);
+    double elapsed_us = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        stopwatch_t sw;
+        sw.start();
+        for (size_t i = 0; i < peers; i++) {
+            rc = slk_send_to(router, &ids[order[i] * 16], 13, payload, sizeof(payload), 0);
+            BENCH_ASSERT(rc == static_cast<int>(sizeof(payload)));
+        }
+        elapsed_us += sw.elapsed_us();
+        drain(sink, buf, sizeof(buf));
+    }
+
+    const double sends = static_cast<double>(rounds * peers);
+    printf("%10zu peers | %10.0f sends | %8.1f ns/send | %10.0f sends/s\n",
+           peers, sends, elapsed_us * 1000.0 / sends,
+           sends / (elapsed_us / 1000000.0));
+
+    slk_close(router);
+    slk_close(sink);
+    slk_ctx_destroy(ctx);
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_peers = 100000;
+    if (argc > 1)
+        max_peers = static_cast<size_t>(strtoul(argv[1], NULL, 10));
+
+    printf("\n=== ServerLink ROUTER Lookup Benchmark ===\n\n");
+    printf("slk_send_to() cost by number of connected peers (inproc)\n\n");
+
+    for (size_t i = 0; i < sizeof(peer_counts) / sizeof(peer_counts[0]); i++) {
+        if (peer_counts[i] > max_peers)
+            break;
+        bench_router_lookup(peer_counts[i]);
+    }
+
+    printf("\n");
+    return 0;
+}
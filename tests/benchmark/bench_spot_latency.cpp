@@ -13,7 +13,7 @@ void spot_echo_server(slk_spot_t *spot, const char *topic_id) {
     while (g_spot_running) {
         size_t tlen, dlen;
         int rc = slk_spot_recv(spot, topic, sizeof(topic), &tlen,
-                              data, sizeof(data), &dlen, 100);  // 100ms timeout
+                              data, sizeof(data), &dlen, 0);
         if (rc != 0) continue;
 
         // Echo back the message
@@ -41,6 +41,17 @@ void bench_spot_local_latency(size_t message_size, int message_count) {
     rc = slk_spot_topic_create(spot_b, "bench:pong");
     BENCH_CHECK(rc, "create pong topic");
 
+    // Each instance only knows its own topics; expose them over inproc
+    // and route the peer's topic explicitly
+    rc = slk_spot_bind(spot_a, "inproc://bench-spot-a");
+    BENCH_CHECK(rc, "bind spot_a");
+    rc = slk_spot_bind(spot_b, "inproc://bench-spot-b");
+    BENCH_CHECK(rc, "bind spot_b");
+    rc = slk_spot_topic_route(spot_a, "bench:pong", "inproc://bench-spot-b");
+    BENCH_CHECK(rc, "route pong to spot_a");
+    rc = slk_spot_topic_route(spot_b, "bench:ping", "inproc://bench-spot-a");
+    BENCH_CHECK(rc, "route ping to spot_b");
+
     // Cross-subscribe
     rc = slk_spot_subscribe(spot_a, "bench:pong");
     BENCH_CHECK(rc, "subscribe to pong");
@@ -49,6 +60,10 @@ void bench_spot_local_latency(size_t message_size, int message_count) {
 
     // Start echo server thread
     g_spot_running = true;
+    // Bounded wait so the echo thread notices g_spot_running going false
+    int echo_timeout = 100;
+    rc = slk_spot_setsockopt(spot_b, SLK_RCVTIMEO, &echo_timeout, sizeof(echo_timeout));
+    BENCH_CHECK(rc, "set echo timeout");
     std::thread echo_thread(spot_echo_server, spot_b, "bench:pong");
 
     // Prepare test data
@@ -137,6 +152,10 @@ void bench_spot_remote_latency(size_t message_size, int message_count) {
 
     // Start echo server thread
     g_spot_running = true;
+    // Bounded wait so the echo thread notices g_spot_running going false
+    int echo_timeout = 100;
+    rc = slk_spot_setsockopt(spot_b, SLK_RCVTIMEO, &echo_timeout, sizeof(echo_timeout));
+    BENCH_CHECK(rc, "set echo timeout");
     std::thread echo_thread(spot_echo_server, spot_b, "bench:pong");
 
     // Prepare test data
@@ -1,8 +1,10 @@
 /* SPDX-License-Identifier: MPL-2.0 */
 
 #include "bench_common.hpp"
+#include <atomic>
 #include <vector>
 #include <string>
+#include <thread>
 
 // Benchmark: Scalability with increasing number of topics
 void bench_spot_topic_scaling() {
@@ -210,6 +212,90 @@ void bench_spot_multitopic_concurrent() {
     }
 }
 
+// Benchmark: Concurrent publishers with increasing shard count
+void bench_spot_shard_scaling() {
+    printf("\n--- Shard Scalability (%d publisher threads) ---\n", 8);
+    printf("%-15s | %12s | %15s | %15s\n",
+           "Shards", "Delivered", "Time", "Throughput");
+    printf("---------------------------------------------------------------\n");
+
+    int shard_counts[] = {1, 2, 4, 8};
+    const int publishers = 8;
+    const int topics_per_publisher = 4;
+    const int messages_per_publisher = 100000;
+    const size_t message_size = 64;
+
+    for (int shards : shard_counts) {
+        slk_ctx_t *ctx = slk_ctx_new();
+        BENCH_ASSERT(ctx);
+
+        slk_spot_t *spot = slk_spot_new_sharded(ctx, shards);
+        BENCH_ASSERT(spot);
+
+        // Each publisher owns a few topics, spread over the shards by hash
+        std::vector<slk_spot_topic_handle_t*> handles;
+        for (int i = 0; i < publishers * topics_per_publisher; i++) {
+            char topic_id[64];
+            snprintf(topic_id, sizeof(topic_id), "shard:%d", i);
+            int rc = slk_spot_topic_create(spot, topic_id);
+            BENCH_ASSERT(rc == 0);
+            rc = slk_spot_subscribe(spot, topic_id);
+            BENCH_ASSERT(rc == 0);
+            handles.push_back(slk_spot_topic_lookup(spot, topic_id));
+            BENCH_ASSERT(handles.back());
+        }
+
+        int timeout_ms = 200;
+        slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+
+        // Messages over the HWM are dropped, so count what is delivered
+        std::atomic<bool> done{false};
+        long delivered = 0;
+        double last_ms = 0;
+
+        stopwatch_t sw;
+        sw.start();
+
+        std::thread receiver([&]() {
+            char topic[64], buf[256];
+            size_t tlen, dlen;
+            while (true) {
+                if (slk_spot_recv(spot, topic, sizeof(topic), &tlen,
+                                  buf, sizeof(buf), &dlen, 0) == 0) {
+                    delivered++;
+                    last_ms = sw.elapsed_ms();
+                } else if (done.load()) {
+                    break;
+                }
+            }
+        });
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < publishers; p++) {
+            threads.emplace_back([&, p]() {
+                std::vector<char> data(message_size, 'S');
+                for (int i = 0; i < messages_per_publisher; i++) {
+                    slk_spot_topic_handle_t *handle =
+                        handles[p * topics_per_publisher + i % topics_per_publisher];
+                    slk_spot_publish_handle(handle, data.data(), data.size());
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        done.store(true);
+        receiver.join();
+
+        double msgs_per_sec = delivered / (last_ms / 1000.0);
+        printf("%-15d | %12ld | %10.2f ms | %11.0f msg/s\n",
+               shards, delivered, last_ms, msgs_per_sec);
+
+        slk_spot_destroy(&spot);
+        slk_ctx_destroy(ctx);
+    }
+}
+
 // Benchmark: Registry lookup performance
 void bench_spot_registry_lookup() {
     printf("\n--- Registry Lookup Performance (O(1) verification) ---\n");
@@ -279,13 +365,15 @@ int main() {
     bench_spot_topic_scaling();
     bench_spot_subscriber_scaling();
     bench_spot_multitopic_concurrent();
+    bench_spot_shard_scaling();
     bench_spot_registry_lookup();
 
     printf("\n=== Benchmark Summary ===\n");
     printf("1. Topic Creation: Linear with topic count\n");
     printf("2. Subscriber Fanout: O(n) where n = subscriber count\n");
     printf("3. Multi-Topic: Concurrent publishing scales linearly\n");
-    printf("4. Registry Lookup: O(1) - constant time regardless of size\n\n");
+    printf("4. Shards: publishers on different shards do not contend\n");
+    printf("5. Registry Lookup: O(1) - constant time regardless of size\n\n");
 
     return 0;
 }
@@ -0,0 +1,553 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+
+// Unified benchmark driver for CI.
+//
+// Sweeps message size x transport x peer count x I/O threads over a
+// ROUTER-ROUTER topology (N client sockets, one server socket) and
+// measures, for every combination:
+//   - throughput: every client streams messages to the server
+//   - latency:    every client runs ping-pong round trips concurrently
+// together with the process CPU time spent per message. Results are
+// printed as a table and optionally written as JSON, which
+// scripts/bench_gate.py compares against a baseline.
+//
+// Usage:
+//   bench_suite [--sizes 64,1024,65536] [--transports tcp,ipc,inproc]
+//               [--peers 1,4] [--io-threads 1,2] [--count N]
+//               [--rtt-count N] [--repeat N] [--backend asio|io_uring]
+//               [--quick] [--json FILE]
+//
+// --quick (implied by the CI or GITHUB_ACTIONS environment variables)
+// cuts message counts so the default sweep finishes in about a minute.
+// The shm transport is measured only when listed explicitly.
+
+#include "bench_common.hpp"
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+struct run_config_t {
+    std::string transport;
+    size_t message_size;
+    int peers;
+    int io_threads;
+    int io_backend;  // SLK_IO_BACKEND_*
+    int count;      // messages per peer for throughput
+    int rtt_count;  // round trips per peer for latency
+};
+
+struct run_result_t {
+    // Throughput
+    long long messages;
+    double msgs_per_sec;
+    double mb_per_sec;
+    double tput_cpu_us_per_msg;
+
+    // Latency (round trip)
+    long long samples;
+    double avg_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+    double rtt_cpu_us_per_msg;
+};
+
+// Process CPU time (user + system, all threads) in microseconds
+static double process_cpu_us() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10.0;
+#else
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec * 1e6 + ru.ru_utime.tv_usec
+           + ru.ru_stime.tv_sec * 1e6 + ru.ru_stime.tv_usec;
+#endif
+}
+
+static int current_pid() {
+#ifdef _WIN32
+    return static_cast<int>(GetCurrentProcessId());
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+// Nearest-rank percentile of a sorted sample
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t idx = static_cast<size_t>(p / 100.0 * sorted.size());
+    if (idx >= sorted.size())
+        idx = sorted.size() - 1;
+    return sorted[idx];
+}
+
+static std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos)
+            end = s.size();
+        if (end > start)
+            out.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
+static std::vector<int> split_ints(const std::string &s) {
+    std::vector<int> out;
+    std::vector<std::string> parts = split(s);
+    for (size_t i = 0; i < parts.size(); i++)
+        out.push_back(atoi(parts[i].c_str()));
+    return out;
+}
+
+//  Benchmark topology
+
+struct fixture_t {
+    slk_ctx_t *ctx;
+    slk_socket_t *server;
+    std::vector<slk_socket_t *> clients;
+    std::vector<std::string> client_ids;
+};
+
+static const char server_id[] = "server";
+
+static void set_int(slk_socket_t *s, int option, int value) {
+    BENCH_CHECK(slk_setsockopt(s, option, &value, sizeof(value)), "slk_setsockopt");
+}
+
+static void setup(fixture_t &f, const run_config_t &cfg, int run_id) {
+    f.ctx = slk_ctx_new();
+    BENCH_ASSERT(f.ctx);
+    BENCH_CHECK(slk_ctx_set(f.ctx, SLK_IO_THREADS, &cfg.io_threads, sizeof(cfg.io_threads)),
+                "slk_ctx_set(SLK_IO_THREADS)");
+    BENCH_CHECK(slk_ctx_set(f.ctx, SLK_IO_BACKEND, &cfg.io_backend, sizeof(cfg.io_backend)),
+                "slk_ctx_set(SLK_IO_BACKEND)");
+
+    f.server = slk_socket(f.ctx, SLK_ROUTER);
+    BENCH_ASSERT(f.server);
+    BENCH_CHECK(slk_setsockopt(f.server, SLK_ROUTING_ID, server_id, strlen(server_id)),
+                "slk_setsockopt(SLK_ROUTING_ID)");
+    set_int(f.server, SLK_SNDHWM, 0);
+    set_int(f.server, SLK_RCVHWM, 0);
+    set_int(f.server, SLK_LINGER, 0);
+    set_int(f.server, SLK_ROUTER_MANDATORY, 1);
+
+    char endpoint[256];
+    if (cfg.transport == "tcp")
+        snprintf(endpoint, sizeof(endpoint), "tcp://127.0.0.1:*");
+    else if (cfg.transport == "ipc")
+        snprintf(endpoint, sizeof(endpoint), "ipc:///tmp/slk-bench-%d-%d.sock",
+                 current_pid(), run_id);
+    else if (cfg.transport == "shm")
+        snprintf(endpoint, sizeof(endpoint), "shm://slk-bench-%d-%d",
+                 current_pid(), run_id);
+    else
+        snprintf(endpoint, sizeof(endpoint), "inproc://bench-%d", run_id);
+    BENCH_CHECK(slk_bind(f.server, endpoint), "slk_bind");
+
+    // Wildcard TCP ports resolve to the port actually bound
+    size_t len = sizeof(endpoint);
+    BENCH_CHECK(slk_getsockopt(f.server, SLK_LAST_ENDPOINT, endpoint, &len),
+                "slk_getsockopt(SLK_LAST_ENDPOINT)");
+
+    for (int i = 0; i < cfg.peers; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "client-%d", i);
+        slk_socket_t *client = slk_socket(f.ctx, SLK_ROUTER);
+        BENCH_ASSERT(client);
+        BENCH_CHECK(slk_setsockopt(client, SLK_ROUTING_ID, id, strlen(id)),
+                    "slk_setsockopt(SLK_ROUTING_ID)");
+        set_int(client, SLK_SNDHWM, 0);
+        set_int(client, SLK_RCVHWM, 0);
+        set_int(client, SLK_LINGER, 0);
+        BENCH_CHECK(slk_connect(client, endpoint), "slk_connect");
+        f.clients.push_back(client);
+        f.client_ids.push_back(id);
+    }
+
+    // Handshake: the server greets every client once it can route to it,
+    // after which each client can route to the server as well.
+    char buf[64];
+    for (int i = 0; i < cfg.peers; i++) {
+        const std::string &id = f.client_ids[i];
+        stopwatch_t sw;
+        sw.start();
+        while (slk_send(f.server, id.data(), id.size(), SLK_SNDMORE) < 0) {
+            BENCH_ASSERT(slk_errno() == SLK_EHOSTUNREACH || slk_errno() == SLK_EAGAIN);
+            BENCH_ASSERT(sw.elapsed_ms() < 10000);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        BENCH_ASSERT(slk_send(f.server, "HELLO", 5, 0) == 5);
+        BENCH_ASSERT(slk_recv(f.clients[i], buf, sizeof(buf), 0) > 0);
+        BENCH_ASSERT(slk_recv(f.clients[i], buf, sizeof(buf), 0) == 5);
+    }
+}
+
+static void teardown(fixture_t &f) {
+    for (size_t i = 0; i < f.clients.size(); i++)
+        slk_close(f.clients[i]);
+    slk_close(f.server);
+    slk_ctx_destroy(f.ctx);
+}
+
+//  Throughput: every client streams cfg.count messages to the server
+
+static void stream_messages(slk_socket_t *client, size_t size, int count) {
+    std::vector<char> data(size, 'A');
+    const size_t id_len = strlen(server_id);
+    for (int i = 0; i < count; i++) {
+        BENCH_ASSERT(slk_send(client, server_id, id_len, SLK_SNDMORE)
+                     == static_cast<int>(id_len));
+        BENCH_ASSERT(slk_send(client, data.data(), data.size(), 0)
+                     == static_cast<int>(size));
+    }
+}
+
+static void run_throughput(fixture_t &f, const run_config_t &cfg, run_result_t &r) {
+    const long long total = static_cast<long long>(cfg.count) * cfg.peers;
+    std::vector<char> buf(cfg.message_size + 64);
+
+    const double cpu_start = process_cpu_us();
+    stopwatch_t sw;
+    sw.start();
+
+    std::vector<std::thread> senders;
+    for (int i = 0; i < cfg.peers; i++)
+        senders.push_back(std::thread(stream_messages, f.clients[i],
+                                      cfg.message_size, cfg.count));
+
+    for (long long i = 0; i < total; i++) {
+        BENCH_ASSERT(slk_recv(f.server, buf.data(), buf.size(), 0) > 0);
+        BENCH_ASSERT(slk_recv(f.server, buf.data(), buf.size(), 0)
+                     == static_cast<int>(cfg.message_size));
+    }
+
+    const double elapsed_s = sw.elapsed_us() / 1e6;
+    const double cpu_us = process_cpu_us() - cpu_start;
+    for (size_t i = 0; i < senders.size(); i++)
+        senders[i].join();
+
+    r.messages = total;
+    r.msgs_per_sec = total / elapsed_s;
+    r.mb_per_sec = total * cfg.message_size / elapsed_s / (1024.0 * 1024.0);
+    r.tput_cpu_us_per_msg = cpu_us / total;
+}
+
+//  Latency: every client runs cfg.rtt_count round trips through the server
+
+static void ping_pong(slk_socket_t *client, size_t size, int warmup, int count,
+                      std::vector<double> *latencies) {
+    std::vector<char> data(size, 'B');
+    std::vector<char> buf(size + 64);
+    const size_t id_len = strlen(server_id);
+    latencies->reserve(count);
+
+    for (int i = 0; i < warmup + count; i++) {
+        stopwatch_t sw;
+        sw.start();
+        BENCH_ASSERT(slk_send(client, server_id, id_len, SLK_SNDMORE)
+                     == static_cast<int>(id_len));
+        BENCH_ASSERT(slk_send(client, data.data(), data.size(), 0)
+                     == static_cast<int>(size));
+        BENCH_ASSERT(slk_recv(client, buf.data(), buf.size(), 0) > 0);
+        BENCH_ASSERT(slk_recv(client, buf.data(), buf.size(), 0)
+                     == static_cast<int>(size));
+        if (i >= warmup)
+            latencies->push_back(sw.elapsed_us());
+    }
+}
+
+static void run_latency(fixture_t &f, const run_config_t &cfg, run_result_t &r) {
+    const int warmup = cfg.rtt_count / 10 < 100 ? cfg.rtt_count / 10 : 100;
+    const long long total =
+      static_cast<long long>(cfg.rtt_count + warmup) * cfg.peers;
+    std::vector<std::vector<double> > latencies(cfg.peers);
+    std::vector<char> id(256);
+    std::vector<char> buf(cfg.message_size + 64);
+
+    const double cpu_start = process_cpu_us();
+
+    std::vector<std::thread> clients;
+    for (int i = 0; i < cfg.peers; i++)
+        clients.push_back(std::thread(ping_pong, f.clients[i], cfg.message_size,
+                                      warmup, cfg.rtt_count, &latencies[i]));
+
+    // Echo every request back to its sender
+    for (long long i = 0; i < total; i++) {
+        const int id_len = slk_recv(f.server, id.data(), id.size(), 0);
+        BENCH_ASSERT(id_len > 0);
+        const int size = slk_recv(f.server, buf.data(), buf.size(), 0);
+        BENCH_ASSERT(size == static_cast<int>(cfg.message_size));
+        BENCH_ASSERT(slk_send(f.server, id.data(), id_len, SLK_SNDMORE) == id_len);
+        BENCH_ASSERT(slk_send(f.server, buf.data(), size, 0) == size);
+    }
+
+    for (size_t i = 0; i < clients.size(); i++)
+        clients[i].join();
+    const double cpu_us = process_cpu_us() - cpu_start;
+
+    std::vector<double> all;
+    for (int i = 0; i < cfg.peers; i++)
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+    std::sort(all.begin(), all.end());
+
+    double sum = 0;
+    for (size_t i = 0; i < all.size(); i++)
+        sum += all[i];
+
+    r.samples = static_cast<long long>(all.size());
+    r.avg_us = all.empty() ? 0 : sum / all.size();
+    r.p50_us = percentile(all, 50);
+    r.p90_us = percentile(all, 90);
+    r.p99_us = percentile(all, 99);
+    r.p999_us = percentile(all, 99.9);
+    r.max_us = all.empty() ? 0 : all.back();
+    // Each round trip is two messages
+    r.rtt_cpu_us_per_msg = cpu_us / (2.0 * total);
+}
+
+//  Repeats are reduced to the per-metric median
+
+static double median_of(std::vector<run_result_t> &runs, double run_result_t::*field) {
+    std::vector<double> values;
+    for (size_t i = 0; i < runs.size(); i++)
+        values.push_back(runs[i].*field);
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static run_result_t run_config(const run_config_t &cfg, int repeat, int *run_id) {
+    std::vector<run_result_t> runs(repeat);
+    for (int i = 0; i < repeat; i++) {
+        fixture_t f;
+        setup(f, cfg, (*run_id)++);
+        run_throughput(f, cfg, runs[i]);
+        run_latency(f, cfg, runs[i]);
+        teardown(f);
+    }
+
+    run_result_t r = runs[0];
+    double run_result_t::*fields[] = {
+      &run_result_t::msgs_per_sec, &run_result_t::mb_per_sec,
+      &run_result_t::tput_cpu_us_per_msg, &run_result_t::avg_us,
+      &run_result_t::p50_us, &run_result_t::p90_us, &run_result_t::p99_us,
+      &run_result_t::p999_us, &run_result_t::max_us,
+      &run_result_t::rtt_cpu_us_per_msg};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+        r.*fields[i] = median_of(runs, fields[i]);
+    return r;
+}
+
+//  Output
+
+static const char *platform_name() {
+#if defined(_WIN32)
+    return "windows";
+#elif defined(__APPLE__)
+    return "macos";
+#elif defined(__linux__)
+    return "linux";
+#else
+    return "unknown";
+#endif
+}
+
+static bool write_json(const char *path, bool quick, int repeat, const char *backend,
+                       const std::vector<run_config_t> &configs,
+                       const std::vector<run_result_t> &results) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+
+    int major = 0, minor = 0, patch = 0;
+    slk_version(&major, &minor, &patch);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"schema\": 1,\n");
+    fprintf(out, "  \"version\": \"%d.%d.%d\",\n", major, minor, patch);
+    fprintf(out, "  \"platform\": \"%s\",\n", platform_name());
+    fprintf(out, "  \"quick\": %s,\n", quick ? "true" : "false");
+    fprintf(out, "  \"repeat\": %d,\n", repeat);
+    fprintf(out, "  \"backend\": \"%s\",\n", backend);
+    fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const run_config_t &c = configs[i];
+        const run_result_t &r = results[i];
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"transport\": \"%s\",\n", c.transport.c_str());
+        fprintf(out, "      \"message_size\": %zu,\n", c.message_size);
+        fprintf(out, "      \"peers\": %d,\n", c.peers);
+        fprintf(out, "      \"io_threads\": %d,\n", c.io_threads);
+        fprintf(out, "      \"throughput\": {\n");
+        fprintf(out, "        \"messages\": %lld,\n", r.messages);
+        fprintf(out, "        \"msgs_per_sec\": %.1f,\n", r.msgs_per_sec);
+        fprintf(out, "        \"mb_per_sec\": %.3f,\n", r.mb_per_sec);
+        fprintf(out, "        \"cpu_us_per_msg\": %.4f\n", r.tput_cpu_us_per_msg);
+        fprintf(out, "      },\n");
+        fprintf(out, "      \"latency\": {\n");
+        fprintf(out, "        \"samples\": %lld,\n", r.samples);
+        fprintf(out, "        \"avg_us\": %.2f,\n", r.avg_us);
+        fprintf(out, "        \"p50_us\": %.2f,\n", r.p50_us);
+        fprintf(out, "        \"p90_us\": %.2f,\n", r.p90_us);
+        fprintf(out, "        \"p99_us\": %.2f,\n", r.p99_us);
+        fprintf(out, "        \"p999_us\": %.2f,\n", r.p999_us);
+        fprintf(out, "        \"max_us\": %.2f,\n", r.max_us);
+        fprintf(out, "        \"cpu_us_per_msg\": %.4f\n", r.rtt_cpu_us_per_msg);
+        fprintf(out, "      }\n");
+        fprintf(out, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+    return true;
+}
+
+static void print_result(const run_config_t &c, const run_result_t &r) {
+    printf("%-6s | %6zu B | %2d peers | %d io | %10.0f msg/s | %8.2f MB/s | %6.2f cpu us/msg"
+           " | p50 %8.2f | p99 %8.2f | p99.9 %8.2f us\n",
+           c.transport.c_str(), c.message_size, c.peers, c.io_threads,
+           r.msgs_per_sec, r.mb_per_sec, r.tput_cpu_us_per_msg,
+           r.p50_us, r.p99_us, r.p999_us);
+    fflush(stdout);
+}
+
+static int default_count(size_t size, bool quick) {
+    if (size <= 1024)
+        return quick ? 20000 : 100000;
+    if (size <= 8192)
+        return quick ? 5000 : 20000;
+    return quick ? 1000 : 2000;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "Usage: bench_suite [--sizes LIST] [--transports LIST] [--peers LIST]\n"
+            "                   [--io-threads LIST] [--count N] [--rtt-count N]\n"
+            "                   [--repeat N] [--backend asio|io_uring] [--quick]\n"
+            "                   [--json FILE]\n");
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> sizes;
+    sizes.push_back(64);
+    sizes.push_back(1024);
+    sizes.push_back(65536);
+    std::vector<std::string> transports = split("tcp,ipc,inproc");
+    std::vector<int> peers = split_ints("1,4");
+    std::vector<int> io_threads = split_ints("1,2");
+    int count = 0;
+    int rtt_count = 0;
+    int repeat = 1;
+    bool quick = getenv("CI") != NULL || getenv("GITHUB_ACTIONS") != NULL;
+    const char *json_path = NULL;
+    std::string backend = "asio";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--quick")
+            quick = true;
+        else if (arg == "--sizes" && has_value)
+            sizes = split_ints(argv[++i]);
+        else if (arg == "--transports" && has_value)
+            transports = split(argv[++i]);
+        else if (arg == "--peers" && has_value)
+            peers = split_ints(argv[++i]);
+        else if (arg == "--io-threads" && has_value)
+            io_threads = split_ints(argv[++i]);
+        else if (arg == "--count" && has_value)
+            count = atoi(argv[++i]);
+        else if (arg == "--rtt-count" && has_value)
+            rtt_count = atoi(argv[++i]);
+        else if (arg == "--repeat" && has_value)
+            repeat = atoi(argv[++i]);
+        else if (arg == "--backend" && has_value)
+            backend = argv[++i];
+        else if (arg == "--json" && has_value)
+            json_path = argv[++i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (repeat < 1)
+        repeat = 1;
+
+    int io_backend = SLK_IO_BACKEND_ASIO;
+    if (backend == "io_uring") {
+        if (!slk_has("io_uring")) {
+            fprintf(stderr, "io_uring backend not supported on this platform\n");
+            return 2;
+        }
+        io_backend = SLK_IO_BACKEND_IO_URING;
+    } else if (backend != "asio") {
+        fprintf(stderr, "Unknown backend: %s\n", backend.c_str());
+        return 2;
+    }
+
+    std::vector<run_config_t> configs;
+    for (size_t t = 0; t < transports.size(); t++) {
+        const std::string &transport = transports[t];
+        if (transport != "tcp" && transport != "inproc" && transport != "ipc"
+            && transport != "shm") {
+            fprintf(stderr, "Unknown transport: %s\n", transport.c_str());
+            return 2;
+        }
+        if ((transport == "ipc" || transport == "shm")
+            && !slk_has(transport.c_str())) {
+            printf("Skipping %s: not supported on this platform\n", transport.c_str());
+            continue;
+        }
+        for (size_t s = 0; s < sizes.size(); s++)
+            for (size_t p = 0; p < peers.size(); p++)
+                for (size_t n = 0; n < io_threads.size(); n++) {
+                    run_config_t c;
+                    c.transport = transport;
+                    c.message_size = static_cast<size_t>(sizes[s]);
+                    c.peers = peers[p] > 0 ? peers[p] : 1;
+                    c.io_threads = io_threads[n] > 0 ? io_threads[n] : 1;
+                    c.io_backend = io_backend;
+                    c.count = count > 0 ? count : default_count(c.message_size, quick);
+                    c.rtt_count = rtt_count > 0 ? rtt_count : (quick ? 2000 : 10000);
+                    configs.push_back(c);
+                }
+    }
+
+    printf("=== ServerLink Benchmark Suite (%s, %s, %zu runs, repeat %d) ===\n",
+           quick ? "quick" : "full", backend.c_str(), configs.size(), repeat);
+
+    std::vector<run_result_t> results;
+    int run_id = 0;
+    for (size_t i = 0; i < configs.size(); i++) {
+        results.push_back(run_config(configs[i], repeat, &run_id));
+        print_result(configs[i], results.back());
+    }
+
+    if (json_path) {
+        if (!write_json(json_path, quick, repeat, backend.c_str(), configs, results))
+            return 1;
+        printf("Results written to %s\n", json_path);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/* ServerLink PUB/SUB Fan-out Integration Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <stdio.h>
+#include <vector>
+
+#define SUBSCRIBERS 3
+
+/* Sizes around the 1-byte/8-byte length boundary and the engine's
+ * gather threshold, where the header shared between subscribers and the
+ * body are written as one chunk. */
+static const size_t sizes[] = {0, 1, 33, 34, 255, 256, 1000, 1008, 1009,
+                               1023, 1024, 8192, 70000};
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static void fill(std::vector<char> &buf, size_t size, size_t seed)
+{
+    buf.resize(size);
+    for (size_t i = 0; i < size; i++)
+        buf[i] = static_cast<char>((i * 31 + seed) & 0xff);
+}
+
+static void recv_expect(slk_socket_t *sub, const std::vector<char> &expected,
+                        int more)
+{
+    TEST_ASSERT(test_poll_readable(sub, 2000));
+    slk_msg_t *msg = slk_msg_new();
+    TEST_SUCCESS(slk_msg_recv(msg, sub, 0));
+    TEST_ASSERT_EQ(slk_msg_size(msg), expected.size());
+    if (!expected.empty())
+        TEST_ASSERT_MEM_EQ(slk_msg_data(msg), expected.data(), expected.size());
+
+    /* Property 0 is the MORE flag */
+    int rcvmore = -1;
+    size_t len = sizeof(rcvmore);
+    TEST_SUCCESS(slk_msg_get(msg, 0, &rcvmore, &len));
+    TEST_ASSERT_EQ(rcvmore, more);
+    slk_msg_destroy(msg);
+}
+
+/* Test: Every TCP subscriber receives identical single-part messages */
+static void test_fanout_sizes()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    slk_socket_t *subs[SUBSCRIBERS];
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        subs[i] = test_socket_new(ctx, SLK_SUB);
+        TEST_SUCCESS(slk_setsockopt(subs[i], SLK_SUBSCRIBE, "", 0));
+        test_socket_connect(subs[i], endpoint);
+    }
+    test_sleep_ms(SETTLE_TIME);
+
+    std::vector<char> payload;
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        fill(payload, sizes[s], s);
+        int rc = slk_send(pub, payload.data(), payload.size(), 0);
+        TEST_ASSERT_EQ(rc, static_cast<int>(payload.size()));
+    }
+
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        for (size_t s = 0; s < NUM_SIZES; s++) {
+            fill(payload, sizes[s], s);
+            recv_expect(subs[i], payload, 0);
+        }
+    }
+
+    for (int i = 0; i < SUBSCRIBERS; i++)
+        test_socket_close(subs[i]);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: The MORE flag survives when frames share a pre-encoded header */
+static void test_fanout_multipart()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    slk_socket_t *subs[SUBSCRIBERS];
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        subs[i] = test_socket_new(ctx, SLK_SUB);
+        TEST_SUCCESS(slk_setsockopt(subs[i], SLK_SUBSCRIBE, "", 0));
+        test_socket_connect(subs[i], endpoint);
+    }
+    test_sleep_ms(SETTLE_TIME);
+
+    /* The same message content is sent twice, once as a non-final frame
+     * and once as the final frame, so its stored header must not be
+     * reused for the second send. */
+    std::vector<char> body;
+    fill(body, 2000, 7);
+    slk_msg_t *msg = slk_msg_new_data(body.data(), body.size());
+    slk_msg_t *copy = slk_msg_new();
+    TEST_SUCCESS(slk_msg_copy(copy, msg));
+
+    TEST_SUCCESS(slk_msg_send(msg, pub, SLK_SNDMORE));
+    TEST_SUCCESS(slk_msg_send(copy, pub, 0));
+    slk_msg_destroy(msg);
+    slk_msg_destroy(copy);
+
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        recv_expect(subs[i], body, 1);
+        recv_expect(subs[i], body, 0);
+    }
+
+    for (int i = 0; i < SUBSCRIBERS; i++)
+        test_socket_close(subs[i]);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink PUB/SUB Fan-out Tests ===\n\n");
+
+    RUN_TEST(test_fanout_sizes);
+    RUN_TEST(test_fanout_multipart);
+
+    printf("\n=== All PUB/SUB Fan-out Tests Passed ===\n");
+    return 0;
+}
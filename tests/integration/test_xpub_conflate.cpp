@@ -0,0 +1,220 @@
+/* ServerLink XPUB Per-Topic Conflation Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define COUNT 50
+
+struct received_t
+{
+    std::string topic;
+    int seq;
+};
+
+/* Binds an XPUB and waits for one subscriber to subscribe. An inproc pipe
+ * sums the HWMs of both ends, so all of them are kept tiny. */
+static slk_socket_t *slow_pair(slk_ctx_t *ctx, const char *endpoint,
+                               slk_socket_t **sub)
+{
+    slk_socket_t *pub = test_socket_new(ctx, SLK_XPUB);
+    test_set_int_option(pub, SLK_SNDHWM, 2);
+    test_set_int_option(pub, SLK_RCVHWM, 2);
+    test_socket_bind(pub, endpoint);
+
+    *sub = test_socket_new(ctx, SLK_SUB);
+    test_set_int_option(*sub, SLK_SNDHWM, 2);
+    test_set_int_option(*sub, SLK_RCVHWM, 2);
+    TEST_SUCCESS(slk_setsockopt(*sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_connect(*sub, endpoint);
+
+    /* The subscription must reach the XPUB before anything is sent */
+    TEST_ASSERT(test_poll_readable(pub, 2000));
+    char buf[16];
+    TEST_ASSERT(slk_recv(pub, buf, sizeof(buf), 0) >= 1);
+    return pub;
+}
+
+static void send_seq(slk_socket_t *pub, const char *topic, int seq)
+{
+    char data[16];
+    snprintf(data, sizeof(data), "%d", seq);
+    TEST_ASSERT_EQ(slk_send(pub, topic, strlen(topic), SLK_SNDMORE),
+                   static_cast<int>(strlen(topic)));
+    TEST_ASSERT_EQ(slk_send(pub, data, strlen(data), SLK_DONTWAIT),
+                   static_cast<int>(strlen(data)));
+}
+
+/* Receives [topic][seq] messages until none arrives any more. Polling the
+ * XPUB lets it notice the subscriber drained and release held messages. */
+static std::vector<received_t> drain(slk_socket_t *pub, slk_socket_t *sub)
+{
+    std::vector<received_t> received;
+    while (true) {
+        if (!test_poll_readable(sub, 100)) {
+            test_poll_writable(pub, 0);
+            if (!test_poll_readable(sub, 500))
+                break;
+        }
+        char topic[32];
+        char data[16];
+        int rc = slk_recv(sub, topic, sizeof(topic) - 1, 0);
+        TEST_ASSERT(rc >= 0);
+        topic[rc] = '\0';
+        rc = slk_recv(sub, data, sizeof(data) - 1, 0);
+        TEST_ASSERT(rc >= 0);
+        data[rc] = '\0';
+
+        received_t r;
+        r.topic = topic;
+        r.seq = atoi(data);
+        received.push_back(r);
+    }
+    return received;
+}
+
+/* Test: A slow subscriber ends up with the newest message of each topic */
+static void test_conflate_latest()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub;
+    slk_socket_t *pub = slow_pair(ctx, "inproc://conflate-latest", &sub);
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_CONFLATE_TOPIC, "pos.", 4));
+
+    for (int i = 0; i < COUNT; i++) {
+        send_seq(pub, "pos.a", i);
+        send_seq(pub, "pos.b", i);
+    }
+
+    std::vector<received_t> received = drain(pub, sub);
+    TEST_ASSERT(received.size() < 2 * COUNT);
+
+    /* In order per topic, and nothing newer is ever lost */
+    std::map<std::string, int> last;
+    for (size_t i = 0; i < received.size(); i++) {
+        std::map<std::string, int>::iterator it = last.find(received[i].topic);
+        if (it != last.end())
+            TEST_ASSERT(received[i].seq > it->second);
+        last[received[i].topic] = received[i].seq;
+    }
+    TEST_ASSERT_EQ(last["pos.a"], COUNT - 1);
+    TEST_ASSERT_EQ(last["pos.b"], COUNT - 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Topics outside the conflated prefixes are still dropped at the HWM */
+static void test_other_topics_dropped()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub;
+    slk_socket_t *pub = slow_pair(ctx, "inproc://conflate-other", &sub);
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_CONFLATE_TOPIC, "pos.", 4));
+
+    for (int i = 0; i < COUNT; i++)
+        send_seq(pub, "chat", i);
+
+    std::vector<received_t> received = drain(pub, sub);
+    TEST_ASSERT(!received.empty());
+    TEST_ASSERT(received.back().seq < COUNT - 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Exact topics conflate only themselves, not longer topics */
+static void test_conflate_exact()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub;
+    slk_socket_t *pub = slow_pair(ctx, "inproc://conflate-exact", &sub);
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_CONFLATE_EXACT, "pos.a", 5));
+
+    for (int i = 0; i < COUNT; i++) {
+        send_seq(pub, "pos.a", i);
+        send_seq(pub, "pos.ab", i);
+    }
+
+    std::vector<received_t> received = drain(pub, sub);
+    std::map<std::string, int> last;
+    for (size_t i = 0; i < received.size(); i++)
+        last[received[i].topic] = received[i].seq;
+    TEST_ASSERT_EQ(last["pos.a"], COUNT - 1);
+    TEST_ASSERT(last["pos.ab"] < COUNT - 1);
+
+    /* Unconflated, the topic is dropped at the HWM again */
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_UNCONFLATE_EXACT, "pos.a", 5));
+    for (int i = 0; i < COUNT; i++)
+        send_seq(pub, "pos.a", COUNT + i);
+    received = drain(pub, sub);
+    TEST_ASSERT(!received.empty());
+    TEST_ASSERT(received.back().seq < 2 * COUNT - 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Unconflating a topic restores plain HWM behaviour */
+static void test_unconflate()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub;
+    slk_socket_t *pub = slow_pair(ctx, "inproc://conflate-off", &sub);
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_CONFLATE_TOPIC, "pos.", 4));
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_UNCONFLATE_TOPIC, "pos.", 4));
+
+    for (int i = 0; i < COUNT; i++)
+        send_seq(pub, "pos.a", i);
+
+    std::vector<received_t> received = drain(pub, sub);
+    TEST_ASSERT(!received.empty());
+    TEST_ASSERT(received.back().seq < COUNT - 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Closing a subscriber with held messages releases them */
+static void test_close_with_held()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub;
+    slk_socket_t *pub = slow_pair(ctx, "inproc://conflate-close", &sub);
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_XPUB_CONFLATE_TOPIC, "", 0));
+
+    for (int i = 0; i < COUNT; i++)
+        send_seq(pub, "pos.a", i);
+
+    test_socket_close(sub);
+    test_sleep_ms(100);
+    send_seq(pub, "pos.a", COUNT);
+
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink XPUB Conflation Tests ===\n\n");
+
+    RUN_TEST(test_conflate_latest);
+    RUN_TEST(test_other_topics_dropped);
+    RUN_TEST(test_conflate_exact);
+    RUN_TEST(test_unconflate);
+    RUN_TEST(test_close_with_held);
+
+    printf("\n=== All XPUB Conflation Tests Passed ===\n");
+    return 0;
+}
@@ -13,8 +13,8 @@
  * - SLK_HEARTBEAT_TIMEOUT: Heartbeat timeout in milliseconds
  * - SLK_HEARTBEAT_TTL: Heartbeat time-to-live (hops)
  *
- * Note: These tests verify option setting/getting. The actual heartbeat
- * mechanism may not be fully implemented, but options should be stored correctly.
+ * Heartbeats are ZMTP PING/PONG commands handled by the engine, so the
+ * last test also checks that none of them reach the application.
  */
 
 /* Test 1: SLK_HEARTBEAT_IVL option setting and getting */
@@ -282,6 +282,112 @@ static void test_heartbeat_before_after_connect()
     test_context_destroy(ctx);
 }
 
+/* Test 7: Heartbeats are exchanged by the engines and never surface as
+ * messages, while the connection stays usable */
+static void test_heartbeat_not_delivered()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    int ivl = 20;
+    int timeout = 1000;
+    int ttl = 2000;
+
+    slk_socket_t *server = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(server, "SERVER");
+    TEST_SUCCESS(slk_setsockopt(server, SLK_HEARTBEAT_IVL, &ivl, sizeof(ivl)));
+    TEST_SUCCESS(slk_setsockopt(server, SLK_HEARTBEAT_TIMEOUT, &timeout,
+                                sizeof(timeout)));
+    test_socket_bind(server, endpoint);
+
+    slk_socket_t *client = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(client, "CLIENT");
+    TEST_SUCCESS(slk_setsockopt(client, SLK_HEARTBEAT_IVL, &ivl, sizeof(ivl)));
+    TEST_SUCCESS(slk_setsockopt(client, SLK_HEARTBEAT_TTL, &ttl, sizeof(ttl)));
+    test_socket_connect(client, endpoint);
+
+    /* Let a good number of PING/PONG rounds go by in both directions */
+    test_sleep_ms(300);
+
+    TEST_ASSERT(!test_poll_readable(server, 0));
+    TEST_ASSERT(!test_poll_readable(client, 0));
+
+    /* The peers did not time each other out */
+    TEST_ASSERT_EQ(slk_send(client, "SERVER", 6, SLK_SNDMORE), 6);
+    TEST_ASSERT_EQ(slk_send(client, "hello", 5, 0), 5);
+
+    char buf[16];
+    TEST_ASSERT(test_poll_readable(server, 2000));
+    TEST_ASSERT_EQ(slk_recv(server, buf, sizeof(buf), 0), 6);
+    TEST_ASSERT_MEM_EQ(buf, "CLIENT", 6);
+    TEST_ASSERT_EQ(slk_recv(server, buf, sizeof(buf), 0), 5);
+    TEST_ASSERT_MEM_EQ(buf, "hello", 5);
+    TEST_ASSERT(!test_poll_readable(server, 0));
+
+    /* With monitoring compiled in, the engine's results show up in the
+     * peer statistics */
+    slk_peer_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    if (slk_get_peer_stats(server, "CLIENT", 6, &stats) == 0)
+        TEST_ASSERT(stats.last_heartbeat > 0);
+
+    test_socket_close(client);
+    test_socket_close(server);
+    test_context_destroy(ctx);
+}
+
+/* Test 8: A peer with heartbeats off answers PINGs that carry a TTL and
+ * arms the TTL timer without having heartbeat timers of its own */
+static void test_heartbeat_asymmetric()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *server = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(server, "SERVER");
+    test_socket_bind(server, endpoint);
+
+    int ivl = 50;
+    int ttl = 1000;
+    slk_socket_t *client = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(client, "CLIENT");
+    TEST_SUCCESS(slk_setsockopt(client, SLK_HEARTBEAT_IVL, &ivl, sizeof(ivl)));
+    TEST_SUCCESS(slk_setsockopt(client, SLK_HEARTBEAT_TTL, &ttl, sizeof(ttl)));
+    test_socket_connect(client, endpoint);
+
+    /* Several PINGs with a TTL reach the server */
+    test_sleep_ms(300);
+
+    TEST_ASSERT(!test_poll_readable(server, 0));
+    TEST_ASSERT(!test_poll_readable(client, 0));
+
+    /* The client keeps the server's TTL timer from expiring */
+    test_sleep_ms(1200);
+
+    TEST_ASSERT_EQ(slk_send(client, "SERVER", 6, SLK_SNDMORE), 6);
+    TEST_ASSERT_EQ(slk_send(client, "hello", 5, 0), 5);
+
+    char buf[16];
+    TEST_ASSERT(test_poll_readable(server, 2000));
+    TEST_ASSERT_EQ(slk_recv(server, buf, sizeof(buf), 0), 6);
+    TEST_ASSERT_MEM_EQ(buf, "CLIENT", 6);
+    TEST_ASSERT_EQ(slk_recv(server, buf, sizeof(buf), 0), 5);
+    TEST_ASSERT_MEM_EQ(buf, "hello", 5);
+
+    TEST_ASSERT_EQ(slk_send(server, "CLIENT", 6, SLK_SNDMORE), 6);
+    TEST_ASSERT_EQ(slk_send(server, "world", 5, 0), 5);
+
+    TEST_ASSERT(test_poll_readable(client, 2000));
+    TEST_ASSERT_EQ(slk_recv(client, buf, sizeof(buf), 0), 6);
+    TEST_ASSERT_MEM_EQ(buf, "SERVER", 6);
+    TEST_ASSERT_EQ(slk_recv(client, buf, sizeof(buf), 0), 5);
+    TEST_ASSERT_MEM_EQ(buf, "world", 5);
+
+    test_socket_close(client);
+    test_socket_close(server);
+    test_context_destroy(ctx);
+}
+
 /* Main test runner */
 int main()
 {
@@ -293,9 +399,9 @@ int main()
     RUN_TEST(test_heartbeat_different_socket_types);
     RUN_TEST(test_heartbeat_invalid_values);
     RUN_TEST(test_heartbeat_before_after_connect);
+    RUN_TEST(test_heartbeat_not_delivered);
+    RUN_TEST(test_heartbeat_asymmetric);
 
     printf("\n=== Heartbeat Option Tests Completed ===\n");
-    printf("NOTE: These tests verify option storage. Actual heartbeat\n");
-    printf("      mechanism behavior depends on implementation status.\n");
     return 0;
 }
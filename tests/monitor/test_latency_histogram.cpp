@@ -0,0 +1,101 @@
+/* ServerLink Latency Histogram Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+
+#define MESSAGES 500
+
+static void check_ordered(const slk_latency_histogram_t &hist)
+{
+    TEST_ASSERT(hist.count > 0);
+    TEST_ASSERT(hist.min_us <= hist.p50_us);
+    TEST_ASSERT(hist.p50_us <= hist.p90_us);
+    TEST_ASSERT(hist.p90_us <= hist.p99_us);
+    TEST_ASSERT(hist.p99_us <= hist.p999_us);
+    TEST_ASSERT(hist.p999_us <= hist.max_us);
+    TEST_ASSERT(hist.mean_us <= hist.max_us);
+    /* Everything here is local; nothing should take seconds */
+    TEST_ASSERT(hist.max_us < 5000000);
+}
+
+/* Test: Both directions are sampled over TCP */
+static void test_tcp_latency()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_bind(pub, endpoint);
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    slk_latency_histogram_t hist;
+    int rc = slk_socket_get_latency_histogram(pub, SLK_LATENCY_SEND, &hist);
+    if (rc != 0) {
+        printf("  Note: latency histograms need SL_ENABLE_MONITORING\n");
+        test_socket_close(sub);
+        test_socket_close(pub);
+        test_context_destroy(ctx);
+        return;
+    }
+
+    char buf[64];
+    for (int i = 0; i < MESSAGES; i++) {
+        TEST_ASSERT_EQ(slk_send(pub, "payload", 7, 0), 7);
+        TEST_ASSERT(test_poll_readable(sub, 5000));
+        TEST_ASSERT_EQ(slk_recv(sub, buf, sizeof(buf), 0), 7);
+    }
+
+    TEST_SUCCESS(slk_socket_get_latency_histogram(pub, SLK_LATENCY_SEND, &hist));
+    printf("  send: count=%lu p50=%lu p99=%lu max=%lu us\n",
+           (unsigned long)hist.count, (unsigned long)hist.p50_us,
+           (unsigned long)hist.p99_us, (unsigned long)hist.max_us);
+    check_ordered(hist);
+
+    TEST_SUCCESS(slk_socket_get_latency_histogram(sub, SLK_LATENCY_RECV, &hist));
+    printf("  recv: count=%lu p50=%lu p99=%lu max=%lu us\n",
+           (unsigned long)hist.count, (unsigned long)hist.p50_us,
+           (unsigned long)hist.p99_us, (unsigned long)hist.max_us);
+    check_ordered(hist);
+    /* One message in flight at a time, so every one of them is sampled */
+    TEST_ASSERT(hist.count >= MESSAGES);
+
+    /* The subscriber only ever sent its subscription */
+    TEST_SUCCESS(slk_socket_get_latency_histogram(sub, SLK_LATENCY_SEND, &hist));
+    TEST_ASSERT(hist.count <= 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Invalid arguments */
+static void test_invalid_args()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *s = test_socket_new(ctx, SLK_ROUTER);
+
+    slk_latency_histogram_t hist;
+    TEST_FAILURE(slk_socket_get_latency_histogram(NULL, SLK_LATENCY_SEND, &hist));
+    TEST_FAILURE(slk_socket_get_latency_histogram(s, SLK_LATENCY_SEND, NULL));
+    TEST_FAILURE(slk_socket_get_latency_histogram(s, 2, &hist));
+    TEST_ASSERT_EQ(slk_errno(), SLK_EINVAL);
+
+    test_socket_close(s);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink Latency Histogram Tests ===\n\n");
+
+    RUN_TEST(test_tcp_latency);
+    RUN_TEST(test_invalid_args);
+
+    printf("\n=== All Latency Histogram Tests Passed ===\n");
+    return 0;
+}
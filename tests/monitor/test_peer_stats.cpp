@@ -120,11 +120,13 @@ static void test_get_peer_stats()
         if (stats.msgs_sent > 0 || stats.msgs_received > 0) {
             /* If statistics are being tracked, verify they're reasonable */
             printf("  Statistics are being tracked\n");
-            /* Each message has 3 frames: routing ID, delimiter, payload
-             * We sent 5 logical messages = 15 frames
-             * We received 5 logical messages = 15 frames */
-            TEST_ASSERT(stats.msgs_sent >= 5);
-            TEST_ASSERT(stats.msgs_received >= 5);
+            /* Each message has 3 frames: routing ID, delimiter, payload.
+             * The routing ID frame is not counted, so each direction saw
+             * 5 messages of an empty delimiter plus the payload. */
+            TEST_ASSERT_EQ(stats.msgs_sent, 5);
+            TEST_ASSERT_EQ(stats.msgs_received, 5);
+            TEST_ASSERT_EQ(stats.bytes_sent, 5 * 5);
+            TEST_ASSERT_EQ(stats.bytes_received, 5 * 4);
         } else {
             printf("  Note: Message statistics not tracked (counters are zero)\n");
         }
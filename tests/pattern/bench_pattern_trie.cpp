@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Pattern trie matching benchmark */
+
+// Measures pattern_trie_t::check() throughput as the number of stored
+// patterns grows, next to a linear scan over glob_pattern_t matchers
+// (the pre-automaton implementation) for reference.
+//
+// Patterns look like game topics: "player:<id>:*", "player:*:<field>",
+// "zone:[0-9]*:<id>", "npc:??:<id>". Topics are drawn so that roughly
+// half of them match some pattern.
+//
+// Usage: bench_pattern_trie [max_patterns]   (default: 10000)
+
+#include "../../src/pattern/pattern_trie.hpp"
+#include "../../src/pattern/glob_pattern.hpp"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static const size_t pattern_counts[] = {10, 100, 1000, 10000, 100000};
+static const size_t topics_per_run = 1000;
+
+static std::string make_pattern(size_t i)
+{
+    char buf[64];
+    switch (i % 4) {
+    case 0: snprintf(buf, sizeof(buf), "player:%zu:*", i); break;
+    case 1: snprintf(buf, sizeof(buf), "player:*:field%zu", i); break;
+    case 2: snprintf(buf, sizeof(buf), "zone:[0-9]*:%zu", i); break;
+    default: snprintf(buf, sizeof(buf), "npc:??:%zu", i); break;
+    }
+    return buf;
+}
+
+static std::string make_topic(std::mt19937 &rng, size_t patterns)
+{
+    char buf[64];
+    const size_t i = rng() % (patterns * 2);
+    switch (rng() % 4) {
+    case 0: snprintf(buf, sizeof(buf), "player:%zu:pos", i); break;
+    case 1: snprintf(buf, sizeof(buf), "player:42:field%zu", i); break;
+    case 2: snprintf(buf, sizeof(buf), "zone:7a:%zu", i); break;
+    default: snprintf(buf, sizeof(buf), "npc:ab:%zu", i); break;
+    }
+    return buf;
+}
+
+template <typename Func>
+static double matches_per_sec(const std::vector<std::string> &topics,
+                              size_t min_matches, Func match, size_t *hits)
+{
+    typedef std::chrono::steady_clock clock;
+    size_t done = 0;
+    *hits = 0;
+    const clock::time_point start = clock::now();
+    while (done < min_matches) {
+        for (size_t i = 0; i < topics.size(); i++)
+            *hits += match(topics[i]) ? 1 : 0;
+        done += topics.size();
+    }
+    const double secs =
+      std::chrono::duration<double>(clock::now() - start).count();
+    return done / secs;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t max_patterns = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+
+    printf("%10s %16s %16s %8s\n", "patterns", "trie matches/s",
+           "linear matches/s", "speedup");
+
+    for (size_t c = 0; c < sizeof(pattern_counts) / sizeof(pattern_counts[0]);
+         c++) {
+        const size_t count = pattern_counts[c];
+        if (count > max_patterns)
+            break;
+
+        slk::pattern_trie_t trie;
+        std::vector<std::unique_ptr<slk::glob_pattern_t> > linear;
+        for (size_t i = 0; i < count; i++) {
+            const std::string pattern = make_pattern(i);
+            trie.add(pattern);
+            linear.push_back(std::unique_ptr<slk::glob_pattern_t>(
+              new slk::glob_pattern_t(pattern)));
+        }
+
+        std::mt19937 rng(12345);
+        std::vector<std::string> topics;
+        for (size_t i = 0; i < topics_per_run; i++)
+            topics.push_back(make_topic(rng, count));
+
+        size_t trie_hits, linear_hits;
+        const double trie_rate = matches_per_sec(
+          topics, 1000000, [&](const std::string &t) { return trie.check(t); },
+          &trie_hits);
+
+        // The linear scan gets fewer iterations; it is quadratic in effect
+        const double linear_rate = matches_per_sec(
+          topics, count >= 10000 ? topics_per_run : 100000,
+          [&](const std::string &t) {
+              for (size_t i = 0; i < linear.size(); i++)
+                  if (linear[i]->match(t))
+                      return true;
+              return false;
+          },
+          &linear_hits);
+
+        printf("%10zu %16.0f %16.0f %7.1fx\n", count, trie_rate, linear_rate,
+               trie_rate / linear_rate);
+    }
+
+    return 0;
+}
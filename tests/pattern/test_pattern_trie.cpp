@@ -4,6 +4,9 @@
 #include "../testutil.hpp"
 #include "../../src/pattern/pattern_trie.hpp"
 #include <string.h>
+#include <set>
+#include <thread>
+#include <atomic>
 
 // Test basic add and check
 static void test_add_and_check()
@@ -171,6 +174,100 @@ static void test_invalid_pattern()
     TEST_ASSERT_EQ(trie.num_patterns(), 0);
 }
 
+// Test that the automaton agrees with glob_pattern_t on shared prefixes
+static void test_matches_glob()
+{
+    static const char *patterns[] = {
+        "player:*:pos", "player:*:hp", "player:1*", "zone:[0-9]*", "zone:??",
+        "zone:[!0-9]x", "*", "a*b*c", "a**c", "[a]bc", "abc", "*:pos",
+        "news.\\*", "x?y*z", ""};
+    static const char *topics[] = {
+        "player:42:pos", "player:42:hp", "player:1", "player:", "zone:7",
+        "zone:ab", "zone:", "zone:ax", "abc", "aXbYc", "ac", "news.*",
+        "news.x", "x1yz", "xyz", "", "pos", ":pos"};
+    const size_t npatterns = sizeof(patterns) / sizeof(patterns[0]);
+    const size_t ntopics = sizeof(topics) / sizeof(topics[0]);
+
+    // Add and remove patterns one at a time so every intermediate
+    // version of the trie is checked
+    for (size_t limit = 1; limit <= npatterns; limit++) {
+        slk::pattern_trie_t trie;
+        for (size_t i = 0; i < npatterns; i++)
+            trie.add(patterns[i]);
+        for (size_t i = limit; i < npatterns; i++)
+            trie.rm(patterns[i]);
+        TEST_ASSERT_EQ(trie.num_patterns(), limit);
+
+        for (size_t t = 0; t < ntopics; t++) {
+            bool expected = false;
+            for (size_t i = 0; i < limit; i++)
+                expected |= slk::glob_pattern_t(patterns[i]).match(topics[t]);
+            TEST_ASSERT_EQ(trie.check(topics[t]), expected);
+        }
+    }
+}
+
+// Test match reports every matching pattern once
+static void collect_pattern(const std::string &pattern, void *arg)
+{
+    std::multiset<std::string> *matched =
+      static_cast<std::multiset<std::string> *>(arg);
+    matched->insert(pattern);
+}
+
+static void test_match_callback()
+{
+    slk::pattern_trie_t trie;
+
+    trie.add("player:*:pos");
+    trie.add("player:*");
+    trie.add("*:pos");
+    trie.add("[p]layer:?:pos");
+    trie.add("zone:*");
+
+    std::multiset<std::string> matched;
+    trie.match(reinterpret_cast<const unsigned char *>("player:7:pos"), 12,
+               collect_pattern, &matched);
+    TEST_ASSERT_EQ(matched.size(), (size_t)4);
+    TEST_ASSERT_EQ(matched.count("player:*:pos"), (size_t)1);
+    TEST_ASSERT_EQ(matched.count("player:*"), (size_t)1);
+    TEST_ASSERT_EQ(matched.count("*:pos"), (size_t)1);
+    TEST_ASSERT_EQ(matched.count("[p]layer:?:pos"), (size_t)1);
+
+    TEST_ASSERT(trie.contains(reinterpret_cast<const unsigned char *>("zone:*"), 6));
+    TEST_ASSERT(!trie.contains(reinterpret_cast<const unsigned char *>("zone"), 4));
+}
+
+// Test readers running concurrently with writers
+static void test_concurrent_readers()
+{
+    slk::pattern_trie_t trie;
+    trie.add("stable.*");
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::thread reader([&]() {
+        while (!stop.load()) {
+            if (!trie.check("stable.topic"))
+                failures++;
+            trie.check("churn.42.x");
+        }
+    });
+
+    char pattern[32];
+    for (int round = 0; round < 2000; round++) {
+        snprintf(pattern, sizeof(pattern), "churn.%d.*", round % 50);
+        if (round % 2 == 0)
+            trie.add(pattern);
+        else
+            trie.rm(pattern);
+    }
+
+    stop = true;
+    reader.join();
+    TEST_ASSERT_EQ(failures.load(), 0);
+}
+
 int main()
 {
     printf("Running pattern_trie tests...\n");
@@ -187,6 +284,9 @@ int main()
     test_complex_patterns();
     test_apply();
     test_invalid_pattern();
+    test_matches_glob();
+    test_match_callback();
+    test_concurrent_readers();
 
     printf("All pattern_trie tests passed!\n");
     return 0;
@@ -0,0 +1,349 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Publisher-side pattern subscription tests */
+
+#include "../testutil.hpp"
+#include <string.h>
+#include <string>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Receive a subscription notification on an XPUB and check it
+static void recv_notification(slk_socket_t *xpub, unsigned char type,
+                              const char *pattern)
+{
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+
+    char buf[256];
+    const int rc = slk_recv(xpub, buf, sizeof(buf), 0);
+    TEST_ASSERT_EQ(rc, (int)strlen(pattern) + 1);
+    TEST_ASSERT_EQ((unsigned char)buf[0], type);
+    TEST_ASSERT_MEM_EQ(buf + 1, pattern, strlen(pattern));
+}
+
+// XSUB does not filter, so anything it receives was sent by the publisher
+static void test_xpub_filters_patterns()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PSUBSCRIBE, "news.*", 6));
+    recv_notification(xpub, 3, "news.*");
+
+    test_send_string(xpub, "weather.today", 0);
+    test_send_string(xpub, "news.sports", 0);
+    test_send_string(xpub, "user.1", 0);
+    test_send_string(xpub, "news.tech", 0);
+
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "news.sports", 0);
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "news.tech", 0);
+    TEST_ASSERT(!test_poll_readable(xsub, 100));
+
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PUNSUBSCRIBE, "news.*", 6));
+    recv_notification(xpub, 2, "news.*");
+
+    test_send_string(xpub, "news.sports", 0);
+    TEST_ASSERT(!test_poll_readable(xsub, 100));
+
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Prefix and pattern subscriptions combine on a SUB socket
+static void test_sub_prefix_and_pattern()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "weather", 7));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_PSUBSCRIBE, "user.?", 6));
+    test_socket_connect(sub, endpoint);
+
+    test_sleep_ms(SETTLE_TIME);
+
+    test_send_string(pub, "news.sports", 0);
+    test_send_string(pub, "user.12", 0);
+    test_send_string(pub, "weather.today", 0);
+    test_send_string(pub, "user.1", 0);
+
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "weather.today", 0);
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "user.1", 0);
+    TEST_ASSERT(!test_poll_readable(sub, 100));
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+// A pattern shared by two subscribers stays until the last one leaves
+static void test_pattern_shared_by_pipes()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *sub1 = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub1, SLK_PSUBSCRIBE, "zone:[0-9]*", 11));
+    test_socket_connect(sub1, endpoint);
+    recv_notification(xpub, 3, "zone:[0-9]*");
+
+    slk_socket_t *sub2 = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub2, SLK_PSUBSCRIBE, "zone:[0-9]*", 11));
+    test_socket_connect(sub2, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    // Only the first subscriber is reported
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    test_socket_close(sub1);
+    test_sleep_ms(SETTLE_TIME);
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    test_send_string(xpub, "zone:7", 0);
+    TEST_ASSERT(test_poll_readable(sub2, 1000));
+    test_recv_string(sub2, "zone:7", 0);
+
+    test_socket_close(sub2);
+    recv_notification(xpub, 2, "zone:[0-9]*");
+
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Upstream user messages pass through unless their first byte is one of
+// the reserved subscription bytes
+static void test_upstream_messages()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    test_send_string(xsub, "\x06user", 0);
+    test_send_string(xsub, "\x03news.*", 0);
+    test_send_string(xsub, "\x03news.*", 0);
+    test_send_string(xsub, "\xffuser", 0);
+    test_send_string(xsub, "hello", 0);
+
+    // A pattern message is consumed: the XPUB reports only the first one
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+    test_recv_string(xpub, "\x06user", 0);
+    recv_notification(xpub, 3, "news.*");
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+    test_recv_string(xpub, "\xffuser", 0);
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+    test_recv_string(xpub, "hello", 0);
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    test_send_string(xpub, "news.tech", 0);
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "news.tech", 0);
+
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Repeating a pattern subscription does not send it upstream again
+static void test_duplicate_psubscribe()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    // A verbose XPUB reports every subscribe that reaches it
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    int verbose = 1;
+    TEST_SUCCESS(slk_setsockopt(xpub, SLK_XPUB_VERBOSE, &verbose,
+                                sizeof(verbose)));
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PSUBSCRIBE, "news.*", 6));
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PSUBSCRIBE, "news.*", 6));
+    recv_notification(xpub, 3, "news.*");
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    // Only the last cancel travels upstream
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PUNSUBSCRIBE, "news.*", 6));
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_PUNSUBSCRIBE, "news.*", 6));
+    recv_notification(xpub, 2, "news.*");
+
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+#ifndef _WIN32
+// A raw ZMTP 3.0 peer that announces itself as a PUB but, like libzmq,
+// does not announce pattern filtering
+
+static bool raw_read(int fd, void *data, size_t size)
+{
+    unsigned char *ptr = static_cast<unsigned char *>(data);
+    while (size > 0) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 2000) != 1)
+            return false;
+        const ssize_t n = read(fd, ptr, size);
+        if (n <= 0)
+            return false;
+        ptr += n;
+        size -= n;
+    }
+    return true;
+}
+
+static void raw_write(int fd, const void *data, size_t size)
+{
+    TEST_ASSERT_EQ(write(fd, data, size), (ssize_t)size);
+}
+
+static bool raw_read_frame(int fd, unsigned char *flags, std::string &body)
+{
+    unsigned char header[9];
+    if (!raw_read(fd, header, 2))
+        return false;
+    *flags = header[0];
+    size_t size = header[1];
+    if (*flags & 0x02) {
+        if (!raw_read(fd, header + 2, 7))
+            return false;
+        size = 0;
+        for (int i = 1; i != 9; i++)
+            size = (size << 8) | header[i];
+    }
+    body.resize(size);
+    return size == 0 || raw_read(fd, &body[0], size);
+}
+
+static void raw_send_frame(int fd, unsigned char flags, const std::string &body)
+{
+    const unsigned char header[2] = {flags, (unsigned char)body.size()};
+    raw_write(fd, header, sizeof(header));
+    raw_write(fd, body.data(), body.size());
+}
+
+// Read the next message frame, skipping commands
+static std::string raw_read_message(int fd)
+{
+    unsigned char flags;
+    std::string body;
+    while (raw_read_frame(fd, &flags, body))
+        if (!(flags & 0x04))
+            return body;
+    return "<timeout>";
+}
+
+// A publisher that does not filter on patterns still delivers to a
+// pattern subscriber: the SUB subscribes it to everything and filters
+static void test_legacy_publisher()
+{
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(listener >= 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_SUCCESS(bind(listener, (sockaddr *)&addr, sizeof(addr)));
+    TEST_SUCCESS(listen(listener, 1));
+    socklen_t addr_len = sizeof(addr);
+    TEST_SUCCESS(getsockname(listener, (sockaddr *)&addr, &addr_len));
+
+    char endpoint[64];
+    snprintf(endpoint, sizeof(endpoint), "tcp://127.0.0.1:%d",
+             ntohs(addr.sin_port));
+
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_PSUBSCRIBE, "news.*", 6));
+    test_socket_connect(sub, endpoint);
+
+    const int fd = accept(listener, NULL, NULL);
+    TEST_ASSERT(fd >= 0);
+
+    unsigned char greeting[64] = {0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0x7f,
+                                  3, 0, 'N', 'U', 'L', 'L'};
+    raw_write(fd, greeting, sizeof(greeting));
+    TEST_ASSERT(raw_read(fd, greeting, sizeof(greeting)));
+
+    const std::string ready("\x05READY\x0bSocket-Type\0\0\0\x03PUB", 25);
+    raw_send_frame(fd, 0x04, ready);
+
+    // The first pattern reaches the peer as the empty prefix, and
+    // further patterns not at all
+    TEST_ASSERT(raw_read_message(fd) == std::string("\x01", 1));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_PSUBSCRIBE, "user.?", 6));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "weather.", 8));
+    TEST_ASSERT(raw_read_message(fd) == "\x01weather.");
+
+    raw_send_frame(fd, 0, "sports.today");
+    raw_send_frame(fd, 0, "news.tech");
+    raw_send_frame(fd, 0, "user.1");
+
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "news.tech", 0);
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "user.1", 0);
+    TEST_ASSERT(!test_poll_readable(sub, 100));
+
+    // Only dropping the last pattern drops the empty prefix
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_PUNSUBSCRIBE, "news.*", 6));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_UNSUBSCRIBE, "weather.", 8));
+    TEST_ASSERT(raw_read_message(fd) == std::string("\x00weather.", 9));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_PUNSUBSCRIBE, "user.?", 6));
+    TEST_ASSERT(raw_read_message(fd) == std::string("\x00", 1));
+
+    test_socket_close(sub);
+    test_context_destroy(ctx);
+    close(fd);
+    close(listener);
+}
+#endif
+
+int main()
+{
+    printf("=== ServerLink Pattern Subscription Tests ===\n\n");
+
+    RUN_TEST(test_xpub_filters_patterns);
+    RUN_TEST(test_sub_prefix_and_pattern);
+    RUN_TEST(test_pattern_shared_by_pipes);
+    RUN_TEST(test_upstream_messages);
+    RUN_TEST(test_duplicate_psubscribe);
+#ifndef _WIN32
+    RUN_TEST(test_legacy_publisher);
+#endif
+
+    printf("\n=== All Pattern Subscription Tests Passed ===\n");
+    return 0;
+}
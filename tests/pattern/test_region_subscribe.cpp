@@ -0,0 +1,361 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Region (area of interest) subscription tests */
+
+#include "../testutil.hpp"
+#include "../../src/pattern/region_index.hpp"
+#include <string.h>
+#include <set>
+#include <string>
+
+// Build a region option value: grid name, then x0, y0, x1, y1 big-endian
+static size_t make_region(unsigned char *buf, const char *grid, int x0, int y0,
+                          int x1, int y1)
+{
+    const size_t len = strlen(grid);
+    memcpy(buf, grid, len);
+    const int coords[4] = {x0, y0, x1, y1};
+    for (int i = 0; i < 4; i++) {
+        const uint32_t v = (uint32_t)coords[i];
+        buf[len + i * 4] = (unsigned char)(v >> 24);
+        buf[len + i * 4 + 1] = (unsigned char)(v >> 16);
+        buf[len + i * 4 + 2] = (unsigned char)(v >> 8);
+        buf[len + i * 4 + 3] = (unsigned char)v;
+    }
+    return len + 16;
+}
+
+// Receive a subscription notification on an XPUB and check it
+static void recv_notification(slk_socket_t *xpub, unsigned char type,
+                              const unsigned char *body, size_t size)
+{
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+
+    unsigned char buf[256];
+    const int rc = slk_recv(xpub, buf, sizeof(buf), 0);
+    TEST_ASSERT_EQ(rc, (int)size + 1);
+    TEST_ASSERT_EQ(buf[0], type);
+    TEST_ASSERT_MEM_EQ(buf + 1, body, size);
+}
+
+static void collect(int *owner, std::set<int> *owners)
+{
+    owners->insert(*owner);
+}
+
+static std::set<int> match(const slk::region_index_t<int> &index,
+                           const char *grid, int x, int y)
+{
+    std::set<int> owners;
+    index.match(grid, x, y, collect, &owners);
+    return owners;
+}
+
+// Test the index directly, including moves across tiles
+static void test_index_match()
+{
+    slk::region_index_t<int> index;
+    int a = 1, b = 2;
+
+    const slk::region_t ra = {0, 0, 9, 9};
+    const slk::region_t rb = {5, 5, 40, 40};
+    TEST_ASSERT(index.set("map", ra, &a));
+    TEST_ASSERT(index.set("map", rb, &b));
+    TEST_ASSERT(!index.set("map", ra, &a));
+    TEST_ASSERT_EQ(index.size(), 2u);
+
+    TEST_ASSERT(match(index, "map", 3, 3) == std::set<int>({1}));
+    TEST_ASSERT(match(index, "map", 7, 7) == std::set<int>({1, 2}));
+    TEST_ASSERT(match(index, "map", 30, 30) == std::set<int>({2}));
+    TEST_ASSERT(match(index, "map", 50, 50).empty());
+    TEST_ASSERT(match(index, "other", 3, 3).empty());
+
+    // Move into other tiles, then partly back
+    const slk::region_t moved = {100, -20, 110, -10};
+    TEST_ASSERT(index.set("map", moved, &a));
+    TEST_ASSERT(match(index, "map", 3, 3).empty());
+    TEST_ASSERT(match(index, "map", 105, -15) == std::set<int>({1}));
+    const slk::region_t back = {8, 8, 20, 20};
+    TEST_ASSERT(index.set("map", back, &a));
+    TEST_ASSERT(match(index, "map", 105, -15).empty());
+    TEST_ASSERT(match(index, "map", 19, 19) == std::set<int>({1, 2}));
+
+    // Regions over many tiles are matched as well
+    const slk::region_t large = {-1000, -1000, 1000, 1000};
+    TEST_ASSERT(index.set("map", large, &b));
+    TEST_ASSERT(match(index, "map", 999, -999) == std::set<int>({2}));
+    TEST_ASSERT(index.set("map", rb, &b));
+    TEST_ASSERT(match(index, "map", 999, -999).empty());
+
+    TEST_ASSERT(index.rm("map", &a));
+    TEST_ASSERT(!index.rm("map", &a));
+    TEST_ASSERT(match(index, "map", 19, 19) == std::set<int>({2}));
+    TEST_ASSERT_EQ(index.size(), 1u);
+}
+
+static bool parse(const char *topic, std::string *grid, int32_t *x,
+                  int32_t *y)
+{
+    std::string_view view;
+    if (!slk::parse_cell((const unsigned char *)topic, strlen(topic), view, *x,
+                         *y))
+        return false;
+    *grid = std::string(view);
+    return true;
+}
+
+// Test parsing of cell topics
+static void test_parse_cell()
+{
+    std::string grid;
+    int32_t x, y;
+
+    TEST_ASSERT(parse("zone:cell:5,-7", &grid, &x, &y));
+    TEST_ASSERT(grid == "zone:cell");
+    TEST_ASSERT_EQ(x, 5);
+    TEST_ASSERT_EQ(y, -7);
+    TEST_ASSERT(parse(":0,0", &grid, &x, &y));
+    TEST_ASSERT(grid.empty());
+    TEST_ASSERT(parse("map:-2147483648,2147483647", &grid, &x, &y));
+    TEST_ASSERT_EQ(x, INT32_MIN);
+    TEST_ASSERT_EQ(y, INT32_MAX);
+
+    TEST_ASSERT(!parse("5,7", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:5", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:5,", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:a,1", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:5,7x", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:2147483648,0", &grid, &x, &y));
+    TEST_ASSERT(!parse("map:12345678901,0", &grid, &x, &y));
+}
+
+// XSUB does not filter, so anything it receives was sent by the publisher
+static void test_xpub_filters_regions()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+
+    unsigned char region[64];
+    size_t size = make_region(region, "map", 0, 0, 3, 3);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    recv_notification(xpub, 5, region, size);
+
+    test_send_string(xpub, "map:1,1", 0);
+    test_send_string(xpub, "map:20,20", 0);
+    test_send_string(xpub, "other:1,1", 0);
+    test_send_string(xpub, "map", 0);
+    test_send_string(xpub, "map:2,3", 0);
+
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "map:1,1", 0);
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "map:2,3", 0);
+    TEST_ASSERT(!test_poll_readable(xsub, 100));
+
+    // Moving the region is a single message, which is not reported
+    size = make_region(region, "map", 20, 20, 21, 21);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    TEST_ASSERT(!test_poll_readable(xpub, SETTLE_TIME));
+
+    test_send_string(xpub, "map:1,1", 0);
+    test_send_string(xpub, "map:20,20", 0);
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "map:20,20", 0);
+    TEST_ASSERT(!test_poll_readable(xsub, 100));
+
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_UNSUBSCRIBE_REGION, "map", 3));
+    recv_notification(xpub, 4, (const unsigned char *)"map", 3);
+
+    test_send_string(xpub, "map:20,20", 0);
+    TEST_ASSERT(!test_poll_readable(xsub, 100));
+
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Prefix and region subscriptions combine on a SUB socket, and regions set
+// before connecting are sent on attach
+static void test_sub_prefix_and_region()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    unsigned char region[64];
+    const size_t size = make_region(region, "map", 0, 0, 5, 5);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "map:1,", 6));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE_REGION, region, size));
+    test_socket_connect(sub, endpoint);
+
+    test_sleep_ms(SETTLE_TIME);
+
+    test_send_string(pub, "map:1,1", 0);
+    test_send_string(pub, "map:9,9", 0);
+    test_send_string(pub, "map:1,9", 0);
+    test_send_string(pub, "map:3,3", 0);
+
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "map:1,1", 0);
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "map:1,9", 0);
+    TEST_ASSERT(test_poll_readable(sub, 1000));
+    test_recv_string(sub, "map:3,3", 0);
+    TEST_ASSERT(!test_poll_readable(sub, 100));
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+// Malformed regions are rejected
+static void test_invalid_region()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+
+    unsigned char region[64];
+    TEST_FAILURE(slk_setsockopt(sub, SLK_SUBSCRIBE_REGION, "map", 3));
+    TEST_ASSERT_EQ(slk_errno(), SLK_EINVAL);
+    const size_t size = make_region(region, "map", 5, 0, 4, 0);
+    TEST_FAILURE(slk_setsockopt(sub, SLK_SUBSCRIBE_REGION, region, size));
+    TEST_ASSERT_EQ(slk_errno(), SLK_EINVAL);
+
+    test_socket_close(sub);
+    test_context_destroy(ctx);
+}
+
+// A subscriber going away cancels its regions
+static void test_region_cancel_on_disconnect()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+
+    unsigned char region[64];
+    const size_t size = make_region(region, "map", 0, 0, 3, 3);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    recv_notification(xpub, 5, region, size);
+
+    test_socket_close(xsub);
+    recv_notification(xpub, 4, (const unsigned char *)"map", 3);
+
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Upstream region messages are consumed, other user messages pass through
+static void test_upstream_messages()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(xsub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    unsigned char msg[64];
+    msg[0] = 5;
+    const size_t size = make_region(msg + 1, "map", 0, 0, 3, 3);
+    TEST_ASSERT_EQ(slk_send(xsub, msg, size + 1, 0), (int)size + 1);
+    test_send_string(xsub, "\x06user", 0);
+
+    recv_notification(xpub, 5, msg + 1, size);
+    TEST_ASSERT(test_poll_readable(xpub, 1000));
+    test_recv_string(xpub, "\x06user", 0);
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    test_send_string(xpub, "map:2,2", 0);
+    TEST_ASSERT(test_poll_readable(xsub, 1000));
+    test_recv_string(xsub, "map:2,2", 0);
+
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+// Only the first region on a grid and the last one leaving it are
+// reported, unless the XPUB is verbose
+static void test_region_notifications()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    // Every move below must reach the XPUB
+    const int hwm = 0;
+    slk_socket_t *xsub = test_socket_new(ctx, SLK_XSUB);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SNDHWM, &hwm, sizeof(hwm)));
+    test_socket_connect(xsub, endpoint);
+    slk_socket_t *other = test_socket_new(ctx, SLK_XSUB);
+    test_socket_connect(other, endpoint);
+
+    unsigned char region[64];
+    size_t size = make_region(region, "map", 0, 0, 3, 3);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    recv_notification(xpub, 5, region, size);
+    TEST_SUCCESS(slk_setsockopt(other, SLK_SUBSCRIBE_REGION, region, size));
+    TEST_ASSERT(!test_poll_readable(xpub, SETTLE_TIME));
+
+    for (int i = 1; i <= 1000; i++) {
+        size = make_region(region, "map", i, i, i + 3, i + 3);
+        TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    }
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_UNSUBSCRIBE_REGION, "map", 3));
+    TEST_SUCCESS(slk_setsockopt(other, SLK_UNSUBSCRIBE_REGION, "map", 3));
+
+    // Only the last region leaving the grid is reported
+    recv_notification(xpub, 4, (const unsigned char *)"map", 3);
+    TEST_ASSERT(!test_poll_readable(xpub, 100));
+
+    // Verbose mode reports moves as well
+    const int verbose = 1;
+    TEST_SUCCESS(slk_setsockopt(xpub, SLK_XPUB_VERBOSE, &verbose,
+                                sizeof(verbose)));
+    size = make_region(region, "map", 0, 0, 3, 3);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    recv_notification(xpub, 5, region, size);
+    size = make_region(region, "map", 5, 5, 8, 8);
+    TEST_SUCCESS(slk_setsockopt(xsub, SLK_SUBSCRIBE_REGION, region, size));
+    recv_notification(xpub, 5, region, size);
+
+    test_socket_close(other);
+    test_socket_close(xsub);
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink Region Subscription Tests ===\n\n");
+
+    RUN_TEST(test_index_match);
+    RUN_TEST(test_parse_cell);
+    RUN_TEST(test_xpub_filters_regions);
+    RUN_TEST(test_sub_prefix_and_region);
+    RUN_TEST(test_invalid_region);
+    RUN_TEST(test_region_cancel_on_disconnect);
+    RUN_TEST(test_region_notifications);
+    RUN_TEST(test_upstream_messages);
+
+    printf("\n=== All Region Subscription Tests Passed ===\n");
+    return 0;
+}
@@ -5,6 +5,9 @@
 #include <cassert>
 #include <cstring>
 #include <cerrno>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 // Test creating and destroying poller
 void test_create_destroy()
@@ -266,6 +269,164 @@ void test_wait_empty_without_timeout()
     printf("  PASSED\n");
 }
 
+// Test that one wait reports every ready socket and that modify rearms
+void test_wait_all_many_sockets()
+{
+    printf("Running test_wait_all_many_sockets...\n");
+
+    const int n_subs = 64;
+
+    slk_ctx_t *ctx = slk_ctx_new();
+    assert(ctx);
+
+    slk_socket_t *pub = slk_socket(ctx, SLK_PUB);
+    assert(pub);
+    int rc = slk_bind(pub, "inproc://poller-many");
+    assert(rc == 0);
+
+    void *poller = slk_poller_new();
+    assert(poller);
+
+    slk_socket_t *subs[n_subs];
+    char topic[16];
+    for (int i = 0; i < n_subs; i++) {
+        subs[i] = slk_socket(ctx, SLK_SUB);
+        assert(subs[i]);
+        snprintf(topic, sizeof(topic), "t%02d", i);
+        rc = slk_setsockopt(subs[i], SLK_SUBSCRIBE, topic, strlen(topic));
+        assert(rc == 0);
+        rc = slk_connect(subs[i], "inproc://poller-many");
+        assert(rc == 0);
+        rc = slk_poller_add(poller, subs[i], &subs[i], SLK_POLLIN);
+        assert(rc == 0);
+    }
+    slk_sleep(200);
+
+    // Nothing is readable yet
+    slk_poller_event_t events[n_subs];
+    rc = slk_poller_wait_all(poller, events, n_subs, 0);
+    assert(rc == -1);
+    assert(errno == EAGAIN);
+
+    // Make every other subscriber readable
+    for (int i = 0; i < n_subs; i += 2) {
+        snprintf(topic, sizeof(topic), "t%02d", i);
+        rc = slk_send(pub, topic, strlen(topic), 0);
+        assert(rc >= 0);
+    }
+
+    bool seen[n_subs] = {};
+    int n_seen = 0;
+    while (n_seen < n_subs / 2) {
+        rc = slk_poller_wait_all(poller, events, n_subs, 1000);
+        assert(rc > 0);
+        for (int e = 0; e < rc; e++) {
+            const int idx = static_cast<int>(
+                static_cast<slk_socket_t **>(events[e].user_data) - subs);
+            assert(idx >= 0 && idx < n_subs && idx % 2 == 0);
+            assert(events[e].socket == subs[idx]);
+            assert(events[e].events & SLK_POLLIN);
+            if (!seen[idx]) {
+                seen[idx] = true;
+                n_seen++;
+            }
+        }
+    }
+
+    // A ready socket keeps being reported until it is drained
+    rc = slk_poller_wait_all(poller, events, n_subs, 0);
+    assert(rc == n_subs / 2);
+
+    char buf[16];
+    for (int i = 0; i < n_subs; i += 2) {
+        rc = slk_recv(subs[i], buf, sizeof(buf), 0);
+        assert(rc == 3);
+    }
+    rc = slk_poller_wait_all(poller, events, n_subs, 0);
+    assert(rc == -1);
+    assert(errno == EAGAIN);
+
+    // Disabled items are not reported; enabling them again picks up
+    // what arrived in between
+    rc = slk_poller_modify(poller, subs[1], 0);
+    assert(rc == 0);
+    rc = slk_send(pub, "t01", 3, 0);
+    assert(rc >= 0);
+    rc = slk_poller_wait_all(poller, events, n_subs, 100);
+    assert(rc == -1);
+    assert(errno == EAGAIN);
+
+    rc = slk_poller_modify(poller, subs[1], SLK_POLLIN);
+    assert(rc == 0);
+    rc = slk_poller_wait_all(poller, events, n_subs, 1000);
+    assert(rc == 1);
+    assert(events[0].socket == subs[1]);
+
+    slk_poller_destroy(&poller);
+    for (int i = 0; i < n_subs; i++)
+        slk_close(subs[i]);
+    slk_close(pub);
+    slk_ctx_destroy(ctx);
+
+    printf("  PASSED\n");
+}
+
+#ifndef _WIN32
+// Test polling a raw file descriptor alongside the socket items
+void test_poll_raw_fd()
+{
+    printf("Running test_poll_raw_fd...\n");
+
+    int fds[2];
+    int rc = pipe(fds);
+    assert(rc == 0);
+
+    void *poller = slk_poller_new();
+    assert(poller);
+
+    rc = slk_poller_add_fd(poller, fds[0], fds, SLK_POLLIN);
+    assert(rc == 0);
+    rc = slk_poller_add_fd(poller, fds[0], fds, SLK_POLLIN);
+    assert(rc == -1);
+
+    slk_poller_event_t event;
+    rc = slk_poller_wait(poller, &event, 0);
+    assert(rc == -1);
+    assert(errno == EAGAIN);
+
+    rc = static_cast<int>(write(fds[1], "x", 1));
+    assert(rc == 1);
+
+    rc = slk_poller_wait(poller, &event, 1000);
+    assert(rc == 0);
+    assert(event.socket == nullptr);
+    assert(event.fd == fds[0]);
+    assert(event.user_data == fds);
+    assert(event.events & SLK_POLLIN);
+
+    rc = slk_poller_modify_fd(poller, fds[0], 0);
+    assert(rc == 0);
+    rc = slk_poller_wait(poller, &event, 0);
+    assert(rc == -1);
+
+    rc = slk_poller_modify_fd(poller, fds[0], SLK_POLLIN);
+    assert(rc == 0);
+    rc = slk_poller_wait(poller, &event, 0);
+    assert(rc == 0);
+    assert(event.fd == fds[0]);
+
+    rc = slk_poller_remove_fd(poller, fds[0]);
+    assert(rc == 0);
+    assert(slk_poller_size(poller) == 0);
+
+    slk_poller_destroy(&poller);
+    close(fds[0]);
+    close(fds[1]);
+
+    printf("  PASSED\n");
+}
+#endif
+
 int main()
 {
     printf("\n===== ServerLink Poller API Tests =====\n\n");
@@ -279,6 +440,10 @@ int main()
     test_poll_basic();
     test_wait_empty_with_timeout();
     test_wait_empty_without_timeout();
+    test_wait_all_many_sockets();
+#ifndef _WIN32
+    test_poll_raw_fd();
+#endif
 
     printf("\n===== All Poller Tests Passed! =====\n\n");
 
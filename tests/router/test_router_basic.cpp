@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "../testutil.hpp"
+#include "../../src/core/ctx.hpp"
 
 /* Test: Create ROUTER socket */
 static void test_router_create()
@@ -179,6 +180,138 @@ static void test_router_multiple_messages()
     test_context_destroy(ctx);
 }
 
+/* Test: Mixed small and large messages in one output batch */
+static void test_router_mixed_sizes()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *server = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(server, "SERVER");
+    test_socket_bind(server, endpoint);
+
+    slk_socket_t *client = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(client, "CLIENT");
+    test_socket_connect(client, endpoint);
+
+    test_sleep_ms(200);
+
+    /* Sizes straddle the copy/gather threshold of the engine */
+    static const size_t sizes[] = {5, 1023, 1024, 4096, 30, 65536, 0, 200, 20000};
+    const int count = sizeof(sizes) / sizeof(sizes[0]);
+    static char buf[65536];
+
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < count; i++) {
+            memset(buf, 'a' + (round * count + i) % 26, sizes[i]);
+            slk_send(client, "SERVER", 6, SLK_SNDMORE);
+            slk_send(client, buf, sizes[i], 0);
+        }
+    }
+
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < count; i++) {
+            TEST_ASSERT(test_poll_readable(server, 1000));
+
+            char identity[256];
+            slk_recv(server, identity, sizeof(identity), 0);
+            int rc = slk_recv(server, buf, sizeof(buf), 0);
+            TEST_ASSERT_EQ(rc, (int)sizes[i]);
+
+            const char expected = 'a' + (round * count + i) % 26;
+            for (size_t j = 0; j < sizes[i]; j++)
+                TEST_ASSERT_EQ(buf[j], expected);
+        }
+    }
+
+    test_socket_close(client);
+    test_socket_close(server);
+    test_context_destroy(ctx);
+}
+
+/* Test: Connections accepted by one listener spread over I/O threads */
+static void test_router_multi_io_threads()
+{
+    /* Clients live in their own context, so the server context's I/O
+     * thread loads count only the sessions of accepted connections */
+    slk_ctx_t *ctx = test_context_new();
+    slk_ctx_t *client_ctx = test_context_new();
+    int io_threads = 4;
+    TEST_SUCCESS(slk_ctx_set(ctx, SLK_IO_THREADS, &io_threads, sizeof(io_threads)));
+    slk::ctx_t *core = reinterpret_cast<slk::ctx_t *>(ctx);
+
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *server = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(server, "SERVER");
+    test_socket_bind(server, endpoint);
+
+    int base_load[4];
+    for (int i = 0; i < io_threads; i++) {
+        base_load[i] = core->get_io_thread_load(i);
+        TEST_ASSERT(base_load[i] >= 0);
+    }
+    TEST_ASSERT_EQ(core->get_io_thread_load(io_threads), -1);
+
+    const int client_count = 8;
+    slk_socket_t *clients[client_count];
+    for (int i = 0; i < client_count; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "CLIENT%d", i);
+        clients[i] = test_socket_new(client_ctx, SLK_ROUTER);
+        test_set_routing_id(clients[i], id);
+        test_socket_connect(clients[i], endpoint);
+    }
+
+    test_sleep_ms(300);
+
+    /* Every client talks to the server and gets a routed reply back */
+    for (int i = 0; i < client_count; i++) {
+        slk_send(clients[i], "SERVER", 6, SLK_SNDMORE);
+        slk_send(clients[i], "PING", 4, 0);
+    }
+
+    for (int i = 0; i < client_count; i++) {
+        TEST_ASSERT(test_poll_readable(server, 1000));
+
+        char identity[256], payload[256];
+        int id_len = slk_recv(server, identity, sizeof(identity), 0);
+        TEST_ASSERT(id_len > 0);
+        int rc = slk_recv(server, payload, sizeof(payload), 0);
+        TEST_ASSERT_EQ(rc, 4);
+
+        slk_send(server, identity, id_len, SLK_SNDMORE);
+        slk_send(server, "PONG", 4, 0);
+    }
+
+    for (int i = 0; i < client_count; i++) {
+        TEST_ASSERT(test_poll_readable(clients[i], 1000));
+
+        char buf[256];
+        slk_recv(clients[i], buf, sizeof(buf), 0);
+        int rc = slk_recv(clients[i], buf, sizeof(buf), 0);
+        TEST_ASSERT_EQ(rc, 4);
+        TEST_ASSERT_MEM_EQ(buf, "PONG", 4);
+    }
+
+    /* The accepted connections are spread over every I/O thread, two
+     * sessions (and their engines) each */
+    int busy_threads = 0;
+    for (int i = 0; i < io_threads; i++) {
+        const int sessions = core->get_io_thread_load(i) - base_load[i];
+        TEST_ASSERT(sessions <= client_count / 2);
+        if (sessions > 0)
+            busy_threads++;
+    }
+    TEST_ASSERT(busy_threads > 1);
+
+    for (int i = 0; i < client_count; i++)
+        test_socket_close(clients[i]);
+    test_socket_close(server);
+    test_context_destroy(client_ctx);
+    test_context_destroy(ctx);
+}
+
 /* Test: Bidirectional communication */
 static void test_router_bidirectional()
 {
@@ -253,6 +386,78 @@ static void test_router_disconnect()
     test_context_destroy(ctx);
 }
 
+/* Test: Vectored send/recv and batched routed sends */
+static void test_router_sendv_batch()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *server = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(server, "SERVER");
+    test_socket_bind(server, endpoint);
+
+    slk_socket_t *client_a = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(client_a, "A");
+    test_socket_connect(client_a, endpoint);
+
+    slk_socket_t *client_b = test_socket_new(ctx, SLK_ROUTER);
+    test_set_routing_id(client_b, "B");
+    test_socket_connect(client_b, endpoint);
+
+    test_sleep_ms(200);
+
+    /* Client sends [SERVER][hdr][body] as one vectored call */
+    slk_iovec_t out[3] = {
+        {(void *)"SERVER", 6}, {(void *)"hdr", 3}, {(void *)"body!", 5}};
+    int rc = slk_sendv(client_a, out, 3, 0);
+    TEST_ASSERT_EQ(rc, 14);
+
+    TEST_ASSERT(test_poll_readable(server, 1000));
+    char id[16], hdr[2], body[16];
+    slk_iovec_t in[3] = {{id, sizeof(id)}, {hdr, sizeof(hdr)}, {body, sizeof(body)}};
+    size_t count = 3;
+    rc = slk_recvv(server, in, &count, 0);
+    TEST_ASSERT_EQ(rc, 3);
+    TEST_ASSERT_EQ(count, (size_t)3);
+    TEST_ASSERT_EQ(in[0].len, (size_t)1);
+    TEST_ASSERT_MEM_EQ(id, "A", 1);
+    TEST_ASSERT_EQ(in[1].len, (size_t)3); /* truncated to 2 bytes */
+    TEST_ASSERT_MEM_EQ(hdr, "hd", 2);
+    TEST_ASSERT_EQ(in[2].len, (size_t)5);
+    TEST_ASSERT_MEM_EQ(body, "body!", 5);
+
+    /* Server fans out interleaved messages to both clients in one batch */
+    const int n = 100;
+    slk_iovec_t ids[n], payloads[n];
+    char bufs[n][16];
+    for (int i = 0; i < n; i++) {
+        ids[i].data = (void *)((i % 3 == 0) ? "B" : "A");
+        ids[i].len = 1;
+        payloads[i].len = snprintf(bufs[i], sizeof(bufs[i]), "msg %d", i);
+        payloads[i].data = bufs[i];
+    }
+    rc = slk_send_to_many(server, ids, payloads, n, 0);
+    TEST_ASSERT_EQ(rc, n);
+
+    for (int i = 0; i < n; i++) {
+        slk_socket_t *client = (i % 3 == 0) ? client_b : client_a;
+        TEST_ASSERT(test_poll_readable(client, 1000));
+
+        char from[16], payload[16];
+        slk_iovec_t frames[2] = {{from, sizeof(from)}, {payload, sizeof(payload)}};
+        count = 2;
+        rc = slk_recvv(client, frames, &count, 0);
+        TEST_ASSERT_EQ(rc, 2);
+        TEST_ASSERT_EQ(frames[1].len, payloads[i].len);
+        TEST_ASSERT_MEM_EQ(payload, bufs[i], payloads[i].len);
+    }
+
+    test_socket_close(client_b);
+    test_socket_close(client_a);
+    test_socket_close(server);
+    test_context_destroy(ctx);
+}
+
 int main()
 {
     printf("=== ServerLink Basic ROUTER Tests ===\n\n");
@@ -263,8 +468,11 @@ int main()
     RUN_TEST(test_router_routing_id);
     RUN_TEST(test_router_to_router_basic);
     RUN_TEST(test_router_multiple_messages);
+    RUN_TEST(test_router_mixed_sizes);
+    RUN_TEST(test_router_multi_io_threads);
     RUN_TEST(test_router_bidirectional);
     RUN_TEST(test_router_disconnect);
+    RUN_TEST(test_router_sendv_batch);
 
     printf("\n=== All Basic ROUTER Tests Passed ===\n");
     return 0;
@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "../testutil.hpp"
+#include <errno.h>
 
 /* Test: Create and destroy SPOT instance */
 static void test_spot_create_destroy()
@@ -256,6 +257,136 @@ static void test_spot_topic_destroy()
     test_context_destroy(ctx);
 }
 
+static void count_free(void *data, void *hint)
+{
+    (void)data;
+    (*static_cast<int *>(hint))++;
+}
+
+/* Test: Zero-copy publish/receive hands the caller's buffer through */
+static void test_spot_zerocopy_pubsub()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    int rc = slk_spot_topic_create(spot, "snapshot");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_subscribe(spot, "snapshot");
+    TEST_SUCCESS(rc);
+
+    /* Larger than any fixed receive buffer used above */
+    const size_t size = 64 * 1024;
+    char *buf = static_cast<char *>(malloc(size));
+    TEST_ASSERT_NOT_NULL(buf);
+    memset(buf, 'z', size);
+
+    int freed = 0;
+    slk_msg_t *msg = slk_msg_new();
+    rc = slk_msg_init_zerocopy(msg, buf, size, count_free, &freed);
+    TEST_SUCCESS(rc);
+
+    rc = slk_spot_publish_msg(spot, "snapshot", msg);
+    TEST_SUCCESS(rc);
+    TEST_ASSERT_EQ(slk_msg_size(msg), 0u);
+    slk_msg_destroy(msg);
+
+    int timeout_ms = 1000;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    slk_msg_t *topic = slk_msg_new();
+    slk_msg_t *data = slk_msg_new();
+    rc = slk_spot_recv_msg(spot, topic, data, 0);
+    TEST_SUCCESS(rc);
+
+    TEST_ASSERT_EQ(slk_msg_size(topic), strlen("snapshot"));
+    TEST_ASSERT_MEM_EQ(slk_msg_data(topic), "snapshot", strlen("snapshot"));
+    TEST_ASSERT_EQ(slk_msg_size(data), size);
+
+    /* inproc delivery shares the original buffer */
+    TEST_ASSERT(slk_msg_data(data) == buf);
+    TEST_ASSERT_EQ(freed, 0);
+
+    slk_msg_destroy(topic);
+    slk_msg_destroy(data);
+    TEST_ASSERT_EQ(freed, 1);
+    free(buf);
+
+    /* Copying recv rejects a payload that does not fit */
+    rc = slk_spot_publish(spot, "snapshot", "0123456789", 10);
+    TEST_SUCCESS(rc);
+    char small_topic[64], small_data[4];
+    size_t topic_len, data_len;
+    rc = slk_spot_recv(spot, small_topic, sizeof(small_topic), &topic_len,
+                       small_data, sizeof(small_data), &data_len, 0);
+    TEST_FAILURE(rc);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Publish through a pre-resolved topic handle */
+static void test_spot_topic_handle()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    TEST_ASSERT_NULL(slk_spot_topic_lookup(spot, "test:topic"));
+
+    int rc = slk_spot_topic_create(spot, "test:topic");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_subscribe(spot, "test:topic");
+    TEST_SUCCESS(rc);
+
+    slk_spot_topic_handle_t *handle = slk_spot_topic_lookup(spot, "test:topic");
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ASSERT(slk_spot_topic_lookup(spot, "test:topic") == handle);
+
+    rc = slk_spot_publish_handle(handle, "first", 5);
+    TEST_SUCCESS(rc);
+
+    int timeout_ms = 1000;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    char topic[64], data[64];
+    size_t topic_len, data_len;
+    rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                       data, sizeof(data), &data_len, 0);
+    TEST_SUCCESS(rc);
+    TEST_ASSERT_EQ(topic_len, strlen("test:topic"));
+    TEST_ASSERT_MEM_EQ(topic, "test:topic", topic_len);
+    TEST_ASSERT_EQ(data_len, 5u);
+    TEST_ASSERT_MEM_EQ(data, "first", 5);
+
+    /* Destroying the topic invalidates the handle */
+    rc = slk_spot_topic_destroy(spot, "test:topic");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_publish_handle(handle, "stale", 5);
+    TEST_FAILURE(rc);
+    TEST_ASSERT_EQ(errno, ENOENT);
+    TEST_ASSERT_NULL(slk_spot_topic_lookup(spot, "test:topic"));
+
+    /* Re-creating it brings the same handle back */
+    rc = slk_spot_topic_create(spot, "test:topic");
+    TEST_SUCCESS(rc);
+    TEST_ASSERT(slk_spot_topic_lookup(spot, "test:topic") == handle);
+
+    slk_msg_t *msg = slk_msg_new_data("second", 6);
+    rc = slk_spot_publish_handle_msg(handle, msg);
+    TEST_SUCCESS(rc);
+    slk_msg_destroy(msg);
+
+    rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                       data, sizeof(data), &data_len, 0);
+    TEST_SUCCESS(rc);
+    TEST_ASSERT_EQ(data_len, 6u);
+    TEST_ASSERT_MEM_EQ(data, "second", 6);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
 int main()
 {
     printf("=== ServerLink SPOT Basic Tests ===\n\n");
@@ -271,6 +402,8 @@ int main()
     RUN_TEST(test_spot_publish_nonexistent);
     RUN_TEST(test_spot_multiple_messages);
     RUN_TEST(test_spot_topic_destroy);
+    RUN_TEST(test_spot_zerocopy_pubsub);
+    RUN_TEST(test_spot_topic_handle);
 
     printf("\n=== All SPOT Basic Tests Passed ===\n");
     return 0;
@@ -4,6 +4,9 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "../testutil.hpp"
+#include <atomic>
+#include <errno.h>
+#include <thread>
 
 /* Test: Multiple topics on single SPOT instance */
 static void test_spot_multi_topic()
@@ -395,6 +398,241 @@ static void test_spot_rapid_pubsub()
     test_context_destroy(ctx);
 }
 
+/* Test: Blocking recv wakes on publish and timed recv expires */
+static void test_spot_blocking_recv()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    int rc = slk_spot_topic_create(spot, "wake");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_subscribe(spot, "wake");
+    TEST_SUCCESS(rc);
+
+    /* Nothing published: a timed recv gives up after the timeout */
+    int timeout_ms = 50;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    char topic[64], data[64];
+    size_t topic_len, data_len;
+    void *watch = slk_stopwatch_start();
+    rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                       data, sizeof(data), &data_len, 0);
+    unsigned long waited_us = slk_stopwatch_stop(watch);
+    TEST_FAILURE(rc);
+    TEST_ASSERT_EQ(errno, EAGAIN);
+    TEST_ASSERT(waited_us >= 40 * 1000);
+
+    /* Block without a timeout; a publish from another thread wakes us */
+    timeout_ms = -1;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    std::thread publisher([spot]() {
+        test_sleep_ms(20);
+        slk_spot_publish(spot, "wake", "up", 2);
+    });
+
+    rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                       data, sizeof(data), &data_len, 0);
+    publisher.join();
+    TEST_SUCCESS(rc);
+    TEST_ASSERT_EQ(data_len, 2u);
+    TEST_ASSERT_MEM_EQ(data, "up", 2);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Concurrent publishers sharing one topic handle. Publishers that
+ * find the shard busy queue their messages for the one sending, which must
+ * keep each publisher's messages in order */
+static void test_spot_concurrent_handle_publish()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    int rc = slk_spot_topic_create(spot, "fanin");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_subscribe(spot, "fanin");
+    TEST_SUCCESS(rc);
+
+    slk_spot_topic_handle_t *handle = slk_spot_topic_lookup(spot, "fanin");
+    TEST_ASSERT_NOT_NULL(handle);
+
+    /* Stays below the HWM of the local pipe */
+    const int threads = 8;
+    const int per_thread = 100;
+    std::thread publishers[threads];
+    std::atomic<int> failures(0);
+    for (int t = 0; t < threads; t++) {
+        publishers[t] = std::thread([handle, t, &failures]() {
+            for (int i = 0; i < per_thread; i++) {
+                int value = t * per_thread + i;
+                if (slk_spot_publish_handle(handle, &value, sizeof(value)) != 0)
+                    failures++;
+            }
+        });
+    }
+    for (int t = 0; t < threads; t++)
+        publishers[t].join();
+    TEST_ASSERT_EQ(failures.load(), 0);
+
+    int timeout_ms = 1000;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    /* Every message arrives intact exactly once, and in publish order per
+     * publisher */
+    bool seen[threads * per_thread] = {};
+    int last[threads];
+    for (int t = 0; t < threads; t++)
+        last[t] = -1;
+    for (int i = 0; i < threads * per_thread; i++) {
+        char topic[64];
+        int value;
+        size_t topic_len, data_len;
+        rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                           &value, sizeof(value), &data_len, 0);
+        TEST_SUCCESS(rc);
+        TEST_ASSERT_EQ(data_len, sizeof(value));
+        TEST_ASSERT(value >= 0 && value < threads * per_thread);
+        TEST_ASSERT(!seen[value]);
+        seen[value] = true;
+        TEST_ASSERT(value % per_thread > last[value / per_thread]);
+        last[value / per_thread] = value % per_thread;
+    }
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: A conflated topic hands a slow subscriber only its newest values */
+static void test_spot_conflate_topic()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    int rc = slk_spot_topic_create_ex(spot, "pos:1", 0x100);
+    TEST_FAILURE(rc);
+    TEST_ASSERT_EQ(errno, EINVAL);
+    rc = slk_spot_topic_create_ex(spot, "pos:1", SLK_SPOT_TOPIC_CONFLATE);
+    TEST_SUCCESS(rc);
+    rc = slk_spot_set_hwm(spot, 2, 2);
+    TEST_SUCCESS(rc);
+    rc = slk_spot_subscribe(spot, "pos:1");
+    TEST_SUCCESS(rc);
+    test_sleep_ms(100);
+
+    /* Far more than the queues between the sockets can hold */
+    const int count = 5000;
+    for (int i = 0; i < count; i++) {
+        rc = slk_spot_publish(spot, "pos:1", &i, sizeof(i));
+        TEST_SUCCESS(rc);
+    }
+
+    int timeout_ms = 200;
+    rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    /* The newest value is released to the caught-up subscriber without
+     * another publish */
+    int received = 0;
+    int last = -1;
+    while (true) {
+        char topic[64];
+        int value;
+        size_t topic_len, data_len;
+        rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len, &value,
+                           sizeof(value), &data_len, 0);
+        if (rc != 0)
+            break;
+        TEST_ASSERT(value > last);
+        last = value;
+        received++;
+    }
+    TEST_ASSERT(received < count);
+    TEST_ASSERT_EQ(last, count - 1);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Publishes [zone:x,y][x*10+y] to every cell of a 5x5 grid and checks
+ * exactly the cells of the rectangle arrive */
+static void check_region(slk_spot_t *spot, int x0, int y0, int x1, int y1)
+{
+    for (int x = 0; x < 5; x++) {
+        for (int y = 0; y < 5; y++) {
+            char topic[32];
+            const int value = x * 10 + y;
+            snprintf(topic, sizeof(topic), "zone:%d,%d", x, y);
+            TEST_SUCCESS(slk_spot_publish(spot, topic, &value, sizeof(value)));
+        }
+    }
+
+    int received = 0;
+    while (true) {
+        char topic[64];
+        int value;
+        size_t topic_len, data_len;
+        const int rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                                     &value, sizeof(value), &data_len, 0);
+        if (rc != 0)
+            break;
+        const int x = value / 10, y = value % 10;
+        TEST_ASSERT(x >= x0 && x <= x1 && y >= y0 && y <= y1);
+        received++;
+    }
+    TEST_ASSERT_EQ(received, (x1 - x0 + 1) * (y1 - y0 + 1));
+}
+
+/* Test: Region subscriptions follow a moving area of interest */
+static void test_spot_region_subscribe()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new(ctx);
+
+    for (int x = 0; x < 5; x++) {
+        for (int y = 0; y < 5; y++) {
+            char topic[32];
+            snprintf(topic, sizeof(topic), "zone:%d,%d", x, y);
+            TEST_SUCCESS(slk_spot_topic_create(spot, topic));
+        }
+    }
+
+    int timeout_ms = 100;
+    int rc = slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    TEST_SUCCESS(rc);
+
+    rc = slk_spot_subscribe_region(spot, "zone", 2, 0, 1, 0);
+    TEST_FAILURE(rc);
+    TEST_ASSERT_EQ(errno, EINVAL);
+
+    rc = slk_spot_subscribe_region(spot, "zone", 1, 1, 2, 2);
+    TEST_SUCCESS(rc);
+    test_sleep_ms(100);
+    check_region(spot, 1, 1, 2, 2);
+
+    /* Moving replaces the region */
+    rc = slk_spot_subscribe_region(spot, "zone", 2, 3, 4, 4);
+    TEST_SUCCESS(rc);
+    test_sleep_ms(100);
+    check_region(spot, 2, 3, 4, 4);
+
+    rc = slk_spot_unsubscribe_region(spot, "zone");
+    TEST_SUCCESS(rc);
+    rc = slk_spot_unsubscribe_region(spot, "zone");
+    TEST_FAILURE(rc);
+    TEST_ASSERT_EQ(errno, ENOENT);
+    test_sleep_ms(100);
+    check_region(spot, 0, 0, -1, 0); /* empty: nothing arrives */
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
 int main()
 {
     printf("=== ServerLink SPOT Local Tests ===\n\n");
@@ -405,6 +643,10 @@ int main()
     RUN_TEST(test_spot_selective_unsubscribe);
     RUN_TEST(test_spot_large_message);
     RUN_TEST(test_spot_rapid_pubsub);
+    RUN_TEST(test_spot_blocking_recv);
+    RUN_TEST(test_spot_concurrent_handle_publish);
+    RUN_TEST(test_spot_conflate_topic);
+    RUN_TEST(test_spot_region_subscribe);
 
     printf("\n=== All SPOT Local Tests Passed ===\n");
     return 0;
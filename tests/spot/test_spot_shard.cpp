@@ -0,0 +1,268 @@
+/* ServerLink SPOT Sharding Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <errno.h>
+#include <thread>
+
+#define SHARDS 4
+#define TOPICS 16
+
+static void topic_name(char *buf, size_t size, int i)
+{
+    snprintf(buf, size, "shard:%d", i);
+}
+
+/* Receives count [topic][int] messages and checks each topic's values
+ * arrive in order, exactly once */
+static void recv_all(slk_spot_t *spot, int topics, int per_topic)
+{
+    int timeout_ms = 2000;
+    TEST_SUCCESS(slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms,
+                                     sizeof(timeout_ms)));
+
+    int next[TOPICS] = {0};
+    for (int i = 0; i < topics * per_topic; i++) {
+        char topic[64];
+        int value;
+        size_t topic_len, data_len;
+        int rc = slk_spot_recv(spot, topic, sizeof(topic), &topic_len,
+                               &value, sizeof(value), &data_len, 0);
+        TEST_SUCCESS(rc);
+        TEST_ASSERT_EQ(data_len, sizeof(value));
+        topic[topic_len] = '\0';
+
+        int t = -1;
+        TEST_ASSERT_EQ(sscanf(topic, "shard:%d", &t), 1);
+        TEST_ASSERT(t >= 0 && t < topics);
+        TEST_ASSERT_EQ(value, next[t]);
+        next[t]++;
+    }
+}
+
+/* Test: Shard counts outside 1-64 are rejected */
+static void test_shard_count()
+{
+    slk_ctx_t *ctx = test_context_new();
+
+    TEST_ASSERT_NULL(slk_spot_new_sharded(ctx, 0));
+    TEST_ASSERT_EQ(errno, EINVAL);
+    TEST_ASSERT_NULL(slk_spot_new_sharded(ctx, 65));
+    TEST_ASSERT_EQ(errno, EINVAL);
+
+    slk_spot_t *spot = slk_spot_new_sharded(ctx, 64);
+    TEST_ASSERT_NOT_NULL(spot);
+    slk_spot_destroy(&spot);
+
+    test_context_destroy(ctx);
+}
+
+/* Test: Topics spread over shards are all delivered to one receiver */
+static void test_shard_local()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new_sharded(ctx, SHARDS);
+    TEST_ASSERT_NOT_NULL(spot);
+
+    char topic[64];
+    for (int t = 0; t < TOPICS; t++) {
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(slk_spot_topic_create(spot, topic));
+        TEST_SUCCESS(slk_spot_subscribe(spot, topic));
+    }
+    test_sleep_ms(100);
+
+    const int per_topic = 50;
+    for (int i = 0; i < per_topic; i++) {
+        for (int t = 0; t < TOPICS; t++) {
+            topic_name(topic, sizeof(topic), t);
+            TEST_SUCCESS(slk_spot_publish(spot, topic, &i, sizeof(i)));
+        }
+    }
+    recv_all(spot, TOPICS, per_topic);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Publishers on different shards run in parallel through handles */
+static void test_shard_concurrent_publish()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new_sharded(ctx, SHARDS);
+    TEST_ASSERT_NOT_NULL(spot);
+
+    char topic[64];
+    slk_spot_topic_handle_t *handles[TOPICS];
+    for (int t = 0; t < TOPICS; t++) {
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(slk_spot_topic_create(spot, topic));
+        TEST_SUCCESS(slk_spot_subscribe(spot, topic));
+        handles[t] = slk_spot_topic_lookup(spot, topic);
+        TEST_ASSERT_NOT_NULL(handles[t]);
+    }
+    test_sleep_ms(100);
+
+    /* One thread per topic; each topic's order must survive */
+    const int per_topic = 200;
+    std::thread publishers[TOPICS];
+    for (int t = 0; t < TOPICS; t++) {
+        slk_spot_topic_handle_t *handle = handles[t];
+        publishers[t] = std::thread([handle, per_topic]() {
+            for (int i = 0; i < per_topic; i++)
+                slk_spot_publish_handle(handle, &i, sizeof(i));
+        });
+    }
+    recv_all(spot, TOPICS, per_topic);
+    for (int t = 0; t < TOPICS; t++)
+        publishers[t].join();
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Pattern subscriptions match topics on every shard */
+static void test_shard_pattern()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new_sharded(ctx, SHARDS);
+    TEST_ASSERT_NOT_NULL(spot);
+
+    char topic[64];
+    for (int t = 0; t < TOPICS; t++) {
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(slk_spot_topic_create(spot, topic));
+    }
+    TEST_SUCCESS(slk_spot_subscribe_pattern(spot, "shard:*"));
+    test_sleep_ms(100);
+
+    for (int t = 0; t < TOPICS; t++) {
+        int value = 0;
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(slk_spot_publish(spot, topic, &value, sizeof(value)));
+    }
+    recv_all(spot, TOPICS, 1);
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Conflated topics on every shard keep their newest value, while
+ * topics they are a prefix of are still dropped at the HWM */
+static void test_shard_conflate()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *spot = slk_spot_new_sharded(ctx, SHARDS);
+    TEST_ASSERT_NOT_NULL(spot);
+    TEST_SUCCESS(slk_spot_set_hwm(spot, 2, 2));
+
+    /* shard:0 to shard:3 are conflated, shard:10 to shard:13 are not */
+    const int topics = 4;
+    char topic[64];
+    for (int t = 0; t < topics; t++) {
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(
+          slk_spot_topic_create_ex(spot, topic, SLK_SPOT_TOPIC_CONFLATE));
+        TEST_SUCCESS(slk_spot_subscribe(spot, topic));
+        topic_name(topic, sizeof(topic), 10 + t);
+        TEST_SUCCESS(slk_spot_topic_create(spot, topic));
+        TEST_SUCCESS(slk_spot_subscribe(spot, topic));
+    }
+    test_sleep_ms(100);
+
+    const int count = 2000;
+    for (int i = 0; i < count; i++) {
+        for (int t = 0; t < topics; t++) {
+            topic_name(topic, sizeof(topic), t);
+            TEST_SUCCESS(slk_spot_publish(spot, topic, &i, sizeof(i)));
+            topic_name(topic, sizeof(topic), 10 + t);
+            TEST_SUCCESS(slk_spot_publish(spot, topic, &i, sizeof(i)));
+        }
+    }
+
+    int timeout_ms = 200;
+    TEST_SUCCESS(slk_spot_setsockopt(spot, SLK_RCVTIMEO, &timeout_ms,
+                                     sizeof(timeout_ms)));
+    int last[10 + topics];
+    for (int t = 0; t < 10 + topics; t++)
+        last[t] = -1;
+    while (true) {
+        int value;
+        size_t topic_len, data_len;
+        if (slk_spot_recv(spot, topic, sizeof(topic), &topic_len, &value,
+                          sizeof(value), &data_len, 0)
+            != 0)
+            break;
+        topic[topic_len] = '\0';
+        int t = -1;
+        TEST_ASSERT_EQ(sscanf(topic, "shard:%d", &t), 1);
+        TEST_ASSERT(t >= 0 && t < 10 + topics);
+        TEST_ASSERT(value > last[t]);
+        last[t] = value;
+    }
+    for (int t = 0; t < topics; t++) {
+        TEST_ASSERT_EQ(last[t], count - 1);
+        TEST_ASSERT(last[10 + t] < count - 1);
+    }
+
+    slk_spot_destroy(&spot);
+    test_context_destroy(ctx);
+}
+
+/* Test: Sharded nodes reach each other's shards over TCP */
+static void test_shard_remote()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_spot_t *pub = slk_spot_new_sharded(ctx, SHARDS);
+    slk_spot_t *sub = slk_spot_new_sharded(ctx, SHARDS);
+    TEST_ASSERT_NOT_NULL(pub);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    /* Shard endpoints are derived from an explicit port */
+    TEST_FAILURE(slk_spot_bind(pub, "tcp://127.0.0.1:*"));
+    TEST_ASSERT_EQ(errno, EINVAL);
+
+    const char *endpoint = test_endpoint_tcp();
+    TEST_SUCCESS(slk_spot_bind(pub, endpoint));
+    TEST_SUCCESS(slk_spot_cluster_add(sub, endpoint));
+
+    char topic[64];
+    for (int t = 0; t < TOPICS; t++) {
+        topic_name(topic, sizeof(topic), t);
+        TEST_SUCCESS(slk_spot_topic_create(pub, topic));
+        TEST_SUCCESS(slk_spot_subscribe(sub, topic));
+    }
+    test_sleep_ms(SETTLE_TIME);
+
+    const int per_topic = 20;
+    for (int i = 0; i < per_topic; i++) {
+        for (int t = 0; t < TOPICS; t++) {
+            topic_name(topic, sizeof(topic), t);
+            TEST_SUCCESS(slk_spot_publish(pub, topic, &i, sizeof(i)));
+        }
+    }
+    recv_all(sub, TOPICS, per_topic);
+
+    TEST_SUCCESS(slk_spot_cluster_remove(sub, endpoint));
+
+    slk_spot_destroy(&sub);
+    slk_spot_destroy(&pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink SPOT Sharding Tests ===\n\n");
+
+    RUN_TEST(test_shard_count);
+    RUN_TEST(test_shard_local);
+    RUN_TEST(test_shard_concurrent_publish);
+    RUN_TEST(test_shard_pattern);
+    RUN_TEST(test_shard_conflate);
+    RUN_TEST(test_shard_remote);
+
+    printf("\n=== All SPOT Sharding Tests Passed ===\n");
+    return 0;
+}
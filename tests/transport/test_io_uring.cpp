@@ -0,0 +1,161 @@
+/* ServerLink io_uring Backend Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <stdio.h>
+#include <vector>
+
+#define BATCH 200
+
+static slk_ctx_t *uring_context_new()
+{
+    slk_ctx_t *ctx = test_context_new();
+    int backend = SLK_IO_BACKEND_IO_URING;
+    TEST_SUCCESS(slk_ctx_set(ctx, SLK_IO_BACKEND, &backend, sizeof(backend)));
+    int io_threads = 2;
+    TEST_SUCCESS(slk_ctx_set(ctx, SLK_IO_THREADS, &io_threads, sizeof(io_threads)));
+    return ctx;
+}
+
+static void fill(std::vector<char> &buf, size_t size, size_t seed)
+{
+    buf.resize(size);
+    for (size_t i = 0; i < size; i++)
+        buf[i] = static_cast<char>((i * 7 + seed) & 0xff);
+}
+
+/* Sends a batch of messages of one size and checks every byte on arrival */
+static void transfer(slk_socket_t *tx, slk_socket_t *rx, size_t size,
+                     int count)
+{
+    std::vector<char> payload;
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        int rc = slk_send(tx, payload.data(), payload.size(), 0);
+        TEST_ASSERT_EQ(rc, static_cast<int>(size));
+    }
+
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        TEST_ASSERT(test_poll_readable(rx, 5000));
+        slk_msg_t *msg = slk_msg_new();
+        TEST_SUCCESS(slk_msg_recv(msg, rx, 0));
+        TEST_ASSERT_EQ(slk_msg_size(msg), size);
+        TEST_ASSERT_MEM_EQ(slk_msg_data(msg), payload.data(), size);
+        slk_msg_destroy(msg);
+    }
+}
+
+/* Test: Option default, round trip and validation */
+static void test_option()
+{
+    slk_ctx_t *ctx = test_context_new();
+
+    int value = -1;
+    size_t len = sizeof(value);
+    TEST_SUCCESS(slk_ctx_get(ctx, SLK_IO_BACKEND, &value, &len));
+    TEST_ASSERT_EQ(value, SLK_IO_BACKEND_ASIO);
+
+    value = SLK_IO_BACKEND_IO_URING;
+    if (slk_has("io_uring")) {
+        TEST_SUCCESS(slk_ctx_set(ctx, SLK_IO_BACKEND, &value, sizeof(value)));
+        TEST_SUCCESS(slk_ctx_get(ctx, SLK_IO_BACKEND, &value, &len));
+        TEST_ASSERT_EQ(value, SLK_IO_BACKEND_IO_URING);
+    } else {
+        TEST_FAILURE(slk_ctx_set(ctx, SLK_IO_BACKEND, &value, sizeof(value)));
+    }
+
+    value = 7;
+    TEST_FAILURE(slk_ctx_set(ctx, SLK_IO_BACKEND, &value, sizeof(value)));
+
+    test_context_destroy(ctx);
+}
+
+/* Runs small, large and multi-megabyte messages (short sends) */
+static void run_transfer(const char *endpoint)
+{
+    slk_ctx_t *ctx = uring_context_new();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_bind(pub, endpoint);
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    transfer(pub, sub, 10, BATCH);
+    transfer(pub, sub, 5000, BATCH);
+    transfer(pub, sub, 4 * 1024 * 1024, 3);
+    transfer(pub, sub, 0, 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: TCP traffic over the io_uring backend */
+static void test_tcp_transfer()
+{
+    run_transfer(test_endpoint_tcp());
+}
+
+/* Test: IPC traffic over the io_uring backend */
+static void test_ipc_transfer()
+{
+    if (!slk_has("ipc"))
+        return;
+    run_transfer(test_endpoint_ipc());
+}
+
+/* Test: Closing a peer with reads and writes in flight, then reconnecting */
+static void test_close_in_flight()
+{
+    slk_ctx_t *ctx = uring_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    std::vector<char> payload;
+    fill(payload, 64 * 1024, 0);
+    for (int round = 0; round < 3; round++) {
+        slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+        TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+        test_socket_connect(sub, endpoint);
+        test_sleep_ms(SETTLE_TIME);
+
+        for (int i = 0; i < BATCH; i++)
+            slk_send(pub, payload.data(), payload.size(), SLK_DONTWAIT);
+        TEST_ASSERT(test_poll_readable(sub, 5000));
+        test_socket_close(sub);
+    }
+
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+    transfer(pub, sub, 100, BATCH);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink io_uring Backend Tests ===\n\n");
+
+    RUN_TEST(test_option);
+    if (slk_has("io_uring")) {
+        RUN_TEST(test_tcp_transfer);
+        RUN_TEST(test_ipc_transfer);
+        RUN_TEST(test_close_in_flight);
+    } else {
+        printf("io_uring not available, skipping transfer tests\n");
+    }
+
+    printf("\n=== All io_uring Backend Tests Passed ===\n");
+    return 0;
+}
@@ -0,0 +1,317 @@
+/* ServerLink Shared-Memory Transport Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <atomic>
+#include <errno.h>
+#include <stdio.h>
+#include <vector>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define BATCH 200
+
+static const char *shm_endpoint()
+{
+    static int counter = 0;
+    static char endpoint[64];
+    snprintf(endpoint, sizeof(endpoint), "shm://test-%d-%d", (int)getpid(),
+             counter++);
+    return endpoint;
+}
+
+static void fill(std::vector<char> &buf, size_t size, size_t seed)
+{
+    buf.resize(size);
+    for (size_t i = 0; i < size; i++)
+        buf[i] = static_cast<char>((i * 7 + seed) & 0xff);
+}
+
+/* Receives a batch of messages of one size; returns false on a mismatch */
+static bool receive(slk_socket_t *rx, size_t size, int count)
+{
+    std::vector<char> payload;
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        if (!test_poll_readable(rx, 5000))
+            return false;
+        slk_msg_t *msg = slk_msg_new();
+        const bool ok = slk_msg_recv(msg, rx, 0) == 0
+                        && slk_msg_size(msg) == size
+                        && memcmp(slk_msg_data(msg), payload.data(), size) == 0;
+        slk_msg_destroy(msg);
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+static void send(slk_socket_t *tx, size_t size, int count)
+{
+    std::vector<char> payload;
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        int rc = slk_send(tx, payload.data(), payload.size(), 0);
+        TEST_ASSERT_EQ(rc, static_cast<int>(size));
+    }
+}
+
+/* Runs small, large and ring-overflowing messages through one connection */
+static bool run_sizes(slk_socket_t *tx, slk_socket_t *rx)
+{
+    const size_t sizes[] = {10, 5000, 300 * 1024, 4 * 1024 * 1024, 0};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        const int count = sizes[i] > 1024 * 1024 ? 3 : BATCH;
+        if (tx)
+            send(tx, sizes[i], count);
+        if (rx && !receive(rx, sizes[i], count))
+            return false;
+    }
+    return true;
+}
+
+/* Test: Endpoint names are validated and cannot be bound twice */
+static void test_bind()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *a = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *b = test_socket_new(ctx, SLK_PUB);
+
+    TEST_FAILURE(slk_bind(a, "shm://"));
+    TEST_FAILURE(slk_bind(a, "shm://*"));
+    TEST_FAILURE(slk_connect(a, "shm://"));
+
+    const char *endpoint = shm_endpoint();
+    test_socket_bind(a, endpoint);
+    TEST_FAILURE(slk_bind(b, endpoint));
+    TEST_ASSERT_EQ(errno, EADDRINUSE);
+
+    /* The name is free again once unbound */
+    TEST_SUCCESS(slk_unbind(a, endpoint));
+    test_sleep_ms(SETTLE_TIME);
+    test_socket_bind(b, endpoint);
+
+    test_socket_close(b);
+    test_socket_close(a);
+    test_context_destroy(ctx);
+}
+
+/* Test: Traffic between two sockets of one process */
+static void test_transfer()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = shm_endpoint();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_bind(pub, endpoint);
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    TEST_ASSERT(run_sizes(pub, sub));
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Traffic between two processes; the subscriber runs in a child */
+static void test_cross_process()
+{
+    const char *endpoint = shm_endpoint();
+    fflush(stdout);
+    const pid_t pid = fork();
+    TEST_ASSERT(pid >= 0);
+
+    if (pid == 0) {
+        slk_ctx_t *ctx = slk_ctx_new();
+        slk_socket_t *sub = slk_socket(ctx, SLK_SUB);
+        bool ok = sub && slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0) == 0
+                  && slk_connect(sub, endpoint) == 0
+                  && run_sizes(NULL, sub);
+        slk_close(sub);
+        slk_ctx_destroy(ctx);
+        _exit(ok ? 0 : 1);
+    }
+
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *xpub = test_socket_new(ctx, SLK_XPUB);
+    test_socket_bind(xpub, endpoint);
+
+    /* Publish once the child's subscription has arrived */
+    TEST_ASSERT(test_poll_readable(xpub, 10000));
+    char subscription[16];
+    TEST_ASSERT(slk_recv(xpub, subscription, sizeof(subscription), 0) >= 1);
+    TEST_ASSERT_EQ(subscription[0], 1);
+    run_sizes(xpub, NULL);
+
+    int status = -1;
+    TEST_ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    TEST_ASSERT(WIFEXITED(status));
+    TEST_ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    test_socket_close(xpub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Subscribers leaving with data in flight, then a fresh one */
+static void test_close_in_flight()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = shm_endpoint();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    std::vector<char> payload;
+    fill(payload, 64 * 1024, 0);
+    for (int round = 0; round < 3; round++) {
+        slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+        TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+        test_socket_connect(sub, endpoint);
+        test_sleep_ms(SETTLE_TIME);
+
+        /* More than both rings hold, so the publisher is left waiting */
+        for (int i = 0; i < BATCH; i++)
+            slk_send(pub, payload.data(), payload.size(), SLK_DONTWAIT);
+        TEST_ASSERT(test_poll_readable(sub, 5000));
+        test_socket_close(sub);
+    }
+
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+    send(pub, 1000, BATCH);
+    TEST_ASSERT(receive(sub, 1000, BATCH));
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Control block at the start of the region, as laid out by the transport */
+struct raw_ring_t
+{
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> reader_waiting;
+    std::atomic<uint32_t> writer_waiting;
+};
+
+struct raw_region_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ring_size;
+    raw_ring_t rings[2];
+};
+
+/* Test: A peer claiming more data than the ring holds is dropped */
+static void test_corrupt_positions()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = shm_endpoint();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    test_socket_bind(pub, endpoint);
+
+    /* Attach by hand, the way the connecting side does */
+    const int control = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT(control != -1);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    const int len = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1,
+                             "serverlink-shm.%s", endpoint + strlen("shm://"));
+    TEST_ASSERT_EQ(connect(control, (sockaddr *)&addr,
+                           offsetof(sockaddr_un, sun_path) + 1 + len),
+                   0);
+
+    struct
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_size;
+    } hello;
+    iovec iov = {&hello, sizeof(hello)};
+    union
+    {
+        cmsghdr align;
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+    } cmsg_buf;
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg_buf.buf;
+    msg.msg_controllen = sizeof(cmsg_buf.buf);
+    TEST_ASSERT_EQ(recvmsg(control, &msg, 0), (ssize_t)sizeof(hello));
+    int fds[3];
+    memcpy(fds, CMSG_DATA(CMSG_FIRSTHDR(&msg)), sizeof(fds));
+
+    raw_region_t *region = (raw_region_t *)mmap(
+      NULL, sizeof(raw_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    TEST_ASSERT(region != MAP_FAILED);
+    TEST_ASSERT_EQ(region->ring_size, hello.ring_size);
+
+    /* Ring 1 is ours to write; claim four laps of it and wake the reader */
+    raw_ring_t &ring = region->rings[1];
+    const uint64_t head = ring.head.load();
+    ring.tail.store(head + 4 * hello.ring_size);
+    const uint64_t one = 1;
+    TEST_ASSERT_EQ(write(fds[1], &one, sizeof(one)), (ssize_t)sizeof(one));
+
+    /* The publisher hangs up without consuming any of it */
+    pollfd pfd = {control, POLLIN, 0};
+    TEST_ASSERT_EQ(poll(&pfd, 1, 5000), 1);
+    char byte;
+    TEST_ASSERT_EQ(recv(control, &byte, 1, 0), 0);
+    TEST_ASSERT_EQ(ring.head.load(), head);
+
+    munmap(region, sizeof(raw_region_t));
+    for (int i = 0; i < 3; i++)
+        close(fds[i]);
+    close(control);
+
+    /* Other subscribers are unaffected */
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+    send(pub, 1000, BATCH);
+    TEST_ASSERT(receive(sub, 1000, BATCH));
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink Shared-Memory Transport Tests ===\n\n");
+
+    if (!slk_has("shm")) {
+        printf("shm transport not available, skipping\n");
+        return 0;
+    }
+
+    /* Fork before any context exists so the child starts without threads */
+    RUN_TEST(test_cross_process);
+    RUN_TEST(test_bind);
+    RUN_TEST(test_transfer);
+    RUN_TEST(test_close_in_flight);
+    RUN_TEST(test_corrupt_positions);
+
+    printf("\n=== All Shared-Memory Transport Tests Passed ===\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* ServerLink Command Processing Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include <stdint.h>
+#include <stdio.h>
+
+#define PEERS 20
+
+static uint64_t commands_processed(slk_socket_t *s)
+{
+    uint64_t count = 0;
+    size_t len = sizeof(count);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_COMMANDS_PROCESSED, &count, &len));
+    TEST_ASSERT_EQ(len, sizeof(count));
+    return count;
+}
+
+/* Test: Option defaults, round trip and validation */
+static void test_options()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *s = test_socket_new(ctx, SLK_PUB);
+
+    int val = 0;
+    size_t len = sizeof(val);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_INBOUND_POLL_RATE, &val, &len));
+    TEST_ASSERT_EQ(val, 100);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_COMMAND_DELAY, &val, &len));
+    TEST_ASSERT_EQ(val, 3000000);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_COMMAND_BATCH, &val, &len));
+    TEST_ASSERT_EQ(val, 256);
+
+    val = 10;
+    TEST_SUCCESS(slk_setsockopt(s, SLK_INBOUND_POLL_RATE, &val, sizeof(val)));
+    TEST_SUCCESS(slk_getsockopt(s, SLK_INBOUND_POLL_RATE, &val, &len));
+    TEST_ASSERT_EQ(val, 10);
+
+    val = 0;
+    TEST_SUCCESS(slk_setsockopt(s, SLK_COMMAND_DELAY, &val, sizeof(val)));
+    TEST_SUCCESS(slk_setsockopt(s, SLK_COMMAND_BATCH, &val, sizeof(val)));
+    TEST_SUCCESS(slk_getsockopt(s, SLK_COMMAND_BATCH, &val, &len));
+    TEST_ASSERT_EQ(val, 0);
+
+    val = 0;
+    TEST_FAILURE(slk_setsockopt(s, SLK_INBOUND_POLL_RATE, &val, sizeof(val)));
+    val = -1;
+    TEST_FAILURE(slk_setsockopt(s, SLK_COMMAND_DELAY, &val, sizeof(val)));
+    TEST_FAILURE(slk_setsockopt(s, SLK_COMMAND_BATCH, &val, sizeof(val)));
+
+    /* The counter is read-only */
+    uint64_t count = 0;
+    TEST_FAILURE(slk_setsockopt(s, SLK_COMMANDS_PROCESSED, &count,
+                                sizeof(count)));
+    TEST_ASSERT_EQ(commands_processed(s), 0);
+
+    test_socket_close(s);
+    test_context_destroy(ctx);
+}
+
+/* Test: A send processes at most COMMAND_BATCH commands, polling drains
+ * the rest */
+static void test_bounded_drain()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+
+    int val = 1;
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_COMMAND_BATCH, &val, sizeof(val)));
+    val = 0;
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_COMMAND_DELAY, &val, sizeof(val)));
+    test_socket_bind(pub, "inproc://command-batch");
+
+    /* Every inproc connect queues a bind command on the publisher */
+    slk_socket_t *subs[PEERS];
+    for (int i = 0; i < PEERS; i++) {
+        subs[i] = test_socket_new(ctx, SLK_SUB);
+        test_socket_connect(subs[i], "inproc://command-batch");
+    }
+
+    uint64_t before = commands_processed(pub);
+    TEST_ASSERT_EQ(slk_send(pub, "x", 1, 0), 1);
+    uint64_t after_send = commands_processed(pub);
+    TEST_ASSERT(after_send - before <= 1);
+
+    /* Polling is not bounded, so the socket state is up to date after it */
+    slk_pollitem_t item = {pub, 0, SLK_POLLOUT, 0};
+    TEST_ASSERT(slk_poll(&item, 1, 0) >= 0);
+    TEST_ASSERT(commands_processed(pub) - after_send >= PEERS - 1);
+
+    for (int i = 0; i < PEERS; i++)
+        test_socket_close(subs[i]);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Messages still flow with a small poll rate and batch */
+static void test_small_batch_delivery()
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    int val = 1;
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_INBOUND_POLL_RATE, &val, sizeof(val)));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_COMMAND_BATCH, &val, sizeof(val)));
+    TEST_SUCCESS(slk_setsockopt(pub, SLK_COMMAND_BATCH, &val, sizeof(val)));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_bind(pub, endpoint);
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    /* Let the publisher see the connection and its subscription before the
+     * first send, which would otherwise only take one command */
+    slk_pollitem_t item = {pub, 0, SLK_POLLOUT, 0};
+    TEST_ASSERT(slk_poll(&item, 1, 0) >= 0);
+
+    for (int i = 0; i < 1000; i++)
+        TEST_ASSERT_EQ(slk_send(pub, "data", 4, 0), 4);
+
+    char buf[16];
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT(test_poll_readable(sub, 5000));
+        TEST_ASSERT_EQ(slk_recv(sub, buf, sizeof(buf), 0), 4);
+    }
+    TEST_ASSERT(commands_processed(sub) > 0);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+int main()
+{
+    printf("=== ServerLink Command Processing Tests ===\n\n");
+
+    RUN_TEST(test_options);
+    RUN_TEST(test_bounded_drain);
+    RUN_TEST(test_small_batch_delivery);
+
+    printf("\n=== All Command Processing Tests Passed ===\n");
+    return 0;
+}
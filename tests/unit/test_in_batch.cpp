@@ -0,0 +1,161 @@
+/* ServerLink Receive Buffer Sizing Tests */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../testutil.hpp"
+#include "../../src/protocol/decoder_allocators.hpp"
+#include <stdio.h>
+#include <vector>
+
+#define BATCH 100
+
+static void fill(std::vector<char> &buf, size_t size, size_t seed)
+{
+    buf.resize(size);
+    for (size_t i = 0; i < size; i++)
+        buf[i] = static_cast<char>((i * 13 + seed) & 0xff);
+}
+
+/* Sends a batch of messages of one size and checks every byte on arrival */
+static void transfer(slk_socket_t *tx, slk_socket_t *rx, size_t size,
+                     int count)
+{
+    std::vector<char> payload;
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        int rc = slk_send(tx, payload.data(), payload.size(), 0);
+        TEST_ASSERT_EQ(rc, static_cast<int>(size));
+    }
+
+    for (int i = 0; i < count; i++) {
+        fill(payload, size, i);
+        TEST_ASSERT(test_poll_readable(rx, 5000));
+        slk_msg_t *msg = slk_msg_new();
+        TEST_SUCCESS(slk_msg_recv(msg, rx, 0));
+        TEST_ASSERT_EQ(slk_msg_size(msg), size);
+        TEST_ASSERT_MEM_EQ(slk_msg_data(msg), payload.data(), size);
+        slk_msg_destroy(msg);
+    }
+}
+
+/* Test: Option defaults, round trip and validation */
+static void test_options()
+{
+    slk_ctx_t *ctx = test_context_new();
+    slk_socket_t *s = test_socket_new(ctx, SLK_SUB);
+
+    int val = 0;
+    size_t len = sizeof(val);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_IN_BATCH_SIZE, &val, &len));
+    TEST_ASSERT_EQ(val, 8192);
+    TEST_SUCCESS(slk_getsockopt(s, SLK_IN_BATCH_MAX, &val, &len));
+    TEST_ASSERT_EQ(val, 256 * 1024);
+
+    val = 4096;
+    TEST_SUCCESS(slk_setsockopt(s, SLK_IN_BATCH_SIZE, &val, sizeof(val)));
+    val = 65536;
+    TEST_SUCCESS(slk_setsockopt(s, SLK_IN_BATCH_MAX, &val, sizeof(val)));
+    TEST_SUCCESS(slk_getsockopt(s, SLK_IN_BATCH_MAX, &val, &len));
+    TEST_ASSERT_EQ(val, 65536);
+
+    val = 0;
+    TEST_FAILURE(slk_setsockopt(s, SLK_IN_BATCH_MAX, &val, sizeof(val)));
+
+    test_socket_close(s);
+    test_context_destroy(ctx);
+}
+
+/* Runs a mixed workload: bulk medium messages make the buffer grow, a long
+ * run of tiny ones makes it shrink, then it has to grow again. */
+static void run_mixed_workload(int batch_size, int batch_max)
+{
+    slk_ctx_t *ctx = test_context_new();
+    const char *endpoint = test_endpoint_tcp();
+
+    slk_socket_t *pub = test_socket_new(ctx, SLK_PUB);
+    slk_socket_t *sub = test_socket_new(ctx, SLK_SUB);
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_IN_BATCH_SIZE, &batch_size,
+                                sizeof(batch_size)));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_IN_BATCH_MAX, &batch_max,
+                                sizeof(batch_max)));
+    TEST_SUCCESS(slk_setsockopt(sub, SLK_SUBSCRIBE, "", 0));
+    test_socket_bind(pub, endpoint);
+    test_socket_connect(sub, endpoint);
+    test_sleep_ms(SETTLE_TIME);
+
+    transfer(pub, sub, 20000, BATCH);
+    for (int i = 0; i < 10; i++)
+        transfer(pub, sub, 40, 1);
+    transfer(pub, sub, 40, BATCH);
+    transfer(pub, sub, 100000, BATCH / 4);
+    transfer(pub, sub, 3000, BATCH);
+    transfer(pub, sub, 2 * 1024 * 1024, 2);
+    transfer(pub, sub, 0, 1);
+
+    test_socket_close(sub);
+    test_socket_close(pub);
+    test_context_destroy(ctx);
+}
+
+/* Test: Data survives the buffer growing and shrinking */
+static void test_adaptive_buffer()
+{
+    run_mixed_workload(8192, 256 * 1024);
+}
+
+/* Test: A growth limit below the initial size keeps the buffer fixed */
+static void test_fixed_buffer()
+{
+    run_mixed_workload(8192, 1);
+}
+
+/* Reports one read into the current buffer and returns the size of the
+ * buffer the engine would read into next */
+static size_t read_and_size(slk::shared_message_memory_allocator &allocator,
+                            size_t bytes)
+{
+    allocator.observe_read(bytes);
+    allocator.allocate();
+    return allocator.size();
+}
+
+/* Test: The buffer grows under load and drops back as soon as it idles */
+static void test_buffer_grows_and_shrinks()
+{
+    slk::shared_message_memory_allocator allocator(8192);
+    allocator.set_max_size(65536);
+    allocator.allocate();
+    TEST_ASSERT_EQ(allocator.size(), 8192u);
+
+    /* Full reads double it up to the limit */
+    TEST_ASSERT_EQ(read_and_size(allocator, 8192), 16384u);
+    TEST_ASSERT_EQ(read_and_size(allocator, 16384), 32768u);
+    TEST_ASSERT_EQ(read_and_size(allocator, 32768), 65536u);
+    TEST_ASSERT_EQ(read_and_size(allocator, 65536), 65536u);
+
+    /* A read with nothing behind it leaves the connection idle: it waits
+     * for the next one in the initial size */
+    TEST_ASSERT_EQ(read_and_size(allocator, 40000), 8192u);
+
+    /* The next burst goes straight back to the size it needed */
+    TEST_ASSERT_EQ(read_and_size(allocator, 8192), 65536u);
+
+    /* Only small reads for a while make it forget that size */
+    for (int i = 0; i < 8; i++)
+        TEST_ASSERT_EQ(read_and_size(allocator, 100), 8192u);
+    TEST_ASSERT_EQ(read_and_size(allocator, 8192), 32768u);
+}
+
+int main()
+{
+    printf("=== ServerLink Receive Buffer Sizing Tests ===\n\n");
+
+    RUN_TEST(test_options);
+    RUN_TEST(test_buffer_grows_and_shrinks);
+    RUN_TEST(test_adaptive_buffer);
+    RUN_TEST(test_fixed_buffer);
+
+    printf("\n=== All Receive Buffer Sizing Tests Passed ===\n");
+    return 0;
+}
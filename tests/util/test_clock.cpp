@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Clock unit tests */
+
+#include "../testutil.hpp"
+#include "../../src/util/clock.hpp"
+#include "../../src/util/config.hpp"
+#include <thread>
+
+// The cache is refreshed after cached_clock_precision CPU ticks; any TSC
+// runs at 1 GHz or more, so that is at most this many microseconds
+static const uint64_t max_staleness_us = slk::cached_clock_precision / 1000;
+
+// Test the cached clock never goes backwards
+static void test_cached_monotonic()
+{
+    uint64_t last = slk::clock_t::now_cached_us();
+    for (int i = 0; i < 1000000; i++) {
+        const uint64_t now = slk::clock_t::now_cached_us();
+        TEST_ASSERT(now >= last);
+        last = now;
+    }
+}
+
+// Test the cached clock stays within its precision of now_us()
+static void test_cached_precision()
+{
+    for (int i = 0; i < 100000; i++) {
+        const uint64_t before = slk::clock_t::now_us();
+        const uint64_t cached = slk::clock_t::now_cached_us();
+        const uint64_t after = slk::clock_t::now_us();
+        TEST_ASSERT(cached <= after);
+        TEST_ASSERT(cached + max_staleness_us >= before);
+    }
+
+    // A sleep is far longer than the precision, so the value moves on
+    const uint64_t before = slk::clock_t::now_cached_us();
+    test_sleep_ms(10);
+    TEST_ASSERT(slk::clock_t::now_cached_us() >= before + 9000);
+}
+
+// Test each thread keeps its own cache on the same time base
+static void test_cached_threads()
+{
+    uint64_t other = 0;
+    const uint64_t before = slk::clock_t::now_us();
+    std::thread thread([&other]() { other = slk::clock_t::now_cached_us(); });
+    thread.join();
+    const uint64_t after = slk::clock_t::now_us();
+    TEST_ASSERT(other + max_staleness_us >= before);
+    TEST_ASSERT(other <= after);
+}
+
+int main()
+{
+    printf("=== ServerLink Clock Tests ===\n\n");
+
+    RUN_TEST(test_cached_monotonic);
+    RUN_TEST(test_cached_precision);
+    RUN_TEST(test_cached_threads);
+
+    printf("\n=== All Clock Tests Passed ===\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+/* SPDX-License-Identifier: MPL-2.0 */
+/* ServerLink - Routing table unit tests */
+
+#include "../testutil.hpp"
+#include "../../src/util/routing_table.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+typedef slk::routing_table_t<int> table_t;
+
+static slk::blob_t make_key(const char *s_)
+{
+    return slk::blob_t(reinterpret_cast<const unsigned char *>(s_),
+                        strlen(s_));
+}
+
+// Test basic insert and find
+static void test_insert_and_find()
+{
+    table_t table;
+    TEST_ASSERT(table.empty());
+    TEST_ASSERT(table.find(make_key("missing")) == NULL);
+
+    TEST_ASSERT(table.insert(make_key("alpha"), 1));
+    TEST_ASSERT(table.insert(make_key("beta"), 2));
+    TEST_ASSERT_EQ(table.size(), 2);
+
+    int *value = table.find(make_key("alpha"));
+    TEST_ASSERT(value != NULL);
+    TEST_ASSERT_EQ(*value, 1);
+    value = table.find(reinterpret_cast<const unsigned char *>("beta"), 4);
+    TEST_ASSERT(value != NULL);
+    TEST_ASSERT_EQ(*value, 2);
+    TEST_ASSERT(table.find(make_key("gamma")) == NULL);
+
+    // Keys are compared by bytes, not by prefix
+    TEST_ASSERT(table.find(make_key("alph")) == NULL);
+}
+
+// Test duplicate insert
+static void test_duplicate_insert()
+{
+    table_t table;
+    TEST_ASSERT(table.insert(make_key("id"), 1));
+    TEST_ASSERT(!table.insert(make_key("id"), 2));
+    TEST_ASSERT_EQ(table.size(), 1);
+    TEST_ASSERT_EQ(*table.find(make_key("id")), 1);
+}
+
+// Test erase by key
+static void test_erase()
+{
+    table_t table;
+    table.insert(make_key("a"), 1);
+    table.insert(make_key("b"), 2);
+
+    int value = 0;
+    TEST_ASSERT(table.erase(make_key("a"), &value));
+    TEST_ASSERT_EQ(value, 1);
+    TEST_ASSERT(!table.erase(make_key("a")));
+    TEST_ASSERT(table.find(make_key("a")) == NULL);
+    TEST_ASSERT_EQ(*table.find(make_key("b")), 2);
+    TEST_ASSERT_EQ(table.size(), 1);
+}
+
+// Test iteration visits every entry once
+static void test_iteration()
+{
+    table_t table;
+    char buf[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(buf, sizeof buf, "peer-%d", i);
+        table.insert(make_key(buf), i);
+    }
+
+    int sum = 0;
+    int count = 0;
+    for (table_t::iterator it = table.begin(); it != table.end(); ++it) {
+        sum += it->second;
+        count++;
+    }
+    TEST_ASSERT_EQ(count, 100);
+    TEST_ASSERT_EQ(sum, 99 * 100 / 2);
+}
+
+// Test growth and erase against std::map as a reference, so that the
+// backward-shift deletion is exercised across long probe clusters
+static void test_against_map()
+{
+    table_t table;
+    std::map<std::string, int> reference;
+    unsigned int seed = 1;
+
+    for (int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        char buf[16];
+        snprintf(buf, sizeof buf, "%u", (seed >> 8) % 5000);
+        const std::string key(buf);
+
+        if ((seed >> 4) % 3 == 0) {
+            const bool erased = table.erase(make_key(buf));
+            TEST_ASSERT_EQ(erased, reference.erase(key) == 1);
+        } else {
+            const bool inserted = table.insert(make_key(buf), i);
+            TEST_ASSERT_EQ(inserted,
+                            reference.insert(std::make_pair(key, i)).second);
+        }
+    }
+
+    TEST_ASSERT_EQ(table.size(), reference.size());
+    for (std::map<std::string, int>::iterator it = reference.begin();
+         it != reference.end(); ++it) {
+        const int *value = table.find(make_key(it->first.c_str()));
+        TEST_ASSERT(value != NULL);
+        TEST_ASSERT_EQ(*value, it->second);
+    }
+}
+
+static void make_integral_id(unsigned char *buf_, unsigned int id_)
+{
+    buf_[0] = 0;
+    buf_[1] = static_cast<unsigned char>(id_ >> 24);
+    buf_[2] = static_cast<unsigned char>(id_ >> 16);
+    buf_[3] = static_cast<unsigned char>(id_ >> 8);
+    buf_[4] = static_cast<unsigned char>(id_);
+}
+
+// Test the 5-byte integral ids ROUTER generates for anonymous peers
+static void test_integral_ids()
+{
+    table_t table;
+    unsigned char buf[5];
+    for (int i = 0; i < 1000; i++) {
+        make_integral_id(buf, 0x1000 + i);
+        TEST_ASSERT(table.insert(slk::blob_t(buf, sizeof buf), i));
+    }
+    for (int i = 0; i < 1000; i++) {
+        make_integral_id(buf, 0x1000 + i);
+        const int *value = table.find(buf, sizeof buf);
+        TEST_ASSERT(value != NULL);
+        TEST_ASSERT_EQ(*value, i);
+    }
+}
+
+int main()
+{
+    printf("Running routing_table tests...\n");
+
+    test_insert_and_find();
+    test_duplicate_insert();
+    test_erase();
+    test_iteration();
+    test_against_map();
+    test_integral_ids();
+
+    printf("All routing_table tests passed!\n");
+    return 0;
+}